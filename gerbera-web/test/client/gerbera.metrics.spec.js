@@ -0,0 +1,84 @@
+import {GerberaApp} from "../../../web/js/gerbera-app.module";
+import {Metrics} from '../../../web/js/gerbera-metrics.module';
+import mockConfig from './fixtures/config';
+import metricsDataJson from './fixtures/metrics-data';
+import gerberaEmptyMetrics from './fixtures/metrics-empty';
+
+describe('Gerbera Metrics', () => {
+  beforeEach(() => {
+    fixture.setBase('test/client/fixtures');
+    fixture.load('index.html');
+    spyOn(window.localStorage, 'getItem').and.callFake((name) => {
+        return;
+    });
+  });
+  afterEach((done) => {
+    fixture.cleanup();
+    done();
+  });
+
+  describe('initialize()', () => {
+   beforeEach(() => {
+     GerberaApp.serverConfig = mockConfig.config;
+   });
+
+   it('clears the datagrid', async () => {
+     await Metrics.initialize();
+     expect($('#metricgrid').text()).toBe('');
+   });
+  });
+  describe('loadItems()', () => {
+    beforeEach(() => {
+      GerberaApp.serverConfig = {};
+      spyOn(GerberaApp, 'getType').and.returnValue('metrics');
+    });
+
+    it('does not load items if response is failure', () => {
+      metricsDataJson.success = false;
+      Metrics.loadItems(metricsDataJson);
+      expect($('#metricgrid').find('tr').length).toEqual(0);
+      metricsDataJson.success = true;
+    });
+
+    it('does not create heading if result is empty', () => {
+      Metrics.loadItems(gerberaEmptyMetrics);
+      expect($('#metricgrid').find('tr').length).toEqual(1);
+    });
+
+    it('loads the response as items in the datagrid', () => {
+      Metrics.loadItems(metricsDataJson);
+      expect($('#metricgrid').find('tr').length).toEqual(3);
+      expect($('#metricgrid').find('tr.grb-metric').get(1).innerText).toContain('3.1 ms');
+    });
+
+    it('loads the slow queries into their own datagrid', () => {
+      Metrics.loadItems(metricsDataJson);
+      expect($('#slowquerygrid').find('tr').length).toEqual(2);
+      expect($('#slowquerygrid').find('tr.grb-metric').get(1).innerText).toContain('browse');
+      expect($('#slowquerygrid').find('tr.grb-metric').get(1).title).toContain('USING INDEX');
+    });
+
+    it('shows a note if no slow queries are recorded', () => {
+      Metrics.loadItems(gerberaEmptyMetrics);
+      expect($('#slowquerygrid').text()).toContain('No slow queries recorded');
+    });
+  });
+  describe('transformItems()', () => {
+    it('shows durations of histograms in readable units', () => {
+      const items = Metrics.transformItems(metricsDataJson.metrics.metric);
+      expect(items[0].value).toEqual(12);
+      expect(items[0].mean).toEqual('4.0 ms');
+      expect(items[0].p99).toEqual('12.3 ms');
+      expect(items[1].value).toEqual(2);
+      expect(items[1].p50).toBeUndefined();
+    });
+
+    it('shows durations of slow queries in readable units', () => {
+      const items = Metrics.transformSlowQueries(metricsDataJson.slow_queries.query);
+      expect(items[0].count).toEqual(3);
+      expect(items[0].total).toEqual('1.50 s');
+      expect(items[0].max).toEqual('750.0 ms');
+      expect(items[0].help).toContain('4711');
+    });
+  });
+ });
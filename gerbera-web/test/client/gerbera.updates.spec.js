@@ -432,4 +432,96 @@ describe('Gerbera Updates', function () {
       expect(Updates.addUiTimer).toHaveBeenCalled();
     });
   });
+  describe('subscribe()', () => {
+    let eventSource;
+    let savedEventSource;
+
+    class FakeEventSource {
+      constructor(url) {
+        this.url = url;
+        this.listeners = {};
+        this.readyState = 1;
+        eventSource = this;
+      }
+      addEventListener(name, listener) {
+        this.listeners[name] = listener;
+      }
+      close() {
+        this.closed = true;
+      }
+    }
+    FakeEventSource.CLOSED = 2;
+
+    beforeEach(() => {
+      savedEventSource = window.EventSource;
+      window.EventSource = FakeEventSource;
+      eventSource = undefined;
+      spyOn(Auth, 'getSessionId').and.returnValue('SESSION_ID');
+      spyOn(GerberaApp, 'isLoggedIn').and.returnValue(true);
+      GerberaApp.serverConfig = {'push-updates': true, 'poll-interval': 100};
+    });
+
+    afterEach(() => {
+      Updates.unsubscribe();
+      window.EventSource = savedEventSource;
+    });
+
+    it('opens an event stream when push updates are enabled', () => {
+      expect(Updates.subscribe()).toBe(true);
+
+      expect(eventSource.url).toEqual('content/interface?req_type=events&updates=get&' + Auth.SID + '=SESSION_ID');
+      expect(Updates.isPushing()).toBe(true);
+      expect(Updates.subscribe()).toBe(false);
+    });
+
+    it('does not open an event stream when push updates are disabled', () => {
+      GerberaApp.serverConfig['push-updates'] = false;
+
+      expect(Updates.subscribe()).toBe(false);
+      expect(eventSource).toBeUndefined();
+    });
+
+    it('passes pushed events to the task and tree updates', async () => {
+      spyOn(Updates, 'updateTask').and.callFake((response) => Promise.resolve(response));
+      spyOn(Updates, 'updateUi').and.callFake((response) => Promise.resolve(response));
+      Updates.subscribe();
+
+      await eventSource.listeners['update']({data: JSON.stringify(updateIds)});
+
+      expect(Updates.updateTask).toHaveBeenCalledWith(updateIds);
+      expect(Updates.updateUi).toHaveBeenCalledWith(updateIds);
+    });
+
+    it('does not poll for tasks while pushing', () => {
+      Updates.subscribe();
+
+      Updates.addTaskInterval();
+
+      expect(Updates.isPolling()).toBeFalsy();
+    });
+
+    it('falls back to polling when the server refuses the stream', () => {
+      spyOn(Updates, 'getUpdates');
+      spyOn(Updates, 'errorCheck');
+      Updates.subscribe();
+      const stream = eventSource;
+
+      stream.listeners['error']({data: JSON.stringify(invalidResponse)});
+
+      expect(stream.closed).toBe(true);
+      expect(Updates.isPushing()).toBe(false);
+      expect(Updates.getUpdates).toHaveBeenCalledWith(false);
+    });
+
+    it('keeps the stream while the browser reconnects', () => {
+      spyOn(Updates, 'getUpdates');
+      Updates.subscribe();
+
+      eventSource.readyState = 0;
+      eventSource.listeners['error']({});
+
+      expect(Updates.isPushing()).toBe(true);
+      expect(Updates.getUpdates).not.toHaveBeenCalled();
+    });
+  });
 });
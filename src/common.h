@@ -57,6 +57,7 @@ static constexpr bool IS_FORBIDDEN_CDS_ID(int id) { return id <= CDS_ID_FS_ROOT;
 #define CONTENT_MEDIA_HANDLER "media"
 #define CONTENT_ONLINE_HANDLER "online"
 #define CONTENT_UI_HANDLER "interface"
+#define CONTENT_METRICS_HANDLER "metrics"
 #define DEVICE_DESCRIPTION_PATH "description.xml"
 
 // SEPARATOR
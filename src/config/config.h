@@ -34,6 +34,7 @@ class AutoscanDirectory;
 class AutoscanList;
 class ClientConfigList;
 class ConfigOption;
+class ConfigSnapshot;
 class Database;
 class DirectoryConfigList;
 class DynamicContentList;
@@ -62,9 +63,13 @@ enum config_option_t {
     CFG_SERVER_HIDE_PC_DIRECTORY,
     CFG_SERVER_BOOKMARK_FILE,
     CFG_SERVER_UPNP_TITLE_AND_DESC_STRING_LIMIT,
+    CFG_SERVER_CONTAINER_UPDATES_MODERATION,
+    CFG_SERVER_CONTAINER_UPDATES_MAX_CONTAINERS,
+    CFG_SERVER_CONTAINER_UPDATES_MAX_SIZE,
     CFG_SERVER_UI_ENABLED,
     CFG_SERVER_UI_POLL_INTERVAL,
     CFG_SERVER_UI_POLL_WHEN_IDLE,
+    CFG_SERVER_UI_PUSH_UPDATES,
     CFG_SERVER_UI_ENABLE_NUMBERING,
     CFG_SERVER_UI_ENABLE_THUMBNAIL,
     CFG_SERVER_UI_ENABLE_VIDEO,
@@ -74,11 +79,14 @@ enum config_option_t {
     CFG_SERVER_UI_DEFAULT_ITEMS_PER_PAGE,
     CFG_SERVER_UI_ITEMS_PER_PAGE_DROPDOWN,
     CFG_SERVER_UI_SHOW_TOOLTIPS,
+    CFG_SERVER_METRICS_ENABLED,
     CFG_SERVER_STORAGE,
     CFG_SERVER_STORAGE_MYSQL,
     CFG_SERVER_STORAGE_SQLITE,
     CFG_SERVER_STORAGE_DRIVER,
     CFG_SERVER_STORAGE_USE_TRANSACTIONS,
+    CFG_SERVER_STORAGE_SLOW_QUERY_TIME,
+    CFG_SERVER_STORAGE_EXPLAIN_SLOW_QUERIES,
     CFG_SERVER_STORAGE_SQLITE_ENABLED,
     CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE,
     CFG_SERVER_STORAGE_SQLITE_SYNCHRONOUS,
@@ -107,6 +115,9 @@ enum config_option_t {
     CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_IMAGE_QUALITY,
     CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR_ENABLED,
     CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR,
+    CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_PREGENERATE,
+    CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_MAX_SIZE,
+    CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_WORKERS,
 #endif
     CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_ENABLED,
     CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_STRING_MODE_PREPEND,
@@ -235,6 +246,24 @@ enum config_option_t {
     CFG_SERVER_DYNAMIC_CONTENT_LIST_ENABLED,
     CFG_SERVER_DYNAMIC_CONTENT_LIST,
     CFG_IMPORT_RESOURCES_ORDER,
+    CFG_SERVER_EXTOPTS_PREFETCH_ENABLED,
+    CFG_SERVER_EXTOPTS_PREFETCH_BUFFER_SIZE,
+    CFG_SERVER_EXTOPTS_PREFETCH_CHUNK_SIZE,
+    CFG_SERVER_EXTOPTS_PREFETCH_FILL_SIZE,
+    CFG_SERVER_EXTOPTS_MAPPED_FILES_ENABLED,
+    CFG_SERVER_EXTOPTS_MAPPED_FILES_MAX_FILE_SIZE,
+    CFG_SERVER_EXTOPTS_MAPPED_FILES_CACHE_SIZE,
+    CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_ENABLED,
+    CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_DIR,
+    CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_SIZES,
+    CFG_SERVER_EXTOPTS_OBJECT_CACHE_ENABLED,
+    CFG_SERVER_EXTOPTS_OBJECT_CACHE_SIZE,
+    CFG_SERVER_EXTOPTS_OBJECT_CACHE_TTL,
+    CFG_TRANSCODING_CACHE_ENABLED,
+    CFG_TRANSCODING_CACHE_DIR,
+    CFG_TRANSCODING_CACHE_SIZE,
+    CFG_TRANSCODING_SCHEDULER_MAX_JOBS,
+    CFG_TRANSCODING_SCHEDULER_QUEUE_TIMEOUT,
 
     CFG_MAX,
 
@@ -286,6 +315,9 @@ enum config_option_t {
     ATTR_TRANSCODING_PROFILES_PROFLE_THUMB,
     ATTR_TRANSCODING_PROFILES_PROFLE_FIRST,
     ATTR_TRANSCODING_PROFILES_PROFLE_ACCOGG,
+    ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS,
+    ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES,
+    ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT,
     ATTR_TRANSCODING_PROFILES_PROFLE_AGENT,
     ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND,
     ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS,
@@ -293,6 +325,9 @@ enum config_option_t {
     ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ENVIRON_KEY,
     ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ENVIRON_NAME,
     ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ENVIRON_VALUE,
+    ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL,
+    ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT,
+    ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC,
     ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER,
     ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_SIZE,
     ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_CHUNK,
@@ -360,6 +395,15 @@ public:
     /// \param option option to retrieve.
     virtual std::string getOption(config_option_t option) const = 0;
 
+    /// \brief returns the current snapshot of frequently read options
+    ///
+    /// Hold the returned pointer while using references into the snapshot,
+    /// it keeps the old values alive after the next updateSnapshot.
+    virtual std::shared_ptr<const ConfigSnapshot> getSnapshot() const = 0;
+
+    /// \brief publish the current option values as new snapshot
+    virtual void updateSnapshot() = 0;
+
     /// \brief returns a config option of type int
     /// \param option option to retrieve.
     virtual int getIntOption(config_option_t option) const = 0;
@@ -50,7 +50,10 @@
 #define DEFAULT_TMPDIR "/tmp/"
 #define DEFAULT_UI_EN_VALUE YES
 #define DEFAULT_UI_SHOW_TOOLTIPS_VALUE YES
+#define DEFAULT_METRICS_EN_VALUE NO
+#define DEFAULT_SLOW_QUERY_TIME 0 // milliseconds, disabled
 #define DEFAULT_POLL_WHEN_IDLE_VALUE NO
+#define DEFAULT_PUSH_UPDATES_VALUE YES
 #define DEFAULT_POLL_INTERVAL 2
 #define DEFAULT_ACCOUNTS_EN_VALUE NO
 #define DEFAULT_ALIVE_INTERVAL 180 // seconds
@@ -63,6 +66,9 @@
 #define DEFAULT_FOLLOW_SYMLINKS_VALUE YES
 #define DEFAULT_RESOURCES_CASE_SENSITIVE YES
 #define DEFAULT_UPNP_STRING_LIMIT (-1)
+#define DEFAULT_CONTAINER_UPDATES_MODERATION 2 // seconds
+#define DEFAULT_CONTAINER_UPDATES_MAX_CONTAINERS 100
+#define DEFAULT_CONTAINER_UPDATES_MAX_SIZE 4096
 #define DEFAULT_SESSION_TIMEOUT 30
 #define DEFAULT_PRES_URL_APPENDTO_ATTR "none"
 #define DEFAULT_ITEMS_PER_PAGE 25
@@ -112,6 +118,9 @@
 #define DEFAULT_FFMPEGTHUMBNAILER_IMAGE_QUALITY 8
 #define DEFAULT_FFMPEGTHUMBNAILER_CACHE_DIR_ENABLED YES
 #define DEFAULT_FFMPEGTHUMBNAILER_CACHE_DIR ""
+#define DEFAULT_FFMPEGTHUMBNAILER_PREGENERATE NO
+#define DEFAULT_FFMPEGTHUMBNAILER_CACHE_MAX_SIZE 268435456
+#define DEFAULT_FFMPEGTHUMBNAILER_WORKERS 1
 #endif
 
 #if defined(HAVE_LASTFMLIB)
@@ -124,6 +133,30 @@
 #define DEFAULT_MARK_PLAYED_ITEMS_SUPPRESS_CDS_UPDATES YES
 #define DEFAULT_MARK_PLAYED_ITEMS_STRING "*"
 
+#define DEFAULT_PREFETCH_ENABLED NO
+#define DEFAULT_PREFETCH_BUFFER_SIZE 4194304
+#define DEFAULT_PREFETCH_CHUNK_SIZE 262144
+#define DEFAULT_PREFETCH_FILL_SIZE 0
+
+#define DEFAULT_MAPPED_FILES_ENABLED NO
+#define DEFAULT_MAPPED_FILES_MAX_FILE_SIZE 1048576
+#define DEFAULT_MAPPED_FILES_CACHE_SIZE 67108864
+
+#define DEFAULT_ALBUM_ART_CACHE_ENABLED NO
+#define DEFAULT_ALBUM_ART_CACHE_DIR ""
+#define DEFAULT_ALBUM_ART_CACHE_SIZES "160"
+
+#define DEFAULT_OBJECT_CACHE_ENABLED NO
+#define DEFAULT_OBJECT_CACHE_SIZE 256
+#define DEFAULT_OBJECT_CACHE_TTL 60
+
+#define DEFAULT_TRANSCODING_CACHE_ENABLED NO
+#define DEFAULT_TRANSCODING_CACHE_DIR ""
+#define DEFAULT_TRANSCODING_CACHE_SIZE 4096
+
+#define DEFAULT_TRANSCODING_SCHEDULER_MAX_JOBS 0
+#define DEFAULT_TRANSCODING_SCHEDULER_QUEUE_TIMEOUT 0
+
 /// \brief default values for CFG_IMPORT_SYSTEM_DIRECTORIES
 static const std::vector<std::string> excludesFullpath {
     "/bin",
@@ -389,6 +422,15 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
     std::make_shared<ConfigIntSetup>(CFG_SERVER_UPNP_TITLE_AND_DESC_STRING_LIMIT,
         "/server/upnp-string-limit", "config-server.html#upnp-string-limit",
         DEFAULT_UPNP_STRING_LIMIT, ConfigIntSetup::CheckUpnpStringLimitValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_CONTAINER_UPDATES_MODERATION,
+        "/server/container-updates/attribute::moderation", "config-server.html#container-updates",
+        DEFAULT_CONTAINER_UPDATES_MODERATION, 2, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_CONTAINER_UPDATES_MAX_CONTAINERS,
+        "/server/container-updates/attribute::max-containers", "config-server.html#container-updates",
+        DEFAULT_CONTAINER_UPDATES_MAX_CONTAINERS, 1, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_CONTAINER_UPDATES_MAX_SIZE,
+        "/server/container-updates/attribute::max-size", "config-server.html#container-updates",
+        DEFAULT_CONTAINER_UPDATES_MAX_SIZE, 64, ConfigIntSetup::CheckMinValue),
 
     std::make_shared<ConfigStringSetup>(CFG_SERVER_STORAGE,
         "/server/storage", "config-server.html#storage",
@@ -396,6 +438,12 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
     std::make_shared<ConfigBoolSetup>(CFG_SERVER_STORAGE_USE_TRANSACTIONS,
         "/server/storage/attribute::use-transactions", "config-server.html#storage",
         NO),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_STORAGE_SLOW_QUERY_TIME,
+        "/server/storage/attribute::slow-query-time", "config-server.html#storage",
+        DEFAULT_SLOW_QUERY_TIME, 0, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_STORAGE_EXPLAIN_SLOW_QUERIES,
+        "/server/storage/attribute::explain-slow-queries", "config-server.html#storage",
+        NO),
     std::make_shared<ConfigStringSetup>(CFG_SERVER_STORAGE_MYSQL,
         "/server/storage/mysql", "config-server.html#storage"),
 #ifdef HAVE_MYSQL
@@ -476,6 +524,9 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
     std::make_shared<ConfigBoolSetup>(CFG_SERVER_UI_POLL_WHEN_IDLE,
         "/server/ui/attribute::poll-when-idle", "config-server.html#ui",
         DEFAULT_POLL_WHEN_IDLE_VALUE),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_UI_PUSH_UPDATES,
+        "/server/ui/attribute::push-updates", "config-server.html#ui",
+        DEFAULT_PUSH_UPDATES_VALUE),
     std::make_shared<ConfigBoolSetup>(CFG_SERVER_UI_ENABLE_NUMBERING,
         "/server/ui/attribute::show-numbering", "config-server.html#ui",
         YES),
@@ -505,6 +556,10 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
         "/server/ui/attribute::show-tooltips", "config-server.html#ui",
         DEFAULT_UI_SHOW_TOOLTIPS_VALUE),
 
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_METRICS_ENABLED,
+        "/server/metrics/attribute::enabled", "config-server.html#metrics",
+        DEFAULT_METRICS_EN_VALUE),
+
     std::make_shared<ConfigBoolSetup>(CFG_THREAD_SCOPE_SYSTEM,
         "/server/attribute::system-threads", "config-server.html#system-threads",
         YES),
@@ -641,6 +696,21 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
         DEFAULT_TRANSCODING_ENABLED),
     std::make_shared<ConfigTranscodingSetup>(CFG_TRANSCODING_PROFILE_LIST,
         "/transcoding", "config-transcode.html#transcoding"),
+    std::make_shared<ConfigBoolSetup>(CFG_TRANSCODING_CACHE_ENABLED,
+        "/transcoding/cache/attribute::enabled", "config-transcode.html#cache",
+        DEFAULT_TRANSCODING_CACHE_ENABLED),
+    std::make_shared<ConfigStringSetup>(CFG_TRANSCODING_CACHE_DIR, // ConfigPathSetup
+        "/transcoding/cache/attribute::location", "config-transcode.html#cache",
+        DEFAULT_TRANSCODING_CACHE_DIR),
+    std::make_shared<ConfigIntSetup>(CFG_TRANSCODING_CACHE_SIZE,
+        "/transcoding/cache/attribute::max-size", "config-transcode.html#cache",
+        DEFAULT_TRANSCODING_CACHE_SIZE, 1, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_TRANSCODING_SCHEDULER_MAX_JOBS,
+        "/transcoding/scheduler/attribute::max-jobs", "config-transcode.html#scheduler",
+        DEFAULT_TRANSCODING_SCHEDULER_MAX_JOBS, 0, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_TRANSCODING_SCHEDULER_QUEUE_TIMEOUT,
+        "/transcoding/scheduler/attribute::queue-timeout", "config-transcode.html#scheduler",
+        DEFAULT_TRANSCODING_SCHEDULER_QUEUE_TIMEOUT, ConfigIntSetup::CheckTranscodeQueueTimeoutValue),
 
     std::make_shared<ConfigStringSetup>(CFG_IMPORT_LIBOPTS_ENTRY_SEP,
         "/import/library-options/attribute::multi-value-separator", "config-import.html#library-options",
@@ -728,6 +798,15 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
     std::make_shared<ConfigStringSetup>(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR, // ConfigPathSetup
         "/server/extended-runtime-options/ffmpegthumbnailer/cache-dir", "config-extended.html#ffmpegthumbnailer",
         DEFAULT_FFMPEGTHUMBNAILER_CACHE_DIR),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_PREGENERATE,
+        "/server/extended-runtime-options/ffmpegthumbnailer/cache-dir/attribute::pregenerate", "config-extended.html#ffmpegthumbnailer",
+        DEFAULT_FFMPEGTHUMBNAILER_PREGENERATE),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_MAX_SIZE,
+        "/server/extended-runtime-options/ffmpegthumbnailer/cache-dir/attribute::max-size", "config-extended.html#ffmpegthumbnailer",
+        DEFAULT_FFMPEGTHUMBNAILER_CACHE_MAX_SIZE, 0, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_WORKERS,
+        "/server/extended-runtime-options/ffmpegthumbnailer/attribute::workers", "config-extended.html#ffmpegthumbnailer",
+        DEFAULT_FFMPEGTHUMBNAILER_WORKERS, 1, ConfigIntSetup::CheckMinValue),
 #endif
 
     std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_ENABLED,
@@ -745,6 +824,45 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
     std::make_shared<ConfigArraySetup>(CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_CONTENT_LIST,
         "/server/extended-runtime-options/mark-played-items/mark", "config-extended.html#extended-runtime-options",
         ATTR_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_CONTENT, ConfigArraySetup::InitPlayedItemsMark),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_PREFETCH_ENABLED,
+        "/server/extended-runtime-options/prefetch/attribute::enabled", "config-extended.html#prefetch",
+        DEFAULT_PREFETCH_ENABLED),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_PREFETCH_BUFFER_SIZE,
+        "/server/extended-runtime-options/prefetch/attribute::buffer-size", "config-extended.html#prefetch",
+        DEFAULT_PREFETCH_BUFFER_SIZE, 65536, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_PREFETCH_CHUNK_SIZE,
+        "/server/extended-runtime-options/prefetch/attribute::chunk-size", "config-extended.html#prefetch",
+        DEFAULT_PREFETCH_CHUNK_SIZE, 4096, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_PREFETCH_FILL_SIZE,
+        "/server/extended-runtime-options/prefetch/attribute::fill-size", "config-extended.html#prefetch",
+        DEFAULT_PREFETCH_FILL_SIZE, 0, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_MAPPED_FILES_ENABLED,
+        "/server/extended-runtime-options/mapped-files/attribute::enabled", "config-extended.html#mapped-files",
+        DEFAULT_MAPPED_FILES_ENABLED),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_MAPPED_FILES_MAX_FILE_SIZE,
+        "/server/extended-runtime-options/mapped-files/attribute::max-file-size", "config-extended.html#mapped-files",
+        DEFAULT_MAPPED_FILES_MAX_FILE_SIZE, 1, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_MAPPED_FILES_CACHE_SIZE,
+        "/server/extended-runtime-options/mapped-files/attribute::cache-size", "config-extended.html#mapped-files",
+        DEFAULT_MAPPED_FILES_CACHE_SIZE, 1, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_ENABLED,
+        "/server/extended-runtime-options/album-art-cache/attribute::enabled", "config-extended.html#album-art-cache",
+        DEFAULT_ALBUM_ART_CACHE_ENABLED),
+    std::make_shared<ConfigStringSetup>(CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_DIR, // ConfigPathSetup
+        "/server/extended-runtime-options/album-art-cache/attribute::location", "config-extended.html#album-art-cache",
+        DEFAULT_ALBUM_ART_CACHE_DIR),
+    std::make_shared<ConfigStringSetup>(CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_SIZES,
+        "/server/extended-runtime-options/album-art-cache/attribute::scaled-sizes", "config-extended.html#album-art-cache",
+        DEFAULT_ALBUM_ART_CACHE_SIZES),
+    std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_OBJECT_CACHE_ENABLED,
+        "/server/extended-runtime-options/object-cache/attribute::enabled", "config-extended.html#object-cache",
+        DEFAULT_OBJECT_CACHE_ENABLED),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_OBJECT_CACHE_SIZE,
+        "/server/extended-runtime-options/object-cache/attribute::size", "config-extended.html#object-cache",
+        DEFAULT_OBJECT_CACHE_SIZE, 1, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(CFG_SERVER_EXTOPTS_OBJECT_CACHE_TTL,
+        "/server/extended-runtime-options/object-cache/attribute::ttl", "config-extended.html#object-cache",
+        DEFAULT_OBJECT_CACHE_TTL, 1, ConfigIntSetup::CheckMinValue),
 #ifdef HAVE_LASTFMLIB
     std::make_shared<ConfigBoolSetup>(CFG_SERVER_EXTOPTS_LASTFM_ENABLED,
         "/server/extended-runtime-options/lastfm/attribute::enabled", "config-extended.html#lastfm",
@@ -880,7 +998,7 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
         NO),
     std::make_shared<ConfigEnumSetup<transcoding_type_t>>(ATTR_TRANSCODING_PROFILES_PROFLE_TYPE,
         "attribute::type", "config-transcode.html#profiles",
-        std::map<std::string, transcoding_type_t>({ { "none", TR_None }, { "external", TR_External }, /* for the future...{"remote", TR_Remote}*/ })),
+        std::map<std::string, transcoding_type_t>({ { "none", TR_None }, { "external", TR_External }, { "internal", TR_Internal }, /* for the future...{"remote", TR_Remote}*/ })),
     std::make_shared<ConfigEnumSetup<avi_fourcc_listmode_t>>(ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_MODE,
         "mode", "config-transcode.html#profiles",
         std::map<std::string, avi_fourcc_listmode_t>({ { "ignore", FCC_Ignore }, { "process", FCC_Process }, { "disabled", FCC_None } })),
@@ -908,6 +1026,15 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
         "first-resource", "config-transcode.html#profiles"),
     std::make_shared<ConfigBoolSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_ACCOGG,
         "accept-ogg-theora", "config-transcode.html#profiles"),
+    std::make_shared<ConfigIntSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS,
+        "attribute::max-jobs", "config-transcode.html#profiles",
+        0, 0, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigIntSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES,
+        "attribute::warm-processes", "config-transcode.html#profiles",
+        0, 0, ConfigIntSetup::CheckMinValue),
+    std::make_shared<ConfigBoolSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT,
+        "attribute::use-stdout", "config-transcode.html#profiles",
+        false),
     std::make_shared<ConfigArraySetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC,
         "avi-fourcc-list", "config-transcode.html#profiles",
         ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_4CC, CFG_MAX, true, true),
@@ -955,6 +1082,15 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
     std::make_shared<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT,
         "agent", "config-transcode.html#profiles",
         true),
+    std::make_shared<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL,
+        "internal", "config-transcode.html#profiles",
+        false),
+    std::make_shared<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT,
+        "attribute::format", "config-transcode.html#profiles",
+        true, "", true),
+    std::make_shared<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC,
+        "attribute::audio-codec", "config-transcode.html#profiles",
+        false, "copy", true),
     std::make_shared<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER,
         "buffer", "config-transcode.html#profiles",
         true),
@@ -1175,6 +1311,9 @@ const std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::complexOptions
 const std::map<config_option_t, std::vector<config_option_t>> ConfigDefinition::parentOptions {
     { ATTR_TRANSCODING_PROFILES_PROFLE_ENABLED, { CFG_TRANSCODING_PROFILE_LIST } },
     { ATTR_TRANSCODING_PROFILES_PROFLE_CLIENTFLAGS, { CFG_TRANSCODING_PROFILE_LIST } },
+    { ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS, { CFG_TRANSCODING_PROFILE_LIST } },
+    { ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES, { CFG_TRANSCODING_PROFILE_LIST } },
+    { ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT, { CFG_TRANSCODING_PROFILE_LIST } },
     { ATTR_TRANSCODING_PROFILES_PROFLE_ACCURL, { CFG_TRANSCODING_PROFILE_LIST } },
     { ATTR_TRANSCODING_PROFILES_PROFLE_TYPE, { CFG_TRANSCODING_PROFILE_LIST } },
 
@@ -1292,6 +1431,9 @@ const std::map<config_option_t, config_option_t> ConfigDefinition::dependencyMap
     { CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_IMAGE_QUALITY, CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED },
     { CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR_ENABLED, CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED },
     { CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR, CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED },
+    { CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_PREGENERATE, CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED },
+    { CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_MAX_SIZE, CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED },
+    { CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_WORKERS, CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED },
 #endif
 #if defined(HAVE_LASTFMLIB)
     { CFG_SERVER_EXTOPTS_LASTFM_USERNAME, CFG_SERVER_EXTOPTS_LASTFM_ENABLED },
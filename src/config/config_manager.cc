@@ -458,6 +458,8 @@ void ConfigManager::load(const fs::path& userHome)
 
     // now the XML is no longer needed we can destroy it
     xmlDoc = nullptr;
+
+    updateSnapshot();
 }
 
 void ConfigManager::updateConfigFromDatabase(std::shared_ptr<Database> database)
@@ -493,6 +495,13 @@ void ConfigManager::updateConfigFromDatabase(std::shared_ptr<Database> database)
             log_error("error setting option {}. Exception {}", cfgValue.key, e.what());
         }
     }
+
+    updateSnapshot();
+}
+
+void ConfigManager::updateSnapshot()
+{
+    std::atomic_store(&snapshot, std::shared_ptr<const ConfigSnapshot>(std::make_shared<ConfigSnapshot>(*this)));
 }
 
 void ConfigManager::setOrigValue(const std::string& item, const std::string& value)
@@ -40,6 +40,7 @@
 
 #include "common.h"
 #include "config.h"
+#include "config_snapshot.h"
 
 // forward declaration
 class AutoscanDirectory;
@@ -78,6 +79,9 @@ public:
     /// \param option option to retrieve.
     std::string getOption(config_option_t option) const override;
 
+    std::shared_ptr<const ConfigSnapshot> getSnapshot() const override { return std::atomic_load(&snapshot); }
+    void updateSnapshot() override;
+
     /// \brief returns a config option of type int
     /// \param option option to retrieve.
     int getIntOption(config_option_t option) const override;
@@ -144,6 +148,9 @@ protected:
 
     std::vector<std::shared_ptr<ConfigOption>> options { CFG_MAX };
 
+    /// \brief current snapshot, read and replaced with std::atomic_load / std::atomic_store
+    std::shared_ptr<const ConfigSnapshot> snapshot { std::make_shared<ConfigSnapshot>() };
+
     std::shared_ptr<ConfigOption> setOption(const pugi::xml_node& root, config_option_t option, const std::map<std::string, std::string>* arguments = nullptr);
 
     std::shared_ptr<Config> getSelf();
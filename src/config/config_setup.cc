@@ -402,6 +402,12 @@ bool ConfigIntSetup::CheckUpnpStringLimitValue(int value)
     return !((value != -1) && (value < 4));
 }
 
+bool ConfigIntSetup::CheckTranscodeQueueTimeoutValue(int value)
+{
+    // waiting requests block a thread of the web server
+    return !(value < 0 || value > 5);
+}
+
 bool ConfigIntSetup::CheckPortValue(int value)
 {
     return !(value < 0 || value > 65535);
@@ -1122,12 +1128,24 @@ bool ConfigTranscodingSetup::createOptionFromNode(const pugi::xml_node& element,
             if (cs->hasXmlElement(child))
                 prof->setTheora(cs->getXmlContent(child));
         }
+        prof->setMaxJobs(ConfigDefinition::findConfigSetup<ConfigIntSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS)->getXmlContent(child));
+        prof->setWarmProcesses(ConfigDefinition::findConfigSetup<ConfigIntSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES)->getXmlContent(child));
+        prof->setUseStdout(ConfigDefinition::findConfigSetup<ConfigBoolSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT)->getXmlContent(child));
 
-        // read agent options
-        sub = ConfigDefinition::findConfigSetup<ConfigSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT)->getXmlElement(child);
-        prof->setCommand(ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND)->getXmlContent(sub));
-        prof->setArguments(ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS)->getXmlContent(sub));
-        {
+        if (prof->getType() == TR_Internal) {
+            // read internal options, there is no agent to run
+            sub = ConfigDefinition::findConfigSetup<ConfigSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL)->getXmlElement(child);
+            if (!sub) {
+                log_error("Error in configuration: internal transcoding profile \"{}\" needs an internal tag", prof->getName());
+                return false;
+            }
+            prof->setFormat(ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT)->getXmlContent(sub));
+            prof->setAudioCodec(ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC)->getXmlContent(sub));
+        } else {
+            // read agent options
+            sub = ConfigDefinition::findConfigSetup<ConfigSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT)->getXmlElement(child);
+            prof->setCommand(ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND)->getXmlContent(sub));
+            prof->setArguments(ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS)->getXmlContent(sub));
             auto cs = ConfigDefinition::findConfigSetup<ConfigDictionarySetup>(ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ENVIRON);
             if (cs->hasXmlElement(child))
                 prof->setEnviron(cs->getXmlContent(cs->getXmlElement(child)));
@@ -1322,6 +1340,27 @@ bool ConfigTranscodingSetup::updateDetail(const std::string& optItem, std::strin
                 log_debug("New Transcoding Detail {} {}", index, config->getTranscodingProfileListOption(option)->getByName(entry->getName(), true)->getSampleFreq());
                 return true;
             }
+            index = getItemPath(i, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS);
+            if (optItem == index) {
+                config->setOrigValue(index, entry->getMaxJobs());
+                entry->setMaxJobs(ConfigDefinition::findConfigSetup<ConfigIntSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS)->checkIntValue(optValue));
+                log_debug("New Transcoding Detail {} {}", index, config->getTranscodingProfileListOption(option)->getByName(entry->getName(), true)->getMaxJobs());
+                return true;
+            }
+            index = getItemPath(i, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES);
+            if (optItem == index) {
+                config->setOrigValue(index, entry->getWarmProcesses());
+                entry->setWarmProcesses(ConfigDefinition::findConfigSetup<ConfigIntSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES)->checkIntValue(optValue));
+                log_debug("New Transcoding Detail {} {}", index, config->getTranscodingProfileListOption(option)->getByName(entry->getName(), true)->getWarmProcesses());
+                return true;
+            }
+            index = getItemPath(i, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT);
+            if (optItem == index) {
+                config->setOrigValue(index, entry->useStdout());
+                entry->setUseStdout(ConfigDefinition::findConfigSetup<ConfigBoolSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT)->checkValue(optValue));
+                log_debug("New Transcoding Detail {} {}", index, config->getTranscodingProfileListOption(option)->getByName(entry->getName(), true)->useStdout());
+                return true;
+            }
             index = getItemPath(i, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_NRCHAN);
             if (optItem == index) {
                 config->setOrigValue(index, entry->getNumChannels());
@@ -1416,6 +1455,26 @@ bool ConfigTranscodingSetup::updateDetail(const std::string& optItem, std::strin
                 }
             }
 
+            // update internal options
+            index = getItemPath(i, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT);
+            if (optItem == index) {
+                if (ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT)->checkValue(optValue)) {
+                    config->setOrigValue(index, entry->getFormat());
+                    entry->setFormat(optValue);
+                    log_debug("New Transcoding Detail {} {}", index, config->getTranscodingProfileListOption(option)->getByName(entry->getName(), true)->getFormat());
+                    return true;
+                }
+            }
+            index = getItemPath(i, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC);
+            if (optItem == index) {
+                if (ConfigDefinition::findConfigSetup<ConfigStringSetup>(ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC)->checkValue(optValue)) {
+                    config->setOrigValue(index, entry->getAudioCodec());
+                    entry->setAudioCodec(optValue);
+                    log_debug("New Transcoding Detail {} {}", index, config->getTranscodingProfileListOption(option)->getByName(entry->getName(), true)->getAudioCodec());
+                    return true;
+                }
+            }
+
             // update 4cc options
             avi_fourcc_listmode_t fccMode = entry->getAVIFourCCListMode();
             auto fccList = entry->getAVIFourCCList();
@@ -386,6 +386,8 @@ public:
     static bool CheckPortValue(int value);
 
     static bool CheckUpnpStringLimitValue(int value);
+
+    static bool CheckTranscodeQueueTimeoutValue(int value);
 };
 
 class ConfigBoolSetup : public ConfigSetup {
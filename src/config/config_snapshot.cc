@@ -0,0 +1,57 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    config_snapshot.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file config_snapshot.cc
+
+#include "config_snapshot.h" // API
+
+#include "config/config.h"
+
+ConfigSnapshot::ConfigSnapshot(const Config& config)
+    : prefetchEnabled(config.getBoolOption(CFG_SERVER_EXTOPTS_PREFETCH_ENABLED))
+    , prefetchBufferSize(config.getIntOption(CFG_SERVER_EXTOPTS_PREFETCH_BUFFER_SIZE))
+    , prefetchChunkSize(config.getIntOption(CFG_SERVER_EXTOPTS_PREFETCH_CHUNK_SIZE))
+    , prefetchFillSize(config.getIntOption(CFG_SERVER_EXTOPTS_PREFETCH_FILL_SIZE))
+{
+    auto mappings = config.getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
+    mimetypeContenttype.reserve(mappings.size());
+    mimetypeContenttype.insert(mappings.begin(), mappings.end());
+
+    auto profiles = config.getDictionaryOption(CFG_IMPORT_MAPPINGS_CONTENTTYPE_TO_DLNAPROFILE_LIST);
+    contenttypeDlnaprofile.reserve(profiles.size());
+    contenttypeDlnaprofile.insert(profiles.begin(), profiles.end());
+}
+
+const std::string& ConfigSnapshot::getContentType(const std::string& mimeType) const
+{
+    static const std::string empty;
+    auto it = mimetypeContenttype.find(mimeType);
+    return it != mimetypeContenttype.end() ? it->second : empty;
+}
+
+const std::string& ConfigSnapshot::getDlnaProfile(const std::string& contentType) const
+{
+    static const std::string empty;
+    auto it = contenttypeDlnaprofile.find(contentType);
+    return it != contenttypeDlnaprofile.end() ? it->second : empty;
+}
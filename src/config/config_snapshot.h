@@ -0,0 +1,62 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    config_snapshot.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file config_snapshot.h
+///\brief Definitions of the ConfigSnapshot class.
+
+#ifndef __CONFIG_SNAPSHOT_H__
+#define __CONFIG_SNAPSHOT_H__
+
+#include <string>
+#include <unordered_map>
+
+// forward declaration
+class Config;
+
+/// \brief Typed copy of the options read on every request or imported file.
+///
+/// A snapshot is never changed after construction. The config publishes a
+/// new one when options change, readers keep the shared_ptr they got.
+class ConfigSnapshot {
+public:
+    ConfigSnapshot() = default;
+    explicit ConfigSnapshot(const Config& config);
+
+    /// \brief content type for a mime type, empty if not mapped
+    const std::string& getContentType(const std::string& mimeType) const;
+
+    /// \brief DLNA profile for a content type, empty if not mapped
+    const std::string& getDlnaProfile(const std::string& contentType) const;
+
+    /// \brief CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST
+    std::unordered_map<std::string, std::string> mimetypeContenttype;
+    /// \brief CFG_IMPORT_MAPPINGS_CONTENTTYPE_TO_DLNAPROFILE_LIST
+    std::unordered_map<std::string, std::string> contenttypeDlnaprofile;
+
+    bool prefetchEnabled {};
+    std::size_t prefetchBufferSize {};
+    std::size_t prefetchChunkSize {};
+    std::size_t prefetchFillSize {};
+};
+
+#endif // __CONFIG_SNAPSHOT_H__
@@ -0,0 +1,104 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    autoscan_index.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file autoscan_index.cc
+
+#include "autoscan_index.h" // API
+
+#include "autoscan.h"
+#include "autoscan_list.h"
+#include "common.h"
+#include "database/database.h"
+
+AutoscanIndex::AutoscanIndex(std::shared_ptr<Database> database, ListProvider lists)
+    : database(std::move(database))
+    , lists(std::move(lists))
+{
+}
+
+void AutoscanIndex::clearParents()
+{
+    std::scoped_lock lock(mutex);
+    parentIDs.clear();
+}
+
+std::shared_ptr<AutoscanDirectory> AutoscanIndex::get(int objectID) const
+{
+    std::scoped_lock lock(mutex);
+    update();
+    auto entry = index.find(objectID);
+    if (entry == index.end() || entry->second->getObjectID() != objectID)
+        return nullptr;
+    return entry->second;
+}
+
+std::vector<int> AutoscanIndex::getPathIDs(int objectID) const
+{
+    std::vector<int> pathIDs;
+    std::unique_lock lock(mutex);
+    while (objectID != CDS_ID_ROOT && objectID != INVALID_OBJECT_ID) {
+        auto parent = parentIDs.find(objectID);
+        if (parent != parentIDs.end()) {
+            pathIDs.push_back(objectID);
+            objectID = parent->second;
+            continue;
+        }
+
+        // fetch the rest of the chain once and remember it
+        lock.unlock();
+        auto missing = database->getPathIDs(objectID);
+        lock.lock();
+        if (parentIDs.size() > MAX_CACHED_PARENT_IDS)
+            parentIDs.clear();
+
+        // a chain which does not reach the root ends with INVALID_OBJECT_ID after the id without row
+        bool complete = missing.empty() || missing.back() != INVALID_OBJECT_ID;
+        if (!complete)
+            missing.pop_back();
+        for (std::size_t i = 0; i + 1 < missing.size(); i++)
+            parentIDs[missing[i]] = missing[i + 1];
+        if (complete && !missing.empty())
+            parentIDs[missing.back()] = CDS_ID_ROOT;
+        pathIDs.insert(pathIDs.end(), missing.begin(), missing.end());
+        break;
+    }
+    return pathIDs;
+}
+
+void AutoscanIndex::update() const
+{
+    unsigned int current = generation;
+    if (current == indexGeneration)
+        return;
+
+    index.clear();
+    for (auto&& list : lists()) {
+        if (!list)
+            continue;
+        for (auto&& adir : list->getArrayCopy()) {
+            if (adir && adir->getObjectID() != INVALID_OBJECT_ID)
+                index[adir->getObjectID()] = adir;
+        }
+    }
+    indexGeneration = current;
+}
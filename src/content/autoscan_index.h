@@ -0,0 +1,77 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    autoscan_index.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file autoscan_index.h
+/// \brief Definition of the AutoscanIndex class.
+
+#ifndef __AUTOSCAN_INDEX_H__
+#define __AUTOSCAN_INDEX_H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class AutoscanDirectory;
+class AutoscanList;
+class Database;
+
+/// \brief autoscan directories by object id and the parents of containers
+///
+/// Lets the UI browse without autoscan queries. The index is rebuilt by the
+/// first lookup after invalidate(), so whoever changes an autoscan list or the
+/// object id of a directory only bumps the generation. Parents are kept until
+/// clearParents() because removed ids may be used again.
+class AutoscanIndex {
+public:
+    using ListProvider = std::function<std::vector<std::shared_ptr<AutoscanList>>()>;
+
+    /// \param lists returns the autoscan lists to index, entries may be nullptr
+    AutoscanIndex(std::shared_ptr<Database> database, ListProvider lists);
+
+    void invalidate() { ++generation; }
+    void clearParents();
+
+    /// \brief directory starting at the object, nullptr if there is none
+    std::shared_ptr<AutoscanDirectory> get(int objectID) const;
+
+    /// \brief ids from the object up to the root container (excluded)
+    std::vector<int> getPathIDs(int objectID) const;
+
+private:
+    std::shared_ptr<Database> database;
+    ListProvider lists;
+
+    mutable std::mutex mutex;
+    mutable std::unordered_map<int, std::shared_ptr<AutoscanDirectory>> index;
+    mutable std::unordered_map<int, int> parentIDs;
+    static constexpr std::size_t MAX_CACHED_PARENT_IDS = 100000;
+    mutable unsigned int indexGeneration {};
+    std::atomic_uint generation { 1 };
+
+    void update() const;
+};
+
+#endif // __AUTOSCAN_INDEX_H__
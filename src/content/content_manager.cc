@@ -33,17 +33,28 @@
 
 #include <regex>
 
+#include "config/config_snapshot.h"
 #include "config/directory_tweak.h"
 #include "database/database.h"
+#include "database/object_cache.h"
 #include "layout/builtin_layout.h"
 #include "metadata/metadata_handler.h"
+#include "metadata/thumbnail_cache.h"
+#include "metadata/thumbnail_worker_pool.h"
+#include "transcoding/transcode_scheduler.h"
+#include "transcoding/transcode_warm_pool.h"
 #include "update_manager.h"
+#include "util/metrics.h"
 #include "util/mime.h"
 #include "util/string_converter.h"
 #include "util/timer.h"
 #include "util/tools.h"
 #include "web/session_manager.h"
 
+#ifdef HAVE_CURL
+#include "iohandler/curl_engine.h"
+#endif
+
 #ifdef HAVE_JS
 #include "layout/js_layout.h"
 #endif
@@ -78,18 +89,39 @@ ContentManager::ContentManager(const std::shared_ptr<Context>& context,
 #ifdef HAVE_LASTFMLIB
     , last_fm(std::make_shared<LastFm>(context))
 #endif
+    , autoscanIndex(database, [this] {
+        auto lists = std::vector { autoscan_timed };
+#ifdef HAVE_INOTIFY
+        lists.push_back(autoscan_inotify);
+#endif
+        return lists;
+    })
 {
-    update_manager = std::make_shared<UpdateManager>(config, database, server);
+    if (config->getBoolOption(CFG_SERVER_EXTOPTS_OBJECT_CACHE_ENABLED)) {
+        objectCache = std::make_shared<ObjectCache>(
+            config->getIntOption(CFG_SERVER_EXTOPTS_OBJECT_CACHE_SIZE),
+            std::chrono::seconds(config->getIntOption(CFG_SERVER_EXTOPTS_OBJECT_CACHE_TTL)));
+    }
+    update_manager = std::make_shared<UpdateManager>(config, database, server, objectCache);
+    transcodeScheduler = std::make_shared<TranscodeScheduler>(
+        config->getIntOption(CFG_TRANSCODING_SCHEDULER_MAX_JOBS),
+        std::chrono::seconds(config->getIntOption(CFG_TRANSCODING_SCHEDULER_QUEUE_TIMEOUT)));
+    transcodeWarmPool = std::make_shared<TranscodeWarmPool>(config);
+#ifdef HAVE_CURL
+    curlEngine = std::make_shared<CurlEngine>(config);
+#endif
 #ifdef ONLINE_SERVICES
     task_processor = std::make_shared<TaskProcessor>(config);
 #endif
-
-    mimetype_contenttype_map = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
 }
 
 void ContentManager::run()
 {
     update_manager->run();
+    transcodeWarmPool->run();
+#ifdef HAVE_CURL
+    curlEngine->run();
+#endif
 #ifdef ONLINE_SERVICES
     task_processor->run();
 #endif
@@ -151,6 +183,7 @@ void ContentManager::run()
     // Start INotify thread
     inotify->run();
 #endif
+    invalidateAutoscanIndex();
 
     std::string layoutType = config->getOption(CFG_IMPORT_SCRIPTING_VIRTUAL_LAYOUT_TYPE);
     if ((layoutType == "builtin") || (layoutType == "js"))
@@ -296,6 +329,7 @@ void ContentManager::shutdown()
         inotify = nullptr;
     }
 #endif
+    invalidateAutoscanIndex();
 
     shutdownFlag = true;
 
@@ -323,6 +357,13 @@ void ContentManager::shutdown()
     task_processor = nullptr;
 #endif
     update_manager->shutdown();
+    transcodeWarmPool->shutdown();
+    // the workers store into the cache, so they are stopped first
+    ThumbnailWorkerPool::shutdownInstance();
+    ThumbnailCache::shutdownInstance();
+#ifdef HAVE_CURL
+    curlEngine->shutdown();
+#endif
     update_manager = nullptr;
 
     log_debug("end");
@@ -346,18 +387,18 @@ std::deque<std::shared_ptr<GenericTask>> ContentManager::getTasklist()
     auto t = getCurrentTask();
 
     // if there is no current task, then the queues are empty
-    // therefore we do not have to allocate the array
-    if (!t)
-        return taskList;
-
-    taskList.push_back(std::move(t));
-    std::copy_if(taskQueue1.begin(), taskQueue1.end(), std::back_inserter(taskList), [](auto&& task) { return task->isValid(); });
+    if (t) {
+        taskList.push_back(std::move(t));
+        std::copy_if(taskQueue1.begin(), taskQueue1.end(), std::back_inserter(taskList), [](auto&& task) { return task->isValid(); });
 
-    for (auto&& task : taskQueue2) {
-        if (task->isValid())
-            taskList.clear();
+        for (auto&& task : taskQueue2) {
+            if (task->isValid())
+                taskList.clear();
+        }
     }
 
+    auto jobs = transcodeScheduler->getJobs();
+    std::move(jobs.begin(), jobs.end(), std::back_inserter(taskList));
     return taskList;
 }
 
@@ -407,7 +448,8 @@ std::shared_ptr<CdsObject> ContentManager::createSingleItem(const fs::directory_
     if (obj->isItem() && layout && (processExisting || isNew)) {
         try {
             std::string mimetype = std::static_pointer_cast<CdsItem>(obj)->getMimeType();
-            std::string contentType = getValueOrDefault(mimetype_contenttype_map, mimetype);
+            auto snapshot = config->getSnapshot();
+            auto&& contentType = snapshot->getContentType(mimetype);
 
             layout->processCdsObject(obj, rootPath, mimetype, contentType);
 
@@ -509,11 +551,13 @@ void ContentManager::_removeObject(const std::shared_ptr<AutoscanDirectory>& adi
     // Removing a file can lead to virtual directories to drop empty and be removed
     // So current container cache must be invalidated
     containerMap.clear();
+    autoscanIndex.clearParents();
 
     if (!parentRemoved) {
         auto changedContainers = database->removeObject(objectID, all);
         if (changedContainers) {
             session_manager->containerChangedUI(changedContainers->ui);
+            update_manager->containersRemoved(changedContainers->removed);
             update_manager->containersChanged(changedContainers->upnp);
         }
     }
@@ -565,6 +609,7 @@ void ContentManager::_rescanDirectory(const std::shared_ptr<AutoscanDirectory>&
     if (containerID == INVALID_OBJECT_ID) {
         if (!fs::is_directory(adir->getLocation())) {
             adir->setObjectID(INVALID_OBJECT_ID);
+            invalidateAutoscanIndex();
             database->updateAutoscanDirectory(adir);
             if (adir->persistent()) {
                 return;
@@ -576,6 +621,7 @@ void ContentManager::_rescanDirectory(const std::shared_ptr<AutoscanDirectory>&
 
         containerID = ensurePathExistence(adir->getLocation());
         adir->setObjectID(containerID);
+        invalidateAutoscanIndex();
         database->updateAutoscanDirectory(adir);
         location = adir->getLocation();
 
@@ -610,6 +656,7 @@ void ContentManager::_rescanDirectory(const std::shared_ptr<AutoscanDirectory>&
             removeObject(adir, containerID, false);
             if (location == adir->getLocation()) {
                 adir->setObjectID(INVALID_OBJECT_ID);
+                invalidateAutoscanIndex();
                 database->updateAutoscanDirectory(adir);
             }
             return;
@@ -760,6 +807,7 @@ void ContentManager::_rescanDirectory(const std::shared_ptr<AutoscanDirectory>&
         auto changedContainers = database->removeObjects(list);
         if (changedContainers) {
             session_manager->containerChangedUI(changedContainers->ui);
+            update_manager->containersRemoved(changedContainers->removed);
             update_manager->containersChanged(changedContainers->upnp);
         }
     }
@@ -1164,6 +1212,9 @@ void ContentManager::updateObject(const std::shared_ptr<CdsObject>& obj, bool se
 
     int containerChanged = INVALID_OBJECT_ID;
     database->updateObject(obj, &containerChanged);
+    // the parent container is only reported if updates are sent
+    if (objectCache)
+        objectCache->remove(obj->getID());
 
     if (sendUpdates) {
         update_manager->containerChanged(containerChanged);
@@ -1198,7 +1249,8 @@ std::shared_ptr<CdsObject> ContentManager::createObjectFromFile(const fs::direct
 
         std::string upnpClass = mime->mimeTypeToUpnpClass(mimetype);
         if (upnpClass.empty()) {
-            std::string contentType = getValueOrDefault(mimetype_contenttype_map, mimetype);
+            auto snapshot = config->getSnapshot();
+            auto&& contentType = snapshot->getContentType(mimetype);
             if (contentType == CONTENT_TYPE_OGG) {
                 upnpClass = isTheora(dirEnt.path())
                     ? UPNP_CLASS_VIDEO_ITEM
@@ -1308,8 +1360,15 @@ void ContentManager::reloadLayout()
 #endif // HAVE_JS
 }
 
+static MetricGauge& taskQueueLength()
+{
+    static auto&& queueLength = Metrics::getInstance()->gauge("gerbera_content_task_queue_length", "Tasks waiting for the content manager");
+    return queueLength;
+}
+
 void ContentManager::threadProc()
 {
+    static auto&& taskTime = Metrics::getInstance()->histogram("gerbera_content_task_seconds", "Duration of content manager tasks");
     std::shared_ptr<GenericTask> task;
     ThreadRunner<std::condition_variable_any, std::recursive_mutex>::waitFor("ContentManager", [this] { return threadRunner != nullptr; });
     auto lock = threadRunner->uniqueLockS("threadProc");
@@ -1329,6 +1388,7 @@ void ContentManager::threadProc()
             task = taskQueue2.front();
             taskQueue2.pop_front();
         }
+        taskQueueLength().set(taskQueue1.size() + taskQueue2.size());
 
         if (!task) {
             working = false;
@@ -1340,9 +1400,11 @@ void ContentManager::threadProc()
 
         currentTask = task;
         lock.unlock();
+        session_manager->taskChanged();
 
         // log_debug("content manager Async START {}", task->getDescription());
         try {
+            auto timer = MetricTimer(taskTime);
             if (task->isValid())
                 task->run();
         } catch (const ServerShutdownException& se) {
@@ -1351,6 +1413,7 @@ void ContentManager::threadProc()
             log_error("Exception caught: {}", e.what());
         }
         // log_debug("content manager ASYNC STOP  {}", task->getDescription());
+        session_manager->taskChanged();
 
         if (!shutdownFlag) {
             lock.lock();
@@ -1370,6 +1433,7 @@ void ContentManager::addTask(const std::shared_ptr<GenericTask>& task, bool lowP
         taskQueue1.push_back(task);
     else
         taskQueue2.push_back(task);
+    taskQueueLength().set(taskQueue1.size() + taskQueue2.size());
     threadRunner->notify();
 }
 
@@ -1532,6 +1596,7 @@ void ContentManager::removeObject(const std::shared_ptr<AutoscanDirectory>& adir
                 }
             }
 #endif
+            invalidateAutoscanIndex();
 
             auto lock = threadRunner->lockGuard("removeObject " + path.string());
 
@@ -1588,7 +1653,22 @@ std::shared_ptr<AutoscanDirectory> ContentManager::getAutoscanDirectory(int scan
 
 std::shared_ptr<AutoscanDirectory> ContentManager::getAutoscanDirectory(int objectID) const
 {
-    return database->getAutoscanDirectory(objectID);
+    return autoscanIndex.get(objectID);
+}
+
+std::shared_ptr<AutoscanDirectory> ContentManager::getParentAutoscanDirectory(int objectID) const
+{
+    for (int pathID : getPathIDs(objectID)) {
+        auto adir = getAutoscanDirectory(pathID);
+        if (adir && adir->getRecursive())
+            return adir;
+    }
+    return nullptr;
+}
+
+std::vector<int> ContentManager::getPathIDs(int objectID) const
+{
+    return autoscanIndex.getPathIDs(objectID);
 }
 
 std::shared_ptr<AutoscanDirectory> ContentManager::getAutoscanDirectory(const fs::path& location) const
@@ -1624,6 +1704,7 @@ void ContentManager::removeAutoscanDirectory(const std::shared_ptr<AutoscanDirec
 
     if (adir->getScanMode() == ScanMode::Timed) {
         autoscan_timed->remove(adir->getScanID());
+        invalidateAutoscanIndex();
         database->removeAutoscanDirectory(adir);
         session_manager->containerChangedUI(adir->getObjectID());
 
@@ -1634,6 +1715,7 @@ void ContentManager::removeAutoscanDirectory(const std::shared_ptr<AutoscanDirec
     if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
         if (adir->getScanMode() == ScanMode::INotify) {
             autoscan_inotify->remove(adir->getScanID());
+            invalidateAutoscanIndex();
             database->removeAutoscanDirectory(adir);
             session_manager->containerChangedUI(adir->getObjectID());
             inotify->unmonitor(adir);
@@ -1646,6 +1728,7 @@ void ContentManager::handlePeristentAutoscanRemove(const std::shared_ptr<Autosca
 {
     if (adir->persistent()) {
         adir->setObjectID(INVALID_OBJECT_ID);
+        invalidateAutoscanIndex();
         database->updateAutoscanDirectory(adir);
     } else {
         removeAutoscanDirectory(adir);
@@ -1656,6 +1739,7 @@ void ContentManager::handlePersistentAutoscanRecreate(const std::shared_ptr<Auto
 {
     int id = ensurePathExistence(adir->getLocation());
     adir->setObjectID(id);
+    invalidateAutoscanIndex();
     database->updateAutoscanDirectory(adir);
 }
 
@@ -1708,6 +1792,7 @@ void ContentManager::setAutoscanDirectory(const std::shared_ptr<AutoscanDirector
             }
         }
 #endif
+        invalidateAutoscanIndex();
         session_manager->containerChangedUI(dir->getObjectID());
         return;
     }
@@ -1755,6 +1840,7 @@ void ContentManager::setAutoscanDirectory(const std::shared_ptr<AutoscanDirector
     }
 #endif
 
+    invalidateAutoscanIndex();
     database->updateAutoscanDirectory(copy);
     if (original->getScanMode() != copy->getScanMode())
         session_manager->containerChangedUI(copy->getObjectID());
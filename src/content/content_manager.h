@@ -31,13 +31,17 @@
 #ifndef __CONTENT_MANAGER_H__
 #define __CONTENT_MANAGER_H__
 
+#include <atomic>
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "autoscan.h"
+#include "autoscan_index.h"
 #include "cds_objects.h"
 #include "common.h"
 #include "context.h"
@@ -72,9 +76,13 @@ class ScriptingRuntime;
 
 // forward declarations
 class ContentManager;
+class CurlEngine;
 class LastFm;
+class ObjectCache;
 class Server;
 class TaskProcessor;
+class TranscodeScheduler;
+class TranscodeWarmPool;
 
 class CMAddFileTask : public GenericTask, public std::enable_shared_from_this<CMAddFileTask> {
 protected:
@@ -241,6 +249,12 @@ public:
     /// \brief Gets an AutoscanDirectory (by objectID) from the watch list.
     std::shared_ptr<AutoscanDirectory> getAutoscanDirectory(int objectID) const;
 
+    /// \brief Gets the recursive AutoscanDirectory covering the object, starting with the object itself.
+    std::shared_ptr<AutoscanDirectory> getParentAutoscanDirectory(int objectID) const;
+
+    /// \brief Ids from the object up to the root container (excluded), the parents of containers are cached.
+    std::vector<int> getPathIDs(int objectID) const;
+
     /// \brief Get an AutoscanDirectory given by location on disk from the watch list.
     std::shared_ptr<AutoscanDirectory> getAutoscanDirectory(const fs::path& location) const;
 
@@ -296,11 +310,43 @@ public:
         return context;
     }
 
+    /// \brief cache for objects requested by renderers, nullptr if disabled
+    std::shared_ptr<ObjectCache> getObjectCache() const
+    {
+        return objectCache;
+    }
+
+    /// \brief admission control for transcoding requests
+    std::shared_ptr<TranscodeScheduler> getTranscodeScheduler() const
+    {
+        return transcodeScheduler;
+    }
+
+    /// \brief resources prepared for starting transcoders
+    std::shared_ptr<TranscodeWarmPool> getTranscodeWarmPool() const
+    {
+        return transcodeWarmPool;
+    }
+
+#ifdef HAVE_CURL
+    /// \brief engine running the requests of proxied streams
+    std::shared_ptr<CurlEngine> getCurlEngine() const
+    {
+        return curlEngine;
+    }
+#endif
+
 protected:
     std::shared_ptr<Config> config;
     std::shared_ptr<Mime> mime;
     std::shared_ptr<Database> database;
     std::shared_ptr<UpdateManager> update_manager;
+    std::shared_ptr<ObjectCache> objectCache;
+    std::shared_ptr<TranscodeScheduler> transcodeScheduler;
+    std::shared_ptr<TranscodeWarmPool> transcodeWarmPool;
+#ifdef HAVE_CURL
+    std::shared_ptr<CurlEngine> curlEngine;
+#endif
     std::shared_ptr<Web::SessionManager> session_manager;
     std::shared_ptr<Context> context;
     ///\brief cache for containers while creating new layout
@@ -311,14 +357,16 @@ protected:
     std::shared_ptr<ScriptingRuntime> scripting_runtime;
     std::shared_ptr<LastFm> last_fm;
 
-    std::map<std::string, std::string> mimetype_contenttype_map;
-
     std::shared_ptr<AutoscanList> autoscan_timed;
 #ifdef HAVE_INOTIFY
     std::unique_ptr<AutoscanInotify> inotify;
     std::shared_ptr<AutoscanList> autoscan_inotify;
 #endif
 
+    /// \brief autoscan directories by object id and the parents of containers, so browsing needs no autoscan queries
+    AutoscanIndex autoscanIndex;
+    void invalidateAutoscanIndex() { autoscanIndex.invalidate(); }
+
     std::vector<std::shared_ptr<Executor>> process_list;
 
     int addFileInternal(const fs::directory_entry& dirEnt, const fs::path& rootpath,
@@ -27,6 +27,7 @@
 #include "curl_online_service.h" // API
 
 #include "config/config.h"
+#include "config/config_snapshot.h"
 #include "content/content_manager.h"
 #include "database/database.h"
 #include "util/string_converter.h"
@@ -132,8 +133,8 @@ bool CurlOnlineService::refreshServiceData(const std::shared_ptr<Layout>& layout
 
             if (layout) {
                 std::string mimetype = std::static_pointer_cast<CdsItem>(obj)->getMimeType();
-                auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-                std::string contentType = getValueOrDefault(mappings, mimetype);
+                auto snapshot = config->getSnapshot();
+                auto&& contentType = snapshot->getContentType(mimetype);
 
                 layout->processCdsObject(obj, "", mimetype, contentType);
             }
@@ -0,0 +1,153 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    update_id_tracker.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file update_id_tracker.cc
+
+#include "update_id_tracker.h" // API
+
+#include <algorithm>
+#include <vector>
+
+#include "common.h"
+#include "util/metrics.h"
+
+UpdateIDTracker::UpdateIDTracker(std::shared_ptr<Database> database, std::size_t maxContainers, std::size_t maxSize)
+    : database(std::move(database))
+    , maxContainers(maxContainers)
+    , maxSize(maxSize)
+{
+}
+
+void UpdateIDTracker::load(const std::unordered_set<int>& ids)
+{
+    std::unordered_set<int> missing;
+    for (int id : ids) {
+        if (containers.find(id) == containers.end())
+            missing.insert(id);
+    }
+    if (missing.empty())
+        return;
+
+    auto loaded = database->loadUpdateIDs(missing);
+    containers.insert(loaded.begin(), loaded.end());
+}
+
+std::string UpdateIDTracker::flush(const std::unordered_set<int>& changed)
+{
+    static auto&& changedCounter = Metrics::getInstance()->counter("gerbera_update_changed_containers_total", "Changed containers passed to ContainerUpdateIDs events");
+    static auto&& reportedCounter = Metrics::getInstance()->counter("gerbera_update_containers_total", "Containers announced in ContainerUpdateIDs events");
+    static auto&& collapsedCounter = Metrics::getInstance()->counter("gerbera_update_collapsed_events_total", "ContainerUpdateIDs events reduced to common ancestors");
+    static auto&& byteCounter = Metrics::getInstance()->counter("gerbera_update_event_bytes_total", "Length of the ContainerUpdateIDs values");
+
+    load(changed);
+
+    // every changed container gets a new update id, even if an ancestor is reported instead
+    std::unordered_set<int> reported;
+    for (int id : changed) {
+        auto it = containers.find(id);
+        if (it == containers.end())
+            continue; // removed in the meantime
+        it->second.updateID++;
+        dirty.insert(id);
+        reported.insert(id);
+    }
+    changedCounter.inc(changed.size());
+
+    auto incremented = reported;
+    auto result = format(reported);
+    bool collapsed = false;
+    while (reported.size() > maxContainers || result.size() > maxSize) {
+        std::unordered_set<int> parents;
+        for (int id : reported) {
+            int parentID = containers.at(id).parentID;
+            // the root container has no parent
+            parents.insert(parentID < CDS_ID_ROOT ? id : parentID);
+        }
+        if (parents == reported)
+            break;
+
+        load(parents);
+        reported.clear();
+        for (int id : parents) {
+            if (containers.find(id) != containers.end())
+                reported.insert(id);
+        }
+        collapsed = true;
+        result = format(reported);
+    }
+
+    if (collapsed) {
+        for (int id : reported) {
+            if (incremented.insert(id).second) {
+                containers.at(id).updateID++;
+                dirty.insert(id);
+            }
+        }
+        result = format(reported);
+        collapsedCounter.inc();
+        log_debug("Collapsed {} changed containers to {}", changed.size(), reported.size());
+    }
+
+    if (!result.empty()) {
+        reportedCounter.inc(reported.size());
+        byteCounter.inc(result.size());
+    }
+    return result;
+}
+
+std::string UpdateIDTracker::format(const std::unordered_set<int>& ids) const
+{
+    auto sorted = std::vector<int>(ids.begin(), ids.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string result;
+    for (int id : sorted) {
+        if (!result.empty())
+            result += ',';
+        result += fmt::format("{},{}", id, containers.at(id).updateID);
+    }
+    return result;
+}
+
+void UpdateIDTracker::persist()
+{
+    if (dirty.empty())
+        return;
+
+    std::unordered_map<int, int> updateIDs;
+    updateIDs.reserve(dirty.size());
+    for (int id : dirty)
+        updateIDs.emplace(id, containers.at(id).updateID);
+
+    database->storeUpdateIDs(updateIDs);
+    log_debug("Stored {} update ids", updateIDs.size());
+    dirty.clear();
+}
+
+void UpdateIDTracker::remove(const std::unordered_set<int>& ids)
+{
+    for (int id : ids) {
+        containers.erase(id);
+        dirty.erase(id);
+    }
+}
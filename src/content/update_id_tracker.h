@@ -0,0 +1,75 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    update_id_tracker.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file update_id_tracker.h
+/// \brief Definition of the UpdateIDTracker class.
+
+#ifndef __UPDATE_ID_TRACKER_H__
+#define __UPDATE_ID_TRACKER_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "database/database.h"
+
+/// \brief counts container update ids in memory for ContainerUpdateIDs events
+///
+/// Update ids are loaded from the database when a container changes for the
+/// first time, kept in memory until the container is removed and written
+/// back by persist(). If more containers changed than fit into one event,
+/// they are replaced by their parents until the event is small enough again.
+/// Clients then browse the common ancestor instead of receiving hundreds of
+/// ids during an import.
+class UpdateIDTracker {
+public:
+    /// \param maxContainers upper limit for containers in one event
+    /// \param maxSize upper limit for the length of the event value
+    UpdateIDTracker(std::shared_ptr<Database> database, std::size_t maxContainers, std::size_t maxSize);
+
+    /// \brief increment the update ids of changed containers
+    /// \return value of the ContainerUpdateIDs state variable: "id,update_id,..."
+    std::string flush(const std::unordered_set<int>& changed);
+
+    /// \brief write changed update ids to the database
+    void persist();
+    bool needsPersist() const { return !dirty.empty(); }
+
+    /// \brief forget removed objects, ids of items are ignored
+    void remove(const std::unordered_set<int>& ids);
+
+private:
+    std::shared_ptr<Database> database;
+    std::size_t maxContainers;
+    std::size_t maxSize;
+
+    /// \brief containers which changed before
+    std::unordered_map<int, Database::UpdateID> containers;
+    std::unordered_set<int> dirty;
+
+    void load(const std::unordered_set<int>& ids);
+    std::string format(const std::unordered_set<int>& ids) const;
+};
+
+#endif // __UPDATE_ID_TRACKER_H__
@@ -32,21 +32,27 @@
 #include "update_manager.h" // API
 
 #include <csignal>
+#include <utility>
 
 #include "database/database.h"
+#include "database/object_cache.h"
 #include "server.h"
+#include "util/metrics.h"
 #include "util/tools.h"
 
-static constexpr auto specInterval = std::chrono::seconds(2);
 static constexpr auto minSleep = std::chrono::milliseconds(1);
+// update ids which failed to be written are retried that often
+static constexpr auto persistInterval = std::chrono::seconds(30);
 
-#define MAX_OBJECT_IDS 1000
-#define MAX_OBJECT_IDS_OVERLOAD 30
-
-UpdateManager::UpdateManager(std::shared_ptr<Config> config, std::shared_ptr<Database> database, std::shared_ptr<Server> server)
+UpdateManager::UpdateManager(std::shared_ptr<Config> config, std::shared_ptr<Database> database, std::shared_ptr<Server> server, std::shared_ptr<ObjectCache> objectCache)
     : config(std::move(config))
     , database(std::move(database))
     , server(std::move(server))
+    , objectCache(std::move(objectCache))
+    , updateIDs(this->database,
+          this->config->getIntOption(CFG_SERVER_CONTAINER_UPDATES_MAX_CONTAINERS),
+          this->config->getIntOption(CFG_SERVER_CONTAINER_UPDATES_MAX_SIZE))
+    , moderation(std::chrono::seconds(this->config->getIntOption(CFG_SERVER_CONTAINER_UPDATES_MODERATION)))
 {
 }
 
@@ -81,6 +87,9 @@ void UpdateManager::shutdown()
 
 void UpdateManager::containersChanged(const std::vector<int>& objectIDs, int flushPolicy)
 {
+    if (objectCache)
+        objectCache->containersChanged(objectIDs);
+
     auto lock = threadRunner->uniqueLock();
     // signalling thread if it could have been idle, because
     // there were no unprocessed updates
@@ -91,37 +100,36 @@ void UpdateManager::containersChanged(const std::vector<int>& objectIDs, int flu
         this->flushPolicy = flushPolicy;
         signal = true;
     }
-    auto size = objectIDs.size();
-    auto hashSize = objectIDHash.size();
-
-    bool split = (hashSize + size >= MAX_OBJECT_IDS + MAX_OBJECT_IDS_OVERLOAD);
+    // large sets are reduced to common ancestors when sent
     for (int objectID : objectIDs) {
-        if (objectID != lastContainerChanged) {
-            // log_debug("containerChanged. id: {}, signal: {}", objectID, signal);
+        if (objectID != lastContainerChanged)
             objectIDHash.insert(objectID);
-            if (split && objectIDHash.size() > MAX_OBJECT_IDS) {
-                while (objectIDHash.size() > MAX_OBJECT_IDS) {
-                    log_debug("in-between signalling...");
-                    threadRunner->notify();
-                    lock.unlock();
-                    lock.lock();
-                }
-            }
-        }
     }
-    if (objectIDHash.size() >= MAX_OBJECT_IDS)
-        signal = true;
     if (signal) {
         log_debug("signalling...");
         threadRunner->notify();
     }
 }
 
+void UpdateManager::containersRemoved(const std::vector<int>& objectIDs)
+{
+    if (objectIDs.empty())
+        return;
+
+    // applied by the update thread before the next use of the tracker
+    auto lock = threadRunner->lockGuard();
+    removedIDs.insert(objectIDs.begin(), objectIDs.end());
+}
+
 void UpdateManager::containerChanged(int objectID, int flushPolicy)
 {
     if (objectID == INVALID_OBJECT_ID)
         return;
 
+    // the cache has to be invalidated even if the update id is already pending
+    if (objectCache)
+        objectCache->containersChanged({ objectID });
+
     auto lock = threadRunner->lockGuard();
 
     if (objectID != lastContainerChanged || flushPolicy > this->flushPolicy) {
@@ -131,10 +139,6 @@ void UpdateManager::containerChanged(int objectID, int flushPolicy)
         log_debug("containerChanged. id: {}, signal: {}", objectID, signal);
         objectIDHash.insert(objectID);
 
-        // signalling if the hash gets too full
-        if (objectIDHash.size() >= MAX_OBJECT_IDS)
-            signal = true;
-
         // very simple caching, but it gets a lot of hits
         lastContainerChanged = objectID;
 
@@ -155,8 +159,20 @@ void UpdateManager::containerChanged(int objectID, int flushPolicy)
 
 /* private stuff */
 
+void UpdateManager::persistUpdateIDs()
+{
+    try {
+        updateIDs.persist();
+    } catch (const std::runtime_error& e) {
+        log_error("Failed to store update ids: {}", e.what());
+    }
+}
+
 void UpdateManager::threadProc()
 {
+    static auto&& eventCounter = Metrics::getInstance()->counter("gerbera_update_events_total", "ContainerUpdateIDs events sent");
+    static auto&& flushTime = Metrics::getInstance()->histogram("gerbera_update_flush_seconds", "Duration of building and sending ContainerUpdateIDs events");
+
     StdThreadRunner::waitFor("UpdateManager", [this] { return threadRunner != nullptr; });
 
     auto lock = threadRunner->uniqueLockS("threadProc");
@@ -164,51 +180,44 @@ void UpdateManager::threadProc()
     threadRunner->setReady();
 
     auto lastUpdate = currentTimeMS();
+    auto lastPersist = lastUpdate;
     while (!shutdownFlag) {
         if (haveUpdates()) {
-            std::chrono::milliseconds sleepMillis {};
-            auto now = currentTimeMS();
-            auto timeDiff = getDeltaMillis(lastUpdate, now);
-            switch (flushPolicy) {
-            case FLUSH_SPEC:
-                sleepMillis = specInterval - timeDiff;
-                break;
-            case FLUSH_ASAP:
-                sleepMillis = {};
-                break;
-            }
-            bool sendUpdates = true;
-            if (sleepMillis >= minSleep && objectIDHash.size() < MAX_OBJECT_IDS) {
+            // ContainerUpdateIDs is a moderated state variable, FLUSH_ASAP
+            // only wakes the thread to send as soon as the interval allows
+            auto timeDiff = getDeltaMillis(lastUpdate, currentTimeMS());
+            auto sleepMillis = moderation - timeDiff;
+            if (sleepMillis >= minSleep) {
                 log_debug("threadProc: sleeping for {} millis", sleepMillis.count());
-                auto ret = threadRunner->waitFor(lock, sleepMillis);
-
-                if (!shutdownFlag) {
-                    if (ret == std::cv_status::timeout)
-                        sendUpdates = false;
-                } else
-                    sendUpdates = false;
-            }
-
-            if (sendUpdates) {
+                threadRunner->waitFor(lock, sleepMillis);
+            } else {
                 log_debug("sending updates...");
                 lastContainerChanged = INVALID_OBJECT_ID;
                 flushPolicy = FLUSH_SPEC;
-                std::string updateString;
+                auto changed = std::move(objectIDHash);
+                objectIDHash.clear();
+                updateIDs.remove(std::exchange(removedIDs, {}));
+                lock.unlock(); // we don't need to hold the lock during the sending of the updates
 
+                auto timer = MetricTimer(flushTime);
+                std::string updateString;
                 try {
-                    updateString = database->incrementUpdateIDs(objectIDHash);
-                    objectIDHash.clear(); // hash_data_array will be invalid after clear()
+                    updateString = updateIDs.flush(changed);
                 } catch (const std::runtime_error& e) {
                     log_error("Fatal error when sending updates: {}", e.what());
                     log_error("Forcing Gerbera shutdown.");
                     kill(0, SIGINT);
                 }
-                lock.unlock(); // we don't need to hold the lock during the sending of the updates
+                // clients browse the announced containers right away, so the
+                // database must return the same update ids before the event
+                persistUpdateIDs();
+                lastPersist = currentTimeMS();
                 if (!updateString.empty()) {
                     try {
                         log_debug("updates sent: \"{}\"", updateString);
                         server->sendCDSSubscriptionUpdate(updateString);
                         lastUpdate = currentTimeMS();
+                        eventCounter.inc();
                     } catch (const std::runtime_error& e) {
                         log_error("Fatal error when sending updates: {}", e.what());
                         log_error("Forcing Gerbera shutdown.");
@@ -217,13 +226,28 @@ void UpdateManager::threadProc()
                 } else {
                     log_debug("NOT sending updates (string empty or invalid).");
                 }
+                timer.stop();
                 lock.lock();
             }
+        } else if (updateIDs.needsPersist()) {
+            auto sleepMillis = persistInterval - getDeltaMillis(lastPersist, currentTimeMS());
+            if (sleepMillis >= minSleep) {
+                threadRunner->waitFor(lock, sleepMillis);
+                continue;
+            }
+            updateIDs.remove(std::exchange(removedIDs, {}));
+            lock.unlock();
+            persistUpdateIDs();
+            lastPersist = currentTimeMS();
+            lock.lock();
         } else {
             // nothing to do
             threadRunner->wait(lock);
         }
     }
 
+    updateIDs.remove(std::exchange(removedIDs, {}));
+    lock.unlock();
+    persistUpdateIDs();
     database->threadCleanup();
 }
@@ -37,11 +37,13 @@
 #include <vector>
 
 #include "common.h"
+#include "update_id_tracker.h"
 #include "util/thread_runner.h"
 
 // forward declaration
 class Config;
 class Database;
+class ObjectCache;
 class Server;
 
 #define FLUSH_ASAP 2
@@ -49,7 +51,7 @@ class Server;
 
 class UpdateManager {
 public:
-    UpdateManager(std::shared_ptr<Config> config, std::shared_ptr<Database> database, std::shared_ptr<Server> server);
+    UpdateManager(std::shared_ptr<Config> config, std::shared_ptr<Database> database, std::shared_ptr<Server> server, std::shared_ptr<ObjectCache> objectCache = nullptr);
     virtual ~UpdateManager();
 
     UpdateManager(const UpdateManager&) = delete;
@@ -60,15 +62,24 @@ public:
 
     void containerChanged(int objectID, int flushPolicy = FLUSH_SPEC);
     void containersChanged(const std::vector<int>& objectIDs, int flushPolicy = FLUSH_SPEC);
+    /// \brief drop the update ids of removed containers kept in memory
+    void containersRemoved(const std::vector<int>& objectIDs);
 
 protected:
     std::shared_ptr<Config> config;
     std::shared_ptr<Database> database;
     std::shared_ptr<Server> server;
+    std::shared_ptr<ObjectCache> objectCache;
 
     std::unique_ptr<StdThreadRunner> threadRunner;
 
     std::unordered_set<int> objectIDHash;
+    /// \brief containers removed since the tracker was last used
+    std::unordered_set<int> removedIDs;
+    /// \brief only used by the update thread
+    UpdateIDTracker updateIDs;
+    /// \brief minimum time between two events
+    std::chrono::milliseconds moderation;
 
     bool shutdownFlag {};
     int flushPolicy { FLUSH_SPEC };
@@ -76,6 +87,7 @@ protected:
     int lastContainerChanged { INVALID_OBJECT_ID };
 
     void threadProc();
+    void persistUpdateIDs();
 
     bool haveUpdates() const { return !objectIDHash.empty(); }
 };
@@ -33,9 +33,11 @@
 #define __STORAGE_H__
 
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "slow_query_log.h"
 #include "util/grb_fs.h"
 
 // forward declaration
@@ -199,12 +201,19 @@ public:
     /// \return the obejectID
     virtual int findObjectIDByPath(const fs::path& fullpath, bool wasRegularFile = false) = 0;
 
-    /// \brief increments the updateIDs for the given objectIDs
-    /// \param ids pointer to the array of ids
-    /// \param size number of entries in the given array
-    /// \return a String for UPnP: a CSV list; for every existing object:
-    ///  "id,update_id"
-    virtual std::string incrementUpdateIDs(const std::unordered_set<int>& ids) = 0;
+    class UpdateID {
+    public:
+        int updateID;
+        int parentID;
+    };
+
+    /// \brief loads update id and parent id of the given objects
+    /// \return entries for all existing objects
+    virtual std::unordered_map<int, UpdateID> loadUpdateIDs(const std::unordered_set<int>& ids) = 0;
+
+    /// \brief writes update ids counted by the UpdateManager
+    /// \param updateIDs object id and update id
+    virtual void storeUpdateIDs(const std::unordered_map<int, int>& updateIDs) = 0;
 
     /* utility methods */
     virtual std::shared_ptr<CdsObject> loadObject(int objectID) = 0;
@@ -216,6 +225,8 @@ public:
         // Signed because IDs start at -1.
         std::vector<std::int32_t> upnp;
         std::vector<std::int32_t> ui;
+        /// \brief containers which were removed
+        std::vector<std::int32_t> removed;
     };
 
     /// \brief Removes the object identified by the objectID from the database.
@@ -277,6 +288,10 @@ public:
     virtual void removeAutoscanDirectory(std::shared_ptr<AutoscanDirectory> adir) = 0;
     virtual void checkOverlappingAutoscans(const std::shared_ptr<AutoscanDirectory>& adir) = 0;
 
+    /// \brief ids from the object up to the root container (excluded)
+    ///
+    /// If a row on the way is missing the result ends with INVALID_OBJECT_ID
+    /// after the id without row.
     virtual std::vector<int> getPathIDs(int objectID) = 0;
 
     /// \brief Ensures that a container given by it's location on disk is
@@ -290,6 +305,9 @@ public:
     virtual void threadCleanup() = 0;
     virtual bool threadCleanupRequired() const = 0;
 
+    /// \brief statements that took longer than the configured slow query time
+    virtual std::vector<SlowQueryLog::Entry> getSlowQueries() const { return {}; }
+
 protected:
     static std::shared_ptr<Database> createInstance(const std::shared_ptr<Config>& config, const std::shared_ptr<Mime>& mime, const std::shared_ptr<Timer>& timer);
     friend class Server;
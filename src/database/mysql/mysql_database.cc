@@ -258,6 +258,7 @@ std::shared_ptr<SQLResult> MySQLDatabaseWithTransactions::select(const std::stri
 
     checkMysqlThreadInit();
     SqlAutoLock lock(sqlMutex);
+    auto start = std::chrono::steady_clock::now();
     bool myTransaction = false;
     if (!inTransaction) { // protect calls outside transactions
         inTransaction = true;
@@ -280,15 +281,17 @@ std::shared_ptr<SQLResult> MySQLDatabaseWithTransactions::select(const std::stri
         inTransaction = false;
     }
 
+    recordQuery(query, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start), mysqlRes ? mysql_num_rows(mysqlRes) : 0);
     return std::make_shared<MysqlResult>(mysqlRes);
 }
 
 std::shared_ptr<SQLResult> MySQLDatabase::select(const std::string& query)
 {
-    log_debug("{}", query);
+    log_vdebug(sql, "{}", query);
 
     checkMysqlThreadInit();
     SqlAutoLock lock(sqlMutex);
+    auto start = std::chrono::steady_clock::now();
     auto res = mysql_real_query(&db, query.c_str(), query.size());
     if (res) {
         std::string myError = getError(&db);
@@ -301,6 +304,7 @@ std::shared_ptr<SQLResult> MySQLDatabase::select(const std::string& query)
         throw DatabaseException(myError, fmt::format("Mysql: mysql_store_result() failed: {}; query: {}", myError, query));
     }
 
+    recordQuery(query, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start), mysqlRes ? mysql_num_rows(mysqlRes) : 0);
     return std::make_shared<MysqlResult>(mysqlRes);
 }
 
@@ -313,6 +317,7 @@ int MySQLDatabase::exec(const std::string& query, bool getLastInsertId)
 
     checkMysqlThreadInit();
     SqlAutoLock lock(sqlMutex);
+    auto start = std::chrono::steady_clock::now();
     auto res = mysql_real_query(&db, query.c_str(), query.size());
     if (res) {
         std::string myError = getError(&db);
@@ -322,9 +327,25 @@ int MySQLDatabase::exec(const std::string& query, bool getLastInsertId)
     int insertId = -1;
     if (getLastInsertId)
         insertId = mysql_insert_id(&db);
+    recordQuery(query, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start), mysql_affected_rows(&db));
     return insertId;
 }
 
+std::string MySQLDatabase::explain(const std::string& query)
+{
+    auto res = std::static_pointer_cast<MysqlResult>(select(fmt::format("EXPLAIN {}", query)));
+    auto fields = mysql_num_fields(res->mysql_res);
+    std::vector<std::string> plan;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow())) {
+        std::vector<std::string> columns;
+        for (unsigned int i = 0; i < fields; i++)
+            columns.push_back(row->col(i));
+        plan.push_back(fmt::format("{}", fmt::join(columns, " ")));
+    }
+    return fmt::format("{}", fmt::join(plan, "\n"));
+}
+
 void MySQLDatabase::shutdownDriver()
 {
 }
@@ -66,6 +66,7 @@ private:
 
     std::shared_ptr<SQLResult> select(const std::string& query) override;
     int exec(const std::string& query, bool getLastInsertId = false) override;
+    std::string explain(const std::string& query) override;
 
     void storeInternalSetting(const std::string& key, const std::string& value) override;
 
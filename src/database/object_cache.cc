@@ -0,0 +1,148 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    object_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file object_cache.cc
+
+#include "object_cache.h" // API
+
+#include "cds_objects.h"
+#include "util/metrics.h"
+#include "util/tools.h"
+
+ObjectCache::ObjectCache(std::size_t maxEntries, std::chrono::milliseconds ttl)
+    : maxEntries(maxEntries)
+    , ttl(ttl)
+{
+}
+
+std::shared_ptr<CdsObject> ObjectCache::copyObject(const std::shared_ptr<CdsObject>& obj)
+{
+    auto copy = CdsObject::createObject(obj->getObjectType());
+    obj->copyTo(copy);
+    return copy;
+}
+
+std::shared_ptr<CdsObject> ObjectCache::get(int objectID, const Loader& loader)
+{
+    static auto&& hitCounter = Metrics::getInstance()->counter("gerbera_cache_requests_total", "Lookups in internal caches", R"(cache="object",result="hit")");
+    static auto&& missCounter = Metrics::getInstance()->counter("gerbera_cache_requests_total", "Lookups in internal caches", R"(cache="object",result="miss")");
+
+    unsigned int loadGeneration;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto it = entries.find(objectID);
+        if (it != entries.end()) {
+            if (currentTimeMS() - it->second.loaded < ttl) {
+                lru.splice(lru.begin(), lru, it->second.lruPos);
+                hitCounter.inc();
+                return copyObject(it->second.obj);
+            }
+            erase(it);
+        }
+        loadGeneration = generation;
+    }
+    missCounter.inc();
+
+    // load without holding the lock, the database may be slow
+    auto obj = loader();
+    if (!obj || !obj->isItem() || maxEntries == 0)
+        return obj;
+
+    auto copy = copyObject(obj);
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    // the object may have changed while it was loaded
+    if (loadGeneration != generation)
+        return obj;
+
+    auto it = entries.find(objectID);
+    if (it != entries.end())
+        erase(it);
+    while (entries.size() >= maxEntries && !lru.empty())
+        erase(entries.find(lru.back()));
+
+    lru.push_front(objectID);
+    entries[objectID] = Entry { copy, currentTimeMS(), lru.begin() };
+    return obj;
+}
+
+void ObjectCache::remove(int objectID)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    generation++;
+    auto it = entries.find(objectID);
+    if (it != entries.end())
+        erase(it);
+    removeReferences({ objectID });
+}
+
+void ObjectCache::containersChanged(const std::vector<int>& containerIDs)
+{
+    auto containers = std::unordered_set<int>(containerIDs.begin(), containerIDs.end());
+    auto removed = containers;
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    generation++;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (containers.find(it->first) != containers.end() || containers.find(it->second.obj->getParentID()) != containers.end()) {
+            removed.insert(it->first);
+            lru.erase(it->second.lruPos);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    removeReferences(removed);
+}
+
+void ObjectCache::removeReferences(const std::unordered_set<int>& objectIDs)
+{
+    // virtual items carry the data of the item they refer to
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto refID = it->second.obj->getRefID();
+        if (refID != INVALID_OBJECT_ID && objectIDs.find(refID) != objectIDs.end()) {
+            lru.erase(it->second.lruPos);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ObjectCache::clear()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    generation++;
+    entries.clear();
+    lru.clear();
+}
+
+std::size_t ObjectCache::size() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return entries.size();
+}
+
+void ObjectCache::erase(std::unordered_map<int, Entry>::iterator it)
+{
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+}
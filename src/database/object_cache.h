@@ -0,0 +1,90 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    object_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file object_cache.h
+/// \brief Definition of the ObjectCache class.
+
+#ifndef __OBJECT_CACHE_H__
+#define __OBJECT_CACHE_H__
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class CdsObject;
+
+/// \brief small LRU cache of items loaded for media requests
+///
+/// Renderers send many range requests for the same item while seeking, each
+/// of them needs the item with all resources. Entries expire after ttl and
+/// are dropped whenever their parent container is reported as changed,
+/// together with the objects that refer to them.
+/// Only items are cached and callers always get their own copy, so they are
+/// free to modify it.
+class ObjectCache {
+public:
+    using Loader = std::function<std::shared_ptr<CdsObject>()>;
+
+    ObjectCache(std::size_t maxEntries, std::chrono::milliseconds ttl);
+
+    /// \brief get object from cache or call loader to load it
+    std::shared_ptr<CdsObject> get(int objectID, const Loader& loader);
+
+    /// \brief drop a single object
+    void remove(int objectID);
+
+    /// \brief drop the containers and all their direct children
+    void containersChanged(const std::vector<int>& containerIDs);
+
+    void clear();
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<CdsObject> obj;
+        std::chrono::milliseconds loaded;
+        std::list<int>::iterator lruPos;
+    };
+
+    std::size_t maxEntries;
+    std::chrono::milliseconds ttl;
+
+    mutable std::mutex mutex;
+    std::unordered_map<int, Entry> entries;
+    /// \brief most recently used object id at the front
+    std::list<int> lru;
+    /// \brief incremented on every invalidation, objects loaded before are not stored
+    unsigned int generation {};
+
+    void erase(std::unordered_map<int, Entry>::iterator it);
+    /// \brief drop objects with a refID in objectIDs, lock must be held
+    void removeReferences(const std::unordered_set<int>& objectIDs);
+    static std::shared_ptr<CdsObject> copyObject(const std::shared_ptr<CdsObject>& obj);
+};
+
+#endif // __OBJECT_CACHE_H__
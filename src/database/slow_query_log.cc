@@ -0,0 +1,146 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    slow_query_log.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file slow_query_log.cc
+
+#include "slow_query_log.h" // API
+
+#include <algorithm>
+#include <cctype>
+
+SlowQueryLog::SlowQueryLog(std::chrono::milliseconds threshold, std::size_t maxEntries)
+    : threshold(threshold)
+    , maxEntries(maxEntries)
+{
+}
+
+static bool isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+std::string SlowQueryLog::normalize(const std::string& query)
+{
+    std::string result;
+    result.reserve(query.size());
+    std::size_t pos = 0;
+    while (pos < query.size()) {
+        auto c = query[pos];
+        if (c == '\'') {
+            // string literal, '' is an escaped quote
+            pos++;
+            while (pos < query.size()) {
+                if (query[pos] == '\'' && (pos + 1 >= query.size() || query[pos + 1] != '\''))
+                    break;
+                pos += query[pos] == '\'' ? 2 : 1;
+            }
+            pos++;
+            result += '?';
+        } else if (c == '"' || c == '`') {
+            // quoted identifier
+            auto end = query.find(c, pos + 1);
+            end = end == std::string::npos ? query.size() : end + 1;
+            result.append(query, pos, end - pos);
+            pos = end;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) && (result.empty() || !isIdentifierChar(result.back()))) {
+            while (pos < query.size() && isIdentifierChar(query[pos]))
+                pos++;
+            result += '?';
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            while (pos < query.size() && std::isspace(static_cast<unsigned char>(query[pos])))
+                pos++;
+            if (!result.empty() && result.back() != '(')
+                result += ' ';
+        } else {
+            if (c == ')' && !result.empty() && result.back() == ' ')
+                result.pop_back();
+            result += c;
+            pos++;
+        }
+    }
+    if (!result.empty() && result.back() == ' ')
+        result.pop_back();
+
+    // IN lists of different length are the same statement
+    std::size_t list = 0;
+    while ((list = result.find("(?,", list)) != std::string::npos) {
+        auto end = list + 2;
+        while (result.compare(end, 3, ", ?") == 0 || result.compare(end, 2, ",?") == 0)
+            end += result[end + 1] == ' ' ? 3 : 2;
+        if (result.compare(end, 1, ")") == 0)
+            result.replace(list + 1, end - list - 1, "?...");
+        list++;
+    }
+    return result;
+}
+
+void SlowQueryLog::record(const std::string& query, std::chrono::microseconds duration, unsigned long long rows, const std::function<std::string()>& explain)
+{
+    auto statement = normalize(query);
+    bool needsPlan = false;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto it = entries.find(statement);
+        if (it == entries.end()) {
+            if (entries.size() >= maxEntries) {
+                // make room by forgetting the cheapest statement
+                auto cheapest = std::min_element(entries.begin(), entries.end(), [](auto&& a, auto&& b) { return a.second.total < b.second.total; });
+                entries.erase(cheapest);
+            }
+            it = entries.emplace(statement, Entry()).first;
+            it->second.statement = statement;
+            needsPlan = bool(explain);
+        }
+        auto&& entry = it->second;
+        entry.count++;
+        entry.total += duration;
+        if (duration >= entry.max) {
+            entry.max = duration;
+            entry.example = query;
+            entry.operation = Operation::get();
+            entry.rows = rows;
+        }
+    }
+
+    if (needsPlan) {
+        // the database is queried again, so do not hold the lock
+        auto plan = explain();
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto it = entries.find(statement);
+        if (it != entries.end())
+            it->second.plan = std::move(plan);
+    }
+}
+
+std::vector<SlowQueryLog::Entry> SlowQueryLog::getEntries() const
+{
+    std::vector<Entry> result;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        result.reserve(entries.size());
+        for (auto&& [statement, entry] : entries)
+            result.push_back(entry);
+    }
+    std::sort(result.begin(), result.end(), [](auto&& a, auto&& b) { return a.total > b.total; });
+    return result;
+}
@@ -0,0 +1,102 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    slow_query_log.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file slow_query_log.h
+
+#ifndef __SLOW_QUERY_LOG_H__
+#define __SLOW_QUERY_LOG_H__
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \brief aggregates database statements that took longer than a threshold
+///
+/// Statements are grouped by their normalised text, i.e. with literals
+/// replaced by placeholders, so the many variants of a generated query
+/// show up as a single entry.
+class SlowQueryLog {
+public:
+    class Entry {
+    public:
+        /// \brief normalised statement
+        std::string statement;
+        /// \brief slowest execution with the original literals
+        std::string example;
+        /// \brief database operation that issued the slowest execution
+        std::string operation;
+        /// \brief query plan, if explaining is enabled
+        std::string plan;
+        std::size_t count {};
+        std::chrono::microseconds total {};
+        std::chrono::microseconds max {};
+        /// \brief rows returned or changed by the slowest execution
+        unsigned long long rows {};
+    };
+
+    /// \brief names the database operation of the current thread for recorded statements
+    class Operation {
+    public:
+        explicit Operation(const char* name)
+            : previous(current)
+        {
+            current = name;
+        }
+        ~Operation() { current = previous; }
+
+        Operation(const Operation&) = delete;
+        Operation& operator=(const Operation&) = delete;
+
+        static const char* get() { return current ? current : "other"; }
+
+    private:
+        const char* previous;
+        static inline thread_local const char* current {};
+    };
+
+    explicit SlowQueryLog(std::chrono::milliseconds threshold, std::size_t maxEntries = 200);
+
+    std::chrono::microseconds getThreshold() const { return threshold; }
+
+    /// \brief add an execution of query to its statement
+    /// \param explain called once per statement to get the query plan, may be empty
+    void record(const std::string& query, std::chrono::microseconds duration, unsigned long long rows, const std::function<std::string()>& explain = nullptr);
+
+    /// \brief all statements, the most expensive in total first
+    std::vector<Entry> getEntries() const;
+
+    /// \brief replace literals by ? and collapse lists and whitespace
+    static std::string normalize(const std::string& query);
+
+private:
+    std::chrono::microseconds threshold;
+    std::size_t maxEntries;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+#endif // __SLOW_QUERY_LOG_H__
@@ -43,6 +43,7 @@
 #include "metadata/metadata_handler.h"
 #include "search_handler.h"
 #include "upnp_xml.h"
+#include "util/metrics.h"
 #include "util/mime.h"
 #include "util/string_converter.h"
 #include "util/tools.h"
@@ -321,6 +322,12 @@ void SQLDatabase::init()
     if (table_quote_begin == '\0' || table_quote_end == '\0')
         throw_std_runtime_error("quote vars need to be overridden");
 
+    auto slowQueryTime = config->getIntOption(CFG_SERVER_STORAGE_SLOW_QUERY_TIME);
+    if (slowQueryTime > 0) {
+        slowQueryLog = std::make_unique<SlowQueryLog>(std::chrono::milliseconds(slowQueryTime));
+        explainSlowQueries = config->getBoolOption(CFG_SERVER_STORAGE_EXPLAIN_SLOW_QUERIES);
+    }
+
     /// \brief Map resource search keys to column ids
     // entries are handled sequentially,
     // duplicate entries are added to statement in same order if key is present in SortCriteria
@@ -492,6 +499,55 @@ void SQLDatabase::shutdown()
     shutdownDriver();
 }
 
+std::vector<SlowQueryLog::Entry> SQLDatabase::getSlowQueries() const
+{
+    return slowQueryLog ? slowQueryLog->getEntries() : std::vector<SlowQueryLog::Entry>();
+}
+
+void SQLDatabase::recordQuery(const std::string& query, std::chrono::microseconds duration, unsigned long long rows)
+{
+    queryMetric(query).record(duration);
+
+    if (!slowQueryLog)
+        return;
+    // the plans are queried through select, too
+    if (duration < slowQueryLog->getThreshold() || startswith(query, "EXPLAIN"))
+        return;
+
+    log_info("Slow query in {} took {} ms for {} rows: {}", SlowQueryLog::Operation::get(), duration.count() / 1000, rows, query);
+    std::function<std::string()> plan;
+    if (explainSlowQueries && (startswith(query, "SELECT") || startswith(query, "UPDATE") || startswith(query, "DELETE"))) {
+        plan = [this, &query]() {
+            try {
+                return explain(query);
+            } catch (const std::runtime_error& e) {
+                return std::string(e.what());
+            }
+        };
+    }
+    slowQueryLog->record(query, duration, rows, plan);
+}
+
+MetricHistogram& SQLDatabase::queryMetric(const std::string& query)
+{
+    static constexpr auto help = "Duration of database queries";
+    static auto&& selectTime = Metrics::getInstance()->histogram("gerbera_database_query_seconds", help, R"(type="select")");
+    static auto&& insertTime = Metrics::getInstance()->histogram("gerbera_database_query_seconds", help, R"(type="insert")");
+    static auto&& updateTime = Metrics::getInstance()->histogram("gerbera_database_query_seconds", help, R"(type="update")");
+    static auto&& deleteTime = Metrics::getInstance()->histogram("gerbera_database_query_seconds", help, R"(type="delete")");
+    static auto&& otherTime = Metrics::getInstance()->histogram("gerbera_database_query_seconds", help, R"(type="other")");
+
+    if (startswith(query, "SELECT"))
+        return selectTime;
+    if (startswith(query, "INSERT"))
+        return insertTime;
+    if (startswith(query, "UPDATE"))
+        return updateTime;
+    if (startswith(query, "DELETE"))
+        return deleteTime;
+    return otherTime;
+}
+
 std::string SQLDatabase::getSortCapabilities()
 {
     std::vector<std::string> sortKeys;
@@ -705,6 +761,7 @@ std::vector<SQLDatabase::AddUpdateTable> SQLDatabase::_addUpdateObject(const std
 
 void SQLDatabase::addObject(const std::shared_ptr<CdsObject>& obj, int* changedContainer)
 {
+    auto operation = SlowQueryLog::Operation("addObject");
     if (obj->getID() != INVALID_OBJECT_ID)
         throw_std_runtime_error("Tried to add an object with an object ID set");
 
@@ -727,6 +784,7 @@ void SQLDatabase::addObject(const std::shared_ptr<CdsObject>& obj, int* changedC
 
 void SQLDatabase::updateObject(const std::shared_ptr<CdsObject>& obj, int* changedContainer)
 {
+    auto operation = SlowQueryLog::Operation("updateObject");
     std::vector<AddUpdateTable> data;
     if (obj->getID() == CDS_ID_FS_ROOT) {
         std::map<std::string, std::string> cdsObjectSql;
@@ -764,6 +822,7 @@ void SQLDatabase::updateObject(const std::shared_ptr<CdsObject>& obj, int* chang
 
 std::shared_ptr<CdsObject> SQLDatabase::loadObject(int objectID)
 {
+    auto operation = SlowQueryLog::Operation("loadObject");
     if (dynamicContainers.find(objectID) != dynamicContainers.end()) {
         return dynamicContainers.at(objectID);
     }
@@ -838,6 +897,7 @@ std::vector<int> SQLDatabase::getServiceObjectIDs(char servicePrefix)
 
 std::vector<std::shared_ptr<CdsObject>> SQLDatabase::browse(BrowseParam& param)
 {
+    auto operation = SlowQueryLog::Operation("browse");
     const auto parent = param.getObject();
 
     if (dynamicContainers.find(parent->getID()) != dynamicContainers.end()) {
@@ -999,6 +1059,7 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::browse(BrowseParam& param)
 
 std::vector<std::shared_ptr<CdsObject>> SQLDatabase::search(const SearchParam& param, int* numMatches)
 {
+    auto operation = SlowQueryLog::Operation("search");
     auto searchParser = SearchParser(*sqlEmitter, param.searchCriteria());
     std::shared_ptr<ASTNode> rootNode = searchParser.parse();
     std::string searchSQL(rootNode->emitSQL());
@@ -1062,6 +1123,7 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::search(const SearchParam& p
 
 int SQLDatabase::getChildCount(int contId, bool containers, bool items, bool hideFsRoot)
 {
+    auto operation = SlowQueryLog::Operation("getChildCount");
     if (!containers && !items)
         return 0;
 
@@ -1091,6 +1153,7 @@ int SQLDatabase::getChildCount(int contId, bool containers, bool items, bool hid
 
 std::map<int, int> SQLDatabase::getChildCounts(const std::vector<int>& contId, bool containers, bool items, bool hideFsRoot)
 {
+    auto operation = SlowQueryLog::Operation("getChildCounts");
     if (!containers && !items)
         return {};
 
@@ -1145,6 +1208,7 @@ std::vector<std::string> SQLDatabase::getMimeTypes()
 
 std::shared_ptr<CdsObject> SQLDatabase::findObjectByPath(const fs::path& fullpath, bool wasRegularFile)
 {
+    auto operation = SlowQueryLog::Operation("findObjectByPath");
     std::string dbLocation = [&fullpath, wasRegularFile] {
         std::error_code ec;
         if (isRegularFile(fullpath, ec) || wasRegularFile)
@@ -1186,6 +1250,7 @@ int SQLDatabase::findObjectIDByPath(const fs::path& fullpath, bool wasRegularFil
 
 int SQLDatabase::ensurePathExistence(const fs::path& path, int* changedContainer)
 {
+    auto operation = SlowQueryLog::Operation("ensurePathExistence");
     if (changedContainer)
         *changedContainer = INVALID_OBJECT_ID;
 
@@ -1542,6 +1607,7 @@ std::vector<std::pair<std::string, std::string>> SQLDatabase::retrieveMetaDataFo
 
 int SQLDatabase::getTotalFiles(bool isVirtual, const std::string& mimeType, const std::string& upnpClass)
 {
+    auto operation = SlowQueryLog::Operation("getTotalFiles");
     auto where = std::vector {
         fmt::format("{} != {:d}", identifier("object_type"), OBJECT_TYPE_CONTAINER),
     };
@@ -1564,39 +1630,56 @@ int SQLDatabase::getTotalFiles(bool isVirtual, const std::string& mimeType, cons
     return 0;
 }
 
-std::string SQLDatabase::incrementUpdateIDs(const std::unordered_set<int>& ids)
+std::unordered_map<int, Database::UpdateID> SQLDatabase::loadUpdateIDs(const std::unordered_set<int>& ids)
 {
+    auto operation = SlowQueryLog::Operation("loadUpdateIDs");
     if (ids.empty())
         return {};
 
-    beginTransaction("incrementUpdateIDs");
-
-    exec(fmt::format("UPDATE {0} SET {1} = {1} + 1 WHERE {2} IN ({3})",
-        identifier(CDS_OBJECT_TABLE), identifier("update_id"), identifier("id"), fmt::join(ids, ",")));
-
-    auto res = select(fmt::format("SELECT {0}, {1} FROM {2} WHERE {0} IN ({3})",
-        identifier("id"), identifier("update_id"), identifier(CDS_OBJECT_TABLE), fmt::join(ids, ",")));
-    if (!res) {
-        rollback("incrementUpdateIDs 2");
+    auto res = select(fmt::format("SELECT {0}, {1}, {2} FROM {3} WHERE {0} IN ({4})",
+        identifier("id"), identifier("update_id"), identifier("parent_id"), identifier(CDS_OBJECT_TABLE), fmt::join(ids, ",")));
+    if (!res)
         throw_std_runtime_error("Error while fetching update ids");
-    }
-    commit("incrementUpdateIDs 2");
 
+    std::unordered_map<int, UpdateID> result;
     std::unique_ptr<SQLRow> row;
-    std::vector<std::string> rows;
-    rows.reserve(res->getNumRows());
     while ((row = res->nextRow())) {
-        rows.push_back(fmt::format("{},{}", row->col(0), row->col(1)));
+        result.emplace(row->col_int(0, INVALID_OBJECT_ID), UpdateID { row->col_int(1, 0), row->col_int(2, INVALID_OBJECT_ID) });
     }
+    return result;
+}
 
-    if (rows.empty())
-        return {};
+void SQLDatabase::storeUpdateIDs(const std::unordered_map<int, int>& updateIDs)
+{
+    auto operation = SlowQueryLog::Operation("storeUpdateIDs");
+    if (updateIDs.empty())
+        return;
 
-    return fmt::format("{}", fmt::join(rows, ","));
+    // keep the statements at a sane size after large imports
+    constexpr std::size_t chunkSize = 500;
+    std::vector<std::string> cases;
+    std::vector<int> ids;
+    cases.reserve(std::min(updateIDs.size(), chunkSize));
+    ids.reserve(std::min(updateIDs.size(), chunkSize));
+
+    beginTransaction("storeUpdateIDs");
+    auto it = updateIDs.begin();
+    while (it != updateIDs.end()) {
+        cases.clear();
+        ids.clear();
+        for (; it != updateIDs.end() && ids.size() < chunkSize; ++it) {
+            cases.push_back(fmt::format("WHEN {} THEN {}", it->first, it->second));
+            ids.push_back(it->first);
+        }
+        exec(fmt::format("UPDATE {0} SET {1} = CASE {2} {3} END WHERE {2} IN ({4})",
+            identifier(CDS_OBJECT_TABLE), identifier("update_id"), identifier("id"), fmt::join(cases, " "), fmt::join(ids, ",")));
+    }
+    commit("storeUpdateIDs");
 }
 
 std::unordered_set<int> SQLDatabase::getObjects(int parentID, bool withoutContainer)
 {
+    auto operation = SlowQueryLog::Operation("getObjects");
     auto colId = identifier("id");
     auto table = identifier(CDS_OBJECT_TABLE);
     auto colParentId = identifier("parent_id");
@@ -1621,6 +1704,7 @@ std::unordered_set<int> SQLDatabase::getObjects(int parentID, bool withoutContai
 
 std::unique_ptr<Database::ChangedContainers> SQLDatabase::removeObjects(const std::unordered_set<int>& list, bool all)
 {
+    auto operation = SlowQueryLog::Operation("removeObjects");
     std::size_t count = list.size();
     if (count <= 0)
         return nullptr;
@@ -1693,6 +1777,7 @@ void SQLDatabase::_removeObjects(const std::vector<std::int32_t>& objectIDs)
 
 std::unique_ptr<Database::ChangedContainers> SQLDatabase::removeObject(int objectID, bool all)
 {
+    auto operation = SlowQueryLog::Operation("removeObject");
     auto res = select(fmt::format("SELECT {}, {} FROM {} WHERE {} = {} LIMIT 1",
         identifier("object_type"), identifier("ref_id"), identifier(CDS_OBJECT_TABLE), identifier("id"), objectID));
     if (!res)
@@ -1728,6 +1813,7 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::_recursiveRemove(
     const std::vector<std::int32_t>& items, const std::vector<std::int32_t>& containers,
     bool all)
 {
+    auto operation = SlowQueryLog::Operation("_recursiveRemove");
     log_debug("start");
 
     ChangedContainers changedContainers;
@@ -1739,6 +1825,7 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::_recursiveRemove(
     auto containerIds = std::vector(containers);
     auto parentIds = std::vector(items);
     auto removeIds = std::vector(containers);
+    changedContainers.removed = containers;
 
     // select statements
     auto parentSql = fmt::format("SELECT DISTINCT {0}parent_id{1} FROM {0}{2}{1} WHERE {0}id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE);
@@ -1802,6 +1889,7 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::_recursiveRemove(
                 if (IS_CDS_CONTAINER(objType)) {
                     containerIds.push_back(objId);
                     removeIds.push_back(objId);
+                    changedContainers.removed.push_back(objId);
                 } else {
                     if (all) {
                         if (!row->isNullOrEmpty(2)) {
@@ -1839,9 +1927,10 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::_recursiveRemove(
 
 std::unique_ptr<Database::ChangedContainers> SQLDatabase::_purgeEmptyContainers(const std::unique_ptr<ChangedContainers>& maybeEmpty)
 {
+    auto operation = SlowQueryLog::Operation("_purgeEmptyContainers");
     log_debug("start upnp: {}; ui: {}", fmt::to_string(fmt::join(maybeEmpty->upnp, ",")), fmt::to_string(fmt::join(maybeEmpty->ui, ",")));
     if (maybeEmpty->upnp.empty() && maybeEmpty->ui.empty())
-        return {};
+        return maybeEmpty->removed.empty() ? nullptr : std::make_unique<ChangedContainers>(*maybeEmpty);
 
     auto tabAlias = identifier("fol");
     auto childAlias = identifier("cld");
@@ -1860,6 +1949,7 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::_purgeEmptyContainers(
     std::unique_ptr<SQLRow> row;
 
     ChangedContainers changedContainers;
+    changedContainers.removed = maybeEmpty->removed;
 
     auto selUi = std::vector(maybeEmpty->ui);
     auto selUpnp = std::vector(maybeEmpty->upnp);
@@ -1913,6 +2003,7 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::_purgeEmptyContainers(
         // log_debug("selecting: {}; removing: {}", selectSql, fmt::join(del, ","));
         if (!del.empty()) {
             _removeObjects(del);
+            std::copy(del.begin(), del.end(), std::back_inserter(changedContainers.removed));
             del.clear();
             if (!selUi.empty() || !selUpnp.empty())
                 again = true;
@@ -2352,13 +2443,11 @@ std::vector<int> SQLDatabase::getPathIDs(int objectID)
     std::vector<int> pathIDs;
     while (objectID != CDS_ID_ROOT) {
         pathIDs.push_back(objectID);
-        auto res = select(fmt::format("{} {} LIMIT 1", sel, objectID));
-        if (!res)
-            break;
-        auto row = res->nextRow();
-        if (!row)
+        if (objectID == INVALID_OBJECT_ID)
             break;
-        objectID = row->col_int(0, INVALID_OBJECT_ID);
+        auto res = select(fmt::format("{} {} LIMIT 1", sel, objectID));
+        auto row = res ? res->nextRow() : nullptr;
+        objectID = row ? row->col_int(0, INVALID_OBJECT_ID) : INVALID_OBJECT_ID;
     }
     return pathIDs;
 }
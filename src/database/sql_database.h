@@ -46,6 +46,7 @@ class CdsContainer;
 class CdsResource;
 class SQLResult;
 class SQLEmitter;
+class MetricHistogram;
 
 #define DBVERSION 15
 
@@ -142,7 +143,8 @@ public:
     // virtual std::shared_ptr<CdsObject> findObjectByTitle(std::string title, int parentID);
     std::shared_ptr<CdsObject> findObjectByPath(const fs::path& fullpath, bool wasRegularFile = false) override;
     int findObjectIDByPath(const fs::path& fullpath, bool wasRegularFile = false) override;
-    std::string incrementUpdateIDs(const std::unordered_set<int>& ids) override;
+    std::unordered_map<int, UpdateID> loadUpdateIDs(const std::unordered_set<int>& ids) override;
+    void storeUpdateIDs(const std::unordered_map<int, int>& updateIDs) override;
 
     fs::path buildContainerPath(int parentID, const std::string& title) override;
     bool addContainer(int parentContainerId, std::string virtualPath, const std::shared_ptr<CdsContainer>& cont, int* containerID) override;
@@ -168,6 +170,8 @@ public:
     void shutdown() override;
     virtual void shutdownDriver() = 0;
 
+    std::vector<SlowQueryLog::Entry> getSlowQueries() const override;
+
     int ensurePathExistence(const fs::path& path, int* changedContainer) override;
 
     static std::string getSortCapabilities();
@@ -212,6 +216,19 @@ protected:
     using SqlAutoLock = std::lock_guard<decltype(sqlMutex)>;
     std::map<int, std::shared_ptr<CdsContainer>> dynamicContainers;
 
+    /// \brief histogram for the duration of query, by kind of statement
+    static MetricHistogram& queryMetric(const std::string& query);
+
+    /// \brief record query in the query histogram and, if it took too long, in the slow query log
+    /// \param duration execution time only, waiting for the connection or the sqlite3 thread is not counted
+    /// \param rows number of rows returned or changed
+    void recordQuery(const std::string& query, std::chrono::microseconds duration, unsigned long long rows);
+    /// \brief query plan of query for the slow query log
+    virtual std::string explain(const std::string& query) { return {}; }
+
+    std::unique_ptr<SlowQueryLog> slowQueryLog;
+    bool explainSlowQueries {};
+
     void upgradeDatabase(unsigned int dbVersion, const std::array<unsigned int, DBVERSION>& hashies, config_option_t upgradeOption, const std::string& updateVersionCommand, const std::string& addResourceColumnCmd);
     virtual void _exec(const std::string& query) = 0;
 
@@ -34,6 +34,7 @@
 #include <array>
 
 #include "config/config_manager.h"
+#include "util/metrics.h"
 
 #define DB_BACKUP_FORMAT "{}.backup"
 
@@ -226,11 +227,13 @@ void Sqlite3DatabaseWithTransactions::commit(std::string_view tName)
 std::shared_ptr<SQLResult> Sqlite3Database::select(const std::string& query)
 {
     try {
-        log_debug("Adding select to Queue: {}", query);
+        log_vdebug(sql, "Adding select to Queue: {}", query);
         auto stask = std::make_shared<SLSelectTask>(query);
         addTask(stask);
         stask->waitForTask();
-        return stask->getResult();
+        auto result = stask->getResult();
+        recordQuery(query, stask->getDuration(), result ? result->getNumRows() : 0);
+        return result;
     } catch (const std::runtime_error& e) {
         if (dbInitDone) {
             log_error("prematurely shutting down.");
@@ -244,10 +247,11 @@ std::shared_ptr<SQLResult> Sqlite3Database::select(const std::string& query)
 int Sqlite3Database::exec(const std::string& query, bool getLastInsertId)
 {
     try {
-        log_debug("Adding query to Queue: {}", query);
+        log_vdebug(sql, "Adding query to Queue: {}", query);
         auto etask = std::make_shared<SLExecTask>(query, getLastInsertId);
         addTask(etask);
         etask->waitForTask();
+        recordQuery(query, etask->getDuration(), etask->getChanges());
         return getLastInsertId ? etask->getLastInsertId() : -1;
     } catch (const std::runtime_error& e) {
         if (dbInitDone) {
@@ -259,6 +263,17 @@ int Sqlite3Database::exec(const std::string& query, bool getLastInsertId)
     }
 }
 
+std::string Sqlite3Database::explain(const std::string& query)
+{
+    // columns of EXPLAIN QUERY PLAN are id, parent, notused, detail
+    auto res = select(fmt::format("EXPLAIN QUERY PLAN {}", query));
+    std::vector<std::string> plan;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()))
+        plan.push_back(row->col(3));
+    return fmt::format("{}", fmt::join(plan, "\n"));
+}
+
 void Sqlite3Database::threadProc()
 {
     log_debug("Running thread");
@@ -273,6 +288,8 @@ void Sqlite3Database::threadProc()
             return;
         }
 
+        static auto&& queueLength = Metrics::getInstance()->gauge("gerbera_sqlite_task_queue_length", "Tasks waiting for the sqlite3 thread");
+
         StdThreadRunner::waitFor("Sqlite3Database", [this] { return threadRunner != nullptr; });
         auto lock = threadRunner->uniqueLockS("threadProc");
         // tell init() that we are ready
@@ -282,6 +299,7 @@ void Sqlite3Database::threadProc()
             while (!taskQueue.empty()) {
                 auto task = taskQueue.front();
                 taskQueue.pop();
+                queueLength.set(taskQueue.size());
 
                 lock.unlock();
                 try {
@@ -335,7 +353,9 @@ void Sqlite3Database::addTask(const std::shared_ptr<SLTask>& task, bool onlyIfDi
         throw_std_runtime_error("sqlite3 task queue is already closed");
     }
     if (!onlyIfDirty || dirty) {
+        static auto&& queueLength = Metrics::getInstance()->gauge("gerbera_sqlite_task_queue_length", "Tasks waiting for the sqlite3 thread");
         taskQueue.push(task);
+        queueLength.set(taskQueue.size());
         threadRunner->notify();
     }
 }
@@ -448,6 +468,7 @@ void SLSelectTask::run(sqlite3*& db, Sqlite3Database* sl)
     pres = std::make_shared<Sqlite3Result>();
 
     char* err = nullptr;
+    auto start = std::chrono::steady_clock::now();
     int ret = sqlite3_get_table(
         db,
         query,
@@ -455,6 +476,7 @@ void SLSelectTask::run(sqlite3*& db, Sqlite3Database* sl)
         &pres->nrow,
         &pres->ncolumn,
         &err);
+    duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
     std::string error;
     if (err) {
         log_debug(err);
@@ -481,12 +503,14 @@ void SLExecTask::run(sqlite3*& db, Sqlite3Database* sl)
 {
     log_debug("Running: {}", query);
     char* err;
+    auto start = std::chrono::steady_clock::now();
     int ret = sqlite3_exec(
         db,
         query,
         nullptr,
         nullptr,
         &err);
+    duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
     std::string error;
     if (err) {
         error = err;
@@ -497,6 +521,7 @@ void SLExecTask::run(sqlite3*& db, Sqlite3Database* sl)
     }
     if (getLastInsertIdFlag)
         lastInsertId = sqlite3_last_insert_rowid(db);
+    changes = sqlite3_changes(db);
     contamination = true;
 }
 
@@ -33,6 +33,7 @@
 #ifndef __SQLITE3_STORAGE_H__
 #define __SQLITE3_STORAGE_H__
 
+#include <chrono>
 #include <queue>
 #include <sqlite3.h>
 #include <unistd.h>
@@ -69,6 +70,9 @@ public:
 
     std::string getError() const { return error; }
 
+    /// \brief time the statement took in the sqlite3 thread, without waiting in the queue
+    std::chrono::microseconds getDuration() const { return duration; }
+
     virtual std::string_view taskType() const = 0;
 
 protected:
@@ -83,6 +87,8 @@ protected:
     /// \brief true if this task has backuped the db
     bool decontamination {};
 
+    std::chrono::microseconds duration {};
+
     std::condition_variable cond;
     std::mutex mutex;
 
@@ -136,6 +142,7 @@ public:
     SLExecTask(const std::string& query, bool getLastInsertId);
     void run(sqlite3*& db, Sqlite3Database* sl) override;
     int getLastInsertId() const { return lastInsertId; }
+    unsigned long long getChanges() const { return changes; }
 
     std::string_view taskType() const override { return "ExecTask"; }
 
@@ -144,6 +151,7 @@ protected:
     const char* query;
 
     int lastInsertId {};
+    unsigned long long changes {};
     bool getLastInsertIdFlag;
 };
 
@@ -180,6 +188,7 @@ private:
 
     std::shared_ptr<SQLResult> select(const std::string& query) override;
     int exec(const std::string& query, bool getLastInsertId = false) override;
+    std::string explain(const std::string& query) override;
 
     void storeInternalSetting(const std::string& key, const std::string& value) override;
 
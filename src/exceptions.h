@@ -84,4 +84,12 @@ class TryAgainException : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+class TranscodingRejectedException : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+class InvalidSeekRangeException : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
 #endif // __EXCEPTIONS_H__
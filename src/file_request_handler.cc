@@ -38,8 +38,12 @@
 #include "content/content_manager.h"
 #include "database/database.h"
 #include "iohandler/file_io_handler.h"
+#include "iohandler/prefetch_io_handler.h"
 #include "metadata/metadata_handler.h"
+#include "transcoding/transcode_cache.h"
 #include "transcoding/transcode_dispatcher.h"
+#include "transcoding/transcode_scheduler.h"
+#include "transcoding/transcode_seek.h"
 #include "util/tools.h"
 #include "util/upnp_headers.h"
 #include "util/upnp_quirks.h"
@@ -51,6 +55,13 @@ FileRequestHandler::FileRequestHandler(std::shared_ptr<ContentManager> content,
 {
 }
 
+/// \brief find a request header, header names are not case sensitive
+static std::string findHeader(const std::map<std::string, std::string>& headers, const std::string& name)
+{
+    auto it = std::find_if(headers.begin(), headers.end(), [&name](auto&& header) { return toLower(header.first) == toLower(name); });
+    return it != headers.end() ? trimString(it->second) : "";
+}
+
 static bool checkFileAndSubtitle(fs::path& path, const std::shared_ptr<CdsObject>& obj, const std::size_t& resId, std::string& mimeType, struct stat& statbuf, const std::string& rh)
 {
     bool isSrt = false;
@@ -73,6 +84,53 @@ static bool checkFileAndSubtitle(fs::path& path, const std::shared_ptr<CdsObject
     return isSrt;
 }
 
+void FileRequestContext::setContentFactory(ContentFactory factory)
+{
+    contentFactory = std::move(factory);
+    ioHandler.reset();
+    isOpen = false;
+    contentLength.reset();
+}
+
+void FileRequestContext::createContent()
+{
+    if (ioHandler)
+        return;
+    if (!contentFactory)
+        throw_std_runtime_error("No content available for {}", path.c_str());
+
+    ioHandler = contentFactory();
+    if (!ioHandler)
+        throw_std_runtime_error("Failed to create content for {}", path.c_str());
+}
+
+off_t FileRequestContext::getContentLength()
+{
+    if (contentLength)
+        return *contentLength;
+
+    createContent();
+    if (!isOpen) {
+        ioHandler->open(UPNP_READ);
+        isOpen = true;
+    }
+    // keep the handler open, open() serves it from the start
+    ioHandler->seek(0L, SEEK_END);
+    contentLength = ioHandler->tell();
+    ioHandler->seek(0L, SEEK_SET);
+    return *contentLength;
+}
+
+std::unique_ptr<IOHandler> FileRequestContext::openContent()
+{
+    createContent();
+    if (!isOpen)
+        ioHandler->open(UPNP_READ);
+    isOpen = false;
+    contentLength.reset();
+    return std::move(ioHandler);
+}
+
 void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
 {
     log_debug("start: {}", filename);
@@ -84,8 +142,10 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
 
     auto headers = std::make_unique<Headers>();
 
-    auto params = parseParameters(filename, LINK_FILE_REQUEST_HANDLER);
-    obj = getObjectById(params);
+    request = std::make_unique<FileRequestContext>();
+    request->params = parseParameters(filename, LINK_FILE_REQUEST_HANDLER);
+    auto&& params = request->params;
+    auto obj = request->obj = getObjectById(params);
     std::string rh = getValueOrDefault(params, RESOURCE_HANDLER);
 
     // determining which resource to serve
@@ -98,9 +158,10 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
 
     auto item = std::dynamic_pointer_cast<CdsItem>(obj);
 
-    fs::path path = item ? item->getLocation() : "";
+    request->path = item ? item->getLocation() : "";
+    auto&& path = request->path;
+    auto&& statbuf = request->statbuf;
     std::string mimeType;
-    struct stat statbuf;
     bool isSrt = checkFileAndSubtitle(path, obj, resId, mimeType, statbuf, rh);
 
     UpnpFileInfo_set_IsReadable(info, access(path.c_str(), R_OK) == 0);
@@ -123,19 +184,14 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
             mimeType = getMTFromProtocolInfo(protocolInfo);
         }
 
-        auto h = MetadataHandler::createHandler(context, resHandler);
+        std::shared_ptr<MetadataHandler> h = MetadataHandler::createHandler(context, resHandler);
         if (mimeType.empty())
             mimeType = h->getMimeType();
 
-        ioHandler = h->serveContent(obj, resId);
-
-        // get size
-        ioHandler->open(UPNP_READ);
-        ioHandler->seek(0L, SEEK_END);
-        off_t size = ioHandler->tell();
-        ioHandler->close();
-
-        UpnpFileInfo_set_FileLength(info, size);
+        request->setContentFactory([h, obj, resId]() { return h->serveContent(obj, resId); });
+        // the length of generated content is only known after generating it,
+        // the request context keeps the content for open()
+        UpnpFileInfo_set_FileLength(info, request->getContentLength());
 
         // Should have its own handler really
         triggerPlayHook = false;
@@ -147,8 +203,7 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
 
         mimeType = tp->getTargetMimeType();
 
-        auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-        if (getValueOrDefault(mappings, mimeType) == CONTENT_TYPE_PCM) {
+        if (config->getSnapshot()->getContentType(mimeType) == CONTENT_TYPE_PCM) {
             std::string freq = obj->getResource(0)->getAttribute(R_SAMPLEFREQUENCY);
             std::string nrch = obj->getResource(0)->getAttribute(R_NRAUDIOCHANNELS);
             if (!freq.empty())
@@ -157,24 +212,66 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
                 mimeType += fmt::format(";channels={}", nrch);
         }
 
+        std::string range = getValueOrDefault(params, "range");
+
+        // seekable profiles are restarted at the requested time, the size of
+        // the output is unknown, so byte ranges are not supported
+        TranscodeSeek seek;
+        if (tp->canSeek()) {
+            auto requestHeaders = Headers::readHeaders(info);
+            auto timeSeek = findHeader(requestHeaders, UPNP_DLNA_TIME_SEEK_HEADER);
+            if (!timeSeek.empty()) {
+                auto duration = getItemDuration(item);
+                auto start = parseNptStart(timeSeek);
+                if (!start || (duration > 0 && *start >= duration))
+                    throw InvalidSeekRangeException(fmt::format("Invalid time seek range '{}' for {}", timeSeek, path.c_str()));
+                seek.time = *start;
+                headers->addHeader(UPNP_DLNA_TIME_SEEK_HEADER, duration > 0 ? fmt::format("npt={}-{}/{}", formatNptTime(seek.time), formatNptTime(duration), formatNptTime(duration)) : fmt::format("npt={}-/*", formatNptTime(seek.time)));
+            }
+        }
+
+        // completely cached outputs can be served with length and ranges
+        auto cache = TranscodeCache::getInstance(config);
+        auto cacheKey = (cache && tp->getType() == TR_External && !item->isExternalItem()) ? TranscodeCache::makeKey(tp, path, statbuf.st_mtime, range, seek.time) : "";
+        // the output stays in the cache for a while, if it is evicted before open() it is transcoded again
+        auto cachedSize = !cacheKey.empty() ? cache->pin(cacheKey) : std::nullopt;
+        if (cachedSize) {
+            UpnpFileInfo_set_FileLength(info, *cachedSize);
+        } else {
 #ifdef UPNP_USING_CHUNKED
-        UpnpFileInfo_set_FileLength(info, UPNP_USING_CHUNKED);
+            UpnpFileInfo_set_FileLength(info, UPNP_USING_CHUNKED);
 #else
-        UpnpFileInfo_set_FileLength(info, -1);
+            UpnpFileInfo_set_FileLength(info, -1);
 #endif
-        std::string range = getValueOrDefault(params, "range");
+        }
 
-        auto transcodeDispatcher = std::make_unique<TranscodeDispatcher>(content);
-        ioHandler = transcodeDispatcher->serveContent(tp, path, item, range);
+        auto seekFlags = cachedSize ? std::string(UPNP_DLNA_OP_SEEK_RANGE) : getTranscodeSeekFlags(tp);
+        auto contentFeatures = fmt::format("{}={};{}={}", UPNP_DLNA_OP, seekFlags, UPNP_DLNA_CONVERSION_INDICATOR, UPNP_DLNA_CONVERSION);
+        if (startswith(mimeType, "audio") || startswith(mimeType, "video"))
+            contentFeatures.append(";" UPNP_DLNA_FLAGS "=" UPNP_DLNA_ORG_FLAGS_AV);
+        headers->addHeader(UPNP_DLNA_CONTENT_FEATURES_HEADER, contentFeatures);
+
+        // requests joining a cached or running output do not start a transcoder,
+        // all others wait for a free slot before the response is sent
+        std::shared_ptr<TranscodeJob> job;
+        if (cacheKey.empty() || !cache->contains(cacheKey))
+            job = content->getTranscodeScheduler()->admit(tp->getName(), tp->getMaxJobs(), fmt::format("Transcoding {} with {}", obj->getTitle(), tp->getName()));
+
+        // the transcoder is only started when the content is actually requested
+        request->setContentFactory([content = content, tp, path, item, range, job, seek]() mutable {
+            auto transcodeDispatcher = std::make_unique<TranscodeDispatcher>(content);
+            transcodeDispatcher->setJob(std::move(job));
+            transcodeDispatcher->setSeek(seek);
+            return transcodeDispatcher->serveContent(tp, path, item, range);
+        });
 
     } else if (item) {
         UpnpFileInfo_set_FileLength(info, statbuf.st_size);
 
         quirks->addCaptionInfo(item, headers);
 
-        auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
         auto resource = item->getResource(0);
-        std::string dlnaContentHeader = getDLNAContentHeader(config, getValueOrDefault(mappings, item->getMimeType()), resource ? resource->getAttribute(R_VIDEOCODEC) : "", resource ? resource->getAttribute(R_AUDIOCODEC) : "");
+        std::string dlnaContentHeader = getDLNAContentHeader(config, config->getSnapshot()->getContentType(item->getMimeType()), resource ? resource->getAttribute(R_VIDEOCODEC) : "", resource ? resource->getAttribute(R_AUDIOCODEC) : "");
         if (!dlnaContentHeader.empty()) {
             headers->addHeader(UPNP_DLNA_CONTENT_FEATURES_HEADER, dlnaContentHeader);
         }
@@ -202,16 +299,25 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
     headers->writeHeaders(info);
 
     // Anything else just needs the FileIOHandler
-    if (!ioHandler) {
-        ioHandler = std::make_unique<FileIOHandler>(path);
+    if (!request->hasContentFactory()) {
+        auto snapshot = config->getSnapshot();
+        auto bufSize = snapshot->prefetchBufferSize;
+        auto chunkSize = snapshot->prefetchChunkSize;
+        // small files fit into a single read anyway
+        if (snapshot->prefetchEnabled && std::size_t(statbuf.st_size) > chunkSize) {
+            auto fillSize = std::min(snapshot->prefetchFillSize, bufSize);
+            request->setContentFactory([config = config, path, bufSize, chunkSize, fillSize]() -> std::unique_ptr<IOHandler> {
+                return std::make_unique<PrefetchIOHandler>(config, path, bufSize, chunkSize, fillSize);
+            });
+        } else {
+            request->setContentFactory([path]() -> std::unique_ptr<IOHandler> { return std::make_unique<FileIOHandler>(path); });
+        }
     }
 
     if (triggerPlayHook) {
         content->triggerPlayHook(obj);
     }
 
-    assert(ioHandler != nullptr);
-
     // log_debug("getInfo: Requested {}, ObjectID: {}, Location: {}, MimeType: {}",
     //      filename, object_id.c_str(), path.c_str(), info->content_type);
 
@@ -227,7 +333,11 @@ std::unique_ptr<IOHandler> FileRequestHandler::open(const char* filename, enum U
         throw_std_runtime_error("UPNP_WRITE unsupported");
     }
 
-    ioHandler->open(mode);
+    if (!request)
+        throw_std_runtime_error("No request information for {}", filename);
+
+    auto ioHandler = request->openContent();
+    request.reset();
     log_debug("end: {}", filename);
-    return std::move(ioHandler);
+    return ioHandler;
 }
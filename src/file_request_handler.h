@@ -32,10 +32,47 @@
 #ifndef __FILE_REQUEST_HANDLER_H__
 #define __FILE_REQUEST_HANDLER_H__
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <sys/stat.h>
+
 #include "common.h"
 #include "request_handler.h"
 #include "upnp_xml.h"
-#include <memory>
+
+/// \brief State of a single file request, kept between getInfo and open.
+///
+/// The content is created lazily by the content factory and memoised, so
+/// generated payloads like thumbnails are produced at most once per request
+/// and not at all if only the headers are requested.
+class FileRequestContext {
+public:
+    using ContentFactory = std::function<std::unique_ptr<IOHandler>()>;
+
+    std::map<std::string, std::string> params;
+    std::shared_ptr<CdsObject> obj;
+    fs::path path;
+    struct stat statbuf {};
+
+    /// \brief set the function creating the content, it is called at most once
+    void setContentFactory(ContentFactory factory);
+    bool hasContentFactory() const { return contentFactory != nullptr; }
+
+    /// \brief get the length of the content, creates the content if required
+    off_t getContentLength();
+
+    /// \brief get the opened content handler positioned at the start
+    std::unique_ptr<IOHandler> openContent();
+
+private:
+    ContentFactory contentFactory;
+    std::unique_ptr<IOHandler> ioHandler;
+    bool isOpen {};
+    std::optional<off_t> contentLength;
+
+    void createContent();
+};
 
 class FileRequestHandler : public RequestHandler {
 
@@ -49,8 +86,7 @@ protected:
     std::shared_ptr<UpnpXMLBuilder> xmlBuilder;
 
 private:
-    std::shared_ptr<CdsObject> obj;
-    std::unique_ptr<IOHandler> ioHandler;
+    std::unique_ptr<FileRequestContext> request;
 };
 
 #endif // __FILE_REQUEST_HANDLER_H__
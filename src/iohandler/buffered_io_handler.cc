@@ -66,67 +66,28 @@ void BufferedIOHandler::close()
 void BufferedIOHandler::threadProc()
 {
     int readBytes = 0;
-    std::size_t maxWrite;
 
 #ifdef TOMBDEBUG
     std::chrono::milliseconds lastLog;
     bool firstLog = true;
 #endif
 
-    auto lock = threadRunner->uniqueLock();
-    do {
+    while (!threadShutdown) {
 #ifdef TOMBDEBUG
         if (firstLog || getDeltaMillis(lastLog) > std::chrono::milliseconds(100)) {
             if (firstLog)
                 firstLog = false;
             lastLog = currentTimeMS();
-            [[maybe_unused]] float percentFillLevel = 0;
-            if (!empty) {
-                auto currentFillSize = int(b - a);
-                if (currentFillSize <= 0)
-                    currentFillSize += bufSize;
-                percentFillLevel = (float(currentFillSize) / float(bufSize)) * 100;
-            }
-            log_debug("buffer fill level: {:03.2f}%  (bufSize: {}; a: {}; b: {})", percentFillLevel, bufSize, a, b);
+            [[maybe_unused]] float percentFillLevel = (float(ring->size()) / float(bufSize)) * 100;
+            log_debug("buffer fill level: {:03.2f}%  (bufSize: {})", percentFillLevel, bufSize);
         }
 #endif
-        if (empty)
-            a = b = 0;
-
-        if (doSeek && !empty && (seekWhence == SEEK_SET || (seekWhence == SEEK_CUR && seekOffset > 0))) {
-            auto currentFillSize = int(b - a);
-            if (currentFillSize <= 0)
-                currentFillSize += bufSize;
-
-            auto relSeek = int(seekOffset);
-            if (seekWhence == SEEK_SET)
-                relSeek -= posRead;
-
-            if (relSeek <= currentFillSize) { // we have everything we need in the buffer already
-                a += relSeek;
-                posRead += relSeek;
-                if (a >= bufSize)
-                    a -= bufSize;
-                if (a == b) {
-                    empty = true;
-                    a = b = 0;
-                }
-
-                /// \todo do we need to wait for initialFillSize again?
-
-                doSeek = false;
-                threadRunner->notify();
-            }
-        }
-
-        // note: seeking could be optimized some more (backward seeking)
-        // but this should suffice for now
-
-        if (doSeek) { // seek not been processed yet
+        // seeks inside of the buffer are handled by the reader,
+        // everything else needs a seek of the underlying handler
+        if (doSeek) {
             try {
                 underlyingHandler->seek(seekOffset, seekWhence);
-                empty = true;
-                a = b = 0;
+                ring->clear();
             } catch (const std::runtime_error& e) {
                 log_error("Error while seeking in buffer: {}", e.what());
             }
@@ -134,43 +95,25 @@ void BufferedIOHandler::threadProc()
             /// \todo should we do that?
             waitForInitialFillSize = (initialFillSize > 0);
 
-            doSeek = false;
-            threadRunner->notify();
+            seekDone();
         }
 
-        maxWrite = (empty ? bufSize : (a < b ? bufSize - b : a - b));
-        if (maxWrite == 0) {
-            threadRunner->wait(lock);
+        if (!waitForSpace(getRefillSize(maxChunkSize)))
+            continue;
+
+        std::size_t maxWrite;
+        char* target = ring->writeArea(maxWrite);
+        std::size_t chunkSize = (maxChunkSize > maxWrite ? maxWrite : maxChunkSize);
+        readBytes = underlyingHandler->read(target, chunkSize);
+        if (readBytes == CHECK_SOCKET) {
+            checkSocket = true;
+            notifyReader();
+        } else if (readBytes <= 0) {
+            break;
         } else {
-            lock.unlock();
-            std::size_t chunkSize = (maxChunkSize > maxWrite ? maxWrite : maxChunkSize);
-            readBytes = underlyingHandler->read(buffer + b, chunkSize);
-            lock.lock();
-            if (readBytes > 0) {
-                b += readBytes;
-                assert(b <= bufSize);
-                if (b == bufSize)
-                    b = 0;
-                if (empty) {
-                    empty = false;
-                    threadRunner->notify();
-                }
-                if (waitForInitialFillSize) {
-                    auto currentFillSize = int(b - a);
-                    if (currentFillSize <= 0)
-                        currentFillSize += bufSize;
-                    if (std::size_t(currentFillSize) >= initialFillSize) {
-                        log_debug("buffer: initial fillsize reached");
-                        waitForInitialFillSize = false;
-                        threadRunner->notify();
-                    }
-                }
-            } else if (readBytes == CHECK_SOCKET) {
-                checkSocket = true;
-                threadRunner->notify();
-            }
+            commitWrite(readBytes);
         }
-    } while ((maxWrite == 0 || readBytes > 0 || readBytes == CHECK_SOCKET) && !threadShutdown);
+    }
     if (!threadShutdown) {
         if (readBytes == 0)
             eof = true;
@@ -178,5 +121,5 @@ void BufferedIOHandler::threadProc()
             readError = true;
     }
     // ensure that read() doesn't wait for me to fill the buffer
-    threadRunner->notify();
+    notifyReader();
 }
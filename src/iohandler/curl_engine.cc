@@ -0,0 +1,302 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    curl_engine.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file curl_engine.cc
+
+#ifdef HAVE_CURL
+#include "curl_engine.h" // API
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "config/config.h"
+
+// curl_multi_wait returns earlier if a transfer has to be handled
+#define CURL_ENGINE_MAX_WAIT_MS 1000
+
+CurlTransfer::CurlTransfer()
+    : handle(curl_easy_init())
+{
+    if (!handle)
+        throw_std_runtime_error("failed to init curl");
+}
+
+CurlTransfer::~CurlTransfer()
+{
+    curl_easy_cleanup(handle);
+}
+
+CurlEngine::CurlEngine(std::shared_ptr<Config> config)
+    : config(std::move(config))
+{
+    if (pipe2(wakeFds, O_CLOEXEC | O_NONBLOCK) != 0)
+        throw_std_runtime_error("Failed to create pipe: {}", std::strerror(errno));
+
+    multi = curl_multi_init();
+    share = curl_share_init();
+    if (!multi || !share) {
+        if (multi)
+            curl_multi_cleanup(multi);
+        if (share)
+            curl_share_cleanup(share);
+        ::close(wakeFds[0]);
+        ::close(wakeFds[1]);
+        throw_std_runtime_error("failed to init curl");
+    }
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, CurlEngine::lockShare);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, CurlEngine::unlockShare);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+CurlEngine::~CurlEngine()
+{
+    shutdown();
+
+    // the easy handles have to be removed before the share is released
+    curl_multi_cleanup(multi);
+    curl_share_cleanup(share);
+    ::close(wakeFds[0]);
+    ::close(wakeFds[1]);
+}
+
+void CurlEngine::run()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (running || shutdownFlag)
+        return;
+
+    running = true;
+    threadRunner = std::make_unique<StdThreadRunner>(
+        "CurlEngineThread", [](void* arg) -> void* {
+            auto inst = static_cast<CurlEngine*>(arg);
+            inst->threadProc();
+            return nullptr;
+        },
+        this, config);
+}
+
+void CurlEngine::shutdown()
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    if (shutdownFlag)
+        return;
+    shutdownFlag = true;
+
+    if (running) {
+        auto wake = char(1);
+        [[maybe_unused]] auto ret = ::write(wakeFds[1], &wake, 1);
+        lock.unlock();
+        threadRunner->join();
+        lock.lock();
+        threadRunner = nullptr;
+        running = false;
+    }
+
+    // transfers started from now on fail immediately
+    for (auto&& [command, transfer] : commands)
+        execute(command, transfer);
+    commands.clear();
+    handledCommands = queuedCommands;
+    processed.notify_all();
+
+    for (auto&& transfer : transfers) {
+        if (transfer->running) {
+            stop(transfer);
+            transfer->onDone(CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+}
+
+void CurlEngine::add(CurlTransfer* transfer)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    transfers.insert(transfer);
+    if (running)
+        queue(Command::Add, transfer);
+    else
+        execute(Command::Add, transfer);
+}
+
+void CurlEngine::wakeup(CurlTransfer* transfer)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (running)
+        queue(Command::Wakeup, transfer);
+    else
+        execute(Command::Wakeup, transfer);
+}
+
+void CurlEngine::remove(CurlTransfer* transfer)
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    if (running) {
+        auto number = queue(Command::Remove, transfer);
+        processed.wait(lock, [this, number]() { return handledCommands >= number; });
+    } else {
+        execute(Command::Remove, transfer);
+    }
+    transfers.erase(transfer);
+}
+
+void CurlEngine::restart(CurlTransfer* transfer)
+{
+    stop(transfer);
+    start(transfer);
+}
+
+std::size_t CurlEngine::getTransferCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return transfers.size();
+}
+
+unsigned long CurlEngine::queue(Command command, CurlTransfer* transfer)
+{
+    // only the first command since the last wakeup has to write to the pipe
+    if (commands.empty()) {
+        auto wake = char(1);
+        [[maybe_unused]] auto ret = ::write(wakeFds[1], &wake, 1);
+    }
+    commands.emplace_back(command, transfer);
+    return ++queuedCommands;
+}
+
+void CurlEngine::execute(Command command, CurlTransfer* transfer)
+{
+    switch (command) {
+    case Command::Add:
+        start(transfer);
+        break;
+    case Command::Wakeup:
+        transfer->onWakeup();
+        break;
+    case Command::Remove:
+        stop(transfer);
+        break;
+    }
+}
+
+void CurlEngine::start(CurlTransfer* transfer)
+{
+    if (transfer->running)
+        return;
+    // the engine thread is gone
+    if (shutdownFlag && !running) {
+        transfer->onDone(CURLE_ABORTED_BY_CALLBACK);
+        return;
+    }
+
+    curl_easy_setopt(transfer->handle, CURLOPT_SHARE, share);
+    curl_easy_setopt(transfer->handle, CURLOPT_PRIVATE, transfer);
+    auto res = curl_multi_add_handle(multi, transfer->handle);
+    if (res != CURLM_OK) {
+        log_error("Failed to start transfer: {}", curl_multi_strerror(res));
+        transfer->onDone(CURLE_FAILED_INIT);
+        return;
+    }
+    transfer->running = true;
+}
+
+void CurlEngine::stop(CurlTransfer* transfer)
+{
+    if (!transfer->running)
+        return;
+    curl_multi_remove_handle(multi, transfer->handle);
+    transfer->running = false;
+}
+
+void CurlEngine::checkDone()
+{
+    int left;
+    CURLMsg* msg;
+    while ((msg = curl_multi_info_read(multi, &left))) {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        char* transferData;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transferData);
+        auto transfer = reinterpret_cast<CurlTransfer*>(transferData);
+        // msg is gone after removing the handle
+        auto result = msg->data.result;
+        stop(transfer);
+        transfer->onDone(result);
+    }
+}
+
+void CurlEngine::threadProc()
+{
+    std::vector<std::pair<Command, CurlTransfer*>> pending;
+    char drain[64];
+
+    while (true) {
+        unsigned long number;
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            if (shutdownFlag)
+                break;
+            pending.swap(commands);
+            number = queuedCommands;
+        }
+
+        if (!pending.empty()) {
+            for (auto&& [command, transfer] : pending)
+                execute(command, transfer);
+            pending.clear();
+
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            handledCommands = number;
+            processed.notify_all();
+        }
+
+        int runningHandles;
+        curl_multi_perform(multi, &runningHandles);
+        checkDone();
+
+        struct curl_waitfd waitFd {};
+        waitFd.fd = wakeFds[0];
+        waitFd.events = CURL_WAIT_POLLIN;
+        curl_multi_wait(multi, &waitFd, 1, CURL_ENGINE_MAX_WAIT_MS, nullptr);
+        if (waitFd.revents) {
+            while (::read(wakeFds[0], drain, sizeof(drain)) > 0) { }
+        }
+    }
+}
+
+void CurlEngine::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+{
+    static_cast<CurlEngine*>(userptr)->shareMutexes.at(data).lock();
+}
+
+void CurlEngine::unlockShare(CURL*, curl_lock_data data, void* userptr)
+{
+    static_cast<CurlEngine*>(userptr)->shareMutexes.at(data).unlock();
+}
+
+#endif // HAVE_CURL
@@ -0,0 +1,152 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    curl_engine.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file curl_engine.h
+/// \brief Definition of the CurlEngine class.
+
+#ifdef HAVE_CURL
+
+#ifndef __CURL_ENGINE_H__
+#define __CURL_ENGINE_H__
+
+#include <array>
+#include <condition_variable>
+#include <curl/curl.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "util/thread_runner.h"
+
+// forward declaration
+class Config;
+class CurlEngine;
+
+/// \brief a request driven by the CurlEngine
+///
+/// The easy handle is only touched by the engine thread while the transfer
+/// is added to the engine. All callbacks are called by the engine thread.
+class CurlTransfer {
+public:
+    CurlTransfer();
+    virtual ~CurlTransfer();
+
+    CurlTransfer(const CurlTransfer&) = delete;
+    CurlTransfer& operator=(const CurlTransfer&) = delete;
+
+    CURL* getHandle() const { return handle; }
+
+protected:
+    CURL* handle;
+
+    /// \brief called by the engine thread after CurlEngine::wakeup()
+    virtual void onWakeup() = 0;
+    /// \brief the request finished, failed or was aborted by the shutdown of the engine
+    virtual void onDone(CURLcode result) = 0;
+
+private:
+    /// \brief the easy handle is added to the multi handle
+    bool running {};
+
+    friend class CurlEngine;
+};
+
+/// \brief runs all streamed curl requests in a single thread
+///
+/// The requests share one multi handle, so connections to the same server
+/// are kept alive and reused by the next request. DNS lookups, TLS sessions
+/// and connections are also kept in a share, which other easy handles can use.
+class CurlEngine {
+public:
+    explicit CurlEngine(std::shared_ptr<Config> config);
+    ~CurlEngine();
+
+    CurlEngine(const CurlEngine&) = delete;
+    CurlEngine& operator=(const CurlEngine&) = delete;
+
+    /// \brief start the engine thread
+    void run();
+    /// \brief abort all transfers and stop the engine thread
+    void shutdown();
+
+    /// \brief start the request of transfer
+    void add(CurlTransfer* transfer);
+    /// \brief let the engine thread call CurlTransfer::onWakeup()
+    void wakeup(CurlTransfer* transfer);
+    /// \brief stop the request of transfer, no callbacks are called after this returns
+    void remove(CurlTransfer* transfer);
+    /// \brief start the request again with the current options of the easy handle,
+    /// only allowed in callbacks of the transfer
+    void restart(CurlTransfer* transfer);
+
+    /// \brief number of added transfers
+    std::size_t getTransferCount() const;
+
+    /// \brief share with the caches of the engine
+    CURLSH* getShare() const { return share; }
+
+private:
+    enum class Command {
+        Add,
+        Wakeup,
+        Remove,
+    };
+
+    std::shared_ptr<Config> config;
+    CURLM* multi;
+    CURLSH* share;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> shareMutexes;
+    /// \brief self pipe to interrupt curl_multi_wait
+    int wakeFds[2];
+
+    mutable std::mutex mutex;
+    std::condition_variable processed;
+    std::vector<std::pair<Command, CurlTransfer*>> commands;
+    std::set<CurlTransfer*> transfers;
+    /// \brief number of commands queued and handled, remove() waits for its command
+    unsigned long queuedCommands {};
+    unsigned long handledCommands {};
+    bool running {};
+    bool shutdownFlag {};
+
+    std::unique_ptr<StdThreadRunner> threadRunner;
+    void threadProc();
+
+    /// \brief queue a command for the engine thread
+    /// \return number of the command
+    unsigned long queue(Command command, CurlTransfer* transfer);
+    /// \brief execute a command, called by the engine thread or with the mutex held while it is not running
+    void execute(Command command, CurlTransfer* transfer);
+    void start(CurlTransfer* transfer);
+    void stop(CurlTransfer* transfer);
+    /// \brief call onDone() of finished transfers
+    void checkDone();
+
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+};
+
+#endif // __CURL_ENGINE_H__
+
+#endif // HAVE_CURL
@@ -35,8 +35,9 @@
 #include "config/config_manager.h"
 #include "util/tools.h"
 
-CurlIOHandler::CurlIOHandler(std::shared_ptr<Config> config, const std::string& url, CURL* curlHandle, std::size_t bufSize, std::size_t initialFillSize)
+CurlIOHandler::CurlIOHandler(std::shared_ptr<Config> config, std::shared_ptr<CurlEngine> engine, const std::string& url, std::size_t bufSize, std::size_t initialFillSize)
     : IOHandlerBufferHelper(std::move(config), bufSize, initialFillSize)
+    , engine(std::move(engine))
 {
     if (url.empty())
         throw_std_runtime_error("URL has not been set correctly");
@@ -44,49 +45,27 @@ CurlIOHandler::CurlIOHandler(std::shared_ptr<Config> config, const std::string&
         throw_std_runtime_error("bufSize must be at least CURL_MAX_WRITE_SIZE({})", CURL_MAX_WRITE_SIZE);
 
     this->URL = url;
-    this->external_curl_handle = curlHandle;
-    this->curl_handle = curlHandle;
-    // bytesCurl = 0;
-    signalAfterEveryRead = true;
 
-    // still todo:
-    // * optimize seek if data already in buffer
     seekEnabled = true;
 }
 
-void CurlIOHandler::open(enum UpnpOpenFileMode mode)
+CurlIOHandler::~CurlIOHandler()
 {
-    if (!curl_handle) {
-        curl_handle = curl_easy_init();
-        if (!curl_handle)
-            throw_std_runtime_error("failed to init curl");
-    } else
-        curl_easy_reset(curl_handle);
-
-    IOHandlerBufferHelper::open(mode);
+    // the base class can't stop the transfer anymore
+    if (isOpen)
+        close();
 }
 
-void CurlIOHandler::close()
+void CurlIOHandler::startBufferThread()
 {
-    IOHandlerBufferHelper::close();
-
-    if (external_curl_handle && curl_handle)
-        curl_easy_cleanup(curl_handle);
-}
-
-void CurlIOHandler::threadProc()
-{
-    CURLcode res;
-    assert(curl_handle);
     assert(!URL.empty());
 
-    // char error_buffer[CURL_ERROR_SIZE] = {'\0'};
-    // curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, error_buffer);
-
-    curl_easy_setopt(curl_handle, CURLOPT_URL, URL.c_str());
-    curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1);
-    curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1);
-    curl_easy_setopt(curl_handle, CURLOPT_MAXREDIRS, -1);
+    curl_easy_reset(handle);
+    curl_easy_setopt(handle, CURLOPT_URL, URL.c_str());
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
+    curl_easy_setopt(handle, CURLOPT_MAXREDIRS, -1);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1);
 
     bool logEnabled;
 #ifdef TOMBDEBUG
@@ -95,48 +74,90 @@ void CurlIOHandler::threadProc()
     logEnabled = ConfigManager::isDebugLogging();
 #endif
     if (logEnabled)
-        curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 1);
-
-    // curl_easy_setopt(curl_handle, CURLOPT_CONNECTTIMEOUT,
+        curl_easy_setopt(handle, CURLOPT_VERBOSE, 1);
 
-    // proxy..
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, CurlIOHandler::curlCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, static_cast<void*>(this));
 
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, CurlIOHandler::curlCallback);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, static_cast<void*>(this));
+    eof = false;
+    readError = false;
+    paused = false;
+    engine->add(this);
+}
 
-    auto lock = threadRunner->uniqueLock(std::defer_lock);
-    do {
-        lock.lock();
-        if (doSeek) {
-            log_debug("SEEK: {} {}", seekOffset, seekWhence);
+void CurlIOHandler::stopBufferThread()
+{
+    engine->remove(this);
+}
 
-            if (seekWhence == SEEK_SET) {
-                posRead = seekOffset;
-                curl_easy_setopt(curl_handle, CURLOPT_RESUME_FROM_LARGE, seekOffset);
-            } else if (seekWhence == SEEK_CUR) {
-                posRead += seekOffset;
-                curl_easy_setopt(curl_handle, CURLOPT_RESUME_FROM_LARGE, posRead);
-            } else {
-                log_error("CurlIOHandler currently does not support SEEK_END");
-                static_assert(true);
-            }
+void CurlIOHandler::wakeBufferThread()
+{
+    // called by the reader for every read, the engine only has to
+    // do something for a seek or to continue a paused request
+    if (doSeek || paused.exchange(false))
+        engine->wakeup(this);
+}
 
-            /// \todo should we do that?
-            waitForInitialFillSize = (initialFillSize > 0);
+void CurlIOHandler::onWakeup()
+{
+    if (doSeek) {
+        log_debug("SEEK: {} {}", seekOffset, seekWhence);
 
-            doSeek = false;
-            threadRunner->notify();
+        if (seekWhence == SEEK_SET) {
+            posRead = seekOffset;
+        } else if (seekWhence == SEEK_CUR) {
+            posRead += seekOffset;
+        } else {
+            log_error("CurlIOHandler currently does not support SEEK_END");
+            seekDone();
+            return;
         }
-        lock.unlock();
-        res = curl_easy_perform(curl_handle);
-    } while (doSeek);
+        curl_easy_setopt(handle, CURLOPT_RESUME_FROM_LARGE, curl_off_t(posRead));
+        ring->clear();
+
+        /// \todo should we do that?
+        waitForInitialFillSize = (initialFillSize > 0);
+        eof = false;
+        readError = false;
+        paused = false;
+
+        // a new request is needed, even if the old one is finished already
+        engine->restart(this);
+        seekDone();
+        return;
+    }
+
+    curl_easy_pause(handle, CURLPAUSE_CONT);
+}
 
-    if (res != CURLE_OK)
+void CurlIOHandler::onDone(CURLcode result)
+{
+    if (result != CURLE_OK) {
+        log_debug("Request for {} failed: {}", URL, curl_easy_strerror(result));
         readError = true;
-    else
+    } else {
         eof = true;
+    }
+    notifyReader();
+}
+
+bool CurlIOHandler::reserveSpace(std::size_t length)
+{
+    if (ring->space() >= length)
+        return true;
 
-    threadRunner->notify();
+    if (waitForInitialFillSize) {
+        // the initial fill size can't be reached anymore, don't let both sides wait
+        waitForInitialFillSize = false;
+        notifyReader();
+    }
+
+    spaceWanted = length;
+    paused = true;
+    // the reader may have freed the space before seeing spaceWanted,
+    // whoever resets paused continues the request
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return ring->space() >= length && paused.exchange(false);
 }
 
 std::size_t CurlIOHandler::curlCallback(void* ptr, std::size_t size, std::size_t nmemb, void* data)
@@ -145,102 +166,23 @@ std::size_t CurlIOHandler::curlCallback(void* ptr, std::size_t size, std::size_t
     std::size_t wantWrite = size * nmemb;
 
     assert(wantWrite <= ego->bufSize);
-    auto& threadRunner = ego->threadRunner;
 
     // log_debug("URL: {}; size: {}; nmemb: {}; wantWrite: {}", ego->URL.c_str(), size, nmemb, wantWrite);
 
-    auto lock = threadRunner->uniqueLock();
-
-    bool first = true;
-
-    int bufFree;
-    do {
-        if (ego->doSeek && !ego->empty && (ego->seekWhence == SEEK_SET || (ego->seekWhence == SEEK_CUR && ego->seekOffset > 0))) {
-            auto currentFillSize = int(ego->b - ego->a);
-            if (currentFillSize <= 0)
-                currentFillSize += ego->bufSize;
-
-            auto relSeek = int(ego->seekOffset);
-            if (ego->seekWhence == SEEK_SET)
-                relSeek -= ego->posRead;
-
-            if (relSeek <= currentFillSize) { // we have everything we need in the buffer already
-                ego->a += relSeek;
-                ego->posRead += relSeek;
-                if (ego->a >= ego->bufSize)
-                    ego->a -= ego->bufSize;
-                if (ego->a == ego->b) {
-                    ego->empty = true;
-                    ego->a = ego->b = 0;
-                }
-                /// \todo do we need to wait for initialFillSize again?
-
-                ego->doSeek = false;
-                threadRunner->notify();
-            }
-        }
-
-        // note: seeking could be optimized some more (backward seeking)
-        // but this should suffice for now
-
-        if (ego->doSeek) { // seek not been processed yet
-            ego->a = ego->b = 0;
-            ego->empty = true;
-
-            // terminate this request, because we need a new request
-            // after the seek
-            return 0;
-        }
-
-        if (!first) {
-            threadRunner->wait(lock);
-        } else
-            first = false;
-
-        if (ego->threadShutdown)
-            return 0;
-
-        if (ego->empty) {
-            ego->a = ego->b = 0;
-            bufFree = ego->bufSize;
-        } else {
-            bufFree = ego->a - ego->b;
-            if (bufFree < 0)
-                bufFree += ego->bufSize;
-        }
-    } while (std::size_t(bufFree) < wantWrite);
-
-    std::size_t maxWrite = (ego->empty ? ego->bufSize : (ego->a < ego->b ? ego->bufSize - ego->b : ego->a - ego->b));
-    std::size_t write1 = (wantWrite > maxWrite ? maxWrite : wantWrite);
-    std::size_t write2 = (write1 < wantWrite ? wantWrite - write1 : 0);
-
-    std::size_t bLocal = ego->b;
-
-    lock.unlock();
-
-    std::memcpy(ego->buffer + bLocal, ptr, write1);
-    if (write2)
-        std::memcpy(ego->buffer, static_cast<char*>(ptr) + maxWrite, write2);
-
-    lock.lock();
-
-    // ego->bytesCurl += wantWrite;
-    ego->b += wantWrite;
-    if (ego->b >= ego->bufSize)
-        ego->b -= ego->bufSize;
-    if (ego->empty) {
-        ego->empty = false;
-        threadRunner->notify();
-    }
-    if (ego->waitForInitialFillSize) {
-        auto currentFillSize = int(ego->b - ego->a);
-        if (currentFillSize <= 0)
-            currentFillSize += ego->bufSize;
-        if (std::size_t(currentFillSize) >= ego->initialFillSize) {
-            log_debug("buffer: initial fillsize reached");
-            ego->waitForInitialFillSize = false;
-            threadRunner->notify();
-        }
+    // the data is delivered again when the request is continued, seeks inside
+    // of the buffer are handled by the reader, any other seek restarts the request
+    if (ego->doSeek || !ego->reserveSpace(wantWrite))
+        return CURL_WRITEFUNC_PAUSE;
+
+    // the data may wrap around the end of the ring
+    std::size_t written = 0;
+    while (written < wantWrite) {
+        std::size_t maxWrite;
+        char* target = ego->ring->writeArea(maxWrite);
+        std::size_t length = std::min(maxWrite, wantWrite - written);
+        std::memcpy(target, static_cast<const char*>(ptr) + written, length);
+        ego->commitWrite(length);
+        written += length;
     }
 
     return wantWrite;
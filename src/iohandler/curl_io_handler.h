@@ -38,25 +38,36 @@
 #include <upnp.h>
 
 #include "common.h"
+#include "curl_engine.h"
 #include "io_handler_buffer_helper.h"
 
 class Config;
 
-class CurlIOHandler : public IOHandlerBufferHelper {
+/// \brief streams a URL through the shared CurlEngine
+///
+/// There is no buffer thread, the engine thread writes to the buffer and
+/// pauses the request while the buffer is full.
+class CurlIOHandler : public IOHandlerBufferHelper, public CurlTransfer {
 public:
-    CurlIOHandler(std::shared_ptr<Config> config, const std::string& URL, CURL* curlHandle, std::size_t bufSize, std::size_t initialFillSize);
-
-    void open(enum UpnpOpenFileMode mode) override;
-    void close() override;
+    CurlIOHandler(std::shared_ptr<Config> config, std::shared_ptr<CurlEngine> engine, const std::string& URL, std::size_t bufSize, std::size_t initialFillSize);
+    ~CurlIOHandler() override;
 
 private:
-    CURL* curl_handle;
-    bool external_curl_handle;
+    std::shared_ptr<CurlEngine> engine;
     std::string URL;
-    // off_t bytesCurl;
+    /// \brief the request is paused because the buffer is full
+    std::atomic_bool paused {};
 
     static std::size_t curlCallback(void* ptr, std::size_t size, std::size_t nmemb, void* data);
-    void threadProc() override;
+    /// \brief check for free space from the engine thread
+    /// \return false if the request has to be paused
+    bool reserveSpace(std::size_t length);
+
+    void startBufferThread() override;
+    void stopBufferThread() override;
+    void wakeBufferThread() override;
+    void onWakeup() override;
+    void onDone(CURLcode result) override;
 };
 
 #endif // __CURL_IO_HANDLER_H__
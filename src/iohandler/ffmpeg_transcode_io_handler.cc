@@ -0,0 +1,438 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    ffmpeg_transcode_io_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file ffmpeg_transcode_io_handler.cc
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_AVSTREAM_CODECPAR)
+#include "ffmpeg_transcode_io_handler.h" // API
+
+#include <cstring>
+
+extern "C" {
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#ifdef HAVE_SWRESAMPLE
+#include <libswresample/swresample.h>
+#endif
+
+} // extern "C"
+
+#include "transcoding/transcoding.h"
+#include "util/tools.h"
+
+#define FFMPEG_TRANSCODE_IO_BUFFER_SIZE (64 * 1024)
+
+// libavutil 57.24 replaced channels and channel_layout by AVChannelLayout
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 24, 100)
+#define HAVE_AV_CHANNEL_LAYOUT
+#endif
+
+static std::string avError(int err)
+{
+    char buf[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(err, buf, sizeof(buf));
+    return buf;
+}
+
+FfmpegTranscodeIOHandler::FfmpegTranscodeIOHandler(std::shared_ptr<TranscodingProfile> profile, std::string location, double time)
+    : profile(std::move(profile))
+    , location(std::move(location))
+    , time(time)
+{
+}
+
+FfmpegTranscodeIOHandler::~FfmpegTranscodeIOHandler()
+{
+    release();
+}
+
+void FfmpegTranscodeIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    if (mode != UPNP_READ)
+        throw_std_runtime_error("open: UpnpOpenFileMode mode not supported");
+
+    try {
+        packet = av_packet_alloc();
+        frame = av_frame_alloc();
+        if (!packet || !frame)
+            throw_std_runtime_error("Failed to allocate buffers for {}", location);
+
+        openInput();
+        openOutput();
+    } catch (const std::runtime_error&) {
+        release();
+        throw;
+    }
+    log_debug("Transcoding {} to {} in process", location, profile->getFormat());
+}
+
+void FfmpegTranscodeIOHandler::openInput()
+{
+#if (LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(58, 9, 100))
+    // Register all formats and codecs
+    av_register_all();
+#endif
+    int ret = avformat_open_input(&input, location.c_str(), nullptr, nullptr);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to open {}: {}", location, avError(ret));
+
+    ret = avformat_find_stream_info(input, nullptr);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to find streams of {}: {}", location, avError(ret));
+
+    if (time > 0) {
+        auto ts = static_cast<int64_t>(time * AV_TIME_BASE);
+        if (input->start_time != AV_NOPTS_VALUE)
+            ts += input->start_time;
+        // the output starts at the key frame before the requested time
+        ret = avformat_seek_file(input, -1, INT64_MIN, ts, ts, 0);
+        if (ret < 0)
+            throw_std_runtime_error("Failed to seek {} to {}s: {}", location, time, avError(ret));
+    }
+}
+
+void FfmpegTranscodeIOHandler::openOutput()
+{
+    auto format = profile->getFormat();
+    int ret = avformat_alloc_output_context2(&output, nullptr, format.c_str(), nullptr);
+    if (ret < 0 || !output)
+        throw_std_runtime_error("Unknown format '{}' in transcoding profile {}", format, profile->getName());
+
+    auto videoIndex = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    auto audioIndex = av_find_best_stream(input, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    for (auto index : { videoIndex, audioIndex }) {
+        if (index < 0)
+            continue;
+
+        auto source = input->streams[index];
+        if (index == audioIndex && profile->getAudioCodec() != "copy") {
+            addConvertedStream(index, source);
+            continue;
+        }
+        // cover art of audio files is not a video
+        if (source->disposition & AV_DISPOSITION_ATTACHED_PIC)
+            continue;
+        if (avformat_query_codec(output->oformat, source->codecpar->codec_id, FF_COMPLIANCE_NORMAL) == 0) {
+            log_debug("Format {} can not carry stream {} of {}", format, index, location);
+            continue;
+        }
+
+        auto stream = avformat_new_stream(output, nullptr);
+        if (!stream)
+            throw_std_runtime_error("Failed to add stream to {}", format);
+        ret = avcodec_parameters_copy(stream->codecpar, source->codecpar);
+        if (ret < 0)
+            throw_std_runtime_error("Failed to copy stream {} of {}: {}", index, location, avError(ret));
+        // the tag of the source container may be invalid in the target
+        stream->codecpar->codec_tag = 0;
+        stream->time_base = source->time_base;
+        streams[index].stream = stream;
+    }
+    if (streams.empty())
+        throw_std_runtime_error("No stream of {} can be stored as {}", location, format);
+
+    auto buffer = static_cast<unsigned char*>(av_malloc(FFMPEG_TRANSCODE_IO_BUFFER_SIZE));
+    if (!buffer)
+        throw_std_runtime_error("Failed to allocate output buffer for {}", location);
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+    auto writer = &writeMuxed;
+#else
+    auto writer = [](void* opaque, uint8_t* buf, int size) { return writeMuxed(opaque, buf, size); };
+#endif
+    output->pb = avio_alloc_context(buffer, FFMPEG_TRANSCODE_IO_BUFFER_SIZE, 1, this, nullptr, writer, nullptr);
+    if (!output->pb) {
+        av_free(buffer);
+        throw_std_runtime_error("Failed to allocate output context for {}", location);
+    }
+    output->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    ret = avformat_write_header(output, nullptr);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to start {} output for {}: {}", format, location, avError(ret));
+}
+
+void FfmpegTranscodeIOHandler::addConvertedStream(int index, const AVStream* source)
+{
+#ifdef HAVE_SWRESAMPLE
+    auto codecName = profile->getAudioCodec();
+    const AVCodec* encoderCodec = avcodec_find_encoder_by_name(codecName.c_str());
+    if (!encoderCodec || encoderCodec->type != AVMEDIA_TYPE_AUDIO)
+        throw_std_runtime_error("Unknown audio encoder '{}' in transcoding profile {}", codecName, profile->getName());
+    const AVCodec* decoderCodec = avcodec_find_decoder(source->codecpar->codec_id);
+    if (!decoderCodec)
+        throw_std_runtime_error("No decoder for the audio of {}", location);
+
+    // registered first, so release() frees a partial setup
+    auto& out = streams[index];
+    out.decoder = avcodec_alloc_context3(decoderCodec);
+    out.encoder = avcodec_alloc_context3(encoderCodec);
+    if (!out.decoder || !out.encoder)
+        throw_std_runtime_error("Failed to allocate audio codecs for {}", location);
+
+    auto dec = out.decoder;
+    int ret = avcodec_parameters_to_context(dec, source->codecpar);
+    if (ret >= 0) {
+        dec->pkt_timebase = source->time_base;
+        ret = avcodec_open2(dec, decoderCodec, nullptr);
+    }
+    if (ret < 0)
+        throw_std_runtime_error("Failed to open audio decoder for {}: {}", location, avError(ret));
+
+    auto enc = out.encoder;
+    enc->sample_rate = profile->getSampleFreq() > 0 ? profile->getSampleFreq() : dec->sample_rate;
+    enc->sample_fmt = encoderCodec->sample_fmts ? encoderCodec->sample_fmts[0] : dec->sample_fmt;
+    enc->time_base = AVRational { 1, enc->sample_rate };
+#ifdef HAVE_AV_CHANNEL_LAYOUT
+    av_channel_layout_default(&enc->ch_layout, profile->getNumChannels() > 0 ? profile->getNumChannels() : dec->ch_layout.nb_channels);
+#else
+    enc->channels = profile->getNumChannels() > 0 ? profile->getNumChannels() : dec->channels;
+    enc->channel_layout = av_get_default_channel_layout(enc->channels);
+#endif
+    if (output->oformat->flags & AVFMT_GLOBALHEADER)
+        enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    ret = avcodec_open2(enc, encoderCodec, nullptr);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to open audio encoder {}: {}", codecName, avError(ret));
+    // encoders with a fixed frame size would need a sample queue
+    if (enc->frame_size > 0 && !(encoderCodec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE))
+        throw_std_runtime_error("Audio encoder {} needs fixed frame sizes, use an external profile instead", codecName);
+
+    out.stream = avformat_new_stream(output, nullptr);
+    if (!out.stream)
+        throw_std_runtime_error("Failed to add stream to {}", profile->getFormat());
+    ret = avcodec_parameters_from_context(out.stream->codecpar, enc);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to set audio parameters for {}: {}", location, avError(ret));
+    out.stream->time_base = enc->time_base;
+
+#ifdef HAVE_AV_CHANNEL_LAYOUT
+    AVChannelLayout inLayout;
+    if (dec->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+        av_channel_layout_default(&inLayout, dec->ch_layout.nb_channels);
+    else
+        av_channel_layout_copy(&inLayout, &dec->ch_layout);
+    ret = swr_alloc_set_opts2(&out.resampler, &enc->ch_layout, enc->sample_fmt, enc->sample_rate, &inLayout, dec->sample_fmt, dec->sample_rate, 0, nullptr);
+    av_channel_layout_uninit(&inLayout);
+#else
+    auto inLayout = dec->channel_layout ? dec->channel_layout : av_get_default_channel_layout(dec->channels);
+    out.resampler = swr_alloc_set_opts(nullptr, enc->channel_layout, enc->sample_fmt, enc->sample_rate, inLayout, dec->sample_fmt, dec->sample_rate, 0, nullptr);
+    ret = out.resampler ? 0 : AVERROR(ENOMEM);
+#endif
+    if (ret >= 0)
+        ret = swr_init(out.resampler);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to set up audio conversion for {}: {}", location, avError(ret));
+#else
+    throw_std_runtime_error("Compiled without libswresample, transcoding profile {} can only copy the audio", profile->getName());
+#endif
+}
+
+bool FfmpegTranscodeIOHandler::processPacket()
+{
+    int ret = av_read_frame(input, packet);
+    if (ret == AVERROR_EOF)
+        return false;
+    if (ret < 0)
+        throw_std_runtime_error("Failed to read {}: {}", location, avError(ret));
+
+    auto it = streams.find(packet->stream_index);
+    if (it != streams.end()) {
+        if (it->second.encoder)
+            decodePacket(it->second, packet);
+        else
+            writePacket(it->second, packet, input->streams[packet->stream_index]->time_base);
+    }
+    av_packet_unref(packet);
+    return true;
+}
+
+void FfmpegTranscodeIOHandler::decodePacket(OutputStream& out, const AVPacket* pkt)
+{
+    int ret = avcodec_send_packet(out.decoder, pkt);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        // a broken packet only causes a short gap
+        log_warning("Failed to decode audio of {}: {}", location, avError(ret));
+        return;
+    }
+    while (avcodec_receive_frame(out.decoder, frame) >= 0) {
+        convertFrame(out, frame);
+        av_frame_unref(frame);
+    }
+}
+
+void FfmpegTranscodeIOHandler::convertFrame(OutputStream& out, const AVFrame* source)
+{
+#ifdef HAVE_SWRESAMPLE
+    auto enc = out.encoder;
+    if (out.nextPts < 0) {
+        // nothing decoded, nothing to drain
+        if (!source)
+            return;
+        auto pts = source->best_effort_timestamp;
+        out.nextPts = (pts == AV_NOPTS_VALUE) ? 0 : av_rescale_q(pts, out.decoder->pkt_timebase, enc->time_base);
+    }
+
+    auto converted = std::unique_ptr<AVFrame, void (*)(AVFrame*)>(av_frame_alloc(), [](AVFrame* f) { av_frame_free(&f); });
+    if (!converted)
+        throw_std_runtime_error("Failed to allocate audio frame for {}", location);
+    // the resampler may hold back samples, so the output can be larger than the input
+    int inSamples = source ? source->nb_samples : 0;
+    converted->nb_samples = swr_get_out_samples(out.resampler, inSamples);
+    if (converted->nb_samples <= 0)
+        return;
+    converted->format = enc->sample_fmt;
+    converted->sample_rate = enc->sample_rate;
+#ifdef HAVE_AV_CHANNEL_LAYOUT
+    av_channel_layout_copy(&converted->ch_layout, &enc->ch_layout);
+#else
+    converted->channel_layout = enc->channel_layout;
+    converted->channels = enc->channels;
+#endif
+    int ret = av_frame_get_buffer(converted.get(), 0);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to allocate audio samples for {}: {}", location, avError(ret));
+
+    ret = swr_convert(out.resampler, converted->data, converted->nb_samples,
+        source ? reinterpret_cast<const uint8_t**>(source->extended_data) : nullptr, inSamples);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to convert audio of {}: {}", location, avError(ret));
+    if (ret == 0)
+        return;
+
+    converted->nb_samples = ret;
+    converted->pts = out.nextPts;
+    out.nextPts += ret;
+    encodeFrame(out, converted.get());
+#endif
+}
+
+void FfmpegTranscodeIOHandler::encodeFrame(OutputStream& out, const AVFrame* converted)
+{
+    int ret = avcodec_send_frame(out.encoder, converted);
+    if (ret < 0 && ret != AVERROR_EOF)
+        throw_std_runtime_error("Failed to encode audio of {}: {}", location, avError(ret));
+
+    auto encoded = std::unique_ptr<AVPacket, void (*)(AVPacket*)>(av_packet_alloc(), [](AVPacket* p) { av_packet_free(&p); });
+    if (!encoded)
+        throw_std_runtime_error("Failed to allocate audio packet for {}", location);
+    while (avcodec_receive_packet(out.encoder, encoded.get()) >= 0)
+        writePacket(out, encoded.get(), out.encoder->time_base);
+}
+
+void FfmpegTranscodeIOHandler::writePacket(const OutputStream& out, AVPacket* pkt, AVRational timeBase)
+{
+    // the muxer may have changed the time base when writing the header
+    av_packet_rescale_ts(pkt, timeBase, out.stream->time_base);
+    pkt->stream_index = out.stream->index;
+    pkt->pos = -1;
+    int ret = av_interleaved_write_frame(output, pkt);
+    if (ret < 0)
+        throw_std_runtime_error("Failed to write {} output for {}: {}", profile->getFormat(), location, avError(ret));
+}
+
+void FfmpegTranscodeIOHandler::finish()
+{
+    for (auto&& [index, out] : streams) {
+        if (!out.encoder)
+            continue;
+        decodePacket(out, nullptr);
+        convertFrame(out, nullptr);
+        encodeFrame(out, nullptr);
+    }
+
+    int ret = av_write_trailer(output);
+    if (ret < 0)
+        log_warning("Failed to finish {} output for {}: {}", profile->getFormat(), location, avError(ret));
+    avio_flush(output->pb);
+    finished = true;
+}
+
+int FfmpegTranscodeIOHandler::writeMuxed(void* opaque, const unsigned char* buf, int size)
+{
+    auto self = static_cast<FfmpegTranscodeIOHandler*>(opaque);
+    self->muxed.append(reinterpret_cast<const char*>(buf), size);
+    return size;
+}
+
+std::size_t FfmpegTranscodeIOHandler::read(char* buf, std::size_t length)
+{
+    try {
+        while (muxedPos == muxed.size() && !finished) {
+            muxed.clear();
+            muxedPos = 0;
+            if (!processPacket()) {
+                finish();
+                break;
+            }
+            // hand out data as soon as the muxer produced it
+            avio_flush(output->pb);
+        }
+    } catch (const std::runtime_error& e) {
+        log_error("{}", e.what());
+        return -1;
+    }
+
+    auto count = std::min(length, muxed.size() - muxedPos);
+    std::memcpy(buf, muxed.data() + muxedPos, count);
+    muxedPos += count;
+    return count;
+}
+
+void FfmpegTranscodeIOHandler::close()
+{
+    release();
+}
+
+void FfmpegTranscodeIOHandler::release()
+{
+    for (auto&& [index, out] : streams) {
+        avcodec_free_context(&out.decoder);
+        avcodec_free_context(&out.encoder);
+#ifdef HAVE_SWRESAMPLE
+        swr_free(&out.resampler);
+#endif
+    }
+    streams.clear();
+
+    if (output) {
+        if (output->pb) {
+            av_freep(&output->pb->buffer);
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(57, 80, 100)
+            avio_context_free(&output->pb);
+#else
+            av_freep(&output->pb);
+#endif
+        }
+        avformat_free_context(output);
+        output = nullptr;
+    }
+    if (input)
+        avformat_close_input(&input);
+
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+}
+
+#endif // HAVE_FFMPEG
@@ -0,0 +1,114 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    ffmpeg_transcode_io_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file ffmpeg_transcode_io_handler.h
+/// \brief Definition of the FfmpegTranscodeIOHandler class.
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_AVSTREAM_CODECPAR)
+#ifndef __FFMPEG_TRANSCODE_IO_HANDLER_H__
+#define __FFMPEG_TRANSCODE_IO_HANDLER_H__
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "io_handler.h"
+
+// forward declaration
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVRational;
+struct AVStream;
+struct SwrContext;
+class TranscodingProfile;
+
+/// \brief Allows the web server to read media remuxed by libavformat.
+///
+/// Packets are read from the source and written to the muxer of the
+/// profile on demand, so no thread or process is needed. The audio stream
+/// can be converted to another encoder, e.g. LPCM, with sample rate and
+/// channels of the profile. All other streams are copied if the target
+/// format supports them.
+class FfmpegTranscodeIOHandler : public IOHandler {
+public:
+    /// \param location source file or URL
+    /// \param time start time of the output in seconds
+    FfmpegTranscodeIOHandler(std::shared_ptr<TranscodingProfile> profile, std::string location, double time = 0);
+    ~FfmpegTranscodeIOHandler() override;
+
+    FfmpegTranscodeIOHandler(const FfmpegTranscodeIOHandler&) = delete;
+    FfmpegTranscodeIOHandler& operator=(const FfmpegTranscodeIOHandler&) = delete;
+
+    void open(enum UpnpOpenFileMode mode) override;
+    std::size_t read(char* buf, std::size_t length) override;
+    void close() override;
+
+private:
+    /// \brief mapping of one source stream to the output
+    struct OutputStream {
+        AVStream* stream {};
+        AVCodecContext* decoder {};
+        AVCodecContext* encoder {};
+        SwrContext* resampler {};
+        /// \brief timestamp of the next converted sample in encoder time base
+        long long nextPts { -1 };
+    };
+
+    std::shared_ptr<TranscodingProfile> profile;
+    std::string location;
+    double time;
+
+    AVFormatContext* input {};
+    AVFormatContext* output {};
+    AVPacket* packet {};
+    AVFrame* frame {};
+    std::map<int, OutputStream> streams;
+
+    /// \brief muxed data not read by the web server yet
+    std::string muxed;
+    std::size_t muxedPos {};
+    bool finished {};
+
+    void openInput();
+    void openOutput();
+    void addConvertedStream(int index, const AVStream* source);
+    /// \brief process the next source packet
+    /// \return false at the end of the source
+    bool processPacket();
+    /// \brief decode an audio packet, nullptr drains the decoder
+    void decodePacket(OutputStream& out, const AVPacket* pkt);
+    /// \brief resample a decoded frame, nullptr drains the resampler
+    void convertFrame(OutputStream& out, const AVFrame* source);
+    /// \brief encode a converted frame, nullptr drains the encoder
+    void encodeFrame(OutputStream& out, const AVFrame* converted);
+    void writePacket(const OutputStream& out, AVPacket* pkt, AVRational timeBase);
+    void finish();
+    void release();
+
+    static int writeMuxed(void* opaque, const unsigned char* buf, int size);
+};
+
+#endif // __FFMPEG_TRANSCODE_IO_HANDLER_H__
+#endif // HAVE_FFMPEG
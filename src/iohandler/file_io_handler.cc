@@ -32,6 +32,7 @@
 #include "file_io_handler.h" // API
 
 #include "cds_objects.h"
+#include "util/metrics.h"
 
 FileIOHandler::FileIOHandler(fs::path filename)
     : file(std::move(filename))
@@ -53,6 +54,7 @@ void FileIOHandler::open(enum UpnpOpenFileMode mode)
 
 std::size_t FileIOHandler::read(char* buf, std::size_t length)
 {
+    static auto&& readCounter = Metrics::getInstance()->counter("gerbera_io_read_bytes_total", "Bytes read by IO handlers", R"(handler="file")");
     std::size_t ret = std::fread(buf, sizeof(char), length, f);
 
     if (ret == 0) {
@@ -62,6 +64,7 @@ std::size_t FileIOHandler::read(char* buf, std::size_t length)
             return -1;
     }
 
+    readCounter.inc(ret);
     return ret;
 }
 
@@ -32,6 +32,7 @@
 #include "io_handler_buffer_helper.h" // API
 
 #include "config/config_manager.h"
+#include "util/metrics.h"
 
 IOHandlerBufferHelper::IOHandlerBufferHelper(std::shared_ptr<Config> config, std::size_t bufSize, std::size_t initialFillSize)
     : config(std::move(config))
@@ -50,7 +51,7 @@ void IOHandlerBufferHelper::open(enum UpnpOpenFileMode mode)
     if (isOpen)
         throw_std_runtime_error("tried to reopen an open IOHandlerBufferHelper");
 
-    buffer = new char[bufSize];
+    ring = std::make_unique<SpscRingBuffer>(bufSize);
     startBufferThread();
     isOpen = true;
 }
@@ -63,65 +64,42 @@ IOHandlerBufferHelper::~IOHandlerBufferHelper() noexcept
 
 std::size_t IOHandlerBufferHelper::read(char* buf, std::size_t length)
 {
+    static auto&& readCounter = Metrics::getInstance()->counter("gerbera_io_read_bytes_total", "Bytes read by IO handlers", R"(handler="buffered")");
     // check read on closed BufferedIOHandler
     assert(isOpen);
     // length must be positive
     assert(length > 0);
 
-    auto lock = threadRunner->uniqueLock();
-
-    while ((empty || waitForInitialFillSize) && !(threadShutdown || eof || readError)) {
-        if (checkSocket) {
-            checkSocket = false;
+    auto ready = [this]() {
+        return (!waitForInitialFillSize && ring->size() > 0) || threadShutdown || threadFinished || eof || readError;
+    };
+    while (!ready()) {
+        if (checkSocket.exchange(false))
             return CHECK_SOCKET;
+        auto key = dataEvent.prepareWait();
+        if (ready() || checkSocket) {
+            dataEvent.cancelWait();
+            continue;
         }
-        threadRunner->wait(lock);
+        dataEvent.wait(key);
     }
 
     if (readError || threadShutdown)
         return -1;
-    if (empty && eof)
-        return 0;
 
-    std::size_t bLocal = b;
-    lock.unlock();
-
-    // we ensured with the while above that the buffer isn't empty
-    auto currentFillSize = int(bLocal - a);
-    if (currentFillSize <= 0)
-        currentFillSize += bufSize;
-    auto maxRead1 = std::size_t(a < bLocal ? bLocal - a : bufSize - a);
-    auto read1 = std::size_t(maxRead1 > length ? length : maxRead1);
-    auto maxRead2 = std::size_t(currentFillSize - read1);
-    auto read2 = std::size_t(read1 < length ? length - read1 : 0);
-    if (read2 > maxRead2)
-        read2 = maxRead2;
-
-    std::memcpy(buf, buffer + a, read1);
-    if (read2)
-        std::memcpy(buf + read1, buffer, read2);
-
-    std::size_t didRead = read1 + read2;
-
-    lock.lock();
-
-    bool signalled = false;
-    // was the buffer full or became it "full" while we read?
-    if (signalAfterEveryRead || a == b) {
-        threadRunner->notify();
-        signalled = true;
-    }
+    // eof is only set after the last write, so an empty ring here means end of stream
+    std::size_t didRead = ring->read(buf, length);
+    if (didRead == 0)
+        return 0;
 
-    a += didRead;
-    if (a >= bufSize)
-        a -= bufSize;
-    if (a == b) {
-        empty = true;
-        if (!signalled)
-            threadRunner->notify();
-    }
+    // only wake the buffer thread if it waits and can write enough now,
+    // the fence makes it see our read position if we see an old spaceWanted
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring->space() >= spaceWanted)
+        wakeBufferThread();
 
     posRead += didRead;
+    readCounter.inc(didRead);
     return didRead;
 }
 
@@ -142,21 +120,41 @@ void IOHandlerBufferHelper::seek(off_t offset, int whence)
     if (whence == SEEK_CUR && offset == 0)
         return;
 
-    auto lock = threadRunner->uniqueLock();
+    if (whence != SEEK_END) {
+        auto relSeek = (whence == SEEK_SET) ? offset - posRead : offset;
+        if (relSeek >= 0 && std::size_t(relSeek) <= ring->size()) {
+            // we have everything we need in the buffer already
+            ring->skip(relSeek);
+            posRead += relSeek;
+            wakeBufferThread();
+            return;
+        }
+    }
 
+    requestSeek(offset, whence);
+}
+
+void IOHandlerBufferHelper::requestSeek(off_t offset, int whence)
+{
     // if another seek isn't processed yet - well we don't care as this new seek
     // will change the position anyway
-    doSeek = true;
     seekOffset = offset;
     seekWhence = whence;
+    doSeek = true;
 
     // tell the probably sleeping thread to process our seek
-    threadRunner->notify();
+    wakeBufferThread();
 
     // wait until the seek has been processed
-    threadRunner->wait(lock, [&]() {
-        return !doSeek || threadShutdown || eof || readError;
-    });
+    auto processed = [this]() { return !doSeek || threadShutdown || threadFinished || readError; };
+    while (!processed()) {
+        auto key = dataEvent.prepareWait();
+        if (processed()) {
+            dataEvent.cancelWait();
+            break;
+        }
+        dataEvent.wait(key);
+    }
 }
 
 void IOHandlerBufferHelper::close()
@@ -165,18 +163,91 @@ void IOHandlerBufferHelper::close()
         log_error("close called on closed IOHandlerBufferHelper");
     isOpen = false;
     stopBufferThread();
-    delete[] buffer;
-    buffer = nullptr;
+    ring = nullptr;
+}
+
+// buffer thread side
+
+void IOHandlerBufferHelper::wakeBufferThread()
+{
+    spaceEvent.notify();
+}
+
+bool IOHandlerBufferHelper::waitForSpace(std::size_t length)
+{
+    while (!(threadShutdown || doSeek)) {
+        if (ring->space() >= length)
+            return true;
+        spaceWanted = length;
+        auto key = spaceEvent.prepareWait();
+        if (threadShutdown || doSeek || ring->space() >= length) {
+            spaceEvent.cancelWait();
+            continue;
+        }
+        spaceEvent.wait(key);
+    }
+    return false;
+}
+
+std::size_t IOHandlerBufferHelper::getRefillSize(std::size_t chunkSize) const
+{
+    // the initial fill size has to be reached without any reads
+    if (waitForInitialFillSize)
+        return 1;
+    return std::max<std::size_t>(1, std::min(chunkSize, bufSize / 2));
+}
+
+void IOHandlerBufferHelper::waitForRequest()
+{
+    while (!(threadShutdown || doSeek)) {
+        auto key = spaceEvent.prepareWait();
+        if (threadShutdown || doSeek) {
+            spaceEvent.cancelWait();
+            break;
+        }
+        spaceEvent.wait(key);
+    }
+}
+
+void IOHandlerBufferHelper::commitWrite(std::size_t length)
+{
+    ring->commit(length);
+    if (waitForInitialFillSize) {
+        if (ring->size() < initialFillSize)
+            return;
+        log_debug("buffer: initial fillsize reached");
+        waitForInitialFillSize = false;
+    }
+    // only wakes the reader if it waits for data
+    dataEvent.notify();
+}
+
+void IOHandlerBufferHelper::seekDone()
+{
+    doSeek = false;
+    dataEvent.notify();
 }
 
 // thread stuff...
 
 void IOHandlerBufferHelper::startBufferThread()
 {
+    threadShutdown = false;
+    threadFinished = false;
+
+    // the thread starts inside the constructor of ThreadRunner,
+    // keep it from using threadRunner before it is assigned
+    auto lock = std::lock_guard<std::mutex>(startMutex);
     threadRunner = std::make_unique<StdThreadRunner>(
         "BufferHelperThread", [](void* arg) -> void* {
             auto inst = static_cast<IOHandlerBufferHelper*>(arg);
+            {
+                auto startLock = std::lock_guard<std::mutex>(inst->startMutex);
+            }
             inst->threadProc();
+            // ensure that read() and seek() don't wait for me anymore
+            inst->threadFinished = true;
+            inst->dataEvent.notify();
             return nullptr;
         },
         this, config);
@@ -184,10 +255,8 @@ void IOHandlerBufferHelper::startBufferThread()
 
 void IOHandlerBufferHelper::stopBufferThread()
 {
-    auto lock = threadRunner->uniqueLock();
     threadShutdown = true;
-    threadRunner->notify();
-    lock.unlock();
+    spaceEvent.notify();
 
     threadRunner->join();
     threadRunner = nullptr;
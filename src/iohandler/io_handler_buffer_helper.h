@@ -32,10 +32,12 @@
 #ifndef __IO_HANDLER_BUFFER_HELPER_H__
 #define __IO_HANDLER_BUFFER_HELPER_H__
 
+#include <atomic>
 #include <upnp.h>
 
 #include "common.h"
 #include "io_handler.h"
+#include "util/ring_buffer.h"
 #include "util/thread_runner.h"
 
 class Config;
@@ -43,11 +45,14 @@ class Config;
 /// \brief a IOHandler with buffer support
 /// the buffer is only for read(). write() is not supported
 /// the public functions of this class are *not* thread safe!
+///
+/// The buffer is a lock free ring shared by exactly two threads: the thread
+/// calling read() and the buffer thread running threadProc(). Either side only
+/// sleeps if the ring is empty or full, all other state is passed with atomics.
 class IOHandlerBufferHelper : public IOHandler {
 public:
     /// \brief get an instance of a IOHandlerBufferHelper
     /// \param bufSize the size of the buffer in bytes
-    /// \param maxChunkSize the maximum size of the chunks which are read by the buffer
     /// \param initialFillSize the number of bytes which have to be in the buffer
     /// before the first read at the very beginning or after a seek returns;
     /// 0 disables the delay
@@ -67,33 +72,64 @@ protected:
     std::shared_ptr<Config> config;
     std::size_t bufSize;
     std::size_t initialFillSize;
-    char* buffer {};
+    std::unique_ptr<SpscRingBuffer> ring;
     bool isOpen {};
-    bool eof {};
-    bool readError {};
-    bool waitForInitialFillSize;
-    bool signalAfterEveryRead {};
-    bool checkSocket {};
-
-    // buffer stuff..
-    bool empty { true };
-    std::size_t a {};
-    std::size_t b {};
+    std::atomic_bool eof {};
+    std::atomic_bool readError {};
+    std::atomic_bool waitForInitialFillSize;
+    std::atomic_bool checkSocket {};
+
+    /// \brief position of the reader, only changed by the buffer thread while a seek is processed
     off_t posRead {};
 
     // seek stuff...
     bool seekEnabled {};
-    bool doSeek {};
+    std::atomic_bool doSeek {};
     off_t seekOffset {};
     int seekWhence {};
 
+    /// \brief hand the seek to the buffer thread and wait until it is processed
+    void requestSeek(off_t offset, int whence);
+
+    // buffer thread side
+    /// \brief wait until length bytes can be written to the buffer
+    /// \return false if woken up by a seek request or shutdown
+    bool waitForSpace(std::size_t length);
+    /// \brief amount of free space worth waking up the buffer thread for,
+    /// refilling a full buffer after every small read would cost a wakeup per read
+    std::size_t getRefillSize(std::size_t chunkSize) const;
+    /// \brief wait until a seek request or shutdown
+    void waitForRequest();
+    /// \brief publish length bytes written to the buffer
+    void commitWrite(std::size_t length);
+    /// \brief mark the seek request as processed
+    void seekDone();
+    /// \brief wake up read() after setting eof, readError or checkSocket
+    void notifyReader() { dataEvent.notify(); }
+    /// \brief tell the buffer side about free space or a seek request
+    virtual void wakeBufferThread();
+
+    /// \brief free space the waiting buffer side needs
+    std::atomic_size_t spaceWanted {};
+
     // thread stuff..
-    void startBufferThread();
-    void stopBufferThread();
-    virtual void threadProc() = 0;
+    /// \brief start filling the buffer, runs threadProc() in a new thread by default
+    virtual void startBufferThread();
+    /// \brief stop filling the buffer, the buffer is not touched anymore afterwards
+    virtual void stopBufferThread();
+    /// \brief fill the buffer, not needed if startBufferThread() is overridden
+    virtual void threadProc() { }
 
     std::unique_ptr<StdThreadRunner> threadRunner;
-    bool threadShutdown {};
+    std::mutex startMutex;
+    std::atomic_bool threadShutdown {};
+    std::atomic_bool threadFinished {};
+
+private:
+    /// \brief read() waits here for data
+    EventCount dataEvent;
+    /// \brief the buffer thread waits here for space or requests
+    EventCount spaceEvent;
 };
 
 #endif // __IO_HANDLER_BUFFER_HELPER_H__
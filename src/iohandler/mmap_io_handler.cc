@@ -0,0 +1,195 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    mmap_io_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file mmap_io_handler.cc
+
+#include "mmap_io_handler.h" // API
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "config/config.h"
+#include "file_io_handler.h"
+#include "util/metrics.h"
+
+MappedFile::MappedFile(const fs::path& path, std::size_t size)
+    : length(size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw_std_runtime_error("Failed to open {}: {}", path.c_str(), std::strerror(errno));
+
+    addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    auto err = errno;
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        throw_std_runtime_error("Failed to map {}: {}", path.c_str(), std::strerror(err));
+
+#ifdef MADV_WILLNEED
+    // small files are always served completely
+    madvise(addr, length, MADV_WILLNEED);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    munmap(addr, length);
+}
+
+MappedFileCache::MappedFileCache(std::size_t maxFileSize, std::size_t maxCacheSize)
+    : maxFileSize(maxFileSize)
+    , maxCacheSize(maxCacheSize)
+{
+}
+
+std::shared_ptr<MappedFile> MappedFileCache::get(const fs::path& path, const struct stat& statbuf)
+{
+    auto size = std::size_t(statbuf.st_size);
+    // mmap does not support empty files
+    if (!S_ISREG(statbuf.st_mode) || size == 0 || size > maxFileSize || size > maxCacheSize)
+        return nullptr;
+
+    auto key = path.string();
+    auto lock = std::lock_guard<std::mutex>(mutex);
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        if (it->second.mtime == statbuf.st_mtime && it->second.file->size() == size) {
+            lru.splice(lru.begin(), lru, it->second.lruPos);
+            return it->second.file;
+        }
+        // file changed on disk
+        erase(it);
+    }
+
+    std::shared_ptr<MappedFile> file;
+    try {
+        file = std::make_shared<MappedFile>(path, size);
+    } catch (const std::runtime_error& e) {
+        log_warning("{}", e.what());
+        return nullptr;
+    }
+
+    while (cacheSize + size > maxCacheSize && !lru.empty())
+        erase(entries.find(lru.back()));
+
+    lru.push_front(key);
+    entries[key] = Entry { file, statbuf.st_mtime, lru.begin() };
+    cacheSize += size;
+    return file;
+}
+
+void MappedFileCache::erase(std::unordered_map<std::string, Entry>::iterator it)
+{
+    cacheSize -= it->second.file->size();
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+}
+
+std::size_t MappedFileCache::getCacheSize() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return cacheSize;
+}
+
+std::size_t MappedFileCache::getEntryCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return entries.size();
+}
+
+std::unique_ptr<MappedFileCache> MmapIOHandler::cache;
+std::once_flag MmapIOHandler::cacheInit;
+
+std::unique_ptr<IOHandler> MmapIOHandler::createHandler(const std::shared_ptr<Config>& config, const fs::path& path, const struct stat& statbuf)
+{
+    if (config->getBoolOption(CFG_SERVER_EXTOPTS_MAPPED_FILES_ENABLED)) {
+        std::call_once(cacheInit, [&config]() {
+            cache = std::make_unique<MappedFileCache>(
+                config->getIntOption(CFG_SERVER_EXTOPTS_MAPPED_FILES_MAX_FILE_SIZE),
+                config->getIntOption(CFG_SERVER_EXTOPTS_MAPPED_FILES_CACHE_SIZE));
+        });
+        auto file = cache->get(path, statbuf);
+        if (file)
+            return std::make_unique<MmapIOHandler>(std::move(file));
+    }
+    return std::make_unique<FileIOHandler>(path);
+}
+
+MmapIOHandler::MmapIOHandler(std::shared_ptr<MappedFile> file)
+    : file(std::move(file))
+{
+}
+
+void MmapIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    if (mode != UPNP_READ)
+        throw_std_runtime_error("open: UpnpOpenFileMode mode not supported");
+    pos = 0;
+}
+
+std::size_t MmapIOHandler::read(char* buf, std::size_t length)
+{
+    static auto&& readCounter = Metrics::getInstance()->counter("gerbera_io_read_bytes_total", "Bytes read by IO handlers", R"(handler="mmap")");
+    auto rest = file->size() - std::size_t(pos);
+    if (length > rest)
+        length = rest;
+
+    std::memcpy(buf, file->data() + pos, length);
+    pos += length;
+    readCounter.inc(length);
+    return length;
+}
+
+void MmapIOHandler::seek(off_t offset, int whence)
+{
+    off_t target;
+    if (whence == SEEK_SET)
+        target = offset;
+    else if (whence == SEEK_CUR)
+        target = pos + offset;
+    else if (whence == SEEK_END)
+        target = off_t(file->size()) + offset;
+    else
+        throw_std_runtime_error("seek failed: unrecognized whence");
+
+    if (target < 0)
+        throw_std_runtime_error("seek failed: trying to seek before the beginning of file");
+    if (target > off_t(file->size()))
+        throw_std_runtime_error("seek failed: trying to seek past end of file");
+
+    pos = target;
+}
+
+off_t MmapIOHandler::tell()
+{
+    return pos;
+}
+
+void MmapIOHandler::close()
+{
+    pos = 0;
+}
@@ -0,0 +1,116 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    mmap_io_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file mmap_io_handler.h
+/// \brief serving of small files from memory mapped pages
+
+#ifndef __MMAP_IO_HANDLER_H__
+#define __MMAP_IO_HANDLER_H__
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <unordered_map>
+
+#include "io_handler.h"
+#include "util/grb_fs.h"
+
+class Config;
+
+/// \brief a read only memory mapping of a complete file
+class MappedFile {
+public:
+    MappedFile(const fs::path& path, std::size_t size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(addr); }
+    std::size_t size() const { return length; }
+
+private:
+    void* addr;
+    std::size_t length;
+};
+
+/// \brief bounded LRU cache of mapped files, keyed by path and modification time
+class MappedFileCache {
+public:
+    /// \param maxFileSize larger files are not mapped
+    /// \param maxCacheSize upper limit for the sum of all mapped files
+    MappedFileCache(std::size_t maxFileSize, std::size_t maxCacheSize);
+
+    /// \brief get the mapping for the file described by statbuf
+    /// \return nullptr if the file is not suitable for mapping
+    std::shared_ptr<MappedFile> get(const fs::path& path, const struct stat& statbuf);
+
+    std::size_t getCacheSize() const;
+    std::size_t getEntryCount() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<MappedFile> file;
+        time_t mtime;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    std::size_t maxFileSize;
+    std::size_t maxCacheSize;
+    std::size_t cacheSize {};
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    /// \brief most recently used path at the front
+    std::list<std::string> lru;
+
+    void erase(std::unordered_map<std::string, Entry>::iterator it);
+};
+
+/// \brief Allows the web server to read from a memory mapped file.
+/// The mapping stays valid as long as the handler exists, even if it
+/// gets evicted from the cache in the meantime.
+class MmapIOHandler : public IOHandler {
+public:
+    explicit MmapIOHandler(std::shared_ptr<MappedFile> file);
+
+    void open(enum UpnpOpenFileMode mode) override;
+    std::size_t read(char* buf, std::size_t length) override;
+    void seek(off_t offset, int whence) override;
+    off_t tell() override;
+    void close() override;
+
+    /// \brief get a handler for a small file, mapped if enabled and possible
+    /// \param statbuf result of stat() for the path, used as cache key
+    static std::unique_ptr<IOHandler> createHandler(const std::shared_ptr<Config>& config, const fs::path& path, const struct stat& statbuf);
+
+private:
+    std::shared_ptr<MappedFile> file;
+    off_t pos {};
+
+    static std::unique_ptr<MappedFileCache> cache;
+    static std::once_flag cacheInit;
+};
+
+#endif // __MMAP_IO_HANDLER_H__
@@ -0,0 +1,136 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    pipe_io_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file pipe_io_handler.cc
+
+#include "pipe_io_handler.h" // API
+
+#ifdef HAVE_EPOLL
+
+#include "content/content_manager.h"
+#include "pipe_reactor.h"
+#include "process_io_handler.h"
+#include "util/metrics.h"
+
+PipeIOHandler::PipeIOHandler(std::shared_ptr<ContentManager> content,
+    std::shared_ptr<PipeStream> stream, std::size_t initialFillSize,
+    std::shared_ptr<Executor> mainProc,
+    std::vector<std::shared_ptr<ProcListItem>> procList)
+    : content(std::move(content))
+    , stream(std::move(stream))
+    , initialFillSize(initialFillSize)
+    , mainProc(std::move(mainProc))
+    , procList(std::move(procList))
+{
+    this->content->registerExecutor(this->mainProc);
+    for (auto&& proc : this->procList) {
+        auto exec = proc->getExecutor();
+        if (exec)
+            this->content->registerExecutor(std::move(exec));
+    }
+}
+
+PipeIOHandler::~PipeIOHandler()
+{
+    log_debug("Destroying PipeIOHandler: terminating process");
+    content->unregisterExecutor(mainProc);
+    for (auto&& proc : procList) {
+        auto exec = proc->getExecutor();
+        if (exec)
+            content->unregisterExecutor(exec);
+    }
+
+    if (!mainProc->kill())
+        log_warning("~PipeIOHandler: Failed to kill process");
+    killAll();
+}
+
+bool PipeIOHandler::abort() const
+{
+    return std::any_of(procList.begin(), procList.end(),
+        [=](auto&& proc) { auto exec = proc->getExecutor();
+            return exec && !exec->isAlive() && proc->abortOnDeath(); });
+}
+
+void PipeIOHandler::killAll() const
+{
+    for (auto&& proc : procList) {
+        auto exec = proc->getExecutor();
+        if (exec)
+            exec->kill();
+    }
+}
+
+void PipeIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    if (mode != UPNP_READ)
+        throw_std_runtime_error("open: UpnpOpenFileMode mode not supported");
+
+    // the output of a short process may be complete already
+    if ((!mainProc->isAlive() && mainProc->getStatus() != EXIT_SUCCESS) || abort()) {
+        killAll();
+        throw_std_runtime_error("process terminated early");
+    }
+}
+
+std::size_t PipeIOHandler::read(char* buf, std::size_t length)
+{
+    static auto&& readCounter = Metrics::getInstance()->counter("gerbera_io_read_bytes_total", "Bytes read by IO handlers", R"(handler="pipe")");
+    auto bytesRead = stream->read(buf, length, initialFillSize, std::chrono::seconds(FIFO_READ_TIMEOUT));
+
+    if (bytesRead == std::size_t(CHECK_SOCKET)) {
+        if (abort()) {
+            mainProc->kill();
+            killAll();
+            return -1;
+        }
+        return CHECK_SOCKET;
+    }
+
+    if (bytesRead == std::size_t(-1)) {
+        mainProc->kill();
+        killAll();
+        return -1;
+    }
+
+    if (bytesRead == 0) {
+        // the process closed its output, which is only complete if it did not fail
+        killAll();
+        if (!mainProc->isAlive() && mainProc->getStatus() != EXIT_SUCCESS) {
+            log_debug("process exited with status {}", mainProc->getStatus());
+            return -1;
+        }
+        return 0;
+    }
+
+    initialFillSize = 0;
+    readCounter.inc(bytesRead);
+    return bytesRead;
+}
+
+void PipeIOHandler::seek(off_t offset, int whence)
+{
+    throw_std_runtime_error("fseek failed");
+}
+
+#endif
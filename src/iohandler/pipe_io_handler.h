@@ -0,0 +1,74 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    pipe_io_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file pipe_io_handler.h
+/// \brief Definition of the PipeIOHandler class.
+
+#ifndef __PIPE_IO_HANDLER_H__
+#define __PIPE_IO_HANDLER_H__
+
+#include <memory>
+#include <vector>
+
+#include "io_handler.h"
+
+// forward declaration
+class ContentManager;
+class Executor;
+class PipeStream;
+class ProcListItem;
+
+/// \brief Allows the web server to read the output of a process from a pipe.
+/// The pipe is read by the PipeReactor, this handler only takes the data from
+/// the stream buffer.
+class PipeIOHandler : public IOHandler {
+public:
+    /// \param stream output of mainProc
+    /// \param initialFillSize number of bytes which have to be buffered before the first read returns
+    /// \param procList associated processes that will be terminated once
+    /// they are no longer needed
+    PipeIOHandler(std::shared_ptr<ContentManager> content,
+        std::shared_ptr<PipeStream> stream, std::size_t initialFillSize,
+        std::shared_ptr<Executor> mainProc,
+        std::vector<std::shared_ptr<ProcListItem>> procList = {});
+    ~PipeIOHandler() override;
+
+    PipeIOHandler(const PipeIOHandler&) = delete;
+    PipeIOHandler& operator=(const PipeIOHandler&) = delete;
+
+    void open(enum UpnpOpenFileMode mode) override;
+    std::size_t read(char* buf, std::size_t length) override;
+    void seek(off_t offset, int whence) override;
+
+private:
+    std::shared_ptr<ContentManager> content;
+    std::shared_ptr<PipeStream> stream;
+    std::size_t initialFillSize;
+    std::shared_ptr<Executor> mainProc;
+    std::vector<std::shared_ptr<ProcListItem>> procList;
+
+    bool abort() const;
+    void killAll() const;
+};
+
+#endif // __PIPE_IO_HANDLER_H__
@@ -0,0 +1,245 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    pipe_reactor.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file pipe_reactor.cc
+
+#include "pipe_reactor.h" // API
+
+#ifdef HAVE_EPOLL
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "iohandler/io_handler.h"
+
+#define PIPE_REACTOR_MAX_EVENTS 64
+
+PipeStream::PipeStream(PipeReactor* reactor, unsigned int id, int fd, std::size_t bufSize, std::size_t maxChunkSize)
+    : reactor(reactor)
+    , id(id)
+    , fd(fd)
+    , maxChunkSize(maxChunkSize)
+    , buffer(bufSize)
+{
+}
+
+PipeStream::~PipeStream()
+{
+    reactor->removeStream(*this);
+    ::close(fd);
+}
+
+void PipeStream::onReadable()
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    if (paused || eof || error)
+        return;
+
+    auto writePos = (readPos + fill) % buffer.size();
+    auto length = std::min({ buffer.size() - fill, buffer.size() - writePos, maxChunkSize });
+
+    // only this thread writes to the free part of the buffer
+    lock.unlock();
+    auto bytesRead = ::read(fd, buffer.data() + writePos, length);
+    auto err = errno;
+    lock.lock();
+
+    if (bytesRead > 0) {
+        fill += bytesRead;
+        if (fill == buffer.size()) {
+            paused = true;
+            reactor->unwatch(*this);
+        }
+    } else if (bytesRead == 0) {
+        eof = true;
+        reactor->unwatch(*this);
+    } else if (err == EAGAIN || err == EINTR) {
+        return;
+    } else {
+        log_error("Failed to read from pipe: {}", std::strerror(err));
+        error = true;
+        reactor->unwatch(*this);
+    }
+    cond.notify_all();
+}
+
+std::size_t PipeStream::read(char* buf, std::size_t length, std::size_t minFill, std::chrono::milliseconds timeout)
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    minFill = std::clamp<std::size_t>(minFill, 1, buffer.size());
+    if (!cond.wait_for(lock, timeout, [&]() { return fill >= minFill || eof || error; }))
+        return CHECK_SOCKET;
+
+    // remaining data is served before reporting the error
+    if (fill == 0)
+        return error ? -1 : 0;
+
+    length = std::min(length, fill);
+    auto read1 = std::min(length, buffer.size() - readPos);
+    std::memcpy(buf, buffer.data() + readPos, read1);
+    std::memcpy(buf + read1, buffer.data(), length - read1);
+    readPos = (readPos + length) % buffer.size();
+    fill -= length;
+
+    if (paused) {
+        paused = false;
+        reactor->watch(*this);
+    }
+    return length;
+}
+
+std::unique_ptr<PipeReactor> PipeReactor::instance;
+std::once_flag PipeReactor::instanceInit;
+
+PipeReactor::PipeReactor(std::shared_ptr<Config> config)
+    : config(std::move(config))
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+        throw_std_runtime_error("Failed to create epoll instance: {}", std::strerror(errno));
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0) {
+        ::close(epollFd);
+        throw_std_runtime_error("Failed to create eventfd: {}", std::strerror(errno));
+    }
+    // stream ids start at 1, so 0 identifies the wake up event
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    threadRunner = std::make_unique<StdThreadRunner>(
+        "PipeReactorThread", [](void* arg) -> void* {
+            auto inst = static_cast<PipeReactor*>(arg);
+            inst->threadProc();
+            return nullptr;
+        },
+        this, this->config);
+}
+
+PipeReactor::~PipeReactor()
+{
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        shutdownFlag = true;
+    }
+    eventfd_write(wakeFd, 1);
+    threadRunner->join();
+
+    ::close(wakeFd);
+    ::close(epollFd);
+}
+
+PipeReactor* PipeReactor::getInstance(const std::shared_ptr<Config>& config)
+{
+    std::call_once(instanceInit, [&config]() {
+        instance = std::make_unique<PipeReactor>(config);
+    });
+    return instance.get();
+}
+
+std::shared_ptr<PipeStream> PipeReactor::addStream(int fd, std::size_t bufSize, std::size_t maxChunkSize)
+{
+    if (bufSize == 0 || maxChunkSize == 0)
+        throw_std_runtime_error("bufSize and maxChunkSize must be greater than 0");
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        throw_std_runtime_error("Failed to make pipe non-blocking: {}", std::strerror(errno));
+
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto stream = std::make_shared<PipeStream>(this, ++lastId, fd, bufSize, maxChunkSize);
+    streams[stream->getID()] = stream;
+    watch(*stream);
+    return stream;
+}
+
+std::size_t PipeReactor::getStreamCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return streams.size();
+}
+
+void PipeReactor::watch(const PipeStream& stream)
+{
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u32 = stream.getID();
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, stream.getFd(), &event) < 0)
+        log_error("Failed to watch pipe: {}", std::strerror(errno));
+}
+
+void PipeReactor::unwatch(const PipeStream& stream)
+{
+    // a full pipe is not watched at all, otherwise EPOLLHUP keeps waking the thread
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, stream.getFd(), nullptr);
+}
+
+void PipeReactor::removeStream(const PipeStream& stream)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    streams.erase(stream.getID());
+    unwatch(stream);
+}
+
+void PipeReactor::threadProc()
+{
+    struct epoll_event events[PIPE_REACTOR_MAX_EVENTS];
+    std::vector<std::shared_ptr<PipeStream>> ready;
+
+    while (true) {
+        int count = epoll_wait(epollFd, events, PIPE_REACTOR_MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            log_error("epoll_wait failed: {}", std::strerror(errno));
+            break;
+        }
+
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            if (shutdownFlag)
+                break;
+
+            for (int i = 0; i < count; i++) {
+                // events of removed streams may still be reported
+                auto it = streams.find(events[i].data.u32);
+                if (it != streams.end())
+                    ready.push_back(it->second.lock());
+            }
+        }
+
+        for (auto&& stream : ready) {
+            if (stream)
+                stream->onReadable();
+        }
+        // releasing the last reference removes the stream, which needs the mutex
+        ready.clear();
+    }
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    pipe_reactor.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file pipe_reactor.h
+/// \brief Definition of the PipeReactor class.
+
+#ifndef __PIPE_REACTOR_H__
+#define __PIPE_REACTOR_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "util/thread_runner.h"
+
+// forward declaration
+class Config;
+class PipeReactor;
+
+/// \brief buffered output of a pipe, filled by the PipeReactor
+///
+/// The reactor pauses reading from the pipe while the buffer is full,
+/// so a slow reader blocks the writing process instead of growing the buffer.
+class PipeStream {
+public:
+    PipeStream(PipeReactor* reactor, unsigned int id, int fd, std::size_t bufSize, std::size_t maxChunkSize);
+    ~PipeStream();
+
+    PipeStream(const PipeStream&) = delete;
+    PipeStream& operator=(const PipeStream&) = delete;
+
+    /// \brief read buffered data
+    /// \param minFill number of bytes which have to be buffered before data is
+    /// returned, unless the pipe was closed
+    /// \param timeout maximum time to wait for data
+    /// \return number of bytes, 0 for end of stream, -1 on error and
+    /// CHECK_SOCKET on timeout
+    std::size_t read(char* buf, std::size_t length, std::size_t minFill, std::chrono::milliseconds timeout);
+
+    unsigned int getID() const { return id; }
+    int getFd() const { return fd; }
+
+private:
+    PipeReactor* reactor;
+    unsigned int id;
+    int fd;
+    std::size_t maxChunkSize;
+
+    /// \brief protects everything below, the reactor reads into the free
+    /// part of the buffer without holding it
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<char> buffer;
+    std::size_t readPos {};
+    std::size_t fill {};
+    bool paused {};
+    bool eof {};
+    bool error {};
+
+    /// \brief read available data from the pipe, called by the reactor thread
+    void onReadable();
+
+    friend class PipeReactor;
+};
+
+/// \brief reads the output of all transcoders in a single thread
+///
+/// Pipes are registered with epoll and their data is moved to the buffer
+/// of the corresponding PipeStream, so the number of threads does not
+/// depend on the number of streams.
+class PipeReactor {
+public:
+    explicit PipeReactor(std::shared_ptr<Config> config);
+    ~PipeReactor();
+
+    PipeReactor(const PipeReactor&) = delete;
+    PipeReactor& operator=(const PipeReactor&) = delete;
+
+    /// \brief start reading from fd
+    /// \param fd read end of a pipe, owned by the stream afterwards
+    /// \param bufSize size of the stream buffer in bytes
+    /// \param maxChunkSize maximum number of bytes read at once, keeps busy pipes from delaying others
+    std::shared_ptr<PipeStream> addStream(int fd, std::size_t bufSize, std::size_t maxChunkSize);
+
+    /// \brief number of streams that are still open
+    std::size_t getStreamCount() const;
+
+    /// \brief get the reactor shared by all transcoders
+    static PipeReactor* getInstance(const std::shared_ptr<Config>& config);
+
+private:
+    std::shared_ptr<Config> config;
+    int epollFd;
+    /// \brief eventfd to wake up the reactor thread on shutdown
+    int wakeFd;
+
+    mutable std::mutex mutex;
+    std::map<unsigned int, std::weak_ptr<PipeStream>> streams;
+    unsigned int lastId {};
+    bool shutdownFlag {};
+
+    std::unique_ptr<StdThreadRunner> threadRunner;
+    void threadProc();
+
+    void watch(const PipeStream& stream);
+    void unwatch(const PipeStream& stream);
+    void removeStream(const PipeStream& stream);
+
+    static std::unique_ptr<PipeReactor> instance;
+    static std::once_flag instanceInit;
+
+    friend class PipeStream;
+};
+
+#endif // __PIPE_REACTOR_H__
@@ -0,0 +1,226 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    prefetch_io_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file prefetch_io_handler.cc
+
+#include "prefetch_io_handler.h" // API
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/metrics.h"
+
+PrefetchIOHandler::PrefetchIOHandler(std::shared_ptr<Config> config, fs::path path, std::size_t bufSize, std::size_t chunkSize, std::size_t initialFillSize)
+    : IOHandlerBufferHelper(std::move(config), bufSize, initialFillSize)
+    , path(std::move(path))
+    , chunkSize(chunkSize)
+{
+    if (chunkSize == 0)
+        throw_std_runtime_error("chunkSize must be greater than 0");
+    seekEnabled = true;
+}
+
+PrefetchIOHandler::~PrefetchIOHandler() noexcept
+{
+    if (isOpen)
+        close();
+}
+
+void PrefetchIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    if (mode != UPNP_READ)
+        throw_std_runtime_error("open: UpnpOpenFileMode mode not supported");
+
+    // do the open here instead of threadProc() because it may throw an exception
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw_std_runtime_error("Failed to open {}: {}", path.c_str(), std::strerror(errno));
+
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) != 0) {
+        auto err = errno;
+        ::close(fd);
+        fd = -1;
+        throw_std_runtime_error("Failed to stat {}: {}", path.c_str(), std::strerror(err));
+    }
+    fileSize = statbuf.st_size;
+    fileOffset = 0;
+    adviseOffset = 0;
+    posRead = 0;
+    streaming = false;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    adviseWindow();
+
+    IOHandlerBufferHelper::open(mode);
+}
+
+std::size_t PrefetchIOHandler::read(char* buf, std::size_t length)
+{
+    if (streaming && ring->size() == 0 && !(eof || readError || threadShutdown))
+        stats.underruns++;
+    streaming = true;
+    return IOHandlerBufferHelper::read(buf, length);
+}
+
+void PrefetchIOHandler::seek(off_t offset, int whence)
+{
+    log_debug("seek called: {} {}", offset, whence);
+    assert(isOpen);
+
+    // the thread only deals with absolute positions
+    off_t target;
+    if (whence == SEEK_SET)
+        target = offset;
+    else if (whence == SEEK_CUR)
+        target = posRead + offset;
+    else if (whence == SEEK_END)
+        target = fileSize + offset;
+    else
+        throw_std_runtime_error("seek: invalid whence {}", whence);
+
+    if (target < 0 || target > fileSize)
+        throw_std_runtime_error("seek: offset {} outside of {} ({} bytes)", target, path.c_str(), fileSize);
+
+    if (target == posRead)
+        return;
+
+    stats.seeks++;
+    streaming = false;
+
+    if (target > posRead && std::size_t(target - posRead) <= ring->size()) {
+        // we have everything we need in the buffer already
+        IOHandlerBufferHelper::seek(target, SEEK_SET);
+        stats.bufferedSeeks++;
+        return;
+    }
+
+    requestSeek(target, SEEK_SET);
+}
+
+off_t PrefetchIOHandler::tell()
+{
+    return posRead;
+}
+
+void PrefetchIOHandler::close()
+{
+    IOHandlerBufferHelper::close();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+
+    static auto&& underrunCounter = Metrics::getInstance()->counter("gerbera_prefetch_underruns_total", "Reads that had to wait for the prefetch thread");
+    static auto&& seekCounter = Metrics::getInstance()->counter("gerbera_prefetch_seeks_total", "Seeks requested on prefetched files");
+    static auto&& bufferedSeekCounter = Metrics::getInstance()->counter("gerbera_prefetch_buffered_seeks_total", "Seeks on prefetched files served from the buffer");
+    static auto&& discardedCounter = Metrics::getInstance()->counter("gerbera_prefetch_discarded_bytes_total", "Prefetched bytes dropped by seeks or close");
+    underrunCounter.inc(stats.underruns);
+    seekCounter.inc(stats.seeks);
+    bufferedSeekCounter.inc(stats.bufferedSeeks);
+    discardedCounter.inc(stats.discardedBytes);
+    log_debug("{}: {} underruns, {} seeks ({} in buffer), {} bytes discarded", path.c_str(), stats.underruns, stats.seeks, stats.bufferedSeeks, stats.discardedBytes);
+}
+
+void PrefetchIOHandler::adviseWindow()
+{
+#ifdef POSIX_FADV_WILLNEED
+    // ask the kernel for the next window before we actually need it,
+    // so the network file system can fetch it in the background
+    if (fileOffset + off_t(bufSize / 2) >= adviseOffset && adviseOffset < fileSize) {
+        auto start = std::max(fileOffset, adviseOffset);
+        posix_fadvise(fd, start, bufSize, POSIX_FADV_WILLNEED);
+        adviseOffset = start + bufSize;
+    }
+#endif
+}
+
+void PrefetchIOHandler::processSeek()
+{
+    // cancel the stale prefetch and restart at the new position
+    stats.discardedBytes += ring->size();
+    ring->clear();
+    fileOffset = seekOffset;
+    adviseOffset = seekOffset;
+    adviseWindow();
+    waitForInitialFillSize = (initialFillSize > 0);
+    // a seek back from the end of the file has to start reading again
+    eof = false;
+    posRead = seekOffset;
+
+    seekDone();
+}
+
+void PrefetchIOHandler::threadProc()
+{
+    while (!threadShutdown) {
+        if (doSeek) {
+            processSeek();
+            continue;
+        }
+
+        if (eof || readError) {
+            waitForRequest();
+            continue;
+        }
+        if (!waitForSpace(getRefillSize(chunkSize)))
+            continue;
+
+        std::size_t maxWrite;
+        char* target = ring->writeArea(maxWrite);
+        std::size_t length = std::min(chunkSize, maxWrite);
+
+        // the reader only touches the filled part of the ring,
+        // so we can fill the free part without any lock
+        auto readBytes = pread(fd, target, length, fileOffset);
+        auto err = errno;
+
+        if (doSeek) {
+            // the client moved on while we were reading, drop the stale data
+            if (readBytes > 0)
+                stats.discardedBytes += readBytes;
+            continue;
+        }
+
+        if (readBytes < 0) {
+            if (err == EINTR)
+                continue;
+            log_error("Failed to read {}: {}", path.c_str(), std::strerror(err));
+            readError = true;
+            notifyReader();
+        } else if (readBytes == 0) {
+            waitForInitialFillSize = false;
+            eof = true;
+            notifyReader();
+        } else {
+            fileOffset += readBytes;
+            commitWrite(readBytes);
+            adviseWindow();
+        }
+    }
+}
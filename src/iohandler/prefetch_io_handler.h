@@ -0,0 +1,93 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    prefetch_io_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file prefetch_io_handler.h
+
+#ifndef __PREFETCH_IO_HANDLER_H__
+#define __PREFETCH_IO_HANDLER_H__
+
+#include <memory>
+#include <upnp.h>
+
+#include "io_handler_buffer_helper.h"
+#include "util/grb_fs.h"
+
+/// \brief counters collected by PrefetchIOHandler
+struct PrefetchStatistics {
+    /// \brief number of reads that found the buffer empty while streaming
+    std::size_t underruns {};
+    /// \brief number of seeks requested by the client
+    std::size_t seeks {};
+    /// \brief number of seeks that were satisfied from the buffer
+    std::size_t bufferedSeeks {};
+    /// \brief bytes that were prefetched but dropped because of a seek
+    std::size_t discardedBytes {};
+};
+
+/// \brief a read ahead IOHandler for local files
+///
+/// A background thread keeps a window of the file ahead of the current client
+/// position in a ring buffer and hints the kernel to read even further ahead.
+/// This hides the latency of network file systems from the renderer.
+/// The public functions of this class are *not* thread safe!
+class PrefetchIOHandler : public IOHandlerBufferHelper {
+public:
+    /// \brief get an instance of a PrefetchIOHandler
+    /// \param path the file to stream
+    /// \param bufSize the size of the prefetch window in bytes
+    /// \param chunkSize the maximum size of a single read from the file
+    /// \param initialFillSize the number of bytes which have to be in the buffer
+    /// before the first read at the very beginning or after a seek returns;
+    /// 0 disables the delay
+    PrefetchIOHandler(std::shared_ptr<Config> config, fs::path path, std::size_t bufSize, std::size_t chunkSize, std::size_t initialFillSize);
+    ~PrefetchIOHandler() noexcept override;
+
+    void open(enum UpnpOpenFileMode mode) override;
+    std::size_t read(char* buf, std::size_t length) override;
+    void seek(off_t offset, int whence) override;
+    off_t tell() override;
+    void close() override;
+
+    /// \brief counters of this handler, added to the metrics on close
+    PrefetchStatistics getStatistics() const { return stats; }
+
+private:
+    fs::path path;
+    std::size_t chunkSize;
+    int fd { -1 };
+    off_t fileSize {};
+    /// \brief file offset of the next byte the thread will fetch
+    off_t fileOffset {};
+    /// \brief end of the range the kernel was asked to read ahead
+    off_t adviseOffset {};
+    /// \brief set after the first read after open or seek to tell underruns from refills
+    bool streaming {};
+
+    PrefetchStatistics stats;
+
+    void processSeek();
+    void adviseWindow();
+    void threadProc() override;
+};
+
+#endif // __PREFETCH_IO_HANDLER_H__
@@ -38,6 +38,7 @@
 #include <sys/select.h>
 
 #include "content/content_manager.h"
+#include "util/metrics.h"
 
 // after MAX_TIMEOUTS we will tell libupnp to check the socket,
 // this will make sure that we do not block the read and allow libupnp to
@@ -156,6 +157,7 @@ void ProcessIOHandler::open(enum UpnpOpenFileMode mode)
 
 std::size_t ProcessIOHandler::read(char* buf, std::size_t length)
 {
+    static auto&& readCounter = Metrics::getInstance()->counter("gerbera_io_read_bytes_total", "Bytes read by IO handlers", R"(handler="process")");
     fd_set readSet;
     struct timespec timeout;
     ssize_t bytesRead;
@@ -241,6 +243,7 @@ std::size_t ProcessIOHandler::read(char* buf, std::size_t length)
         return ret;
     }
 
+    readCounter.inc(numBytes);
     return numBytes;
 }
 
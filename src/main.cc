@@ -172,6 +172,7 @@ int main(int argc, char** argv, char** envp)
 
     options.add_options() //
         ("D,debug", "Enable debugging", cxxopts::value<bool>()->default_value("false")) //
+        ("debug-mode", "Enable debug output of subsystems (cds, xml, clients, sql or all), implies --debug", cxxopts::value<std::string>()) //
         ("d,daemon", "Daemonize after startup", cxxopts::value<bool>()->default_value("false")) //
         ("u,user", "Drop privs to user", cxxopts::value<std::string>()) //
         ("P,pidfile", "Write a pidfile to the specified location, e.g. /run/gerbera.pid", cxxopts::value<fs::path>()) //
@@ -223,7 +224,15 @@ int main(int argc, char** argv, char** envp)
             std::exit(EXIT_SUCCESS);
         }
 
-        bool debug = opts["debug"].as<bool>();
+        bool debug = opts["debug"].as<bool>() || opts.count("debug-mode") > 0;
+        if (opts.count("debug-mode") > 0) {
+            try {
+                GrbLogger::enableFacilities(opts["debug-mode"].as<std::string>());
+            } catch (const std::runtime_error& e) {
+                fmt::print(stderr, "Failed to parse arguments: {}\n", e.what());
+                std::exit(EXIT_FAILURE);
+            }
+        }
         if (debug) {
             spdlog::set_level(spdlog::level::debug);
             spdlog::set_pattern("%Y-%m-%d %X.%e %^%6l%$: [%s:%#] %!(): %v");
@@ -0,0 +1,175 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    album_art_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file album_art_cache.cc
+
+#include "album_art_cache.h" // API
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
+#include <libffmpegthumbnailer/videothumbnailer.h>
+#endif
+
+#include "config/config.h"
+#include "util/tools.h"
+
+#define ALBUM_ART_VARIANT_QUALITY 8
+#define ALBUM_ART_MAX_SIZE 4096
+#define ALBUM_ART_MAX_SIZE_DIGITS 4
+
+static bool isCached(const fs::path& path)
+{
+    std::error_code ec;
+    return isRegularFile(path, ec);
+}
+
+std::unique_ptr<AlbumArtCache> AlbumArtCache::instance;
+std::once_flag AlbumArtCache::instanceInit;
+
+AlbumArtCache::AlbumArtCache(fs::path baseDir, std::vector<int> sizes)
+    : baseDir(std::move(baseDir))
+    , sizes(std::move(sizes))
+{
+}
+
+AlbumArtCache* AlbumArtCache::getInstance(const std::shared_ptr<Config>& config)
+{
+    if (!config->getBoolOption(CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_ENABLED))
+        return nullptr;
+
+    std::call_once(instanceInit, [&config]() {
+        fs::path dir = config->getOption(CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_DIR);
+        if (dir.empty())
+            dir = fs::path(config->getOption(CFG_SERVER_HOME)) / "art-cache";
+
+        std::vector<int> sizes;
+        for (auto&& size : splitString(config->getOption(CFG_SERVER_EXTOPTS_ALBUM_ART_CACHE_SIZES), ',')) {
+            trimStringInPlace(size);
+            auto edge = parseSize(size);
+            if (edge)
+                sizes.push_back(*edge);
+            else if (!size.empty())
+                log_warning("Ignoring invalid album art size '{}'", size);
+        }
+        instance = std::make_unique<AlbumArtCache>(dir, sizes);
+    });
+    return instance.get();
+}
+
+std::optional<int> AlbumArtCache::parseSize(const std::string& value)
+{
+    if (value.empty() || value.size() > ALBUM_ART_MAX_SIZE_DIGITS || !std::all_of(value.begin(), value.end(), ::isdigit))
+        return std::nullopt;
+    auto size = std::stoi(value);
+    if (size <= 0 || size > ALBUM_ART_MAX_SIZE)
+        return std::nullopt;
+    return size;
+}
+
+fs::path AlbumArtCache::getReferencePath(const fs::path& mediaFile) const
+{
+    auto hash = hexStringMd5(mediaFile.string());
+    return baseDir / "refs" / hash.substr(0, 2) / hash;
+}
+
+fs::path AlbumArtCache::getPicturePath(const std::string& hash) const
+{
+    return baseDir / "data" / hash.substr(0, 2) / hash;
+}
+
+std::optional<std::string> AlbumArtCache::lookup(const fs::path& mediaFile, time_t mtime) const
+{
+    auto file = std::ifstream(getReferencePath(mediaFile));
+    time_t refTime;
+    std::string hash;
+    std::string refFile;
+    if (!(file >> refTime >> hash) || !std::getline(file >> std::ws, refFile))
+        return std::nullopt;
+
+    // guard against md5 collisions of the media file name
+    if (refTime != mtime || refFile != mediaFile.string() || !isCached(getPicturePath(hash)))
+        return std::nullopt;
+    return hash;
+}
+
+std::string AlbumArtCache::store(const fs::path& mediaFile, time_t mtime, const std::byte* data, std::size_t size)
+{
+    auto hash = hexMd5(data, size);
+    auto picturePath = getPicturePath(hash);
+    if (!isCached(picturePath)) {
+        writeFile(picturePath, data, size);
+        log_debug("Stored album art of {} as {}", mediaFile.c_str(), hash);
+    }
+
+    auto reference = fmt::format("{} {} {}\n", mtime, hash, mediaFile.string());
+    writeFile(getReferencePath(mediaFile), reinterpret_cast<const std::byte*>(reference.data()), reference.size());
+    return hash;
+}
+
+std::optional<fs::path> AlbumArtCache::getVariantPath(const std::string& hash, int size)
+{
+    auto path = getPicturePath(hash);
+    path += fmt::format("-{}.jpg", size);
+    if (isCached(path))
+        return path;
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
+    // ffmpegthumbnailer is not thread safe
+    static std::mutex scaleMutex;
+    auto lock = std::scoped_lock<std::mutex>(scaleMutex);
+    if (isCached(path))
+        return path;
+
+    try {
+        auto th = ffmpegthumbnailer::VideoThumbnailer(size, false, true, ALBUM_ART_VARIANT_QUALITY, false);
+        std::vector<uint8_t> img;
+        th.generateThumbnail(getPicturePath(hash).c_str(), Jpeg, img);
+        if (img.empty())
+            return std::nullopt;
+        writeFile(path, reinterpret_cast<const std::byte*>(img.data()), img.size());
+        log_debug("Created {}px variant of album art {}", size, hash);
+        return path;
+    } catch (const std::exception& e) {
+        log_warning("Failed to scale album art {}: {}", hash, e.what());
+    }
+#endif
+    return std::nullopt;
+}
+
+void AlbumArtCache::writeFile(const fs::path& path, const std::byte* data, std::size_t size)
+{
+    fs::create_directories(path.parent_path());
+
+    // readers must never see a partial file
+    auto tmpPath = path;
+    tmpPath += fmt::format(".{}", generateRandomId());
+    GrbFile(tmpPath).writeBinaryFile(data, size);
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        throw_std_runtime_error("Failed to store {}: {}", path.c_str(), ec.message());
+    }
+}
@@ -0,0 +1,87 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    album_art_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file album_art_cache.h
+/// \brief Definition of the AlbumArtCache class.
+
+#ifndef __ALBUM_ART_CACHE_H__
+#define __ALBUM_ART_CACHE_H__
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "util/grb_fs.h"
+
+class Config;
+
+/// \brief on disk store for embedded album art
+///
+/// Pictures are stored once per content hash, so all tracks of an album
+/// share the same file. A small reference file per media file maps
+/// path and modification time to the hash. Scaled JPEG variants are
+/// created next to the original picture on demand.
+class AlbumArtCache {
+public:
+    /// \param baseDir directory of the cache
+    /// \param sizes the maximum edge length of the scaled variants
+    AlbumArtCache(fs::path baseDir, std::vector<int> sizes);
+
+    /// \brief get the hash of the picture stored for mediaFile
+    /// \return std::nullopt if nothing is stored or the media file was modified since
+    std::optional<std::string> lookup(const fs::path& mediaFile, time_t mtime) const;
+
+    /// \brief store picture embedded in mediaFile
+    /// \return hash of the picture
+    std::string store(const fs::path& mediaFile, time_t mtime, const std::byte* data, std::size_t size);
+
+    /// \brief path of the original picture
+    fs::path getPicturePath(const std::string& hash) const;
+
+    /// \brief path of the scaled variant, created if it does not exist yet
+    /// \return std::nullopt if scaling is not available
+    std::optional<fs::path> getVariantPath(const std::string& hash, int size);
+
+    /// \brief configured variant sizes
+    const std::vector<int>& getVariantSizes() const { return sizes; }
+
+    /// \brief parse a variant size from configuration or a resource parameter
+    /// \return std::nullopt if value is not a positive edge length
+    static std::optional<int> parseSize(const std::string& value);
+
+    /// \brief get the cache instance if enabled in the configuration
+    static AlbumArtCache* getInstance(const std::shared_ptr<Config>& config);
+
+private:
+    fs::path baseDir;
+    std::vector<int> sizes;
+
+    fs::path getReferencePath(const fs::path& mediaFile) const;
+    static void writeFile(const fs::path& path, const std::byte* data, std::size_t size);
+
+    static std::unique_ptr<AlbumArtCache> instance;
+    static std::once_flag instanceInit;
+};
+
+#endif // __ALBUM_ART_CACHE_H__
@@ -53,11 +53,16 @@ extern "C" {
 
 #ifdef HAVE_FFMPEGTHUMBNAILER
 #include "iohandler/mem_io_handler.h"
+#include "iohandler/mmap_io_handler.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_worker_pool.h"
 #include <libffmpegthumbnailer/filmstripfilter.h>
 #include <libffmpegthumbnailer/videothumbnailer.h>
 #endif
 
 #include "cds_objects.h"
+#include "config/config_snapshot.h"
+#include "exceptions.h"
 #include "util/string_converter.h"
 #include "util/tools.h"
 
@@ -249,10 +254,9 @@ void FfmpegHandler::addFfmpegResourceFields(const std::shared_ptr<CdsItem>& item
         auto [x, y] = checkResolution(videoresolution);
 
         if (!videoresolution.empty() && x && y) {
-            auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-
-            auto it = mappings.find(CONTENT_TYPE_JPG);
-            std::string thumbMimetype = it != mappings.end() && !it->second.empty() ? it->second : "image/jpeg";
+            auto snapshot = config->getSnapshot();
+            auto&& jpgMimetype = snapshot->getContentType(CONTENT_TYPE_JPG);
+            std::string thumbMimetype = !jpgMimetype.empty() ? jpgMimetype : "image/jpeg";
 
             auto ffres = std::make_shared<CdsResource>(CH_FFTH);
             ffres->addParameter(RESOURCE_HANDLER, fmt::to_string(CH_FFTH));
@@ -265,6 +269,15 @@ void FfmpegHandler::addFfmpegResourceFields(const std::shared_ptr<CdsItem>& item
             ffres->addAttribute(R_RESOLUTION, resolution);
             item->addResource(ffres);
             log_debug("Adding resource for video thumbnail");
+
+            // the workers are only started if thumbnails are generated
+            if (config->getBoolOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_PREGENERATE)) {
+                auto cache = ThumbnailCache::getInstance(config);
+                auto pool = cache ? ThumbnailWorkerPool::getInstance(config) : nullptr;
+                auto location = item->getLocation();
+                if (pool && !cache->contains(location) && !pool->pregenerate(location))
+                    log_debug("Thumbnail of {} is generated on first request, too many are queued", location.c_str());
+            }
         }
     }
 #endif // HAVE_FFMPEGTHUMBNAILER
@@ -329,21 +342,34 @@ fs::path getThumbnailCachePath(const fs::path& base, const fs::path& movie)
     return path;
 }
 
-std::optional<std::vector<std::byte>> FfmpegHandler::readThumbnailCacheFile(const fs::path& movieFilename) const
+std::optional<std::vector<std::byte>> FfmpegHandler::readLegacyThumbnailCacheFile(const fs::path& movieFilename) const
 {
     auto path = getThumbnailCachePath(getThumbnailCacheBasePath(*config), movieFilename);
-    return GrbFile(path).readBinaryFile();
+    std::error_code ec;
+    if (!isRegularFile(path, ec))
+        return std::nullopt;
+
+    auto data = GrbFile(path).readBinaryFile();
+    fs::remove(path, ec);
+    return data;
 }
 
-void FfmpegHandler::writeThumbnailCacheFile(const fs::path& movieFilename, const std::byte* data, std::size_t size) const
+std::vector<std::byte> generateThumbnail(const std::shared_ptr<Config>& config, const fs::path& movie)
 {
-    try {
-        auto path = getThumbnailCachePath(getThumbnailCacheBasePath(*config), movieFilename);
-        fs::create_directories(path.parent_path());
-        GrbFile(path).writeBinaryFile(data, size);
-    } catch (const std::runtime_error& e) {
-        log_error("Failed to write thumbnail cache: {}", e.what());
-    }
+    auto th = ffmpegthumbnailer::VideoThumbnailer(config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_THUMBSIZE), false, true, config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_IMAGE_QUALITY), false);
+    std::vector<uint8_t> img;
+
+    th.setSeekPercentage(config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_SEEK_PERCENTAGE));
+    if (config->getBoolOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_FILMSTRIP_OVERLAY))
+        th.addFilter(new ffmpegthumbnailer::FilmStripFilter());
+
+    th.generateThumbnail(movie.c_str(), Jpeg, img);
+    auto data = reinterpret_cast<const std::byte*>(img.data());
+
+    auto cache = ThumbnailCache::getInstance(config);
+    if (cache && !img.empty())
+        cache->store(movie, data, img.size());
+    return { data, data + img.size() };
 }
 #endif
 
@@ -357,32 +383,31 @@ std::unique_ptr<IOHandler> FfmpegHandler::serveContent(const std::shared_ptr<Cds
     if (!config->getBoolOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED))
         return nullptr;
 
-    const auto cacheEnabled = config->getBoolOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR_ENABLED);
-
-    if (cacheEnabled) {
-        if (auto data = readThumbnailCacheFile(item->getLocation())) {
-            log_debug("Returning cached thumbnail for file: {}", item->getLocation().c_str());
+    auto cache = ThumbnailCache::getInstance(config);
+    if (cache) {
+        auto location = item->getLocation();
+        if (auto path = cache->lookup(location)) {
+            struct stat statbuf;
+            if (stat(path->c_str(), &statbuf) == 0) {
+                log_debug("Returning cached thumbnail for file: {}", location.c_str());
+                return MmapIOHandler::createHandler(config, *path, statbuf);
+            }
+            // removed from the cache directory behind our back
+            cache->remove(location);
+        } else if (auto data = readLegacyThumbnailCacheFile(location)) {
+            log_debug("Moving thumbnail of {} to the new cache layout", location.c_str());
+            cache->store(location, data->data(), data->size());
             return std::make_unique<MemIOHandler>(data->data(), data->size());
         }
     }
 
-    auto thumbLock = std::scoped_lock<std::mutex>(thumb_mutex);
-
-    auto th = ffmpegthumbnailer::VideoThumbnailer(config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_THUMBSIZE), false, true, config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_IMAGE_QUALITY), false);
-    std::vector<uint8_t> img;
-
-    th.setSeekPercentage(config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_SEEK_PERCENTAGE));
-    if (config->getBoolOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_FILMSTRIP_OVERLAY))
-        th.addFilter(new ffmpegthumbnailer::FilmStripFilter());
-
-    log_debug("Generating thumbnail for file: {}", item->getLocation().c_str());
-
-    th.generateThumbnail(item->getLocation().c_str(), Jpeg, img);
-    if (cacheEnabled) {
-        writeThumbnailCacheFile(item->getLocation(),
-            reinterpret_cast<std::byte*>(img.data()), img.size());
-    }
-
+    // generated by the workers, concurrent requests for the same file share the job
+    auto pool = ThumbnailWorkerPool::getInstance(config);
+    if (!pool)
+        throw ServerShutdownException("Thumbnails are not generated during shutdown");
+    auto img = pool->get(item->getLocation());
+    if (img.empty())
+        throw_std_runtime_error("Failed to generate thumbnail for {}", item->getLocation().c_str());
     return std::make_unique<MemIOHandler>(img.data(), img.size());
 #else
     return nullptr;
@@ -391,7 +416,8 @@ std::unique_ptr<IOHandler> FfmpegHandler::serveContent(const std::shared_ptr<Cds
 
 std::string FfmpegHandler::getMimeType() const
 {
-    auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-    return getValueOrDefault(mappings, CONTENT_TYPE_JPG, "image/jpeg");
+    auto snapshot = config->getSnapshot();
+    auto&& mimeType = snapshot->getContentType(CONTENT_TYPE_JPG);
+    return !mimeType.empty() ? mimeType : "image/jpeg";
 }
 #endif // HAVE_FFMPEG
@@ -56,20 +56,20 @@ public:
     std::string getMimeType() const override;
 
 private:
-    // The ffmpegthumbnailer code (ffmpeg?) is not threading safe.
-    // Add a lock around the usage to avoid crashing randomly.
-    std::mutex thumb_mutex;
     std::map<std::string, std::string> specialPropertyMap;
 
     void addFfmpegAuxdataFields(const std::shared_ptr<CdsItem>& item, const AVFormatContext* pFormatCtx) const;
     void addFfmpegMetadataFields(const std::shared_ptr<CdsItem>& item, const AVFormatContext* pFormatCtx) const;
     void addFfmpegResourceFields(const std::shared_ptr<CdsItem>& item, const AVFormatContext* pFormatCtx) const;
-    std::optional<std::vector<std::byte>> readThumbnailCacheFile(const fs::path& movieFilename) const;
-    void writeThumbnailCacheFile(const fs::path& movieFilename, const std::byte* data, std::size_t size) const;
+    /// \brief read and remove a thumbnail stored next to the media path by older versions
+    std::optional<std::vector<std::byte>> readLegacyThumbnailCacheFile(const fs::path& movieFilename) const;
 };
 
 fs::path getThumbnailCacheBasePath(const Config& config);
+/// \brief path of the thumbnail in the cache layout of older versions
 fs::path getThumbnailCachePath(const fs::path& base, const fs::path& movie);
+/// \brief run ffmpegthumbnailer for movie and store the result in the thumbnail cache if enabled
+std::vector<std::byte> generateThumbnail(const std::shared_ptr<Config>& config, const fs::path& movie);
 
 #endif //__FFMPEG_HANDLER_H__
 #endif // HAVE_FFMPEG
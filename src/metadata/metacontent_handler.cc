@@ -31,7 +31,7 @@
 #include "cds_objects.h"
 #include "config/config.h"
 #include "config/directory_tweak.h"
-#include "iohandler/file_io_handler.h"
+#include "iohandler/mmap_io_handler.h"
 #include "util/mime.h"
 #include "util/tools.h"
 
@@ -204,7 +204,7 @@ std::unique_ptr<IOHandler> FanArtHandler::serveContent(const std::shared_ptr<Cds
         log_warning("File does not exist: {} ({})", path.c_str(), std::strerror(errno));
         return nullptr;
     }
-    return std::make_unique<FileIOHandler>(path);
+    return MmapIOHandler::createHandler(config, path, statbuf);
 }
 
 std::unique_ptr<ContentPathSetup> ContainerArtHandler::setup {};
@@ -258,7 +258,7 @@ std::unique_ptr<IOHandler> ContainerArtHandler::serveContent(const std::shared_p
         log_warning("File does not exist: {} ({})", path.c_str(), std::strerror(errno));
         return nullptr;
     }
-    return std::make_unique<FileIOHandler>(path);
+    return MmapIOHandler::createHandler(config, path, statbuf);
 }
 
 std::unique_ptr<ContentPathSetup> SubtitleHandler::setup {};
@@ -314,7 +314,7 @@ std::unique_ptr<IOHandler> SubtitleHandler::serveContent(const std::shared_ptr<C
         log_warning("File does not exist: {} ({})", path.c_str(), std::strerror(errno));
         return nullptr;
     }
-    return std::make_unique<FileIOHandler>(path);
+    return MmapIOHandler::createHandler(config, path, statbuf);
 }
 
 std::unique_ptr<ContentPathSetup> ResourceHandler::setup {};
@@ -359,5 +359,5 @@ std::unique_ptr<IOHandler> ResourceHandler::serveContent(const std::shared_ptr<C
         log_warning("File does not exist: {} ({})", path.string(), std::strerror(errno));
         return nullptr;
     }
-    return std::make_unique<FileIOHandler>(path);
+    return MmapIOHandler::createHandler(config, path, statbuf);
 }
@@ -80,8 +80,8 @@ void MetadataHandler::extractMetaData(const std::shared_ptr<Context>& context, c
     item->addResource(resource);
     item->clearMetaData();
 
-    auto mappings = context->getConfig()->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-    std::string contentType = getValueOrDefault(mappings, mimetype);
+    auto snapshot = context->getConfig()->getSnapshot();
+    auto&& contentType = snapshot->getContentType(mimetype);
 
     if ((contentType == CONTENT_TYPE_OGG) && (isTheora(item->getLocation()))) {
         item->setFlag(OBJECT_FLAG_OGG_THEORA);
@@ -82,6 +82,7 @@ class IOHandler;
 #define RESOURCE_HANDLER "rh"
 
 #define ID3_ALBUM_ART "aa"
+#define ALBUM_ART_SIZE "as"
 #define VIDEO_SUB "vs"
 
 #define EXIF_THUMBNAIL "EX_TH"
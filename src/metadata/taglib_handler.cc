@@ -43,6 +43,7 @@
 #include <oggflacfile.h>
 #include <opusfile.h>
 #include <speexfile.h>
+#include <sys/stat.h>
 #include <textidentificationframe.h>
 #include <tfilestream.h>
 #include <tiostream.h>
@@ -52,7 +53,10 @@
 
 #include "cds_objects.h"
 #include "config/config_manager.h"
+#include "album_art_cache.h"
+#include "iohandler/file_io_handler.h"
 #include "iohandler/mem_io_handler.h"
+#include "iohandler/mmap_io_handler.h"
 #include "util/mime.h"
 #include "util/tools.h"
 
@@ -246,8 +250,8 @@ void TagLibHandler::fillMetadata(const std::shared_ptr<CdsObject>& obj)
     if (!item)
         return;
 
-    auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-    std::string contentType = getValueOrDefault(mappings, item->getMimeType());
+    auto snapshot = config->getSnapshot();
+    auto&& contentType = snapshot->getContentType(item->getMimeType());
 
     auto fs = TagLib::FileStream(item->getLocation().c_str(), true); // true = Read only
 
@@ -290,17 +294,49 @@ std::string TagLibHandler::getContentTypeFromByteVector(const TagLib::ByteVector
 #endif
 }
 
-void TagLibHandler::addArtworkResource(const std::shared_ptr<CdsItem>& item, const std::string& artMimetype)
+void TagLibHandler::addArtworkResource(const std::shared_ptr<CdsItem>& item, const std::string& artMimetype, const TagLib::ByteVector& pic) const
 {
     // if we could not determine the mimetype, then there is no
     // point to add the resource - it's probably garbage
     log_debug("Found artwork of type {} in file {}", artMimetype.c_str(), item->getLocation().c_str());
 
-    if (artMimetype != MIMETYPE_DEFAULT) {
-        auto resource = std::make_shared<CdsResource>(CH_ID3);
-        resource->addAttribute(R_PROTOCOLINFO, renderProtocolInfo(artMimetype));
-        resource->addParameter(RESOURCE_CONTENT_TYPE, ID3_ALBUM_ART);
-        item->addResource(resource);
+    if (artMimetype == MIMETYPE_DEFAULT)
+        return;
+
+    auto resource = std::make_shared<CdsResource>(CH_ID3);
+    resource->addAttribute(R_PROTOCOLINFO, renderProtocolInfo(artMimetype));
+    resource->addParameter(RESOURCE_CONTENT_TYPE, ID3_ALBUM_ART);
+    item->addResource(resource);
+
+    // extract the picture once during import, browsing then only reads the cache
+    auto artCache = AlbumArtCache::getInstance(config);
+    if (!artCache)
+        return;
+
+    try {
+        struct stat statbuf;
+        if (stat(item->getLocation().c_str(), &statbuf) != 0)
+            throw_std_runtime_error("Failed to stat {}: {}", item->getLocation().c_str(), std::strerror(errno));
+
+        auto hash = artCache->store(item->getLocation(), statbuf.st_mtime, reinterpret_cast<const std::byte*>(pic.data()), pic.size());
+        for (auto&& size : artCache->getVariantSizes()) {
+            auto variant = artCache->getVariantPath(hash, size);
+            if (!variant)
+                break;
+
+            auto ioHandler = std::make_unique<FileIOHandler>(*variant);
+            ioHandler->open(UPNP_READ);
+            auto resolution = get_jpeg_resolution(std::move(ioHandler));
+
+            auto variantResource = std::make_shared<CdsResource>(CH_ID3);
+            variantResource->addAttribute(R_PROTOCOLINFO, renderProtocolInfo("image/jpeg"));
+            variantResource->addAttribute(R_RESOLUTION, resolution);
+            variantResource->addParameter(RESOURCE_CONTENT_TYPE, ID3_ALBUM_ART);
+            variantResource->addParameter(ALBUM_ART_SIZE, fmt::to_string(size));
+            item->addResource(variantResource);
+        }
+    } catch (const std::runtime_error& e) {
+        log_warning("Failed to cache artwork of {}: {}", item->getLocation().c_str(), e.what());
     }
 }
 
@@ -314,8 +350,52 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(const std::shared_ptr<Cds
     if (!item) // not streamable
         return nullptr;
 
-    auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
-    std::string contentType = getValueOrDefault(mappings, item->getMimeType());
+    auto artCache = AlbumArtCache::getInstance(config);
+    if (!artCache) {
+        auto data = getArtwork(item);
+        return std::make_unique<MemIOHandler>(data.data(), data.size());
+    }
+
+    struct stat statbuf;
+    if (stat(item->getLocation().c_str(), &statbuf) != 0)
+        throw_std_runtime_error("Failed to stat {}: {}", item->getLocation().c_str(), std::strerror(errno));
+
+    auto hash = artCache->lookup(item->getLocation(), statbuf.st_mtime);
+    if (!hash) {
+        auto data = getArtwork(item);
+        try {
+            hash = artCache->store(item->getLocation(), statbuf.st_mtime, reinterpret_cast<const std::byte*>(data.data()), data.size());
+        } catch (const std::runtime_error& e) {
+            log_warning("Failed to cache artwork of {}: {}", item->getLocation().c_str(), e.what());
+            return std::make_unique<MemIOHandler>(data.data(), data.size());
+        }
+    }
+
+    fs::path path = artCache->getPicturePath(*hash);
+    auto resource = (resNum >= 0 && std::size_t(resNum) < item->getResourceCount()) ? item->getResource(resNum) : nullptr;
+    auto size = resource ? resource->getParameter(ALBUM_ART_SIZE) : "";
+    if (!size.empty()) {
+        // only create variants that are configured, the size is not trusted
+        auto edge = AlbumArtCache::parseSize(size);
+        auto&& sizes = artCache->getVariantSizes();
+        if (edge && std::find(sizes.begin(), sizes.end(), *edge) != sizes.end()) {
+            auto variant = artCache->getVariantPath(*hash, *edge);
+            if (variant)
+                path = *variant;
+        } else {
+            log_warning("Rejecting album art size '{}' of {}", size, item->getLocation().c_str());
+        }
+    }
+
+    if (stat(path.c_str(), &statbuf) != 0)
+        throw_std_runtime_error("Failed to stat {}: {}", path.c_str(), std::strerror(errno));
+    return MmapIOHandler::createHandler(config, path, statbuf);
+}
+
+TagLib::ByteVector TagLibHandler::getArtwork(const std::shared_ptr<CdsItem>& item) const
+{
+    auto snapshot = config->getSnapshot();
+    auto&& contentType = snapshot->getContentType(item->getMimeType());
 
     auto roStream = TagLib::FileStream(item->getLocation().c_str(), true); // Open read only
 
@@ -334,11 +414,10 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(const std::shared_ptr<Cds
             throw_std_runtime_error("resource has no album information");
 
         auto art = dynamic_cast<TagLib::ID3v2::AttachedPictureFrame*>(list.front());
-        if (!art) {
-            return nullptr;
-        }
+        if (!art)
+            throw_std_runtime_error("resource has no album information");
 
-        return std::make_unique<MemIOHandler>(art->picture().data(), art->picture().size());
+        return art->picture();
     }
     if (contentType == CONTENT_TYPE_FLAC) {
         // stream album art from FLAC file
@@ -353,7 +432,7 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(const std::shared_ptr<Cds
         const TagLib::FLAC::Picture* pic = f.pictureList().front();
         const TagLib::ByteVector& data = pic->data();
 
-        return std::make_unique<MemIOHandler>(data.data(), data.size());
+        return data;
     }
     if (contentType == CONTENT_TYPE_MP4) {
         // stream album art from MP4 file
@@ -382,7 +461,7 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(const std::shared_ptr<Cds
         const TagLib::MP4::CoverArt& coverArt = coverArtList.front();
         const TagLib::ByteVector& data = coverArt.data();
 
-        return std::make_unique<MemIOHandler>(data.data(), data.size());
+        return data;
     }
     if (contentType == CONTENT_TYPE_WMA) {
         // stream album art from WMA file
@@ -405,7 +484,7 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(const std::shared_ptr<Cds
 
         const TagLib::ByteVector& data = wmpic.picture();
 
-        return std::make_unique<MemIOHandler>(data.data(), data.size());
+        return data;
     }
     if (contentType == CONTENT_TYPE_OGG) {
         // stream album art from Ogg/Vorbis file
@@ -421,7 +500,7 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(const std::shared_ptr<Cds
         const TagLib::FLAC::Picture* pic = picList.front();
         const TagLib::ByteVector& data = pic->data();
 
-        return std::make_unique<MemIOHandler>(data.data(), data.size());
+        return data;
     }
 
     throw_std_runtime_error("Unsupported content_type: {}", contentType.c_str());
@@ -527,7 +606,7 @@ void TagLibHandler::extractMP3(TagLib::IOStream* roStream, const std::shared_ptr
             artMimetype = getContentTypeFromByteVector(pic);
         }
 
-        addArtworkResource(item, artMimetype);
+        addArtworkResource(item, artMimetype, pic);
     }
 }
 
@@ -584,7 +663,7 @@ void TagLibHandler::extractOgg(TagLib::IOStream* roStream, const std::shared_ptr
     if (!isValidArtworkContentType(artMimetype)) {
         artMimetype = getContentTypeFromByteVector(data);
     }
-    addArtworkResource(item, artMimetype);
+    addArtworkResource(item, artMimetype, data);
 }
 
 void TagLibHandler::extractASF(TagLib::IOStream* roStream, const std::shared_ptr<CdsItem>& item) const
@@ -622,7 +701,7 @@ void TagLibHandler::extractASF(TagLib::IOStream* roStream, const std::shared_ptr
         if (!isValidArtworkContentType(artMimetype)) {
             artMimetype = getContentTypeFromByteVector(wmpic.picture());
         }
-        addArtworkResource(item, artMimetype);
+        addArtworkResource(item, artMimetype, wmpic.picture());
     }
 }
 
@@ -658,7 +737,7 @@ void TagLibHandler::extractFLAC(TagLib::IOStream* roStream, const std::shared_pt
     if (!isValidArtworkContentType(artMimetype)) {
         artMimetype = getContentTypeFromByteVector(data);
     }
-    addArtworkResource(item, artMimetype);
+    addArtworkResource(item, artMimetype, data);
 }
 
 void TagLibHandler::extractAPE(TagLib::IOStream* roStream, const std::shared_ptr<CdsItem>& item) const
@@ -744,7 +823,7 @@ void TagLibHandler::extractMP4(TagLib::IOStream* roStream, const std::shared_ptr
         const auto& coverArt = coverArtList.front();
         auto artMimetype = getContentTypeFromByteVector(coverArt.data());
         if (!artMimetype.empty()) {
-            addArtworkResource(item, artMimetype);
+            addArtworkResource(item, artMimetype, coverArt.data());
         }
     } else {
         log_debug("TagLibHandler {}: mp4 file has no 'covr' item",
@@ -71,7 +71,8 @@ private:
     void populateAuxTags(const std::shared_ptr<CdsItem>& item, const TagLib::PropertyMap& propertyMap, const std::unique_ptr<StringConverter>& sc) const;
     static bool isValidArtworkContentType(std::string_view artMimetype);
     std::string getContentTypeFromByteVector(const TagLib::ByteVector& data) const;
-    static void addArtworkResource(const std::shared_ptr<CdsItem>& item, const std::string& artMimetype);
+    void addArtworkResource(const std::shared_ptr<CdsItem>& item, const std::string& artMimetype, const TagLib::ByteVector& pic) const;
+    TagLib::ByteVector getArtwork(const std::shared_ptr<CdsItem>& item) const;
     void extractMP3(TagLib::IOStream* roStream, const std::shared_ptr<CdsItem>& item) const;
     void extractOgg(TagLib::IOStream* roStream, const std::shared_ptr<CdsItem>& item) const;
     void extractASF(TagLib::IOStream* roStream, const std::shared_ptr<CdsItem>& item) const;
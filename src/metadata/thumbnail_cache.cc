@@ -0,0 +1,338 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    thumbnail_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file thumbnail_cache.cc
+
+#include "thumbnail_cache.h" // API
+
+#include <algorithm>
+#include <fstream>
+#include <sys/stat.h>
+
+#include "config/config.h"
+#include "util/tools.h"
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
+#include "ffmpeg_handler.h"
+#endif
+
+// changed access times are written at most that often
+#define THUMBNAIL_CACHE_FLUSH_INTERVAL std::chrono::seconds(60)
+// files without index entry may still be stored right now
+#define THUMBNAIL_CACHE_STRAY_AGE std::chrono::minutes(1)
+
+static std::optional<time_t> getModificationTime(const fs::path& path)
+{
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf) != 0)
+        return std::nullopt;
+    return statbuf.st_mtime;
+}
+
+std::unique_ptr<ThumbnailCache> ThumbnailCache::instance;
+std::once_flag ThumbnailCache::instanceInit;
+
+ThumbnailCache::ThumbnailCache(fs::path baseDir, std::size_t maxSize)
+    : baseDir(std::move(baseDir))
+    , maxSize(maxSize)
+    , lastFlush(std::chrono::steady_clock::now())
+{
+    load();
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    shutdown();
+}
+
+void ThumbnailCache::shutdown()
+{
+    stopCleanup = true;
+    if (cleanupThread.joinable())
+        cleanupThread.join();
+    flush();
+}
+
+ThumbnailCache* ThumbnailCache::getInstance(const std::shared_ptr<Config>& config)
+{
+#if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
+    if (!config->getBoolOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_DIR_ENABLED))
+        return nullptr;
+
+    std::call_once(instanceInit, [&config]() {
+        instance = std::make_unique<ThumbnailCache>(getThumbnailCacheBasePath(*config),
+            config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_CACHE_MAX_SIZE));
+        // checking every media file takes a while on large libraries
+        instance->cleanupThread = std::thread([]() { instance->removeOrphans(); });
+    });
+#endif
+    return instance.get();
+}
+
+void ThumbnailCache::shutdownInstance()
+{
+    std::call_once(instanceInit, []() {});
+    if (instance)
+        instance->shutdown();
+}
+
+fs::path ThumbnailCache::getThumbnailPath(const std::string& hash) const
+{
+    return baseDir / "thumbs" / hash.substr(0, 2) / fmt::format("{}.jpg", hash);
+}
+
+void ThumbnailCache::load()
+{
+    auto file = std::ifstream(getIndexPath());
+    if (!file)
+        return;
+
+    std::vector<std::pair<std::string, Entry>> loaded;
+    std::string hash;
+    Entry entry;
+    std::string movie;
+    while (file >> hash >> entry.mtime >> entry.size >> entry.lastAccess && std::getline(file >> std::ws, movie)) {
+        entry.movie = movie;
+        loaded.emplace_back(hash, entry);
+    }
+
+    std::stable_sort(loaded.begin(), loaded.end(), [](auto&& a, auto&& b) { return a.second.lastAccess > b.second.lastAccess; });
+    for (auto&& [entryHash, loadedEntry] : loaded) {
+        if (entries.find(entryHash) != entries.end())
+            continue;
+        lru.push_back(entryHash);
+        loadedEntry.lruPos = std::prev(lru.end());
+        cacheSize += loadedEntry.size;
+        entries.emplace(entryHash, std::move(loadedEntry));
+    }
+    log_debug("Loaded {} thumbnails with {} bytes from {}", entries.size(), cacheSize, getIndexPath().c_str());
+
+    while (maxSize > 0 && cacheSize > maxSize && !lru.empty())
+        erase(entries.find(lru.back()));
+}
+
+std::optional<fs::path> ThumbnailCache::lookup(const fs::path& movie)
+{
+    auto mtime = getModificationTime(movie);
+    if (!mtime)
+        return std::nullopt;
+
+    auto hash = hexStringMd5(movie.string());
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    auto it = entries.find(hash);
+    // guard against md5 collisions of the media file name
+    if (it == entries.end() || it->second.movie != movie)
+        return std::nullopt;
+    if (it->second.mtime != *mtime) {
+        log_debug("Thumbnail of modified file {} is outdated", movie.c_str());
+        erase(it);
+        return std::nullopt;
+    }
+
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    it->second.lastAccess = currentTime().count();
+    dirty = true;
+    flushLater(lock);
+    return getThumbnailPath(hash);
+}
+
+bool ThumbnailCache::contains(const fs::path& movie) const
+{
+    auto mtime = getModificationTime(movie);
+    if (!mtime)
+        return false;
+
+    auto hash = hexStringMd5(movie.string());
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = entries.find(hash);
+    return it != entries.end() && it->second.movie == movie && it->second.mtime == *mtime;
+}
+
+void ThumbnailCache::store(const fs::path& movie, const std::byte* data, std::size_t size)
+{
+    auto mtime = getModificationTime(movie);
+    if (!mtime)
+        return;
+
+    auto hash = hexStringMd5(movie.string());
+    auto path = getThumbnailPath(hash);
+    try {
+        fs::create_directories(path.parent_path());
+        // readers must never see a partial file
+        auto tmpPath = path;
+        tmpPath += fmt::format(".{}", generateRandomId());
+        GrbFile(tmpPath).writeBinaryFile(data, size);
+        std::error_code ec;
+        fs::rename(tmpPath, path, ec);
+        if (ec) {
+            fs::remove(tmpPath, ec);
+            log_error("Failed to store thumbnail {}: {}", path.c_str(), ec.message());
+            return;
+        }
+    } catch (const std::runtime_error& e) {
+        log_error("Failed to write thumbnail cache: {}", e.what());
+        return;
+    }
+
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    auto it = entries.find(hash);
+    if (it != entries.end())
+        erase(it, false);
+
+    lru.push_front(hash);
+    entries[hash] = Entry { movie, *mtime, size, currentTime().count(), lru.begin() };
+    cacheSize += size;
+    dirty = true;
+
+    // the new thumbnail is kept even if it exceeds the size on its own
+    while (maxSize > 0 && cacheSize > maxSize && lru.size() > 1)
+        erase(entries.find(lru.back()));
+    flushLater(lock);
+}
+
+void ThumbnailCache::remove(const fs::path& movie)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = entries.find(hexStringMd5(movie.string()));
+    if (it != entries.end() && it->second.movie == movie)
+        erase(it);
+}
+
+void ThumbnailCache::erase(std::unordered_map<std::string, Entry>::iterator it, bool removeFile)
+{
+    if (removeFile) {
+        std::error_code ec;
+        fs::remove(getThumbnailPath(it->first), ec);
+    }
+    cacheSize -= it->second.size;
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+    dirty = true;
+}
+
+std::size_t ThumbnailCache::removeOrphans()
+{
+    std::vector<std::pair<std::string, fs::path>> known;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        known.reserve(entries.size());
+        for (auto&& [hash, entry] : entries)
+            known.emplace_back(hash, entry.movie);
+    }
+
+    std::size_t removed = 0;
+    for (auto&& [hash, movie] : known) {
+        if (stopCleanup)
+            return removed;
+        // the media may be on a file system which is not mounted right now
+        std::error_code ec;
+        if (fs::exists(movie, ec) || ec)
+            continue;
+
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto it = entries.find(hash);
+        if (it != entries.end() && it->second.movie == movie) {
+            log_debug("Removing thumbnail of deleted file {}", movie.c_str());
+            erase(it);
+            removed++;
+        }
+    }
+
+    // thumbnails stored after the last index was written
+    std::error_code ec;
+    auto strayTime = fs::file_time_type::clock::now() - THUMBNAIL_CACHE_STRAY_AGE;
+    for (auto&& dirEnt : fs::recursive_directory_iterator(baseDir / "thumbs", ec)) {
+        if (stopCleanup)
+            return removed;
+        std::error_code entryEc;
+        if (!dirEnt.is_regular_file(entryEc) || dirEnt.last_write_time(entryEc) > strayTime || entryEc)
+            continue;
+
+        auto hash = dirEnt.path().stem().string();
+        bool stray;
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            stray = dirEnt.path().extension() != ".jpg" || entries.find(hash) == entries.end();
+        }
+        if (stray && fs::remove(dirEnt.path(), entryEc))
+            removed++;
+    }
+
+    if (removed > 0)
+        log_info("Removed {} orphaned thumbnails from {}", removed, baseDir.c_str());
+    flush();
+    return removed;
+}
+
+void ThumbnailCache::flushLater(std::unique_lock<std::mutex>& lock)
+{
+    if (!dirty || std::chrono::steady_clock::now() - lastFlush < THUMBNAIL_CACHE_FLUSH_INTERVAL) {
+        lock.unlock();
+        return;
+    }
+    // keep other threads from flushing, too
+    lastFlush = std::chrono::steady_clock::now();
+    lock.unlock();
+    flush();
+}
+
+void ThumbnailCache::flush()
+{
+    auto flushLock = std::lock_guard<std::mutex>(flushMutex);
+    std::string index;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        if (!dirty)
+            return;
+        for (auto&& hash : lru) {
+            auto&& entry = entries.at(hash);
+            index += fmt::format("{} {} {} {} {}\n", hash, entry.mtime, entry.size, entry.lastAccess, entry.movie.string());
+        }
+        dirty = false;
+        lastFlush = std::chrono::steady_clock::now();
+    }
+
+    try {
+        fs::create_directories(baseDir);
+        auto tmpPath = getIndexPath();
+        tmpPath += fmt::format(".{}", generateRandomId());
+        GrbFile(tmpPath).writeTextFile(index);
+        fs::rename(tmpPath, getIndexPath());
+    } catch (const std::exception& e) {
+        log_error("Failed to write thumbnail index: {}", e.what());
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        dirty = true;
+    }
+}
+
+std::size_t ThumbnailCache::getCacheSize() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return cacheSize;
+}
+
+std::size_t ThumbnailCache::getEntryCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return entries.size();
+}
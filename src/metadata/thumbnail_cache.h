@@ -0,0 +1,133 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    thumbnail_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file thumbnail_cache.h
+/// \brief Definition of the ThumbnailCache class.
+
+#ifndef __THUMBNAIL_CACHE_H__
+#define __THUMBNAIL_CACHE_H__
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "util/grb_fs.h"
+
+// forward declaration
+class Config;
+
+/// \brief size bounded on disk store for generated video thumbnails
+///
+/// Thumbnails are stored by the hash of the media path in 256 shard
+/// directories. An index file keeps the modification time of the media
+/// file, the size and the last access of every thumbnail, so the least
+/// recently used thumbnails can be removed if the cache exceeds its size.
+class ThumbnailCache {
+public:
+    /// \param baseDir directory of the cache
+    /// \param maxSize upper limit for the sum of all thumbnails in bytes, 0 for no limit
+    ThumbnailCache(fs::path baseDir, std::size_t maxSize);
+    ~ThumbnailCache();
+
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    /// \brief get the thumbnail of movie and mark it as used
+    /// \return std::nullopt if nothing is stored or movie was modified since
+    std::optional<fs::path> lookup(const fs::path& movie);
+
+    /// \brief check for a thumbnail of movie without marking it as used
+    bool contains(const fs::path& movie) const;
+
+    /// \brief store the thumbnail of movie, may remove the least recently used thumbnails
+    void store(const fs::path& movie, const std::byte* data, std::size_t size);
+
+    /// \brief remove the thumbnail of movie
+    void remove(const fs::path& movie);
+
+    /// \brief remove thumbnails of deleted media and files missing in the index
+    /// \return number of removed thumbnails
+    std::size_t removeOrphans();
+
+    /// \brief write the index if it was changed
+    void flush();
+
+    /// \brief stop removing orphans and write the index
+    void shutdown();
+
+    std::size_t getCacheSize() const;
+    std::size_t getEntryCount() const;
+
+    /// \brief path of a thumbnail in the cache
+    fs::path getThumbnailPath(const std::string& hash) const;
+
+    /// \brief get the cache instance if enabled in the configuration
+    /// \return nullptr after shutdownInstance() if the cache was not used before
+    static ThumbnailCache* getInstance(const std::shared_ptr<Config>& config);
+    /// \brief shut down the cache instance, called on server shutdown
+    static void shutdownInstance();
+
+private:
+    struct Entry {
+        fs::path movie;
+        time_t mtime;
+        std::size_t size;
+        time_t lastAccess;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    fs::path baseDir;
+    std::size_t maxSize;
+    std::size_t cacheSize {};
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    /// \brief hash of the most recently used thumbnail at the front
+    std::list<std::string> lru;
+    bool dirty {};
+    std::chrono::steady_clock::time_point lastFlush;
+    /// \brief serializes writing the index
+    std::mutex flushMutex;
+
+    /// \brief removes orphans after loading the index
+    std::thread cleanupThread;
+    std::atomic_bool stopCleanup {};
+
+    fs::path getIndexPath() const { return baseDir / "index"; }
+    void load();
+    /// \param removeFile false if the file was replaced already
+    void erase(std::unordered_map<std::string, Entry>::iterator it, bool removeFile = true);
+    /// \brief flush if the index was not written for some time, releases the lock
+    void flushLater(std::unique_lock<std::mutex>& lock);
+
+    static std::unique_ptr<ThumbnailCache> instance;
+    static std::once_flag instanceInit;
+};
+
+#endif // __THUMBNAIL_CACHE_H__
@@ -0,0 +1,186 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    thumbnail_worker_pool.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file thumbnail_worker_pool.cc
+
+#include "thumbnail_worker_pool.h" // API
+
+#include <algorithm>
+
+#include "config/config.h"
+#include "exceptions.h"
+#include "util/tools.h"
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
+#include "ffmpeg_handler.h"
+#endif
+
+// limits the memory used by an import of many videos
+#define THUMBNAIL_MAX_QUEUED_PREGENERATIONS 10000
+
+ThumbnailWorkerPool::ThumbnailWorkerPool(std::size_t workers, std::size_t maxQueued, Generator generator)
+    : maxQueued(maxQueued)
+    , generator(std::move(generator))
+{
+    if (workers == 0)
+        throw_std_runtime_error("The thumbnail worker pool needs at least one worker");
+
+    for (std::size_t i = 0; i < workers; i++)
+        this->workers.emplace_back(&ThumbnailWorkerPool::threadProc, this);
+}
+
+ThumbnailWorkerPool::~ThumbnailWorkerPool()
+{
+    shutdown();
+}
+
+void ThumbnailWorkerPool::shutdown()
+{
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        if (shutdownFlag)
+            return;
+        shutdownFlag = true;
+    }
+    jobQueued.notify_all();
+    jobDone.notify_all();
+
+    for (auto&& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+std::vector<std::byte> ThumbnailWorkerPool::get(const fs::path& file)
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    if (shutdownFlag)
+        throw ServerShutdownException("Thumbnails are not generated during shutdown");
+
+    std::shared_ptr<Job> job;
+    auto it = jobs.find(file);
+    if (it != jobs.end()) {
+        job = it->second;
+        log_debug("Waiting for thumbnail of {}", file.c_str());
+        // a client is waiting now, so the job must not wait for other pregenerations
+        if (!job->requested && !job->running) {
+            pregenerateQueue.erase(std::find(pregenerateQueue.begin(), pregenerateQueue.end(), job));
+            requestQueue.push_back(job);
+        }
+        job->requested = true;
+    } else {
+        job = std::make_shared<Job>();
+        job->file = file;
+        job->requested = true;
+        jobs[file] = job;
+        requestQueue.push_back(job);
+        jobQueued.notify_one();
+    }
+
+    jobDone.wait(lock, [this, &job]() { return job->done || shutdownFlag; });
+    if (!job->done)
+        throw ServerShutdownException(fmt::format("Thumbnail of {} was not generated before shutdown", file.c_str()));
+    if (job->error)
+        std::rethrow_exception(job->error);
+    return job->result;
+}
+
+bool ThumbnailWorkerPool::pregenerate(const fs::path& file)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (shutdownFlag)
+        return false;
+    if (jobs.find(file) != jobs.end())
+        return true;
+    if (pregenerateQueue.size() >= maxQueued)
+        return false;
+
+    auto job = std::make_shared<Job>();
+    job->file = file;
+    jobs[file] = job;
+    pregenerateQueue.push_back(job);
+    jobQueued.notify_one();
+    return true;
+}
+
+std::size_t ThumbnailWorkerPool::getJobCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return jobs.size();
+}
+
+void ThumbnailWorkerPool::threadProc()
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    while (true) {
+        jobQueued.wait(lock, [this]() { return shutdownFlag || !requestQueue.empty() || !pregenerateQueue.empty(); });
+        if (shutdownFlag)
+            break;
+
+        auto& queue = requestQueue.empty() ? pregenerateQueue : requestQueue;
+        auto job = queue.front();
+        queue.pop_front();
+        job->running = true;
+
+        lock.unlock();
+        std::vector<std::byte> result;
+        std::exception_ptr error;
+        try {
+            log_debug("Generating thumbnail for file: {}", job->file.c_str());
+            result = generator(job->file);
+        } catch (const std::exception& e) {
+            log_warning("Failed to generate thumbnail for {}: {}", job->file.c_str(), e.what());
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        job->result = std::move(result);
+        job->error = std::move(error);
+        job->done = true;
+        jobs.erase(job->file);
+        if (job->requested)
+            jobDone.notify_all();
+    }
+}
+
+std::unique_ptr<ThumbnailWorkerPool> ThumbnailWorkerPool::instance;
+std::once_flag ThumbnailWorkerPool::instanceInit;
+
+ThumbnailWorkerPool* ThumbnailWorkerPool::getInstance(const std::shared_ptr<Config>& config)
+{
+#if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEGTHUMBNAILER)
+    std::call_once(instanceInit, [&config]() {
+        instance = std::make_unique<ThumbnailWorkerPool>(
+            config->getIntOption(CFG_SERVER_EXTOPTS_FFMPEGTHUMBNAILER_WORKERS), THUMBNAIL_MAX_QUEUED_PREGENERATIONS,
+            [config](const fs::path& file) { return generateThumbnail(config, file); });
+    });
+#endif
+    return instance.get();
+}
+
+void ThumbnailWorkerPool::shutdownInstance()
+{
+    // the pool must not be started by a late request anymore
+    std::call_once(instanceInit, []() {});
+    if (instance)
+        instance->shutdown();
+}
@@ -0,0 +1,116 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    thumbnail_worker_pool.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file thumbnail_worker_pool.h
+/// \brief Definition of the ThumbnailWorkerPool class.
+
+#ifndef __THUMBNAIL_WORKER_POOL_H__
+#define __THUMBNAIL_WORKER_POOL_H__
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util/grb_fs.h"
+
+// forward declaration
+class Config;
+
+/// \brief generates thumbnails in a fixed number of worker threads
+///
+/// Requests for a file which is already queued or generated wait for the
+/// same job instead of generating the thumbnail again. Thumbnails can also
+/// be queued in advance during the import, these jobs are only started if
+/// no client is waiting for a thumbnail.
+class ThumbnailWorkerPool {
+public:
+    /// \brief creates the thumbnail of a file, called by the workers
+    using Generator = std::function<std::vector<std::byte>(const fs::path& file)>;
+
+    /// \param workers number of worker threads
+    /// \param maxQueued maximum number of queued pregenerations
+    ThumbnailWorkerPool(std::size_t workers, std::size_t maxQueued, Generator generator);
+    ~ThumbnailWorkerPool();
+
+    ThumbnailWorkerPool(const ThumbnailWorkerPool&) = delete;
+    ThumbnailWorkerPool& operator=(const ThumbnailWorkerPool&) = delete;
+
+    /// \brief get the thumbnail of file, waits until it is generated
+    /// \throws ServerShutdownException if the pool was shut down before the thumbnail was generated
+    /// \throws the exception of the generator if the generation failed
+    std::vector<std::byte> get(const fs::path& file);
+
+    /// \brief generate the thumbnail of file in the background
+    /// \return false if too many pregenerations are queued already
+    bool pregenerate(const fs::path& file);
+
+    /// \brief number of queued and running jobs
+    std::size_t getJobCount() const;
+
+    /// \brief stop the workers, the remaining pregenerations are dropped
+    void shutdown();
+
+    /// \brief get the pool for ffmpegthumbnailer
+    /// \return nullptr after shutdownInstance() if the pool was not used before
+    static ThumbnailWorkerPool* getInstance(const std::shared_ptr<Config>& config);
+    /// \brief stop the workers of the pool for ffmpegthumbnailer, called on server shutdown
+    static void shutdownInstance();
+
+private:
+    struct Job {
+        fs::path file;
+        /// \brief a client waits for the thumbnail
+        bool requested {};
+        bool running {};
+        bool done {};
+        std::vector<std::byte> result;
+        /// \brief set if the generator failed, rethrown to all clients
+        std::exception_ptr error;
+    };
+
+    std::size_t maxQueued;
+    Generator generator;
+
+    mutable std::mutex mutex;
+    std::condition_variable jobQueued;
+    std::condition_variable jobDone;
+    /// \brief queued and running jobs by file
+    std::map<fs::path, std::shared_ptr<Job>> jobs;
+    std::deque<std::shared_ptr<Job>> requestQueue;
+    std::deque<std::shared_ptr<Job>> pregenerateQueue;
+    bool shutdownFlag {};
+    std::vector<std::thread> workers;
+
+    void threadProc();
+
+    static std::unique_ptr<ThumbnailWorkerPool> instance;
+    static std::once_flag instanceInit;
+};
+
+#endif // __THUMBNAIL_WORKER_POOL_H__
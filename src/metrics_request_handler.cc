@@ -0,0 +1,58 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    metrics_request_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file metrics_request_handler.cc
+
+#include "metrics_request_handler.h" // API
+
+#include "iohandler/mem_io_handler.h"
+#include "util/metrics.h"
+
+MetricsRequestHandler::MetricsRequestHandler(std::shared_ptr<ContentManager> content)
+    : RequestHandler(std::move(content))
+{
+}
+
+void MetricsRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
+{
+    UpnpFileInfo_set_FileLength(info, -1); // length is unknown
+    UpnpFileInfo_set_IsReadable(info, 1);
+    UpnpFileInfo_set_IsDirectory(info, 0);
+
+    std::string contentType = "text/plain; version=0.0.4";
+
+#ifdef USING_NPUPNP
+    info->content_type = std::move(contentType);
+#else
+    UpnpFileInfo_set_ContentType(info, contentType.c_str());
+#endif
+}
+
+std::unique_ptr<IOHandler> MetricsRequestHandler::open(const char* filename, enum UpnpOpenFileMode mode)
+{
+    log_debug("Metrics requested");
+
+    auto ioHandler = std::make_unique<MemIOHandler>(Metrics::getInstance()->renderPrometheus());
+    ioHandler->open(mode);
+    return ioHandler;
+}
@@ -0,0 +1,41 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    metrics_request_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file metrics_request_handler.h
+
+#ifndef __METRICS_REQUEST_HANDLER_H__
+#define __METRICS_REQUEST_HANDLER_H__
+
+#include "request_handler.h"
+#include <memory>
+
+/// \brief serves all metrics in Prometheus text format
+class MetricsRequestHandler : public RequestHandler {
+public:
+    explicit MetricsRequestHandler(std::shared_ptr<ContentManager> content);
+
+    void getInfo(const char* filename, UpnpFileInfo* info) override;
+    std::unique_ptr<IOHandler> open(const char* filename, enum UpnpOpenFileMode mode) override;
+};
+
+#endif // __METRICS_REQUEST_HANDLER_H__
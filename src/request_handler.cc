@@ -33,6 +33,7 @@
 
 #include "content/content_manager.h"
 #include "database/database.h"
+#include "database/object_cache.h"
 #include "util/tools.h"
 
 #include <fmt/core.h>
@@ -88,5 +89,8 @@ std::shared_ptr<CdsObject> RequestHandler::getObjectById(const std::map<std::str
     }
 
     int objectID = std::stoi(it->second);
+    auto objectCache = content->getObjectCache();
+    if (objectCache)
+        return objectCache->get(objectID, [this, objectID]() { return database->loadObject(objectID); });
     return database->loadObject(objectID);
 }
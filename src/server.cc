@@ -47,6 +47,7 @@
 #include "database/database.h"
 #include "device_description_handler.h"
 #include "file_request_handler.h"
+#include "metrics_request_handler.h"
 #include "util/mime.h"
 #include "util/upnp_clients.h"
 #include "web/pages.h"
@@ -301,6 +302,9 @@ void Server::shutdown()
 
     log_debug("Server shutting down");
 
+    // web server threads must not wait for ui events
+    session_manager->shutdown();
+
     ret = UpnpUnRegisterClient(clientHandle);
     if (ret != UPNP_E_SUCCESS) {
         log_error("UpnpUnRegisterClient failed ({})", ret);
@@ -311,10 +315,6 @@ void Server::shutdown()
         log_error("UpnpUnRegisterRootDevice failed ({})", ret);
     }
 
-#ifdef HAVE_CURL
-    curl_global_cleanup();
-#endif
-
     log_debug("now calling upnp finish");
     UpnpFinish();
 
@@ -323,6 +323,11 @@ void Server::shutdown()
         content = nullptr;
     }
 
+    // the curl engine of the content manager is stopped now
+#ifdef HAVE_CURL
+    curl_global_cleanup();
+#endif
+
     session_manager = nullptr;
 
     if (database->threadCleanupRequired()) {
@@ -502,6 +507,11 @@ std::unique_ptr<RequestHandler> Server::createRequestHandler(const char* filenam
         return std::make_unique<DeviceDescriptionHandler>(content, xmlbuilder);
     }
 
+    // served without UI session like the media files, documented for <metrics enabled="yes"/>
+    if (config->getBoolOption(CFG_SERVER_METRICS_ENABLED) && startswith(link, fmt::format("/{}/{}", SERVER_VIRTUAL_DIR, CONTENT_METRICS_HANDLER))) {
+        return std::make_unique<MetricsRequestHandler>(content);
+    }
+
 #if defined(HAVE_CURL)
     if (startswith(link, fmt::format("/{}/{}", SERVER_VIRTUAL_DIR, CONTENT_ONLINE_HANDLER))) {
         return std::make_unique<URLRequestHandler>(content);
@@ -526,6 +536,13 @@ int Server::registerVirtualDirCallbacks()
         } catch (const SubtitlesNotFoundException& sex) {
             log_warning("{}", sex.what());
             return -1;
+        } catch (const TranscodingRejectedException& tex) {
+            log_warning("{}", tex.what());
+            return -1;
+        } catch (const InvalidSeekRangeException& rex) {
+            // the callback can not choose the status, so this is no 416 response
+            log_warning("{}", rex.what());
+            return -1;
         } catch (const std::runtime_error& e) {
             log_error("{}", e.what());
             return -1;
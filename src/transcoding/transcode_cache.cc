@@ -0,0 +1,498 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_cache.cc
+
+#include "transcode_cache.h" // API
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "config/config.h"
+#include "transcoding.h"
+#include "util/tools.h"
+
+#define TRANSCODE_CACHE_CHUNK_SIZE 65536
+#define TRANSCODE_CACHE_PART_SUFFIX ".part"
+
+static constexpr auto readTimeout = std::chrono::seconds(2);
+
+static fs::path getPartPath(const fs::path& path)
+{
+    auto partPath = path;
+    partPath += TRANSCODE_CACHE_PART_SUFFIX;
+    return partPath;
+}
+
+TranscodeCacheIOHandler::TranscodeCacheIOHandler(std::shared_ptr<TranscodeCacheEntry> entry, int fd)
+    : entry(std::move(entry))
+    , fd(fd)
+{
+}
+
+TranscodeCacheIOHandler::~TranscodeCacheIOHandler()
+{
+    if (fd >= 0) {
+        ::close(fd);
+        release();
+    }
+}
+
+void TranscodeCacheIOHandler::release()
+{
+    auto lock = std::lock_guard<std::mutex>(entry->mutex);
+    entry->readers--;
+}
+
+void TranscodeCacheIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    if (mode != UPNP_READ)
+        throw_std_runtime_error("open: UpnpOpenFileMode mode not supported");
+    if (fd < 0)
+        throw_std_runtime_error("open: {} already closed", entry->path.c_str());
+    pos = 0;
+}
+
+std::size_t TranscodeCacheIOHandler::read(char* buf, std::size_t length)
+{
+    auto lock = std::unique_lock<std::mutex>(entry->mutex);
+    if (!entry->cond.wait_for(lock, readTimeout, [this] { return entry->size > pos || entry->complete || entry->failed; }))
+        return CHECK_SOCKET;
+
+    if (entry->size <= pos)
+        return entry->failed ? -1 : 0;
+
+    auto available = std::size_t(entry->size - pos);
+    lock.unlock();
+
+    auto bytesRead = pread(fd, buf, std::min(length, available), pos);
+    if (bytesRead < 0) {
+        log_error("Failed to read {}: {}", entry->path.c_str(), std::strerror(errno));
+        return -1;
+    }
+    pos += bytesRead;
+    return bytesRead;
+}
+
+void TranscodeCacheIOHandler::seek(off_t offset, int whence)
+{
+    auto lock = std::lock_guard<std::mutex>(entry->mutex);
+    off_t target;
+    if (whence == SEEK_SET)
+        target = offset;
+    else if (whence == SEEK_CUR)
+        target = pos + offset;
+    else if (whence == SEEK_END && entry->complete)
+        target = entry->size + offset;
+    else
+        throw_std_runtime_error("seek failed: unsupported whence {} for {}", whence, entry->path.c_str());
+
+    if (target < 0)
+        throw_std_runtime_error("seek failed: trying to seek before the beginning of file");
+    if (target > entry->size)
+        throw_std_runtime_error("seek failed: {} is only available up to {}", entry->path.c_str(), entry->size);
+
+    pos = target;
+}
+
+off_t TranscodeCacheIOHandler::tell()
+{
+    return pos;
+}
+
+void TranscodeCacheIOHandler::close()
+{
+    if (fd < 0)
+        return;
+    if (::close(fd) != 0)
+        log_debug("Failed to close {}: {}", entry->path.c_str(), std::strerror(errno));
+    fd = -1;
+    release();
+}
+
+std::unique_ptr<TranscodeCache> TranscodeCache::instance;
+std::once_flag TranscodeCache::instanceInit;
+
+TranscodeCache* TranscodeCache::getInstance(const std::shared_ptr<Config>& config)
+{
+    if (!config->getBoolOption(CFG_TRANSCODING_CACHE_ENABLED))
+        return nullptr;
+
+    std::call_once(instanceInit, [&config]() {
+        fs::path dir = config->getOption(CFG_TRANSCODING_CACHE_DIR);
+        if (dir.empty())
+            dir = fs::path(config->getOption(CFG_SERVER_HOME)) / "transcode-cache";
+        instance = std::make_unique<TranscodeCache>(dir, off_t(config->getIntOption(CFG_TRANSCODING_CACHE_SIZE)) * 1024 * 1024);
+    });
+    return instance.get();
+}
+
+TranscodeCache::TranscodeCache(fs::path baseDir, off_t maxSize)
+    : baseDir(std::move(baseDir))
+    , maxSize(maxSize)
+{
+    loadEntries();
+}
+
+TranscodeCache::~TranscodeCache()
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    shutdownFlag = true;
+    writerDone.wait(lock, [this] { return writers == 0; });
+}
+
+std::string TranscodeCache::makeKey(const std::shared_ptr<TranscodingProfile>& profile, const fs::path& location, time_t mtime, const std::string& range, double start)
+{
+    auto key = fmt::format("{}\n{}\n{}\n{}\n{}\n{}", location.string(), mtime, profile->getName(), profile->getCommand().string(), profile->getArguments(), range);
+    // keys of outputs starting at the beginning stay the same as before
+    if (start > 0)
+        key += fmt::format("\n{:.3f}", start);
+    return hexStringMd5(key);
+}
+
+void TranscodeCache::loadEntries()
+{
+    std::error_code ec;
+    fs::create_directories(baseDir, ec);
+    if (ec)
+        throw_std_runtime_error("Failed to create transcode cache {}: {}", baseDir.c_str(), ec.message());
+
+    auto files = std::vector<fs::directory_entry>();
+    for (auto&& dirEnt : fs::directory_iterator(baseDir, ec)) {
+        auto&& path = dirEnt.path();
+        if (!dirEnt.is_regular_file(ec))
+            continue;
+        // output of a transcoder that was interrupted
+        if (path.extension() == TRANSCODE_CACHE_PART_SUFFIX) {
+            fs::remove(path, ec);
+            continue;
+        }
+
+        files.push_back(dirEnt);
+    }
+    // oldest outputs are removed first
+    std::sort(files.begin(), files.end(), [](auto&& a, auto&& b) {
+        std::error_code ec;
+        return a.last_write_time(ec) < b.last_write_time(ec);
+    });
+
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    for (auto&& dirEnt : files) {
+        auto key = dirEnt.path().filename().string();
+        auto entry = std::make_shared<TranscodeCacheEntry>(key, dirEnt.path(), ++useCounter);
+        entry->size = off_t(dirEnt.file_size(ec));
+        entry->complete = true;
+        entries[key] = entry;
+        cacheSize += entry->size;
+    }
+    evict(lock, 0);
+    log_debug("Transcode cache {} contains {} outputs with {} bytes", baseDir.c_str(), entries.size(), cacheSize);
+}
+
+std::unique_ptr<IOHandler> TranscodeCache::openReader(const std::shared_ptr<TranscodeCacheEntry>& entry)
+{
+    entry->lastUsed = ++useCounter;
+
+    auto entryLock = std::lock_guard<std::mutex>(entry->mutex);
+    if (entry->failed)
+        return nullptr;
+
+    int fd = ::open((entry->complete ? entry->path : getPartPath(entry->path)).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_warning("Failed to open {}: {}", entry->path.c_str(), std::strerror(errno));
+        return nullptr;
+    }
+    entry->readers++;
+    return std::make_unique<TranscodeCacheIOHandler>(entry, fd);
+}
+
+std::unique_ptr<IOHandler> TranscodeCache::serve(const std::string& key, const TranscoderFactory& transcoder)
+{
+    std::shared_ptr<TranscodeCacheEntry> entry;
+    std::unique_ptr<IOHandler> reader;
+    int writeFd = -1;
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        if (shutdownFlag)
+            throw_std_runtime_error("Transcode cache is shutting down");
+
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            // readers joining an output whose transcoder is still starting
+            // wait for data like for a running transcoder
+            reader = openReader(it->second);
+            if (reader) {
+                log_debug("Serving {} from transcode cache", key);
+                return reader;
+            }
+            // the broken output is removed by its writer, serve uncached meanwhile
+        } else {
+            entry = std::make_shared<TranscodeCacheEntry>(key, baseDir / key, ++useCounter);
+            auto partPath = getPartPath(entry->path);
+            writeFd = ::open(partPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+            if (writeFd < 0) {
+                log_warning("Failed to create {}: {}", partPath.c_str(), std::strerror(errno));
+                entry.reset();
+            } else {
+                entries[key] = entry;
+                reader = openReader(entry);
+                if (!reader) {
+                    ::close(writeFd);
+                    entries.erase(key);
+                    fs::remove(partPath);
+                    throw_std_runtime_error("Failed to open {}", partPath.c_str());
+                }
+                // the destructor waits for the transcoder to be started
+                writers++;
+            }
+        }
+    }
+
+    // starting a transcoder can take long, so it is not done under the lock
+    if (!entry)
+        return transcoder();
+
+    std::unique_ptr<IOHandler> source;
+    try {
+        source = transcoder();
+    } catch (const std::runtime_error&) {
+        ::close(writeFd);
+        {
+            auto lock = std::lock_guard<std::mutex>(entry->mutex);
+            entry->failed = true;
+        }
+        entry->cond.notify_all();
+        remove(entry, 0);
+
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        writers--;
+        writerDone.notify_all();
+        throw;
+    }
+
+    std::thread([this, entry, writeFd, source = std::move(source)]() mutable {
+        writeOutput(entry, writeFd, std::move(source));
+    }).detach();
+
+    log_debug("Writing transcoding output to {}", getPartPath(entry->path).c_str());
+    return reader;
+}
+
+void TranscodeCache::writeOutput(const std::shared_ptr<TranscodeCacheEntry>& entry, int fd, std::unique_ptr<IOHandler> transcoder)
+{
+    bool ok = false;
+    off_t reserved = 0;
+    try {
+        transcoder->open(UPNP_READ);
+        auto buffer = std::vector<char>(TRANSCODE_CACHE_CHUNK_SIZE);
+        while (true) {
+            {
+                auto lock = std::lock_guard<std::mutex>(mutex);
+                if (shutdownFlag)
+                    break;
+            }
+            {
+                // mark the output as failed at once, so no new reader joins it
+                auto lock = std::lock_guard<std::mutex>(entry->mutex);
+                if (entry->readers == 0) {
+                    log_debug("Stopping transcoding to {}, no readers left", entry->path.c_str());
+                    entry->failed = true;
+                    break;
+                }
+            }
+
+            auto bytesRead = transcoder->read(buffer.data(), buffer.size());
+            if (bytesRead == std::size_t(CHECK_SOCKET))
+                continue;
+            if (bytesRead == 0) {
+                ok = true;
+                break;
+            }
+            if (bytesRead == std::size_t(-1)) {
+                log_warning("Transcoding of {} failed", entry->path.c_str());
+                break;
+            }
+
+            if (!reserve(entry, off_t(bytesRead))) {
+                log_warning("Transcoding output {} does not fit into cache of {} bytes", entry->path.c_str(), maxSize);
+                break;
+            }
+            reserved += off_t(bytesRead);
+
+            std::size_t written = 0;
+            while (written < bytesRead) {
+                auto ret = ::write(fd, buffer.data() + written, bytesRead - written);
+                if (ret < 0 && errno == EINTR)
+                    continue;
+                if (ret < 0)
+                    throw_std_runtime_error("Failed to write {}: {}", entry->path.c_str(), std::strerror(errno));
+                written += ret;
+            }
+
+            {
+                auto lock = std::lock_guard<std::mutex>(entry->mutex);
+                entry->size += off_t(bytesRead);
+            }
+            entry->cond.notify_all();
+        }
+    } catch (const std::runtime_error& e) {
+        log_error("Transcode cache: {}", e.what());
+        ok = false;
+    }
+
+    ::close(fd);
+    try {
+        transcoder->close();
+    } catch (const std::runtime_error& e) {
+        log_debug("{}", e.what());
+    }
+
+    {
+        auto lock = std::lock_guard<std::mutex>(entry->mutex);
+        // rename while locked, new readers open the part file until completed
+        std::error_code ec;
+        if (ok)
+            fs::rename(getPartPath(entry->path), entry->path, ec);
+        if (ec)
+            log_error("Failed to complete {}: {}", entry->path.c_str(), ec.message());
+        entry->complete = ok && !ec;
+        entry->failed = !entry->complete;
+    }
+    entry->cond.notify_all();
+
+    if (entry->failed)
+        remove(entry, reserved);
+    else
+        log_debug("Transcoding output {} complete with {} bytes", entry->path.c_str(), entry->size);
+
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    writers--;
+    writerDone.notify_all();
+}
+
+bool TranscodeCache::reserve(const std::shared_ptr<TranscodeCacheEntry>& entry, off_t bytes)
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    if (cacheSize + bytes > maxSize)
+        evict(lock, bytes);
+    if (cacheSize + bytes > maxSize)
+        return false;
+
+    cacheSize += bytes;
+    return true;
+}
+
+void TranscodeCache::evict(const std::unique_lock<std::mutex>& lock, off_t required)
+{
+    auto now = std::chrono::steady_clock::now();
+    while (cacheSize + required > maxSize) {
+        // outputs that are still written are never removed
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            auto entryLock = std::lock_guard<std::mutex>(it->second->mutex);
+            if (it->second->complete && it->second->pinnedUntil <= now && (oldest == entries.end() || it->second->lastUsed < oldest->second->lastUsed))
+                oldest = it;
+        }
+        if (oldest == entries.end())
+            return;
+
+        auto entry = oldest->second;
+        log_debug("Removing {} from transcode cache", entry->path.c_str());
+        // readers keep their file descriptor
+        std::error_code ec;
+        fs::remove(entry->path, ec);
+        cacheSize -= entry->size;
+        entries.erase(oldest);
+    }
+}
+
+void TranscodeCache::remove(const std::shared_ptr<TranscodeCacheEntry>& entry, off_t reserved)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    cacheSize -= reserved;
+    auto it = entries.find(entry->key);
+    if (it != entries.end() && it->second == entry)
+        entries.erase(it);
+
+    std::error_code ec;
+    fs::remove(getPartPath(entry->path), ec);
+    fs::remove(entry->path, ec);
+}
+
+std::optional<off_t> TranscodeCache::getCompleteSize(const std::string& key) const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return std::nullopt;
+
+    auto entryLock = std::lock_guard<std::mutex>(it->second->mutex);
+    if (!it->second->complete)
+        return std::nullopt;
+    return it->second->size;
+}
+
+std::optional<off_t> TranscodeCache::pin(const std::string& key, std::chrono::milliseconds duration)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return std::nullopt;
+
+    auto entry = it->second;
+    {
+        auto entryLock = std::lock_guard<std::mutex>(entry->mutex);
+        if (!entry->complete)
+            return std::nullopt;
+    }
+    entry->pinnedUntil = std::max(entry->pinnedUntil, std::chrono::steady_clock::now() + duration);
+    // the size of a complete output does not change anymore
+    return entry->size;
+}
+
+bool TranscodeCache::contains(const std::string& key) const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return false;
+
+    auto entryLock = std::lock_guard<std::mutex>(it->second->mutex);
+    return !it->second->failed;
+}
+
+off_t TranscodeCache::getCacheSize() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return cacheSize;
+}
+
+std::size_t TranscodeCache::getEntryCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return entries.size();
+}
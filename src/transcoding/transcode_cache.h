@@ -0,0 +1,171 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_cache.h
+/// \brief Definition of the TranscodeCache class.
+
+#ifndef __TRANSCODE_CACHE_H__
+#define __TRANSCODE_CACHE_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "iohandler/io_handler.h"
+#include "util/grb_fs.h"
+
+// forward declaration
+class Config;
+class TranscodingProfile;
+
+/// \brief output of one transcoding run, complete or still being written
+struct TranscodeCacheEntry {
+    TranscodeCacheEntry(std::string key, fs::path path, std::uint64_t lastUsed)
+        : key(std::move(key))
+        , path(std::move(path))
+        , lastUsed(lastUsed)
+    {
+    }
+
+    const std::string key;
+    /// \brief final location, the output is written to path.part before
+    const fs::path path;
+
+    /// \brief protects size, complete, failed and readers
+    std::mutex mutex;
+    /// \brief signalled whenever data was written
+    std::condition_variable cond;
+    off_t size {};
+    bool complete {};
+    bool failed {};
+    /// \brief number of open readers, the writer stops if it drops to zero
+    int readers {};
+
+    /// \brief sequence number of the last request, protected by the cache mutex
+    std::uint64_t lastUsed;
+    /// \brief the entry is not evicted before this time, protected by the cache mutex
+    std::chrono::steady_clock::time_point pinnedUntil {};
+};
+
+/// \brief Reads from a cached transcoding output.
+/// If the output is still being written, reads block until the data is available.
+class TranscodeCacheIOHandler : public IOHandler {
+public:
+    /// \param fd opened file descriptor of the output, owned by the handler
+    TranscodeCacheIOHandler(std::shared_ptr<TranscodeCacheEntry> entry, int fd);
+    ~TranscodeCacheIOHandler() override;
+
+    TranscodeCacheIOHandler(const TranscodeCacheIOHandler&) = delete;
+    TranscodeCacheIOHandler& operator=(const TranscodeCacheIOHandler&) = delete;
+
+    void open(enum UpnpOpenFileMode mode) override;
+    std::size_t read(char* buf, std::size_t length) override;
+    /// \brief seeking is limited to the part that is already written
+    void seek(off_t offset, int whence) override;
+    off_t tell() override;
+    void close() override;
+
+private:
+    std::shared_ptr<TranscodeCacheEntry> entry;
+    int fd;
+    off_t pos {};
+
+    void release();
+};
+
+/// \brief On disk cache of transcoding outputs.
+///
+/// The output of a transcoder is written to the cache by a background thread
+/// and all requests for the same source, profile and arguments read from
+/// the cache file, even while it is still being written. The writer stops
+/// when the last reader is closed before the output is complete. Complete
+/// outputs are removed in least recently used order if the cache exceeds
+/// its size.
+class TranscodeCache {
+public:
+    using TranscoderFactory = std::function<std::unique_ptr<IOHandler>()>;
+
+    /// \param baseDir directory of the cache, existing outputs are reused
+    /// \param maxSize upper limit for the sum of all outputs in bytes
+    TranscodeCache(fs::path baseDir, off_t maxSize);
+    ~TranscodeCache();
+
+    TranscodeCache(const TranscodeCache&) = delete;
+    TranscodeCache& operator=(const TranscodeCache&) = delete;
+
+    /// \brief build the cache key for a transcoding request
+    static std::string makeKey(const std::shared_ptr<TranscodingProfile>& profile, const fs::path& location, time_t mtime, const std::string& range, double start = 0);
+
+    /// \brief get a reader for the output stored under key
+    /// \param transcoder starts the transcoder if the output is not cached yet
+    std::unique_ptr<IOHandler> serve(const std::string& key, const TranscoderFactory& transcoder);
+
+    /// \brief get the size of the output if it is complete
+    std::optional<off_t> getCompleteSize(const std::string& key) const;
+
+    /// \brief keep a complete output from being evicted for some time
+    /// \param duration the pin expires by itself, so requests that are never opened do not keep the output forever
+    /// \return size of the output, std::nullopt if it is not complete
+    std::optional<off_t> pin(const std::string& key, std::chrono::milliseconds duration = std::chrono::seconds(30));
+
+    /// \brief check whether the output is cached or being written
+    bool contains(const std::string& key) const;
+
+    off_t getCacheSize() const;
+    std::size_t getEntryCount() const;
+
+    /// \brief get the cache instance if enabled in the configuration
+    static TranscodeCache* getInstance(const std::shared_ptr<Config>& config);
+
+private:
+    fs::path baseDir;
+    off_t maxSize;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::shared_ptr<TranscodeCacheEntry>> entries;
+    off_t cacheSize {};
+    std::uint64_t useCounter {};
+    bool shutdownFlag {};
+    /// \brief number of running writer threads, signalled by writerDone
+    int writers {};
+    std::condition_variable writerDone;
+
+    /// \brief open a reader for an existing entry, cache mutex must be held
+    /// \return nullptr if the entry failed
+    std::unique_ptr<IOHandler> openReader(const std::shared_ptr<TranscodeCacheEntry>& entry);
+    void writeOutput(const std::shared_ptr<TranscodeCacheEntry>& entry, int fd, std::unique_ptr<IOHandler> transcoder);
+    /// \brief account written bytes, false if the output does not fit into the cache
+    bool reserve(const std::shared_ptr<TranscodeCacheEntry>& entry, off_t bytes);
+    void remove(const std::shared_ptr<TranscodeCacheEntry>& entry, off_t reserved);
+    void evict(const std::unique_lock<std::mutex>& lock, off_t required);
+    void loadEntries();
+
+    static std::unique_ptr<TranscodeCache> instance;
+    static std::once_flag instanceInit;
+};
+
+#endif // __TRANSCODE_CACHE_H__
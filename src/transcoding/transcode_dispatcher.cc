@@ -34,6 +34,7 @@
 #include "cds_objects.h"
 #include "iohandler/io_handler.h"
 #include "transcode_ext_handler.h"
+#include "transcode_internal_handler.h"
 #include "transcoding.h"
 
 std::unique_ptr<IOHandler> TranscodeDispatcher::serveContent(std::shared_ptr<TranscodingProfile> profile,
@@ -46,8 +47,17 @@ std::unique_ptr<IOHandler> TranscodeDispatcher::serveContent(std::shared_ptr<Tra
 
     if (profile->getType() == TR_External) {
         auto trExt = std::make_unique<TranscodeExternalHandler>(std::move(content));
+        trExt->setJob(std::move(job));
+        trExt->setSeek(seek);
         return trExt->serveContent(std::move(profile), std::move(location), std::move(obj), std::move(range));
     }
 
+    if (profile->getType() == TR_Internal) {
+        auto trInt = std::make_unique<TranscodeInternalHandler>(std::move(content));
+        trInt->setJob(std::move(job));
+        trInt->setSeek(seek);
+        return trInt->serveContent(std::move(profile), std::move(location), std::move(obj), std::move(range));
+    }
+
     throw_std_runtime_error("Unknown transcoding type for profile {}", profile->getName());
 }
@@ -42,7 +42,13 @@
 #include "database/database.h"
 #include "iohandler/buffered_io_handler.h"
 #include "iohandler/io_handler_chainer.h"
+#include "iohandler/pipe_io_handler.h"
+#include "iohandler/pipe_reactor.h"
 #include "iohandler/process_io_handler.h"
+#include "transcode_cache.h"
+#include "transcode_scheduler.h"
+#include "transcode_seek.h"
+#include "transcode_warm_pool.h"
 #include "util/tools.h"
 #include "web/session_manager.h"
 
@@ -50,6 +56,9 @@
 #include "iohandler/curl_io_handler.h"
 #endif
 
+// output file given to transcoders writing to the pipe
+#define TRANSCODE_PIPE_OUTPUT "/dev/stdout"
+
 std::unique_ptr<IOHandler> TranscodeExternalHandler::serveContent(std::shared_ptr<TranscodingProfile> profile,
     std::string location, std::shared_ptr<CdsObject> obj, std::string range)
 {
@@ -76,6 +85,53 @@ std::unique_ptr<IOHandler> TranscodeExternalHandler::serveContent(std::shared_pt
     }
 #endif
 
+    // outputs of online content can not be reused
+    auto cache = TranscodeCache::getInstance(config);
+    struct stat statbuf;
+    if (cache && !obj->isExternalItem() && stat(location.c_str(), &statbuf) == 0) {
+        auto key = TranscodeCache::makeKey(profile, location, statbuf.st_mtime, range, seek.time);
+        auto ioHandler = cache->serve(key, [&]() { return startTranscoder(profile, location, obj, range, seek.time); });
+        content->triggerPlayHook(obj);
+        return ioHandler;
+    }
+
+    if (!profile->canSeek()) {
+        auto ioHandler = startTranscoder(profile, location, obj, range);
+        content->triggerPlayHook(obj);
+        return ioHandler;
+    }
+
+    // the scheduler slot is held by the request, not by each restarted transcoder
+    auto starter = [content = content, profile, location, obj, range](double time) {
+        return TranscodeExternalHandler(content).startTranscoder(profile, location, obj, range, time);
+    };
+    auto key = fmt::format("{}\n{}\n{}", profile->getName(), location, range);
+    std::unique_ptr<IOHandler> ioHandler = std::make_unique<SeekableTranscodeIOHandler>(std::move(starter), std::move(key), seek, TranscodeRestartCache::getInstance());
+    if (job) {
+        job->start();
+        ioHandler = std::make_unique<ScheduledIOHandler>(job, std::move(ioHandler));
+    }
+    content->triggerPlayHook(obj);
+    return ioHandler;
+}
+
+std::unique_ptr<IOHandler> TranscodeExternalHandler::startTranscoder(const std::shared_ptr<TranscodingProfile>& profile,
+    std::string location, const std::shared_ptr<CdsObject>& obj, const std::string& range, double time)
+{
+    auto pool = content->getTranscodeWarmPool();
+    auto startTime = std::chrono::steady_clock::now();
+    auto stageStart = startTime;
+    auto stageDone = [&stageStart]() {
+        auto now = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - stageStart);
+        stageStart = now;
+        return duration;
+    };
+    TranscodeStartupTimings timings;
+
+    auto executable = pool->resolveCommand(profile->getCommand());
+    timings.resolve = stageDone();
+
     std::vector<std::shared_ptr<ProcListItem>> procList;
 
     bool isURL = obj->isExternalItem();
@@ -87,63 +143,85 @@ std::unique_ptr<IOHandler> TranscodeExternalHandler::serveContent(std::shared_pt
 #endif
     }
 
-    checkTranscoder(profile);
-    fs::path fifoName = makeFifo();
-
-    std::vector<std::string> arglist = populateCommandLine(profile->getArguments(), location, fifoName, range, obj->getTitle());
+    auto start = fmt::format("{:.3f}", time);
 
-    log_debug("Running profile command: '{}', arguments: '{}'", profile->getCommand().c_str(), fmt::to_string(fmt::join(arglist, " ")));
-
-    auto tempFiles = std::vector<fs::path>({ fifoName });
+    auto tempFiles = std::vector<fs::path>();
     if (isURL && !profile->acceptURL()) {
         tempFiles.emplace_back(location);
     }
-    auto mainProc = std::make_shared<ProcessExecutor>(profile->getCommand(), arglist, profile->getEnviron(), tempFiles);
 
-    content->triggerPlayHook(obj);
+    // a helper of the warm pool comes with its output pipe
+    auto warmProcess = pool->takeProcess(profile);
+    auto startWarm = [&](const std::vector<std::string>& arglist) -> std::shared_ptr<ProcessExecutor> {
+        if (!warmProcess)
+            return nullptr;
+        auto argv = arglist;
+        argv.insert(argv.begin(), profile->getCommand().string());
+        if (!warmProcess->exec(executable, argv, profile->getEnviron()))
+            return nullptr;
+        timings.warm = true;
+        return std::make_shared<ProcessExecutor>(warmProcess->getPid(), tempFiles);
+    };
+
+    std::unique_ptr<IOHandler> ioHandler;
+#ifdef HAVE_EPOLL
+    if (profile->useStdout()) {
+        std::vector<std::string> arglist = populateCommandLine(profile->getArguments(), location, TRANSCODE_PIPE_OUTPUT, range, obj->getTitle(), start);
+
+        log_debug("Running profile command: '{}', arguments: '{}'", profile->getCommand().c_str(), fmt::to_string(fmt::join(arglist, " ")));
+
+        int outputFd = -1;
+        auto mainProc = startWarm(arglist);
+        if (mainProc) {
+            outputFd = warmProcess->releaseOutput();
+            timings.spawn = stageDone();
+        } else {
+            // the transcoder writes to an anonymous pipe which is read by the reactor thread
+            int fds[2];
+            if (pipe2(fds, O_CLOEXEC) != 0)
+                throw_std_runtime_error("Failed to create pipe for the transcoding process: {}", std::strerror(errno));
+            timings.pipe = stageDone();
+
+            try {
+                mainProc = std::make_shared<ProcessExecutor>(profile->getCommand(), arglist, profile->getEnviron(), tempFiles, fds[1]);
+            } catch (const std::runtime_error&) {
+                ::close(fds[0]);
+                ::close(fds[1]);
+                throw;
+            }
+            ::close(fds[1]);
+            outputFd = fds[0];
+            timings.spawn = stageDone();
+        }
 
-    auto processIoHandler = std::make_unique<ProcessIOHandler>(std::move(content), std::move(fifoName), std::move(mainProc), std::move(procList));
-    return std::make_unique<BufferedIOHandler>(config, std::move(processIoHandler), profile->getBufferSize(), profile->getBufferChunkSize(), profile->getBufferInitialFillSize());
-}
+        auto stream = PipeReactor::getInstance(config)->addStream(outputFd, profile->getBufferSize(), profile->getBufferChunkSize());
+        ioHandler = std::make_unique<PipeIOHandler>(content, std::move(stream), profile->getBufferInitialFillSize(), std::move(mainProc), std::move(procList));
+    } else
+#endif
+    {
+        fs::path fifoName = pool->takeFifo();
+        tempFiles.push_back(fifoName);
+        timings.pipe = stageDone();
 
-fs::path TranscodeExternalHandler::makeFifo()
-{
-    fs::path tmpDir = config->getOption(CFG_SERVER_TMPDIR);
-    auto fifoPath = tmpDir / fmt::format("grb-tr-{}", generateRandomId());
-
-    log_debug("Creating FIFO: {}", fifoPath.string());
-    int err = mkfifo(fifoPath.c_str(), O_RDWR);
-    if (err != 0) {
-        log_error("Failed to create FIFO for the transcoding process!: {}", std::strerror(errno));
-        throw_std_runtime_error("Could not create FIFO");
-    }
+        std::vector<std::string> arglist = populateCommandLine(profile->getArguments(), location, fifoName, range, obj->getTitle(), start);
 
-    err = chmod(fifoPath.c_str(), S_IWUSR | S_IRUSR);
-    if (err != 0) {
-        log_error("Failed to change location permissions: {}", std::strerror(errno));
-    }
-    return fifoPath;
-}
+        log_debug("Running profile command: '{}', arguments: '{}'", profile->getCommand().c_str(), fmt::to_string(fmt::join(arglist, " ")));
 
-void TranscodeExternalHandler::checkTranscoder(const std::shared_ptr<TranscodingProfile>& profile)
-{
-    fs::path check;
-    if (profile->getCommand().is_absolute()) {
-        std::error_code ec;
-        if (!isRegularFile(profile->getCommand(), ec))
-            throw_std_runtime_error("Could not find transcoder: {}", profile->getCommand().c_str());
-
-        check = profile->getCommand();
-    } else {
-        check = findInPath(profile->getCommand());
-
-        if (check.empty())
-            throw_std_runtime_error("Could not find transcoder {} in $PATH", profile->getCommand().c_str());
+        auto mainProc = startWarm(arglist);
+        if (!mainProc)
+            mainProc = std::make_shared<ProcessExecutor>(profile->getCommand(), arglist, profile->getEnviron(), tempFiles);
+        timings.spawn = stageDone();
+
+        auto processIoHandler = std::make_unique<ProcessIOHandler>(content, std::move(fifoName), std::move(mainProc), std::move(procList));
+        ioHandler = std::make_unique<BufferedIOHandler>(config, std::move(processIoHandler), profile->getBufferSize(), profile->getBufferChunkSize(), profile->getBufferInitialFillSize());
     }
+    ioHandler = std::make_unique<StartupTimingIOHandler>(pool, profile->getName(), timings, startTime, profile->getBufferInitialFillSize(), std::move(ioHandler));
+    if (!job)
+        return ioHandler;
 
-    int err = 0;
-    if (!isExecutable(check, &err))
-        throw_std_runtime_error("Transcoder {} is not executable: {}", profile->getCommand().c_str(), std::strerror(err));
+    // the slot is released when the transcoder is killed
+    job->start();
+    return std::make_unique<ScheduledIOHandler>(job, std::move(ioHandler));
 }
 
 #ifdef HAVE_CURL
@@ -151,10 +229,10 @@ void TranscodeExternalHandler::openCurlFifo(std::string& location, std::vector<s
 {
     std::string url = location;
     log_debug("creating reader fifo: {}", location.c_str());
-    location = makeFifo();
+    location = content->getTranscodeWarmPool()->takeFifo();
 
     try {
-        auto cIoh = std::make_unique<CurlIOHandler>(config, url, nullptr,
+        auto cIoh = std::make_unique<CurlIOHandler>(config, content->getCurlEngine(), url,
             config->getIntOption(CFG_EXTERNAL_TRANSCODING_CURL_BUFFER_SIZE),
             config->getIntOption(CFG_EXTERNAL_TRANSCODING_CURL_FILL_SIZE));
         auto pIoh = std::make_unique<ProcessIOHandler>(content, location, nullptr);
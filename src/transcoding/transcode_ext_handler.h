@@ -50,8 +50,13 @@ public:
         std::string range) override;
 
 private:
-    fs::path makeFifo();
-    static void checkTranscoder(const std::shared_ptr<TranscodingProfile>& profile);
+    /// \brief start the transcoding process for location
+    /// \param time start time of the output in seconds
+    std::unique_ptr<IOHandler> startTranscoder(const std::shared_ptr<TranscodingProfile>& profile,
+        std::string location,
+        const std::shared_ptr<CdsObject>& obj,
+        const std::string& range,
+        double time = 0);
 #ifdef HAVE_CURL
     void openCurlFifo(std::string& location, std::vector<std::shared_ptr<ProcListItem>>& procList);
 #endif
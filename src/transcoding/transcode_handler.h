@@ -37,12 +37,14 @@
 #include <upnp.h>
 
 #include "common.h"
+#include "transcode_seek.h"
 
 // forward declaration
 class CdsObject;
 class Config;
 class ContentManager;
 class IOHandler;
+class TranscodeJob;
 class TranscodingProfile;
 
 class TranscodeHandler {
@@ -56,9 +58,17 @@ public:
         std::string range)
         = 0;
 
+    /// \brief scheduler slot that is held while the started transcoder runs
+    void setJob(std::shared_ptr<TranscodeJob> job) { this->job = std::move(job); }
+
+    /// \brief position at which the output starts
+    void setSeek(const TranscodeSeek& seek) { this->seek = seek; }
+
 protected:
     std::shared_ptr<Config> config;
     std::shared_ptr<ContentManager> content;
+    std::shared_ptr<TranscodeJob> job;
+    TranscodeSeek seek;
 };
 
 #endif // __TRANSCODE_HANDLER_H__
@@ -0,0 +1,58 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_internal_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_internal_handler.cc
+
+#include "transcode_internal_handler.h" // API
+
+#include "cds_objects.h"
+#include "content/content_manager.h"
+#include "iohandler/ffmpeg_transcode_io_handler.h"
+#include "transcode_scheduler.h"
+#include "transcode_seek.h"
+#include "transcoding.h"
+
+std::unique_ptr<IOHandler> TranscodeInternalHandler::serveContent(std::shared_ptr<TranscodingProfile> profile,
+    std::string location, std::shared_ptr<CdsObject> obj, std::string range)
+{
+    log_debug("Start internal transcoding of file: {}", location);
+    if (!profile)
+        throw_std_runtime_error("Transcoding of file {} requested but no profile given", location);
+
+#if defined(HAVE_FFMPEG) && defined(HAVE_AVSTREAM_CODECPAR)
+    // seeking restarts the muxer at the matching time
+    auto starter = [profile, location](double time) -> std::unique_ptr<IOHandler> {
+        return std::make_unique<FfmpegTranscodeIOHandler>(profile, location, time);
+    };
+    auto key = fmt::format("{}\n{}", profile->getName(), location);
+    std::unique_ptr<IOHandler> ioHandler = std::make_unique<SeekableTranscodeIOHandler>(std::move(starter), std::move(key), seek, TranscodeRestartCache::getInstance());
+    if (job) {
+        job->start();
+        ioHandler = std::make_unique<ScheduledIOHandler>(job, std::move(ioHandler));
+    }
+    content->triggerPlayHook(obj);
+    return ioHandler;
+#else
+    throw_std_runtime_error("Compiled without libav support, internal transcoding profile {} is not available", profile->getName());
+#endif
+}
@@ -0,0 +1,43 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_internal_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_internal_handler.h
+/// \brief Definition of the TranscodeInternalHandler class.
+#ifndef __TRANSCODE_INTERNAL_HANDLER_H__
+#define __TRANSCODE_INTERNAL_HANDLER_H__
+
+#include "common.h"
+#include "transcode_handler.h"
+
+/// \brief transcoding with libav inside the server process
+class TranscodeInternalHandler : public TranscodeHandler {
+    using TranscodeHandler::TranscodeHandler;
+
+public:
+    std::unique_ptr<IOHandler> serveContent(std::shared_ptr<TranscodingProfile> profile,
+        std::string location,
+        std::shared_ptr<CdsObject> obj,
+        std::string range) override;
+};
+
+#endif // __TRANSCODE_INTERNAL_HANDLER_H__
@@ -0,0 +1,166 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_scheduler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_scheduler.cc
+
+#include "transcode_scheduler.h" // API
+
+#include <algorithm>
+
+#include "exceptions.h"
+#include "util/logger.h"
+#include "util/metrics.h"
+
+static MetricGauge& jobCount()
+{
+    static auto&& jobs = Metrics::getInstance()->gauge("gerbera_transcoding_jobs", "Admitted transcoding jobs");
+    return jobs;
+}
+
+TranscodeJob::TranscodeJob(std::shared_ptr<TranscodeScheduler> scheduler, std::string profile, std::chrono::steady_clock::time_point reservedUntil)
+    : GenericTask(TranscodeSchedulerTask)
+    , scheduler(std::move(scheduler))
+    , profile(std::move(profile))
+    , reservedUntil(reservedUntil)
+{
+    taskType = Transcode;
+    cancellable = false;
+}
+
+TranscodeJob::~TranscodeJob()
+{
+    scheduler->jobFinished(this);
+}
+
+void TranscodeJob::start()
+{
+    started = true;
+    scheduler->jobStarted(this);
+}
+
+TranscodeScheduler::TranscodeScheduler(int maxJobs, std::chrono::milliseconds queueTimeout, std::chrono::milliseconds reservationTimeout)
+    : maxJobs(maxJobs)
+    , queueTimeout(queueTimeout)
+    , reservationTimeout(reservationTimeout)
+{
+}
+
+std::shared_ptr<TranscodeJob> TranscodeScheduler::admit(const std::string& profile, int profileMaxJobs, const std::string& description)
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = now + queueTimeout;
+    bool queued = false;
+
+    while (true) {
+        auto [total, ofProfile] = countActive(profile, now);
+        if ((maxJobs <= 0 || total < maxJobs) && (profileMaxJobs <= 0 || ofProfile < profileMaxJobs))
+            break;
+
+        if (now >= deadline) {
+            static auto&& rejectCounter = Metrics::getInstance()->counter("gerbera_transcoding_rejected_total", "Transcoding requests rejected because of job limits");
+            rejectCounter.inc();
+            throw TranscodingRejectedException(fmt::format("Too many transcoding jobs running: {} of {} total, {} of {} with profile {}", total, maxJobs, ofProfile, profileMaxJobs, profile));
+        }
+
+        if (!queued) {
+            log_debug("Queueing transcoding job for profile {}", profile);
+            queued = true;
+        }
+        // unstarted reservations expire without notification
+        jobDone.wait_until(lock, std::min({ deadline, now + reservationTimeout, now + std::chrono::seconds(1) }));
+        now = std::chrono::steady_clock::now();
+    }
+
+    auto job = std::make_shared<TranscodeJob>(shared_from_this(), profile, now + reservationTimeout);
+    job->setID(++lastJobId);
+    job->setDescription(description);
+    jobs.push_back(job.get());
+    jobCount().add(1);
+    return job;
+}
+
+std::pair<int, int> TranscodeScheduler::countActive(const std::string& profile, std::chrono::steady_clock::time_point now)
+{
+    // the request of an expired reservation may never be opened and keep its job forever
+    auto expired = std::remove_if(jobs.begin(), jobs.end(), [now](auto&& job) { return !job->isActive(now); });
+    jobCount().add(-(jobs.end() - expired));
+    jobs.erase(expired, jobs.end());
+
+    int ofProfile = std::count_if(jobs.begin(), jobs.end(), [&profile](auto&& job) { return job->getProfile() == profile; });
+    return { int(jobs.size()), ofProfile };
+}
+
+int TranscodeScheduler::getActiveCount(const std::string& profile)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto [total, ofProfile] = countActive(profile, std::chrono::steady_clock::now());
+    return profile.empty() ? total : ofProfile;
+}
+
+std::deque<std::shared_ptr<GenericTask>> TranscodeScheduler::getJobs()
+{
+    std::vector<std::shared_ptr<TranscodeJob>> existing;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        countActive("", std::chrono::steady_clock::now());
+        for (auto&& job : jobs) {
+            // jobs being destroyed are still in the list but can not be locked
+            auto ptr = job->weak_from_this().lock();
+            if (ptr)
+                existing.push_back(std::move(ptr));
+        }
+    }
+
+    // the last reference may be released here, which needs the mutex
+    return { existing.begin(), existing.end() };
+}
+
+void TranscodeScheduler::jobStarted(TranscodeJob* job)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    // a late start of an expired reservation occupies a slot again
+    if (std::find(jobs.begin(), jobs.end(), job) == jobs.end()) {
+        jobs.push_back(job);
+        jobCount().add(1);
+    }
+}
+
+void TranscodeScheduler::jobFinished(TranscodeJob* job)
+{
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto it = std::find(jobs.begin(), jobs.end(), job);
+        if (it != jobs.end()) {
+            jobs.erase(it);
+            jobCount().add(-1);
+        }
+    }
+    jobDone.notify_all();
+}
+
+ScheduledIOHandler::ScheduledIOHandler(std::shared_ptr<TranscodeJob> job, std::unique_ptr<IOHandler> ioHandler)
+    : job(std::move(job))
+    , ioHandler(std::move(ioHandler))
+{
+}
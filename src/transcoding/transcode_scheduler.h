@@ -0,0 +1,138 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_scheduler.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_scheduler.h
+/// \brief Definition of the TranscodeScheduler class.
+
+#ifndef __TRANSCODE_SCHEDULER_H__
+#define __TRANSCODE_SCHEDULER_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "iohandler/io_handler.h"
+#include "util/generic_task.h"
+
+// forward declaration
+class TranscodeScheduler;
+
+/// \brief slot of one transcoding request, held as long as the transcoder runs
+///
+/// A job is reserved when the request is accepted and started when the
+/// transcoder is actually launched. Reservations that are never started,
+/// e.g. for HEAD requests, are dropped by the scheduler after a grace period.
+class TranscodeJob : public GenericTask, public std::enable_shared_from_this<TranscodeJob> {
+public:
+    TranscodeJob(std::shared_ptr<TranscodeScheduler> scheduler, std::string profile, std::chrono::steady_clock::time_point reservedUntil);
+    ~TranscodeJob() override;
+
+    TranscodeJob(const TranscodeJob&) = delete;
+    TranscodeJob& operator=(const TranscodeJob&) = delete;
+
+    void run() override { }
+
+    /// \brief mark the transcoder of the job as running
+    void start();
+    bool isStarted() const { return started; }
+
+    const std::string& getProfile() const { return profile; }
+
+    /// \brief check whether the job occupies a slot at time now
+    bool isActive(std::chrono::steady_clock::time_point now) const { return started || now < reservedUntil; }
+
+private:
+    std::shared_ptr<TranscodeScheduler> scheduler;
+    std::string profile;
+    std::chrono::steady_clock::time_point reservedUntil;
+    std::atomic_bool started { false };
+};
+
+/// \brief admission control for transcoding requests
+///
+/// Limits the number of transcoders running at the same time, globally
+/// and per profile. Requests exceeding a limit wait for a free slot up
+/// to the queue timeout and are rejected afterwards. The wait blocks the
+/// calling web server thread, so the timeout is kept short.
+class TranscodeScheduler : public std::enable_shared_from_this<TranscodeScheduler> {
+public:
+    /// \param maxJobs global limit, 0 for unlimited
+    /// \param queueTimeout maximum time a request waits for a free slot
+    /// \param reservationTimeout time after which a job that was never started stops counting
+    TranscodeScheduler(int maxJobs, std::chrono::milliseconds queueTimeout, std::chrono::milliseconds reservationTimeout = std::chrono::seconds(30));
+
+    /// \brief reserve a slot for a transcoder of profile
+    /// \param profile name of the transcoding profile
+    /// \param profileMaxJobs limit of the profile, 0 for unlimited
+    /// \param description shown in the task list
+    /// \throws TranscodingRejectedException if no slot became free in time
+    std::shared_ptr<TranscodeJob> admit(const std::string& profile, int profileMaxJobs, const std::string& description);
+
+    /// \brief get all active jobs
+    std::deque<std::shared_ptr<GenericTask>> getJobs();
+
+    /// \brief number of active jobs, optionally restricted to a profile
+    int getActiveCount(const std::string& profile = "");
+
+private:
+    int maxJobs;
+    std::chrono::milliseconds queueTimeout;
+    std::chrono::milliseconds reservationTimeout;
+
+    std::mutex mutex;
+    /// \brief signalled whenever a job ends
+    std::condition_variable jobDone;
+    /// \brief active jobs, removed by their destructor or when the reservation expired
+    std::vector<TranscodeJob*> jobs;
+    unsigned int lastJobId {};
+
+    /// \brief remove expired reservations and count the remaining jobs in total and of profile, mutex must be held
+    std::pair<int, int> countActive(const std::string& profile, std::chrono::steady_clock::time_point now);
+    void jobStarted(TranscodeJob* job);
+    void jobFinished(TranscodeJob* job);
+
+    friend class TranscodeJob;
+};
+
+/// \brief keeps the job of a transcoder while its output is served
+class ScheduledIOHandler : public IOHandler {
+public:
+    ScheduledIOHandler(std::shared_ptr<TranscodeJob> job, std::unique_ptr<IOHandler> ioHandler);
+
+    void open(enum UpnpOpenFileMode mode) override { ioHandler->open(mode); }
+    std::size_t read(char* buf, std::size_t length) override { return ioHandler->read(buf, length); }
+    std::size_t write(char* buf, std::size_t length) override { return ioHandler->write(buf, length); }
+    void seek(off_t offset, int whence) override { ioHandler->seek(offset, whence); }
+    off_t tell() override { return ioHandler->tell(); }
+    void close() override { ioHandler->close(); }
+
+private:
+    std::shared_ptr<TranscodeJob> job;
+    std::unique_ptr<IOHandler> ioHandler;
+};
+
+#endif // __TRANSCODE_SCHEDULER_H__
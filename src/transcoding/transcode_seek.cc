@@ -0,0 +1,269 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_seek.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_seek.cc
+
+#include "transcode_seek.h" // API
+
+#include <cmath>
+#include <cstring>
+
+#include "cds_objects.h"
+#include "transcoding.h"
+#include "upnp_common.h"
+#include "util/tools.h"
+
+// transcoders which delivered more than this are not parked
+#define TRANSCODE_RESTART_PREFIX_SIZE (256 * 1024)
+#define TRANSCODE_RESTART_MAX_ENTRIES 4
+#define TRANSCODE_RESTART_TIMEOUT std::chrono::seconds(10)
+
+std::optional<double> parseNptStart(std::string_view header)
+{
+    auto value = trimString(std::string(header));
+    if (!startswith(value, "npt="))
+        return std::nullopt;
+
+    auto dash = value.find('-', 4);
+    if (dash == std::string::npos)
+        return std::nullopt;
+
+    auto start = trimString(value.substr(4, dash - 4));
+    auto parts = splitString(start, ':', true);
+    if (start.empty() || parts.size() > 3)
+        return std::nullopt;
+
+    // either seconds or H:MM:SS, both with optional fraction
+    double seconds = 0;
+    for (auto&& part : parts) {
+        char* end = nullptr;
+        double val = std::strtod(part.c_str(), &end);
+        if (part.empty() || *end != '\0' || !std::isfinite(val) || val < 0)
+            return std::nullopt;
+        seconds = seconds * 60 + val;
+    }
+    return seconds;
+}
+
+std::string formatNptTime(double seconds)
+{
+    return millisecondsToHMSF(int(std::lround(seconds * 1000)));
+}
+
+double getItemDuration(const std::shared_ptr<CdsItem>& item)
+{
+    auto resource = (item && item->getResourceCount() > 0) ? item->getResource(0) : nullptr;
+    if (!resource)
+        return 0;
+
+    auto duration = resource->getAttribute(R_DURATION);
+    return duration.empty() ? 0 : HMSFToMilliseconds(duration) / 1000.0;
+}
+
+std::string getTranscodeSeekFlags(const std::shared_ptr<TranscodingProfile>& profile)
+{
+    // the size of the output is not known before the transcoder finished,
+    // so only seeking by time is offered
+    if (!profile || !profile->canSeek())
+        return UPNP_DLNA_OP_SEEK_DISABLED;
+    return UPNP_DLNA_OP_SEEK_TIME;
+}
+
+TranscodeRestartCache::TranscodeRestartCache(std::size_t maxEntries, std::chrono::milliseconds timeout)
+    : maxEntries(maxEntries)
+    , timeout(timeout)
+{
+}
+
+TranscodeRestartCache::~TranscodeRestartCache()
+{
+    // kill parked transcoders before the members go away
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    auto parked = std::move(entries);
+    lock.unlock();
+}
+
+TranscodeRestartCache& TranscodeRestartCache::getInstance()
+{
+    static TranscodeRestartCache instance(TRANSCODE_RESTART_MAX_ENTRIES, TRANSCODE_RESTART_TIMEOUT);
+    return instance;
+}
+
+void TranscodeRestartCache::expire(std::deque<Entry>& expired)
+{
+    auto now = std::chrono::steady_clock::now();
+    while (!entries.empty() && (entries.size() > maxEntries || entries.front().parked + timeout <= now)) {
+        expired.push_back(std::move(entries.front()));
+        entries.pop_front();
+    }
+}
+
+void TranscodeRestartCache::park(const std::string& key, std::unique_ptr<IOHandler> transcoder, std::string prefix)
+{
+    // killing a transcoder waits for the process, do that without the lock
+    std::deque<Entry> expired;
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (maxEntries == 0) {
+        expired.push_back(Entry { key, std::move(transcoder), {}, {} });
+        return;
+    }
+    entries.push_back(Entry { key, std::move(transcoder), std::move(prefix), std::chrono::steady_clock::now() });
+    expire(expired);
+    log_debug("Parked transcoder, {} waiting for reuse", entries.size());
+}
+
+std::unique_ptr<IOHandler> TranscodeRestartCache::take(const std::string& key, std::string& prefix)
+{
+    std::deque<Entry> expired;
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    expire(expired);
+
+    auto it = std::find_if(entries.begin(), entries.end(), [&key](auto&& entry) { return entry.key == key; });
+    if (it == entries.end())
+        return nullptr;
+
+    auto transcoder = std::move(it->transcoder);
+    prefix = std::move(it->prefix);
+    entries.erase(it);
+    return transcoder;
+}
+
+std::size_t TranscodeRestartCache::getEntryCount() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return entries.size();
+}
+
+SeekableTranscodeIOHandler::SeekableTranscodeIOHandler(Starter starter, std::string key, const TranscodeSeek& seek, TranscodeRestartCache& cache)
+    : starter(std::move(starter))
+    , key(std::move(key))
+    , start(seek)
+    , cache(cache)
+{
+}
+
+SeekableTranscodeIOHandler::~SeekableTranscodeIOHandler()
+{
+    try {
+        parkTranscoder();
+    } catch (const std::exception& e) {
+        log_error("Failed to release transcoder: {}", e.what());
+    }
+}
+
+std::string SeekableTranscodeIOHandler::getRestartKey() const
+{
+    return fmt::format("{}\n{}", key, std::lround(start.time * 1000));
+}
+
+void SeekableTranscodeIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    if (mode != UPNP_READ)
+        throw_std_runtime_error("open: UpnpOpenFileMode mode not supported");
+    // the transcoder is started on the first read, so a seek right after open does not start it twice
+}
+
+void SeekableTranscodeIOHandler::startTranscoder()
+{
+    prefix.clear();
+    prefixPos = 0;
+    parkable = true;
+
+    transcoder = cache.take(getRestartKey(), prefix);
+    if (transcoder) {
+        log_debug("Continuing parked transcoder at {}", formatNptTime(start.time));
+        return;
+    }
+
+    log_debug("Starting transcoder at {}", formatNptTime(start.time));
+    transcoder = starter(start.time);
+    transcoder->open(UPNP_READ);
+}
+
+void SeekableTranscodeIOHandler::parkTranscoder()
+{
+    if (!transcoder)
+        return;
+
+    // a transcoder is only reusable if everything it delivered is known
+    if (parkable)
+        cache.park(getRestartKey(), std::move(transcoder), std::move(prefix));
+    transcoder.reset();
+    prefix.clear();
+    prefixPos = 0;
+}
+
+std::size_t SeekableTranscodeIOHandler::read(char* buf, std::size_t length)
+{
+    if (!transcoder)
+        startTranscoder();
+
+    // replay what a parked transcoder delivered before
+    if (prefixPos < prefix.size()) {
+        auto count = std::min(length, prefix.size() - prefixPos);
+        std::memcpy(buf, prefix.data() + prefixPos, count);
+        prefixPos += count;
+        pos += count;
+        return count;
+    }
+
+    auto ret = transcoder->read(buf, length);
+    if (ret == 0 || ret == std::size_t(-1) || ret == std::size_t(CHECK_SOCKET))
+        return ret;
+
+    if (parkable && prefix.size() + ret <= TRANSCODE_RESTART_PREFIX_SIZE) {
+        prefix.append(buf, ret);
+        prefixPos = prefix.size();
+    } else if (parkable) {
+        parkable = false;
+        prefix.clear();
+        prefixPos = 0;
+    }
+    pos += ret;
+    return ret;
+}
+
+void SeekableTranscodeIOHandler::seek(off_t offset, int whence)
+{
+    off_t target;
+    if (whence == SEEK_SET)
+        target = offset;
+    else if (whence == SEEK_CUR)
+        target = pos + offset;
+    else
+        throw_std_runtime_error("seek failed: the end of the transcoded output is unknown");
+
+    if (target == pos)
+        return;
+    throw_std_runtime_error("seek failed: the size of the transcoded output is unknown");
+}
+
+off_t SeekableTranscodeIOHandler::tell()
+{
+    return pos;
+}
+
+void SeekableTranscodeIOHandler::close()
+{
+    parkTranscoder();
+}
@@ -0,0 +1,145 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_seek.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_seek.h
+/// \brief Definition of the SeekableTranscodeIOHandler class.
+
+#ifndef __TRANSCODE_SEEK_H__
+#define __TRANSCODE_SEEK_H__
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "iohandler/io_handler.h"
+
+// forward declaration
+class CdsItem;
+class TranscodingProfile;
+
+/// \brief position at which a transcoder is started
+struct TranscodeSeek {
+    /// \brief start time of the output in seconds
+    double time {};
+};
+
+/// \brief parse the start time of a TimeSeekRange.dlna.org header, e.g. "npt=90.5-" or "npt=0:01:30.5-120"
+/// \return start time in seconds, std::nullopt if the header is invalid
+std::optional<double> parseNptStart(std::string_view header);
+
+/// \brief format seconds as npt time "H:MM:SS.mmm"
+std::string formatNptTime(double seconds);
+
+/// \brief duration of the item in seconds, 0 if unknown
+double getItemDuration(const std::shared_ptr<CdsItem>& item);
+
+/// \brief DLNA operation flags for the transcoded resources of profile
+std::string getTranscodeSeekFlags(const std::shared_ptr<TranscodingProfile>& profile);
+
+/// \brief short lived store of transcoders that were abandoned right after start
+///
+/// Renderers probe a new position with several requests while the user is
+/// scrubbing, most of them are closed after a few kilobytes. A transcoder
+/// that delivered only the beginning of its output is parked together with
+/// that data, so a request for the same position can continue it instead of
+/// forking a new process.
+class TranscodeRestartCache {
+public:
+    /// \param maxEntries number of transcoders kept running
+    /// \param timeout parked transcoders are killed after this time
+    TranscodeRestartCache(std::size_t maxEntries, std::chrono::milliseconds timeout);
+    ~TranscodeRestartCache();
+
+    /// \brief keep the transcoder for key, prefix is the data it delivered already
+    void park(const std::string& key, std::unique_ptr<IOHandler> transcoder, std::string prefix);
+
+    /// \brief take the transcoder parked for key
+    /// \return nullptr if none is available
+    std::unique_ptr<IOHandler> take(const std::string& key, std::string& prefix);
+
+    std::size_t getEntryCount() const;
+
+    static TranscodeRestartCache& getInstance();
+
+private:
+    struct Entry {
+        std::string key;
+        std::unique_ptr<IOHandler> transcoder;
+        std::string prefix;
+        std::chrono::steady_clock::time_point parked;
+    };
+
+    std::size_t maxEntries;
+    std::chrono::milliseconds timeout;
+
+    mutable std::mutex mutex;
+    /// \brief most recently parked at the back
+    std::deque<Entry> entries;
+
+    /// \brief remove expired entries, caller must hold the lock
+    void expire(std::deque<Entry>& expired);
+};
+
+/// \brief Serves the output of a transcoder started at the requested time.
+/// The size of the output is unknown, so the web server can not seek in it.
+class SeekableTranscodeIOHandler : public IOHandler {
+public:
+    /// \brief start a transcoder at the given time in seconds
+    using Starter = std::function<std::unique_ptr<IOHandler>(double time)>;
+
+    /// \param key identifies source and profile of the output
+    /// \param seek start position of the request
+    SeekableTranscodeIOHandler(Starter starter, std::string key, const TranscodeSeek& seek, TranscodeRestartCache& cache);
+    ~SeekableTranscodeIOHandler() override;
+
+    void open(enum UpnpOpenFileMode mode) override;
+    std::size_t read(char* buf, std::size_t length) override;
+    void seek(off_t offset, int whence) override;
+    off_t tell() override;
+    void close() override;
+
+private:
+    Starter starter;
+    std::string key;
+    TranscodeSeek start;
+    TranscodeRestartCache& cache;
+
+    std::unique_ptr<IOHandler> transcoder;
+    /// \brief position in the output seen by the web server
+    off_t pos {};
+    /// \brief output of the running transcoder while it is small enough for parking
+    std::string prefix;
+    /// \brief part of prefix that was delivered by this handler
+    std::size_t prefixPos {};
+    bool parkable { true };
+
+    std::string getRestartKey() const;
+    void startTranscoder();
+    void parkTranscoder();
+};
+
+#endif // __TRANSCODE_SEEK_H__
@@ -0,0 +1,498 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_warm_pool.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_warm_pool.cc
+
+#include "transcode_warm_pool.h" // API
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "config/config.h"
+#include "transcoding.h"
+#include "util/tools.h"
+
+// limits of the command line sent to a helper process
+#define WARM_MESSAGE_SIZE 65536
+#define WARM_MAX_STRINGS 1024
+
+// the pool is checked for configuration changes at least that often
+#define WARM_POOL_REFILL_INTERVAL std::chrono::seconds(30)
+
+/// \brief helpers of profiles reading the standard output come with the pipe
+static bool useOutput(const TranscodingProfile& profile)
+{
+#ifdef HAVE_EPOLL
+    return profile.useStdout();
+#else
+    return false;
+#endif
+}
+
+/// \brief close all descriptors after standard error except keep in a forked child
+/// \param maxFd upper limit used if close_range is not supported by the kernel
+static void closeDescriptors(int keep, int maxFd)
+{
+#ifdef SYS_close_range
+    if ((keep == STDERR_FILENO + 1 || syscall(SYS_close_range, STDERR_FILENO + 1, keep - 1, 0) == 0)
+        && syscall(SYS_close_range, keep + 1, ~0U, 0) == 0)
+        return;
+#endif
+    for (int fd = STDERR_FILENO + 1; fd < maxFd; fd++) {
+        if (fd != keep)
+            ::close(fd);
+    }
+}
+
+/// \brief main function of the helper process, only uses async signal safe functions
+/// because the server has other threads which may hold locks while forking
+[[noreturn]] static void runHelper(int control, char* message, char** strings)
+{
+    // the message is argc and envc followed by the executable, the arguments
+    // and the environment as NUL terminated strings
+    std::size_t length = 0;
+    while (length < WARM_MESSAGE_SIZE) {
+        auto ret = ::read(control, message + length, WARM_MESSAGE_SIZE - length);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            break;
+        length += ret;
+    }
+    // closed without a command by the pool or the exiting server
+    if (length < 2 * sizeof(uint32_t))
+        _exit(EXIT_SUCCESS);
+
+    uint32_t argc;
+    uint32_t envc;
+    std::memcpy(&argc, message, sizeof(argc));
+    std::memcpy(&envc, message + sizeof(argc), sizeof(envc));
+    if (argc == 0 || argc + envc > WARM_MAX_STRINGS)
+        _exit(127);
+
+    char* pos = message + 2 * sizeof(uint32_t);
+    char* end = message + length;
+    auto next = [&pos, end]() -> char* {
+        char* result = pos;
+        while (pos < end && *pos)
+            pos++;
+        if (pos >= end)
+            _exit(127);
+        pos++;
+        return result;
+    };
+
+    char* executable = next();
+    char** argv = strings;
+    for (uint32_t i = 0; i < argc; i++)
+        argv[i] = next();
+    argv[argc] = nullptr;
+    char** envp = strings + argc + 1;
+    for (uint32_t i = 0; i < envc; i++)
+        envp[i] = next();
+    envp[envc] = nullptr;
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigprocmask(SIG_SETMASK, &mask, nullptr);
+    execve(executable, argv, envp);
+    _exit(127);
+}
+
+WarmProcess::WarmProcess(bool withOutput)
+{
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+        throw_std_runtime_error("Failed to create control socket: {}", std::strerror(errno));
+
+    int fds[2] = { -1, -1 };
+    if (withOutput && pipe2(fds, O_CLOEXEC) != 0) {
+        auto err = errno;
+        ::close(sockets[0]);
+        ::close(sockets[1]);
+        throw_std_runtime_error("Failed to create pipe: {}", std::strerror(err));
+    }
+
+    // the helper must not allocate memory, so everything is prepared here
+    auto message = std::make_unique<char[]>(WARM_MESSAGE_SIZE);
+    auto strings = std::make_unique<char*[]>(WARM_MAX_STRINGS + 2);
+    auto maxFd = int(sysconf(_SC_OPEN_MAX));
+
+    pid = fork();
+    if (pid == 0) {
+        if (fds[1] >= 0)
+            dup2(fds[1], STDOUT_FILENO);
+        // close-on-exec does not apply before the exec, so the helper would
+        // keep the control sockets and pipes of other helpers open otherwise
+        closeDescriptors(sockets[1], maxFd);
+        runHelper(sockets[1], message.get(), strings.get());
+    }
+
+    auto err = errno;
+    ::close(sockets[1]);
+    if (fds[1] >= 0)
+        ::close(fds[1]);
+    if (pid < 0) {
+        ::close(sockets[0]);
+        if (fds[0] >= 0)
+            ::close(fds[0]);
+        throw_std_runtime_error("Failed to fork helper process: {}", std::strerror(err));
+    }
+    control = sockets[0];
+    output = fds[0];
+    log_debug("Started warm process {}", pid);
+}
+
+WarmProcess::~WarmProcess()
+{
+    if (control >= 0)
+        ::close(control);
+    if (output >= 0)
+        ::close(output);
+    // an unused helper exits as soon as the control socket is closed,
+    // a used one belongs to the executor of the transcoder
+    if (!started && pid > 0)
+        waitpid(pid, nullptr, 0);
+}
+
+bool WarmProcess::exec(const fs::path& executable, const std::vector<std::string>& argv, const std::map<std::string, std::string>& env)
+{
+    if (started)
+        throw_std_runtime_error("Warm process {} was used already", pid);
+
+    std::vector<std::string> envList;
+    for (char** entry = environ; *entry; entry++) {
+        auto var = std::string_view(*entry);
+        if (env.find(std::string(var.substr(0, var.find('=')))) == env.end())
+            envList.emplace_back(var);
+    }
+    for (auto&& [name, value] : env)
+        envList.push_back(fmt::format("{}={}", name, value));
+
+    uint32_t argc = argv.size();
+    uint32_t envc = envList.size();
+    std::string message(2 * sizeof(uint32_t), '\0');
+    std::memcpy(message.data(), &argc, sizeof(argc));
+    std::memcpy(message.data() + sizeof(argc), &envc, sizeof(envc));
+    message.append(executable.string()).push_back('\0');
+    for (auto&& arg : argv)
+        message.append(arg).push_back('\0');
+    for (auto&& var : envList)
+        message.append(var).push_back('\0');
+
+    if (argc == 0 || argc + envc > WARM_MAX_STRINGS || message.size() > WARM_MESSAGE_SIZE) {
+        log_debug("Command line of {} is too long for warm process {}", executable.c_str(), pid);
+        return false;
+    }
+
+    std::size_t sent = 0;
+    while (sent < message.size()) {
+        auto ret = send(control, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0) {
+            log_debug("Warm process {} is gone: {}", pid, std::strerror(errno));
+            return false;
+        }
+        sent += ret;
+    }
+
+    // the helper starts the command when it sees the end of the message
+    ::close(control);
+    control = -1;
+    started = true;
+    return true;
+}
+
+int WarmProcess::releaseOutput()
+{
+    auto fd = output;
+    output = -1;
+    return fd;
+}
+
+TranscodeWarmPool::TranscodeWarmPool(std::shared_ptr<Config> config)
+    : config(std::move(config))
+{
+}
+
+TranscodeWarmPool::~TranscodeWarmPool()
+{
+    shutdown();
+}
+
+void TranscodeWarmPool::run()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (running || shutdownFlag)
+        return;
+    running = true;
+    thread = std::thread([this] { threadProc(); });
+}
+
+void TranscodeWarmPool::shutdown()
+{
+    std::thread refillThread;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        shutdownFlag = true;
+        refillThread = std::move(thread);
+    }
+    refill.notify_all();
+    if (refillThread.joinable())
+        refillThread.join();
+
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    processes.clear();
+    for (auto&& fifo : fifos) {
+        std::error_code ec;
+        fs::remove(fifo, ec);
+    }
+    fifos.clear();
+
+    for (auto&& [profile, stats] : statistics) {
+        log_info("Startup of transcoding profile {}: {} starts, {} from warm pool, average resolve {} us, pipe {} us, spawn {} us, first data after {} ms",
+            profile, stats.starts, stats.warmStarts,
+            stats.total.resolve.count() / stats.starts, stats.total.pipe.count() / stats.starts, stats.total.spawn.count() / stats.starts,
+            stats.total.firstData.count() / stats.starts / 1000);
+    }
+    statistics.clear();
+}
+
+fs::path TranscodeWarmPool::resolveCommand(const fs::path& command)
+{
+    int err = 0;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        auto it = commandPaths.find(command);
+        if (it != commandPaths.end()) {
+            if (isExecutable(it->second, &err))
+                return it->second;
+            // the transcoder was moved or removed, search again
+            commandPaths.erase(it);
+        }
+    }
+
+    fs::path path;
+    if (command.is_absolute()) {
+        std::error_code ec;
+        if (!isRegularFile(command, ec))
+            throw_std_runtime_error("Could not find transcoder: {}", command.c_str());
+
+        path = command;
+    } else {
+        path = findInPath(command);
+
+        if (path.empty())
+            throw_std_runtime_error("Could not find transcoder {} in $PATH", command.c_str());
+    }
+
+    if (!isExecutable(path, &err))
+        throw_std_runtime_error("Transcoder {} is not executable: {}", command.c_str(), std::strerror(err));
+
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    commandPaths[command] = path;
+    return path;
+}
+
+std::unique_ptr<WarmProcess> TranscodeWarmPool::takeProcess(const std::shared_ptr<TranscodingProfile>& profile)
+{
+    if (profile->getWarmProcesses() <= 0)
+        return nullptr;
+
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    // start a replacement, or the first helpers of a profile changed in the web UI
+    refill.notify_one();
+
+    auto it = processes.find(profile->getName());
+    if (it == processes.end() || it->second.empty())
+        return nullptr;
+
+    // the profile was switched to or from the standard output, wait for the refill
+    if (it->second.front()->hasOutput() != useOutput(*profile))
+        return nullptr;
+
+    auto process = std::move(it->second.front());
+    it->second.pop_front();
+    return process;
+}
+
+fs::path TranscodeWarmPool::takeFifo()
+{
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        if (!fifos.empty()) {
+            auto fifo = std::move(fifos.front());
+            fifos.pop_front();
+            refill.notify_one();
+            return fifo;
+        }
+    }
+    return makeFifo(config->getOption(CFG_SERVER_TMPDIR));
+}
+
+fs::path TranscodeWarmPool::makeFifo(const fs::path& dir)
+{
+    auto fifoPath = dir / fmt::format("grb-tr-{}", generateRandomId());
+
+    log_debug("Creating FIFO: {}", fifoPath.string());
+    int err = mkfifo(fifoPath.c_str(), O_RDWR);
+    if (err != 0) {
+        log_error("Failed to create FIFO for the transcoding process!: {}", std::strerror(errno));
+        throw_std_runtime_error("Could not create FIFO");
+    }
+
+    err = chmod(fifoPath.c_str(), S_IWUSR | S_IRUSR);
+    if (err != 0) {
+        log_error("Failed to change location permissions: {}", std::strerror(errno));
+    }
+    return fifoPath;
+}
+
+void TranscodeWarmPool::addTimings(const std::string& profile, const TranscodeStartupTimings& timings)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto& stats = statistics[profile];
+    stats.starts++;
+    if (timings.warm)
+        stats.warmStarts++;
+    stats.total.resolve += timings.resolve;
+    stats.total.pipe += timings.pipe;
+    stats.total.spawn += timings.spawn;
+    stats.total.firstData += timings.firstData;
+    stats.max.resolve = std::max(stats.max.resolve, timings.resolve);
+    stats.max.pipe = std::max(stats.max.pipe, timings.pipe);
+    stats.max.spawn = std::max(stats.max.spawn, timings.spawn);
+    stats.max.firstData = std::max(stats.max.firstData, timings.firstData);
+}
+
+TranscodeStartupStatistics TranscodeWarmPool::getStatistics(const std::string& profile) const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = statistics.find(profile);
+    return it != statistics.end() ? it->second : TranscodeStartupStatistics();
+}
+
+std::map<std::string, std::shared_ptr<TranscodingProfile>> TranscodeWarmPool::getWantedProcesses() const
+{
+    std::map<std::string, std::shared_ptr<TranscodingProfile>> result;
+    if (!config->getBoolOption(CFG_TRANSCODING_TRANSCODING_ENABLED))
+        return result;
+
+    auto list = config->getTranscodingProfileListOption(CFG_TRANSCODING_PROFILE_LIST);
+    if (!list)
+        return result;
+    for (auto&& [mimeType, profiles] : list->getList()) {
+        for (auto&& [name, profile] : *profiles) {
+            if (profile->getEnabled() && profile->getType() == TR_External && profile->getWarmProcesses() > 0)
+                result[name] = profile;
+        }
+    }
+    return result;
+}
+
+void TranscodeWarmPool::threadProc()
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    while (!shutdownFlag) {
+        auto wanted = getWantedProcesses();
+
+        // drop the helpers of profiles which were changed in the meantime
+        for (auto it = processes.begin(); it != processes.end();) {
+            auto profile = getValueOrDefault(wanted, it->first, std::shared_ptr<TranscodingProfile>());
+            auto& helpers = it->second;
+            if (profile) {
+                helpers.erase(std::remove_if(helpers.begin(), helpers.end(), [output = useOutput(*profile)](auto&& process) { return process->hasOutput() != output; }), helpers.end());
+                if (helpers.size() > std::size_t(profile->getWarmProcesses()))
+                    helpers.resize(profile->getWarmProcesses());
+            } else {
+                helpers.clear();
+            }
+            it = helpers.empty() ? processes.erase(it) : std::next(it);
+        }
+
+        std::size_t fifoCount = 0;
+        for (auto&& [name, profile] : wanted) {
+            auto count = std::size_t(profile->getWarmProcesses());
+            auto withOutput = useOutput(*profile);
+            if (!withOutput)
+                fifoCount += count;
+            while (!shutdownFlag && processes[name].size() < count) {
+                // forking takes a while, don't block the requests
+                lock.unlock();
+                std::unique_ptr<WarmProcess> process;
+                try {
+                    process = std::make_unique<WarmProcess>(withOutput);
+                } catch (const std::runtime_error& e) {
+                    log_warning("Failed to start warm process for profile {}: {}", name, e.what());
+                }
+                lock.lock();
+                if (!process)
+                    break;
+                processes[name].push_back(std::move(process));
+            }
+        }
+
+        while (!shutdownFlag && fifos.size() < fifoCount) {
+            try {
+                fifos.push_back(makeFifo(config->getOption(CFG_SERVER_TMPDIR)));
+            } catch (const std::runtime_error& e) {
+                break;
+            }
+        }
+
+        refill.wait_for(lock, WARM_POOL_REFILL_INTERVAL);
+    }
+}
+
+StartupTimingIOHandler::StartupTimingIOHandler(std::shared_ptr<TranscodeWarmPool> pool, std::string profile, TranscodeStartupTimings timings,
+    std::chrono::steady_clock::time_point start, std::size_t initialFillSize, std::unique_ptr<IOHandler> ioHandler)
+    : pool(std::move(pool))
+    , profile(std::move(profile))
+    , timings(timings)
+    , start(start)
+    , initialFillSize(initialFillSize)
+    , ioHandler(std::move(ioHandler))
+{
+}
+
+std::size_t StartupTimingIOHandler::read(char* buf, std::size_t length)
+{
+    auto ret = ioHandler->read(buf, length);
+    if (!reported && ret > 0 && ret != std::size_t(-1) && ret != std::size_t(CHECK_SOCKET)) {
+        reported = true;
+        timings.firstData = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        log_debug("Startup of transcoding profile {}: resolve {} us, pipe {} us, spawn {} us{}, first data after {} ms with initial fill size {}",
+            profile, timings.resolve.count(), timings.pipe.count(), timings.spawn.count(), timings.warm ? " (warm)" : "",
+            timings.firstData.count() / 1000, initialFillSize);
+        pool->addTimings(profile, timings);
+    }
+    return ret;
+}
@@ -0,0 +1,183 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    transcode_warm_pool.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file transcode_warm_pool.h
+/// \brief Definition of the TranscodeWarmPool class.
+
+#ifndef __TRANSCODE_WARM_POOL_H__
+#define __TRANSCODE_WARM_POOL_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "iohandler/io_handler.h"
+#include "util/grb_fs.h"
+
+// forward declaration
+class Config;
+class TranscodeWarmPool;
+class TranscodingProfile;
+
+/// \brief duration of the stages of a transcoder start
+struct TranscodeStartupTimings {
+    /// \brief finding the executable of the transcoder
+    std::chrono::microseconds resolve {};
+    /// \brief creating the output pipe or FIFO
+    std::chrono::microseconds pipe {};
+    /// \brief starting the process
+    std::chrono::microseconds spawn {};
+    /// \brief from the start until the first read returned data, includes waiting for the initial fill size
+    std::chrono::microseconds firstData {};
+    /// \brief a process of the warm pool was used
+    bool warm {};
+};
+
+/// \brief startup timings summed up per profile
+struct TranscodeStartupStatistics {
+    std::size_t starts {};
+    std::size_t warmStarts {};
+    TranscodeStartupTimings total;
+    TranscodeStartupTimings max;
+};
+
+/// \brief a forked helper process waiting for the command it should execute
+///
+/// The helper is forked in advance, so a request only has to send the command
+/// line and the environment to it. If the helper is created with an output
+/// pipe, its standard output is connected to the pipe already.
+class WarmProcess {
+public:
+    /// \param withOutput create a pipe for the standard output of the process
+    explicit WarmProcess(bool withOutput);
+    ~WarmProcess();
+
+    WarmProcess(const WarmProcess&) = delete;
+    WarmProcess& operator=(const WarmProcess&) = delete;
+
+    /// \brief let the helper replace itself with executable
+    /// \param argv including argv[0]
+    /// \param env overrides of the environment of the server
+    /// \return false if the helper is gone
+    bool exec(const fs::path& executable, const std::vector<std::string>& argv, const std::map<std::string, std::string>& env);
+
+    /// \brief pid of the helper, and of the executed process after exec()
+    pid_t getPid() const { return pid; }
+
+    /// \brief hand the read end of the output pipe over to the caller
+    int releaseOutput();
+    bool hasOutput() const { return output >= 0; }
+
+private:
+    pid_t pid { -1 };
+    int control { -1 };
+    int output { -1 };
+    bool started {};
+};
+
+/// \brief resources prepared ahead of transcoding requests
+///
+/// The pool caches the executables found in $PATH and keeps the number of
+/// helper processes configured by warm-processes of a profile ready. A
+/// background thread replaces the helpers taken by requests. Transcoders write
+/// to FIFOs, which are also created in advance, unless the profile uses the
+/// standard output and epoll is available.
+class TranscodeWarmPool {
+public:
+    explicit TranscodeWarmPool(std::shared_ptr<Config> config);
+    ~TranscodeWarmPool();
+
+    TranscodeWarmPool(const TranscodeWarmPool&) = delete;
+    TranscodeWarmPool& operator=(const TranscodeWarmPool&) = delete;
+
+    /// \brief start filling the pool
+    void run();
+    /// \brief stop all helper processes
+    void shutdown();
+
+    /// \brief find the executable of a transcoder, the search in $PATH is done only once per command
+    fs::path resolveCommand(const fs::path& command);
+
+    /// \brief take a helper process for profile
+    /// \return nullptr if none is ready
+    std::unique_ptr<WarmProcess> takeProcess(const std::shared_ptr<TranscodingProfile>& profile);
+
+    /// \brief take a FIFO created in advance or create a new one
+    fs::path takeFifo();
+
+    /// \brief add the timings of a transcoder start to the statistics of profile
+    void addTimings(const std::string& profile, const TranscodeStartupTimings& timings);
+    TranscodeStartupStatistics getStatistics(const std::string& profile) const;
+
+    /// \brief create a FIFO in dir
+    static fs::path makeFifo(const fs::path& dir);
+
+private:
+    std::shared_ptr<Config> config;
+
+    mutable std::mutex mutex;
+    /// \brief signalled when the pool should be refilled
+    std::condition_variable refill;
+    std::thread thread;
+    bool running {};
+    bool shutdownFlag {};
+
+    std::map<fs::path, fs::path> commandPaths;
+    std::map<std::string, std::deque<std::unique_ptr<WarmProcess>>> processes;
+    std::deque<fs::path> fifos;
+    std::map<std::string, TranscodeStartupStatistics> statistics;
+
+    void threadProc();
+    /// \brief profiles which want helpers by name
+    std::map<std::string, std::shared_ptr<TranscodingProfile>> getWantedProcesses() const;
+};
+
+/// \brief reports the time until the first data of a transcoder arrives
+class StartupTimingIOHandler : public IOHandler {
+public:
+    StartupTimingIOHandler(std::shared_ptr<TranscodeWarmPool> pool, std::string profile, TranscodeStartupTimings timings,
+        std::chrono::steady_clock::time_point start, std::size_t initialFillSize, std::unique_ptr<IOHandler> ioHandler);
+
+    void open(enum UpnpOpenFileMode mode) override { ioHandler->open(mode); }
+    std::size_t read(char* buf, std::size_t length) override;
+    std::size_t write(char* buf, std::size_t length) override { return ioHandler->write(buf, length); }
+    void seek(off_t offset, int whence) override { ioHandler->seek(offset, whence); }
+    off_t tell() override { return ioHandler->tell(); }
+    void close() override { ioHandler->close(); }
+
+private:
+    std::shared_ptr<TranscodeWarmPool> pool;
+    std::string profile;
+    TranscodeStartupTimings timings;
+    std::chrono::steady_clock::time_point start;
+    std::size_t initialFillSize;
+    bool reported {};
+    std::unique_ptr<IOHandler> ioHandler;
+};
+
+#endif // __TRANSCODE_WARM_POOL_H__
@@ -44,7 +44,8 @@
 enum transcoding_type_t {
     TR_None,
     TR_External,
-    TR_Remote
+    TR_Remote,
+    TR_Internal
 };
 
 enum avi_fourcc_listmode_t {
@@ -114,6 +115,9 @@ public:
 
     /// \brief retrieves the argument string
     std::string getArguments() const { return args; }
+
+    /// \brief the transcoder can start at a time offset, external ones need the %start token
+    bool canSeek() const { return tr_type == TR_Internal || args.find("%start") != std::string::npos; }
     void setEnviron(const std::map<std::string, std::string>& environ) { this->environment = environ; }
 
     const std::map<std::string, std::string>& getEnviron() const { return environment; }
@@ -189,6 +193,26 @@ public:
     void setNumChannels(int chans) { number_of_channels = chans; }
     int getNumChannels() const { return number_of_channels; }
 
+    /// \brief libavformat muxer used by internal profiles, e.g. "mpegts"
+    void setFormat(const std::string& format) { this->format = format; }
+    std::string getFormat() const { return format; }
+
+    /// \brief encoder for the audio stream of internal profiles, "copy" keeps the source codec
+    void setAudioCodec(const std::string& codec) { audio_codec = codec; }
+    std::string getAudioCodec() const { return audio_codec; }
+
+    /// \brief Maximum number of transcoders running with this profile, 0 for unlimited
+    void setMaxJobs(int jobs) { max_jobs = jobs; }
+    int getMaxJobs() const { return max_jobs; }
+
+    /// \brief Number of helper processes kept ready to start the transcoder
+    void setWarmProcesses(int processes) { warm_processes = processes; }
+    int getWarmProcesses() const { return warm_processes; }
+
+    /// \brief Read the output from the standard output of the agent instead of a FIFO
+    void setUseStdout(bool use) { use_stdout = use; }
+    bool useStdout() const { return use_stdout; }
+
     static std::string mapFourCcMode(avi_fourcc_listmode_t mode);
 
 protected:
@@ -196,12 +220,15 @@ protected:
     std::string tm;
     fs::path command;
     std::string args;
+    std::string format;
+    std::string audio_codec { "copy" };
     bool enabled { true };
     bool first_resource {};
     bool theora {};
     bool accept_url { true };
     bool hide_orig_res {};
     bool thumbnail {};
+    bool use_stdout {};
     bool force_chunked { true };
     std::size_t buffer_size {};
     std::size_t chunk_size {};
@@ -209,6 +236,8 @@ protected:
     transcoding_type_t tr_type;
     int number_of_channels { SOURCE };
     int sample_frequency { SOURCE };
+    int max_jobs {};
+    int warm_processes {};
     std::map<std::string, std::string> attributes;
     std::map<std::string, std::string> environment;
     std::vector<std::string> fourcc_list;
@@ -37,6 +37,7 @@
 #include "config/config_manager.h"
 #include "database/database.h"
 #include "database/sql_database.h"
+#include "util/metrics.h"
 #include "util/upnp_quirks.h"
 
 ContentDirectoryService::ContentDirectoryService(const std::shared_ptr<Context>& context,
@@ -55,6 +56,8 @@ ContentDirectoryService::ContentDirectoryService(const std::shared_ptr<Context>&
 void ContentDirectoryService::doBrowse(const std::unique_ptr<ActionRequest>& request)
 {
     log_debug("start");
+    static auto&& requestTime = Metrics::getInstance()->histogram("gerbera_cds_request_seconds", "Duration of ContentDirectory actions", R"(action="Browse")");
+    auto timer = MetricTimer(requestTime);
 
     auto req = request->getRequest();
     auto reqRoot = req->document_element();
@@ -136,7 +139,7 @@ void ContentDirectoryService::doBrowse(const std::unique_ptr<ActionRequest>& req
     }
 
     std::string didlLiteXml = UpnpXMLBuilder::printXml(didlLite, "", 0);
-    log_debug("didl {}", didlLiteXml);
+    log_vdebug(cds, "didl {}", didlLiteXml);
 
     auto response = UpnpXMLBuilder::createResponse(request->getActionName(), UPNP_DESC_CDS_SERVICE_TYPE);
     auto respRoot = response->document_element();
@@ -152,6 +155,8 @@ void ContentDirectoryService::doBrowse(const std::unique_ptr<ActionRequest>& req
 void ContentDirectoryService::doSearch(const std::unique_ptr<ActionRequest>& request)
 {
     log_debug("start");
+    static auto&& requestTime = Metrics::getInstance()->histogram("gerbera_cds_request_seconds", "Duration of ContentDirectory actions", R"(action="Search")");
+    auto timer = MetricTimer(requestTime);
 
     auto req = request->getRequest();
     auto reqRoot = req->document_element();
@@ -222,7 +227,7 @@ void ContentDirectoryService::doSearch(const std::unique_ptr<ActionRequest>& req
     }
 
     std::string didlLiteXml = UpnpXMLBuilder::printXml(didlLite, "", 0);
-    log_debug("didl {}", didlLiteXml);
+    log_vdebug(cds, "didl {}", didlLiteXml);
 
     auto response = UpnpXMLBuilder::createResponse(request->getActionName(), UPNP_DESC_CDS_SERVICE_TYPE);
     auto respRoot = response->document_element();
@@ -55,6 +55,9 @@
 #define UPNP_DLNA_TRANSFER_MODE_STREAMING "Streaming"
 #define UPNP_DLNA_TRANSFER_MODE_INTERACTIVE "Interactive"
 
+// time based seeking
+#define UPNP_DLNA_TIME_SEEK_HEADER "TimeSeekRange.dlna.org"
+
 // contentFeatures
 #define UPNP_DLNA_CONTENT_FEATURES_HEADER "contentFeatures.dlna.org"
 #define UPNP_DLNA_PROFILE "DLNA.ORG_PN"
@@ -37,6 +37,7 @@
 #include "database/database.h"
 #include "metadata/metadata_handler.h"
 #include "request_handler.h"
+#include "transcoding/transcode_seek.h"
 #include "transcoding/transcoding.h"
 
 UpnpXMLBuilder::UpnpXMLBuilder(const std::shared_ptr<Context>& context,
@@ -210,7 +211,7 @@ void UpnpXMLBuilder::renderObject(const std::shared_ptr<CdsObject>& obj, std::si
             }
         }
     }
-    log_debug("Rendered DIDL: {}", printXml(result, "  "));
+    log_vdebug(xml, "Rendered DIDL: {}", printXml(result, "  "));
 }
 
 std::unique_ptr<pugi::xml_document> UpnpXMLBuilder::createEventPropertySet()
@@ -501,7 +502,7 @@ void UpnpXMLBuilder::addResources(const std::shared_ptr<CdsItem>& item, pugi::xm
     bool skipURL = (item->isExternalItem() && !item->getFlag(OBJECT_FLAG_PROXY_URL));
 
     bool isExtThumbnail = false; // this sucks
-    auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
+    auto snapshot = config->getSnapshot();
 
     // this will be used to count only the "real" resources, omitting the
     // transcoded ones
@@ -526,7 +527,7 @@ void UpnpXMLBuilder::addResources(const std::shared_ptr<CdsItem>& item, pugi::xm
             // check for client profile prop and filter if no match
             if (quirks && tp->getClientFlags() > 0 && quirks->checkFlags(tp->getClientFlags()) == 0)
                 continue;
-            std::string ct = getValueOrDefault(mappings, item->getMimeType());
+            auto&& ct = snapshot->getContentType(item->getMimeType());
             if (ct == CONTENT_TYPE_OGG) {
                 if (((item->getFlag(OBJECT_FLAG_OGG_THEORA)) && (!tp->isTheora())) || (!item->getFlag(OBJECT_FLAG_OGG_THEORA) && (tp->isTheora()))) {
                     continue;
@@ -644,7 +645,7 @@ void UpnpXMLBuilder::addResources(const std::shared_ptr<CdsItem>& item, pugi::xm
         }
 
         assert(!mimeType.empty());
-        std::string contentType = getValueOrDefault(mappings, mimeType);
+        auto&& contentType = snapshot->getContentType(mimeType);
         std::string url;
 
         /// \todo who will sync mimetype that is part of the protocol info and
@@ -703,7 +704,15 @@ void UpnpXMLBuilder::addResources(const std::shared_ptr<CdsItem>& item, pugi::xm
             /// \todo clean this up, make sure to check the mimetype and
             /// provide the profile correctly
             aa.append_attribute(UPNP_XML_DLNA_NAMESPACE_ATTR) = UPNP_XML_DLNA_METADATA_NAMESPACE;
-            aa.append_attribute("dlna:profileID") = "JPEG_TN";
+            auto [artX, artY] = checkResolution(res->getAttribute(R_RESOLUTION));
+            if (artX <= 160 && artY <= 160)
+                aa.append_attribute("dlna:profileID") = UPNP_DLNA_PROFILE_JPEG_TN;
+            else if (artX <= 640 && artY <= 480)
+                aa.append_attribute("dlna:profileID") = UPNP_DLNA_PROFILE_JPEG_SM;
+            else if (artX <= 1024 && artY <= 768)
+                aa.append_attribute("dlna:profileID") = UPNP_DLNA_PROFILE_JPEG_MED;
+            else
+                aa.append_attribute("dlna:profileID") = UPNP_DLNA_PROFILE_JPEG_LRG;
             if (res->isMetaResource(ID3_ALBUM_ART)) {
                 continue;
             }
@@ -753,10 +762,11 @@ void UpnpXMLBuilder::addResources(const std::shared_ptr<CdsItem>& item, pugi::xm
             extend = dlnaProfile.empty() ? getDLNAprofileString(config, contentType, res->getAttribute(R_VIDEOCODEC), res->getAttribute(R_AUDIOCODEC)) : fmt::format("{}={};", UPNP_DLNA_PROFILE, dlnaProfile);
         }
 
-        // we do not support seeking at all, so 00
+        // seeking depends on the profile being able to start at a time offset
         // and the media is converted, so set CI to 1
         if (!isExtThumbnail && transcoded) {
-            extend.append(fmt::format("{}={};{}={}", UPNP_DLNA_OP, UPNP_DLNA_OP_SEEK_DISABLED, UPNP_DLNA_CONVERSION_INDICATOR, UPNP_DLNA_CONVERSION));
+            auto tp = tlist->getByName(getValueOrDefault(resParams, URL_PARAM_TRANSCODE_PROFILE_NAME));
+            extend.append(fmt::format("{}={};{}={}", UPNP_DLNA_OP, getTranscodeSeekFlags(tp), UPNP_DLNA_CONVERSION_INDICATOR, UPNP_DLNA_CONVERSION));
 
             if (startswith(mimeType, "audio") || startswith(mimeType, "video"))
                 extend.append(";" UPNP_DLNA_FLAGS "=" UPNP_DLNA_ORG_FLAGS_AV);
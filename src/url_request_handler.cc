@@ -140,7 +140,7 @@ std::unique_ptr<IOHandler> URLRequestHandler::open(const char* filename, enum Up
     }
 
     ///\todo make curl io handler configurable for url request handler
-    auto ioHandler = std::make_unique<CurlIOHandler>(config, url, nullptr, 1024 * 1024, 0);
+    auto ioHandler = std::make_unique<CurlIOHandler>(config, content->getCurlEngine(), url, 1024 * 1024, 0);
     ioHandler->open(mode);
     content->triggerPlayHook(obj);
     return ioHandler;
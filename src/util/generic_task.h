@@ -11,12 +11,14 @@ enum task_type_t {
     AddFile,
     RemoveObject,
     RescanDirectory,
-    FetchOnlineContent
+    FetchOnlineContent,
+    Transcode
 };
 
 enum task_owner_t {
     ContentManagerTask,
-    TaskProcessorTask
+    TaskProcessorTask,
+    TranscodeSchedulerTask
 };
 
 class GenericTask {
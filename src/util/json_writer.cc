@@ -0,0 +1,167 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    json_writer.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file json_writer.cc
+
+#include "json_writer.h" // API
+
+#include <algorithm>
+
+JsonWriter::JsonWriter(bool members)
+    : members(members)
+{
+    if (members)
+        first.push_back(true);
+}
+
+void JsonWriter::clear()
+{
+    buffer.clear();
+    first.clear();
+    if (members)
+        first.push_back(true);
+    afterKey = false;
+}
+
+void JsonWriter::separator()
+{
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!first.empty()) {
+        if (!first.back())
+            buffer.push_back(',');
+        first.back() = false;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject()
+{
+    separator();
+    buffer.push_back('{');
+    first.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+    buffer.push_back('}');
+    first.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray()
+{
+    separator();
+    buffer.push_back('[');
+    first.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+    buffer.push_back(']');
+    first.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name)
+{
+    separator();
+    appendString(buffer, name);
+    buffer.push_back(':');
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text)
+{
+    separator();
+    appendString(buffer, text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag)
+{
+    separator();
+    buffer.append(flag ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::textValue(std::string_view text)
+{
+    if (text == "true" || text == "false") {
+        separator();
+        buffer.append(text);
+        return *this;
+    }
+
+    auto digits = text.substr(!text.empty() && text.front() == '-' ? 1 : 0);
+    if (!digits.empty() && std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        separator();
+        buffer.append(text);
+        return *this;
+    }
+
+    return value(text);
+}
+
+void JsonWriter::appendString(std::string& out, std::string_view text)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    out.push_back('"');
+    auto start = text.begin();
+    for (auto it = text.begin(); it != text.end(); ++it) {
+        auto c = static_cast<unsigned char>(*it);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        out.append(start, it);
+        start = std::next(it);
+        switch (c) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\r':
+            out.append("\\r");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            out.append("\\u00");
+            out.push_back(hex[c >> 4]);
+            out.push_back(hex[c & 0xf]);
+        }
+    }
+    out.append(start, text.end());
+    out.push_back('"');
+}
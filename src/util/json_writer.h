@@ -0,0 +1,101 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    json_writer.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file json_writer.h
+/// \brief streaming json output for the web ui
+
+#ifndef __UTIL_JSON_WRITER_H__
+#define __UTIL_JSON_WRITER_H__
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+/// \brief appends json directly to a string buffer
+///
+/// Objects and arrays are opened and closed explicitly, the writer only keeps
+/// track of the separators. Keys are written with the key() call or by the
+/// variants taking a key, so a member is written as key("id").value(5) or
+/// field("id", 5).
+class JsonWriter {
+public:
+    /// \brief create a writer for a single json value
+    /// \param members the output is a list of members of an object that is opened and closed by the caller
+    explicit JsonWriter(bool members = false);
+
+    JsonWriter& beginObject();
+    JsonWriter& beginObject(std::string_view name) { return key(name).beginObject(); }
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& beginArray(std::string_view name) { return key(name).beginArray(); }
+    JsonWriter& endArray();
+
+    /// \brief write the key of the next object member
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+    JsonWriter& value(bool flag);
+    template <typename T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>, bool> = true>
+    JsonWriter& value(T number)
+    {
+        separator();
+        fmt::format_to(std::back_inserter(buffer), "{}", number);
+        return *this;
+    }
+
+    /// \brief write text as boolean or number if it looks like one and as string otherwise
+    ///
+    /// This is the conversion Xml2Json applies to untyped values, it is kept
+    /// for fields that the ui already receives in this form.
+    JsonWriter& textValue(std::string_view text);
+
+    /// \brief write a complete object member
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& val) { return key(name).value(val); }
+    JsonWriter& textField(std::string_view name, std::string_view text) { return key(name).textValue(text); }
+
+    /// \brief quote and escape text as json string into out
+    static void appendString(std::string& out, std::string_view text);
+
+    const std::string& str() const { return buffer; }
+    bool empty() const { return buffer.empty(); }
+    void reserve(std::size_t size) { buffer.reserve(size); }
+    /// \brief drop all output and start over
+    void clear();
+
+private:
+    void separator();
+
+    std::string buffer;
+    /// \brief one entry for each open object or array, true until the first element was written
+    std::vector<bool> first;
+    bool members;
+    bool afterKey {};
+};
+
+#endif // __UTIL_JSON_WRITER_H__
@@ -0,0 +1,57 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    logger.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file logger.cc
+
+#include "logger.h" // API
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "exceptions.h"
+#include "util/tools.h"
+
+static constexpr std::array<std::pair<std::string_view, GrbLogFacility>, 4> facilityNames { {
+    { "cds", GrbLogFacility::cds },
+    { "xml", GrbLogFacility::xml },
+    { "clients", GrbLogFacility::clients },
+    { "sql", GrbLogFacility::sql },
+} };
+
+void GrbLogger::enableFacilities(const std::string& names)
+{
+    unsigned int mask = 0;
+    for (auto&& name : splitString(toLower(names), ',')) {
+        trimStringInPlace(name);
+        if (name == "all") {
+            mask = ~0U;
+            continue;
+        }
+        auto it = std::find_if(facilityNames.begin(), facilityNames.end(), [&](auto&& entry) { return entry.first == name; });
+        if (it == facilityNames.end())
+            throw_std_runtime_error("Unknown debug mode {}", name);
+        mask |= 1U << int(it->second);
+    }
+    facilities.fetch_or(mask, std::memory_order_relaxed);
+}
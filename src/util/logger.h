@@ -32,9 +32,43 @@
 #ifndef __LOGGER_H__
 #define __LOGGER_H__
 
+#include <atomic>
 #include <spdlog/spdlog.h>
+#include <string>
 
-#define log_debug SPDLOG_DEBUG
+/// \brief subsystems with verbose debug output that is enabled separately by --debug-mode
+enum class GrbLogFacility {
+    cds,
+    xml,
+    clients,
+    sql,
+};
+
+class GrbLogger {
+public:
+    /// \brief enable facilities from a comma separated list of names, "all" enables every facility
+    static void enableFacilities(const std::string& names);
+    static bool isEnabled(GrbLogFacility facility) { return facilities.load(std::memory_order_relaxed) & (1U << int(facility)); }
+
+private:
+    static inline std::atomic<unsigned int> facilities {};
+};
+
+// the arguments are only evaluated if the message is really written,
+// so expensive formatting does not cost anything with debug output disabled
+#define log_debug(...)                                  \
+    do {                                                \
+        if (spdlog::should_log(spdlog::level::debug)) { \
+            SPDLOG_DEBUG(__VA_ARGS__);                  \
+        }                                               \
+    } while (false)
+// debug output of a subsystem, e.g. log_vdebug(xml, "{}", dump())
+#define log_vdebug(facility, ...)                                                                              \
+    do {                                                                                                       \
+        if (GrbLogger::isEnabled(GrbLogFacility::facility) && spdlog::should_log(spdlog::level::debug)) { \
+            SPDLOG_DEBUG(__VA_ARGS__);                                                                         \
+        }                                                                                                      \
+    } while (false)
 #define log_info SPDLOG_INFO
 #define log_warning SPDLOG_WARN
 #define log_error SPDLOG_ERROR
@@ -0,0 +1,202 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    metrics.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file metrics.cc
+
+#include "metrics.h" // API
+
+#include <algorithm>
+#include <fmt/format.h>
+
+#include "util/tools.h"
+
+std::size_t MetricHistogram::bucketIndex(std::uint64_t micros)
+{
+    if (micros < SUB_BUCKETS)
+        return micros;
+
+    std::size_t exponent = 63 - __builtin_clzll(micros);
+    if (exponent > MAX_EXPONENT)
+        return BUCKETS - 1;
+    return SUB_BUCKETS * (exponent - 1) + ((micros >> (exponent - 2)) & (SUB_BUCKETS - 1));
+}
+
+std::uint64_t MetricHistogram::bucketLimit(std::size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    auto exponent = bucket / SUB_BUCKETS + 1;
+    auto sub = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << (exponent - 2)) - 1;
+}
+
+void MetricHistogram::record(std::chrono::microseconds duration)
+{
+    auto micros = std::uint64_t(std::max(duration.count(), std::chrono::microseconds::rep(0)));
+    buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(micros, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds MetricHistogram::getQuantile(double q) const
+{
+    std::array<std::uint64_t, BUCKETS> values;
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < BUCKETS; i++) {
+        values[i] = getBucket(i);
+        total += values[i];
+    }
+    if (total == 0)
+        return std::chrono::microseconds::zero();
+
+    auto rank = std::max<std::uint64_t>(1, std::uint64_t(q * total + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; i++) {
+        seen += values[i];
+        if (seen >= rank)
+            return std::chrono::microseconds(bucketLimit(i));
+    }
+    return std::chrono::microseconds(bucketLimit(BUCKETS - 1));
+}
+
+std::unique_ptr<Metrics> Metrics::instance;
+std::once_flag Metrics::instanceInit;
+
+Metrics* Metrics::getInstance()
+{
+    std::call_once(instanceInit, [] { instance = std::make_unique<Metrics>(); });
+    return instance.get();
+}
+
+Metrics::Entry& Metrics::getEntry(const std::string& name, const std::string& help, const std::string& labels, MetricType type)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    auto it = std::find_if(entries.begin(), entries.end(), [&](auto&& entry) { return entry->name == name && entry->labels == labels; });
+    if (it != entries.end()) {
+        if ((*it)->type != type)
+            throw_std_runtime_error("Metric {}{{{}}} registered with different type", name, labels);
+        return **it;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labels;
+    entry->type = type;
+    switch (type) {
+    case MetricType::Counter:
+        entry->counter = std::make_unique<MetricCounter>();
+        break;
+    case MetricType::Gauge:
+        entry->gauge = std::make_unique<MetricGauge>();
+        break;
+    case MetricType::Histogram:
+        entry->histogram = std::make_unique<MetricHistogram>();
+        break;
+    }
+    entries.push_back(std::move(entry));
+    return *entries.back();
+}
+
+MetricCounter& Metrics::counter(const std::string& name, const std::string& help, const std::string& labels)
+{
+    return *getEntry(name, help, labels, MetricType::Counter).counter;
+}
+
+MetricGauge& Metrics::gauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+    return *getEntry(name, help, labels, MetricType::Gauge).gauge;
+}
+
+MetricHistogram& Metrics::histogram(const std::string& name, const std::string& help, const std::string& labels)
+{
+    return *getEntry(name, help, labels, MetricType::Histogram).histogram;
+}
+
+std::vector<const Metrics::Entry*> Metrics::getEntries() const
+{
+    std::vector<const Entry*> result;
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        result.reserve(entries.size());
+        for (auto&& entry : entries)
+            result.push_back(entry.get());
+    }
+    std::sort(result.begin(), result.end(), [](auto&& a, auto&& b) { return a->name != b->name ? a->name < b->name : a->labels < b->labels; });
+    return result;
+}
+
+static std::string_view typeName(MetricType type)
+{
+    switch (type) {
+    case MetricType::Counter:
+        return "counter";
+    case MetricType::Gauge:
+        return "gauge";
+    case MetricType::Histogram:
+        return "histogram";
+    }
+    return "untyped";
+}
+
+std::string Metrics::renderPrometheus() const
+{
+    std::string result;
+    auto out = std::back_inserter(result);
+    std::string lastName;
+    for (auto&& entry : getEntries()) {
+        if (entry->name != lastName) {
+            fmt::format_to(out, "# HELP {} {}\n# TYPE {} {}\n", entry->name, entry->help, entry->name, typeName(entry->type));
+            lastName = entry->name;
+        }
+        auto labels = entry->labels.empty() ? "" : fmt::format("{{{}}}", entry->labels);
+        switch (entry->type) {
+        case MetricType::Counter:
+            fmt::format_to(out, "{}{} {}\n", entry->name, labels, entry->counter->get());
+            break;
+        case MetricType::Gauge:
+            fmt::format_to(out, "{}{} {}\n", entry->name, labels, entry->gauge->get());
+            break;
+        case MetricType::Histogram: {
+            // export every fourth power of two from 64us, the limits of these buckets are exact
+            auto&& histogram = *entry->histogram;
+            auto sep = entry->labels.empty() ? "" : ",";
+            std::uint64_t cumulative = 0;
+            std::size_t exponent = 6;
+            for (std::size_t i = 0; i < MetricHistogram::BUCKETS; i++) {
+                cumulative += histogram.getBucket(i);
+                if (MetricHistogram::bucketLimit(i) + 1 == (std::uint64_t(1) << exponent)) {
+                    fmt::format_to(out, "{}_bucket{{{}{}le=\"{}\"}} {}\n", entry->name, entry->labels, sep, double(std::uint64_t(1) << exponent) / 1e6, cumulative);
+                    exponent += 2;
+                }
+            }
+            fmt::format_to(out, "{}_bucket{{{}{}le=\"+Inf\"}} {}\n", entry->name, entry->labels, sep, cumulative);
+            fmt::format_to(out, "{}_sum{} {}\n", entry->name, labels, double(histogram.getSum().count()) / 1e6);
+            fmt::format_to(out, "{}_count{} {}\n", entry->name, labels, cumulative);
+            break;
+        }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,166 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    metrics.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file metrics.h
+/// \brief Definition of the Metrics registry.
+
+#ifndef __UTIL_METRICS_H__
+#define __UTIL_METRICS_H__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class MetricType {
+    Counter,
+    Gauge,
+    Histogram,
+};
+
+/// \brief monotonic counter, e.g. bytes served
+class MetricCounter {
+public:
+    void inc(std::uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value {};
+};
+
+/// \brief current value, e.g. a queue length
+class MetricGauge {
+public:
+    void set(std::int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void add(std::int64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+    std::int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> value {};
+};
+
+/// \brief latency histogram with logarithmic buckets
+///
+/// Durations are counted in microseconds. Like in a HDR histogram every
+/// power of two is split into 4 linear sub buckets, so a bucket is at most
+/// 25% wide and recording is a single atomic increment.
+class MetricHistogram {
+public:
+    static constexpr std::size_t SUB_BUCKETS = 4;
+    /// \brief largest power of two with own buckets, about 19 hours
+    static constexpr std::size_t MAX_EXPONENT = 36;
+    static constexpr std::size_t BUCKETS = SUB_BUCKETS * MAX_EXPONENT;
+
+    void record(std::chrono::microseconds duration);
+
+    std::uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    /// \brief sum of all recorded durations
+    std::chrono::microseconds getSum() const { return std::chrono::microseconds(sum.load(std::memory_order_relaxed)); }
+    std::uint64_t getBucket(std::size_t bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    /// \brief upper bound of the bucket containing quantile q (0..1)
+    std::chrono::microseconds getQuantile(double q) const;
+
+    static std::size_t bucketIndex(std::uint64_t micros);
+    /// \brief largest value in microseconds counted in bucket
+    static std::uint64_t bucketLimit(std::size_t bucket);
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKETS> buckets {};
+    std::atomic<std::uint64_t> count {};
+    std::atomic<std::uint64_t> sum {};
+};
+
+/// \brief records the lifetime of the timer into a histogram
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& histogram)
+        : histogram(histogram)
+        , start(std::chrono::steady_clock::now())
+    {
+    }
+    ~MetricTimer() { stop(); }
+
+    /// \brief record now instead of at the end of the scope
+    void stop()
+    {
+        if (stopped)
+            return;
+        histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+        stopped = true;
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+    bool stopped { false };
+};
+
+/// \brief process wide registry of all metrics
+///
+/// Metrics are registered once, usually into a function local static, and
+/// live as long as the process. Updating them never locks, only registration
+/// and rendering take the registry lock.
+class Metrics {
+public:
+    class Entry {
+    public:
+        std::string name;
+        std::string help;
+        /// \brief prometheus labels without braces, e.g. type="select"
+        std::string labels;
+        MetricType type;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /// \brief all metrics sorted by name and labels
+    std::vector<const Entry*> getEntries() const;
+
+    /// \brief render all metrics in Prometheus text exposition format
+    std::string renderPrometheus() const;
+
+    static Metrics* getInstance();
+
+private:
+    Entry& getEntry(const std::string& name, const std::string& help, const std::string& labels, MetricType type);
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+
+    static std::unique_ptr<Metrics> instance;
+    static std::once_flag instanceInit;
+};
+
+#endif // __UTIL_METRICS_H__
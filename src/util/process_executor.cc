@@ -40,7 +40,7 @@
 #include "exceptions.h"
 #include "logger.h"
 
-ProcessExecutor::ProcessExecutor(const std::string& command, const std::vector<std::string>& arglist, const std::map<std::string, std::string>& env, std::vector<fs::path> tempPaths)
+ProcessExecutor::ProcessExecutor(const std::string& command, const std::vector<std::string>& arglist, const std::map<std::string, std::string>& env, std::vector<fs::path> tempPaths, int stdOut)
     : tempPaths(std::move(tempPaths))
 {
 #define MAX_ARGS 255
@@ -69,6 +69,9 @@ ProcessExecutor::ProcessExecutor(const std::string& command, const std::vector<s
             log_debug("setenv: {}='{}'", eName, eValue);
         }
         log_debug("Launching process: {} {}", command, fmt::join(arglist, " "));
+        // after logging, the log may be written to stdout
+        if (stdOut >= 0 && stdOut != STDOUT_FILENO)
+            dup2(stdOut, STDOUT_FILENO);
         execvp(command.c_str(), const_cast<char**>(argv));
         break;
     default:
@@ -78,6 +81,12 @@ ProcessExecutor::ProcessExecutor(const std::string& command, const std::vector<s
     log_debug("Launched process {} {}, pid: {}", command, fmt::join(arglist, " "), pid);
 }
 
+ProcessExecutor::ProcessExecutor(pid_t pid, std::vector<fs::path> tempPaths)
+    : tempPaths(std::move(tempPaths))
+    , pid(pid)
+{
+}
+
 bool ProcessExecutor::isAlive()
 {
     return (waitpid(pid, &exitStatus, WNOHANG) == 0);
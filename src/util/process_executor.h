@@ -42,7 +42,10 @@
 
 class ProcessExecutor final : public Executor {
 public:
-    ProcessExecutor(const std::string& command, const std::vector<std::string>& arglist, const std::map<std::string, std::string>& env, std::vector<fs::path> tempPaths);
+    /// \param stdOut file descriptor which becomes the standard output of the process, -1 to inherit it
+    ProcessExecutor(const std::string& command, const std::vector<std::string>& arglist, const std::map<std::string, std::string>& env, std::vector<fs::path> tempPaths, int stdOut = -1);
+    /// \brief take over a child process started elsewhere
+    ProcessExecutor(pid_t pid, std::vector<fs::path> tempPaths);
     ~ProcessExecutor() override;
 
     ProcessExecutor(const ProcessExecutor&) = delete;
@@ -0,0 +1,151 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    ring_buffer.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file ring_buffer.cc
+
+#include "ring_buffer.h" // API
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+uint32_t EventCount::prepareWait()
+{
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    auto key = epoch.load(std::memory_order_seq_cst);
+    // the condition checked by the caller must not be read before the announcement
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return key;
+}
+
+void EventCount::cancelWait()
+{
+    waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void EventCount::wait(uint32_t key)
+{
+#ifdef __linux__
+    while (epoch.load(std::memory_order_acquire) == key) {
+        // returns immediately if epoch was changed in the meantime
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+    }
+#else
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    cond.wait(lock, [this, key]() { return epoch.load(std::memory_order_acquire) != key; });
+#endif
+    waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void EventCount::notify()
+{
+    // order the change of the condition before the check for waiters
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+    }
+    cond.notify_all();
+#endif
+}
+
+SpscRingBuffer::SpscRingBuffer(std::size_t capacity)
+    : data(std::make_unique<char[]>(capacity))
+    , cap(capacity)
+{
+}
+
+std::size_t SpscRingBuffer::size() const
+{
+    // load tail first, so head can only be newer and the difference is never negative
+    auto t = tail.load(std::memory_order_acquire);
+    return head.load(std::memory_order_acquire) - t;
+}
+
+std::size_t SpscRingBuffer::space() const
+{
+    auto h = head.load(std::memory_order_acquire);
+    return cap - (h - tail.load(std::memory_order_acquire));
+}
+
+std::size_t SpscRingBuffer::read(char* buf, std::size_t length)
+{
+    auto t = tail.load(std::memory_order_relaxed);
+    auto available = head.load(std::memory_order_acquire) - t;
+    if (length > available)
+        length = available;
+    if (length == 0)
+        return 0;
+
+    auto pos = t % cap;
+    auto read1 = std::min(length, cap - pos);
+    std::memcpy(buf, data.get() + pos, read1);
+    if (read1 < length)
+        std::memcpy(buf + read1, data.get(), length - read1);
+
+    tail.store(t + length, std::memory_order_release);
+    return length;
+}
+
+std::size_t SpscRingBuffer::skip(std::size_t length)
+{
+    auto t = tail.load(std::memory_order_relaxed);
+    auto available = head.load(std::memory_order_acquire) - t;
+    if (length > available)
+        length = available;
+    tail.store(t + length, std::memory_order_release);
+    return length;
+}
+
+char* SpscRingBuffer::writeArea(std::size_t& length)
+{
+    auto h = head.load(std::memory_order_relaxed);
+    auto free = cap - (h - tail.load(std::memory_order_acquire));
+    auto pos = h % cap;
+    length = std::min(free, cap - pos);
+    return data.get() + pos;
+}
+
+void SpscRingBuffer::commit(std::size_t length)
+{
+    head.store(head.load(std::memory_order_relaxed) + length, std::memory_order_release);
+}
+
+void SpscRingBuffer::clear()
+{
+    // start at the beginning of the memory again to get the largest write area
+    head.store(0, std::memory_order_release);
+    tail.store(0, std::memory_order_release);
+}
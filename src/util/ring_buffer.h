@@ -0,0 +1,103 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    ring_buffer.h - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file ring_buffer.h
+/// \brief lock free single producer single consumer byte ring
+
+#ifndef __RING_BUFFER_H__
+#define __RING_BUFFER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/// \brief a blocking wait without lock for flags and counters shared between threads
+///
+/// The waiting thread announces itself with prepareWait(), checks its condition
+/// again and then sleeps in wait() until notify() is called. notify() only
+/// enters the kernel if somebody is actually sleeping, so the common case of
+/// a producer and consumer running at the same speed never makes a syscall.
+class EventCount {
+public:
+    /// \brief announce a wait, the condition has to be checked again afterwards
+    /// \return key to pass to wait()
+    uint32_t prepareWait();
+    /// \brief the condition became true after prepareWait()
+    void cancelWait();
+    /// \brief sleep until notify() is called after prepareWait() returned key
+    void wait(uint32_t key);
+    /// \brief wake all waiting threads, call after changing the condition
+    void notify();
+
+private:
+    std::atomic<uint32_t> epoch {};
+    std::atomic<uint32_t> waiters {};
+#ifndef __linux__
+    std::mutex mutex;
+    std::condition_variable cond;
+#endif
+};
+
+/// \brief a fixed size byte ring for exactly one writing and one reading thread
+///
+/// The positions are running byte counters, so the ring can be completely
+/// filled and no lock is needed to tell a full from an empty ring.
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(std::size_t capacity);
+
+    std::size_t capacity() const { return cap; }
+
+    /// \brief number of bytes ready for the consumer
+    std::size_t size() const;
+    /// \brief number of bytes the producer can write
+    std::size_t space() const;
+
+    /// \brief copy up to length bytes out of the ring, consumer only
+    /// \return number of bytes copied
+    std::size_t read(char* buf, std::size_t length);
+    /// \brief drop up to length bytes, consumer only
+    /// \return number of bytes dropped
+    std::size_t skip(std::size_t length);
+
+    /// \brief get the contiguous free area, producer only
+    /// \param length receives the size of the area
+    char* writeArea(std::size_t& length);
+    /// \brief publish length bytes written to writeArea(), producer only
+    void commit(std::size_t length);
+
+    /// \brief drop all data, only allowed while the consumer does not access the ring
+    void clear();
+
+private:
+    std::unique_ptr<char[]> data;
+    std::size_t cap;
+    /// \brief total number of bytes written, keep producer and consumer positions on separate cache lines
+    alignas(64) std::atomic_size_t head {};
+    /// \brief total number of bytes read
+    alignas(64) std::atomic_size_t tail {};
+};
+
+#endif // __RING_BUFFER_H__
@@ -597,9 +597,10 @@ std::vector<std::string> populateCommandLine(const std::string& line,
     const std::string& in,
     const std::string& out,
     const std::string& range,
-    const std::string& title)
+    const std::string& title,
+    const std::string& start)
 {
-    log_debug("Template: '{}', in: '{}', out: '{}', range: '{}', title: '{}'", line, in, out, range, title);
+    log_debug("Template: '{}', in: '{}', out: '{}', range: '{}', title: '{}', start: '{}'", line, in, out, range, title, start);
     std::vector<std::string> params = splitString(line, ' ');
     if (in.empty() && out.empty())
         return params;
@@ -624,6 +625,11 @@ std::vector<std::string> populateCommandLine(const std::string& line,
         if (titlePos != std::string::npos) {
             std::string newParam = param.replace(titlePos, 6, title);
         }
+
+        auto startPos = param.find("%start");
+        if (startPos != std::string::npos) {
+            std::string newParam = param.replace(startPos, 6, start);
+        }
     }
     return params;
 }
@@ -663,12 +669,13 @@ ssize_t getValidUTF8CutPosition(std::string_view str, ssize_t cutpos)
 std::string getDLNAprofileString(const std::shared_ptr<Config>& config, const std::string& contentType, const std::string& vCodec, const std::string& aCodec)
 {
     // get profiles from <contenttype-dlnaprofile> mappings
-    auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_CONTENTTYPE_TO_DLNAPROFILE_LIST);
-    auto profile = getValueOrDefault(mappings, fmt::format("{}-{}-{}", contentType, vCodec, aCodec), "");
-    if (profile.empty())
-        profile = getValueOrDefault(mappings, contentType, "");
+    auto snapshot = config->getSnapshot();
+    auto&& profile = snapshot->getDlnaProfile(fmt::format("{}-{}-{}", contentType, vCodec, aCodec));
+    if (!profile.empty())
+        return fmt::format("{}={};", UPNP_DLNA_PROFILE, profile);
 
-    return profile.empty() ? "" : fmt::format("{}={};", UPNP_DLNA_PROFILE, profile);
+    auto&& plainProfile = snapshot->getDlnaProfile(contentType);
+    return plainProfile.empty() ? "" : fmt::format("{}={};", UPNP_DLNA_PROFILE, plainProfile);
 }
 
 std::string getDLNAContentHeader(const std::shared_ptr<Config>& config, const std::string& contentType, const std::string& vCodec, const std::string& aCodec)
@@ -276,7 +276,8 @@ std::vector<std::string> populateCommandLine(const std::string& line,
     const std::string& in = "",
     const std::string& out = "",
     const std::string& range = "",
-    const std::string& title = "");
+    const std::string& title = "",
+    const std::string& start = "0");
 
 /// \brief Calculates a position where it is safe to cut an UTF-8 string.
 /// \return Caclulated position or -1 in case of an error.
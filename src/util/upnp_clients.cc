@@ -29,7 +29,9 @@
 #include "config/config.h"
 #include "util/tools.h"
 
-#include <array>
+#include <algorithm>
+#include <cstring>
+#include <queue>
 
 #include <upnp.h>
 
@@ -40,6 +42,9 @@ Clients::Clients(const std::shared_ptr<Config>& config)
 
 void Clients::refresh(const std::shared_ptr<Config>& config)
 {
+    auto newRules = std::make_shared<ClientRules>();
+    auto&& clientInfo = newRules->clientInfo;
+
     // table of supported clients (reverse search, sequence of entries matters!)
     clientInfo = {
         // Used for not explicitly listed clients, must be first entry
@@ -137,6 +142,32 @@ void Clients::refresh(const std::shared_ptr<Config>& config)
         auto clientConfig = clientConfigList->get(i);
         clientInfo.push_back(*clientConfig->getClientInfo());
     }
+
+    // compile the table, clientInfo must not change any more
+    for (std::size_t i = 0; i < clientInfo.size(); i++) {
+        auto&& info = clientInfo[i];
+        if (info.matchType == ClientMatchType::IP) {
+            if (!newRules->addresses.add(info.match, &info))
+                log_warning("Ignoring client with invalid address '{}'", info.match);
+        } else if (info.matchType == ClientMatchType::UserAgent) {
+            newRules->userAgents.add(info.match, static_cast<int>(i));
+        }
+    }
+    newRules->userAgents.compile();
+
+    AutoLock lock(mutex);
+    std::atomic_store(&rules, std::shared_ptr<const ClientRules>(newRules));
+
+    // cached clients must not keep the old table alive
+    for (auto&& shard : cache) {
+        AutoLock shardLock(shard.mutex);
+        for (auto&& [key, entry] : shard.entries) {
+            auto info = getInfoByAddr(*newRules, &entry.addr);
+            if (!info)
+                info = getInfoByUserAgent(*newRules, entry.userAgent);
+            entry.pInfo = std::shared_ptr<const ClientInfo>(newRules, info ? info : &clientInfo[0]);
+        }
+    }
 }
 
 void Clients::addClientByDiscovery(const struct sockaddr_storage* addr, const std::string& userAgent, const std::string& descLocation)
@@ -152,17 +183,22 @@ void Clients::addClientByDiscovery(const struct sockaddr_storage* addr, const st
 #endif
 }
 
-const ClientInfo* Clients::getInfo(const struct sockaddr_storage* addr, const std::string& userAgent)
+std::shared_ptr<const ClientInfo> Clients::getInfo(const struct sockaddr_storage* addr, const std::string& userAgent)
 {
+    auto current = std::atomic_load(&rules);
+
     // 1. by IP address
-    auto info = getInfoByAddr(addr);
-    if (!info) {
+    const ClientInfo* match = getInfoByAddr(*current, addr);
+    if (!match) {
         // 2. by User-Agent
-        info = getInfoByType(userAgent, ClientMatchType::UserAgent);
+        match = getInfoByUserAgent(*current, userAgent);
     }
 
-    // update IP or User-Agent match in cache
-    if (info) {
+    // share ownership of the rule table, refresh may replace it at any time
+    std::shared_ptr<const ClientInfo> info;
+    if (match) {
+        // update IP or User-Agent match in cache
+        info = std::shared_ptr<const ClientInfo>(current, match);
         updateCache(addr, userAgent, info);
     } else {
         // 3. by cache
@@ -172,8 +208,8 @@ const ClientInfo* Clients::getInfo(const struct sockaddr_storage* addr, const st
 
     if (!info) {
         // always return something, 'Unknown' if we do not know better
-        assert(clientInfo[0].type == ClientType::Unknown);
-        info = &clientInfo[0];
+        assert(current->clientInfo[0].type == ClientType::Unknown);
+        info = std::shared_ptr<const ClientInfo>(current, &current->clientInfo[0]);
 
         // also add to cache, for web-ui proposes only
         updateCache(addr, userAgent, info);
@@ -183,100 +219,273 @@ const ClientInfo* Clients::getInfo(const struct sockaddr_storage* addr, const st
     return info;
 }
 
-const ClientInfo* Clients::getInfoByAddr(const struct sockaddr_storage* addr)
+const ClientInfo* Clients::getInfoByAddr(const ClientRules& rules, const struct sockaddr_storage* addr)
 {
-    auto it = std::find_if(clientInfo.begin(), clientInfo.end(), [=](auto&& c) {
-        if (c.matchType != ClientMatchType::IP) {
-            return false;
-        }
+    if (rules.addresses.empty())
+        return nullptr;
 
-        if (c.match.find(':') != std::string::npos) {
-            // IPv6
-            struct sockaddr_in6 clientAddr = {};
-            clientAddr.sin6_family = AF_INET6;
-            if (inet_pton(AF_INET6, c.match.c_str(), &clientAddr.sin6_addr) == 1) {
-                if (sockAddrCmpAddr(reinterpret_cast<const struct sockaddr*>(&clientAddr), reinterpret_cast<const struct sockaddr*>(addr)) == 0) {
-                    return true;
-                }
-            }
-        } else if (c.match.find('.') != std::string::npos) {
-            // IPv4
-            struct sockaddr_in clientAddr = {};
-            clientAddr.sin_family = AF_INET;
-            clientAddr.sin_addr.s_addr = inet_addr(c.match.c_str());
-            if (sockAddrCmpAddr(reinterpret_cast<const struct sockaddr*>(&clientAddr), reinterpret_cast<const struct sockaddr*>(addr)) == 0) {
-                return true;
-            }
+    auto info = rules.addresses.find(reinterpret_cast<const struct sockaddr*>(addr));
+    if (info)
+        log_debug("found client by IP (match='{}')", info->match);
+    return info;
+}
+
+const ClientInfo* Clients::getInfoByUserAgent(const ClientRules& rules, const std::string& userAgent)
+{
+    if (!userAgent.empty()) {
+        auto rule = rules.userAgents.find(userAgent);
+        if (rule >= 0) {
+            log_debug("found client by type (match='{}')", userAgent);
+            return &rules.clientInfo[rule];
         }
+    }
 
-        return false;
-    });
+    return nullptr;
+}
 
-    if (it != clientInfo.end()) {
-        auto ip = getHostName(reinterpret_cast<const struct sockaddr*>(addr));
-        log_debug("found client by IP (ip='{}')", ip);
-        return &(*it);
+std::shared_ptr<const ClientInfo> Clients::getInfoByCache(const struct sockaddr_storage* addr)
+{
+    auto key = CacheKey(addr);
+    auto&& shard = getShard(key);
+    AutoLock lock(shard.mutex);
+
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end() && it->second.last + std::chrono::hours(6) >= currentTime()) {
+        log_debug("found client by cache (match='{}')", it->second.pInfo->match);
+        return it->second.pInfo;
     }
 
     return nullptr;
 }
 
-const ClientInfo* Clients::getInfoByType(const std::string& match, ClientMatchType type)
+void Clients::updateCache(const struct sockaddr_storage* addr, std::string userAgent, const std::shared_ptr<const ClientInfo>& pInfo)
 {
-    if (!match.empty()) {
-        auto it = std::find_if(clientInfo.rbegin(), clientInfo.rend(), [=](auto&& c) { return c.matchType == type && match.find(c.match) != std::string::npos; });
-        if (it != clientInfo.rend()) {
-            log_debug("found client by type (match='{}')", match);
-            return &(*it);
+    auto key = CacheKey(addr);
+    auto&& shard = getShard(key);
+    AutoLock lock(shard.mutex);
+
+    auto now = currentTime();
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        auto&& entry = it->second;
+        if (entry.pInfo != pInfo || entry.last + std::chrono::hours(6) < now) {
+            // client info changed, update all
+            entry.age = now;
+            entry.userAgent = std::move(userAgent);
+            entry.pInfo = pInfo;
         }
+        entry.last = now;
+        return;
     }
 
-    return nullptr;
+    if (shard.entries.size() >= MAX_CACHE_ENTRIES_PER_SHARD) {
+        // house cleaning, remove old entries
+        for (auto entry = shard.entries.begin(); entry != shard.entries.end();) {
+            if (entry->second.last + std::chrono::hours(6) < now)
+                entry = shard.entries.erase(entry);
+            else
+                ++entry;
+        }
+        // still full, drop the client not seen for the longest time
+        if (shard.entries.size() >= MAX_CACHE_ENTRIES_PER_SHARD) {
+            shard.entries.erase(std::min_element(shard.entries.begin(), shard.entries.end(),
+                [](auto&& a, auto&& b) { return a.second.last < b.second.last; }));
+        }
+    }
+
+    // add new client
+    shard.entries.emplace(key, ClientCacheEntry(*addr, std::move(userAgent), now, now, pInfo));
 }
 
-const ClientInfo* Clients::getInfoByCache(const struct sockaddr_storage* addr)
+std::vector<ClientCacheEntry> Clients::getClientList() const
 {
-    AutoLock lock(mutex);
+    auto now = currentTime();
+    std::vector<ClientCacheEntry> result;
+    for (auto&& shard : cache) {
+        AutoLock lock(shard.mutex);
+        for (auto&& [key, entry] : shard.entries) {
+            if (entry.last + std::chrono::hours(6) >= now)
+                result.push_back(entry);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](auto&& a, auto&& b) { return a.age < b.age; });
+    return result;
+}
+
+Clients::CacheKey::CacheKey(const struct sockaddr_storage* addr)
+    : family(addr->ss_family)
+{
+    auto sa = reinterpret_cast<const struct sockaddr*>(addr);
+    if (family == AF_INET) {
+        std::memcpy(bytes.data(), &SOCK_ADDR_IN_ADDR(sa), sizeof(struct in_addr));
+    } else if (family == AF_INET6) {
+        std::memcpy(bytes.data(), &SOCK_ADDR_IN6_ADDR(sa), sizeof(struct in6_addr));
+    }
+}
+
+std::size_t Clients::CacheKeyHash::operator()(const CacheKey& key) const
+{
+    // FNV-1a
+    std::size_t hash = 14695981039346656037ULL ^ key.family;
+    for (auto&& b : key.bytes) {
+        hash = (hash ^ b) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool ClientAddressTrie::add(const std::string& match, const ClientInfo* info)
+{
+    auto address = match;
+    int prefix = -1;
+    auto slash = match.find('/');
+    if (slash != std::string::npos) {
+        address = match.substr(0, slash);
+        prefix = stoiString(match.substr(slash + 1), -1);
+        if (prefix < 0)
+            return false;
+    }
+
+    if (address.find(':') != std::string::npos) {
+        // IPv6
+        struct in6_addr addr6 = {};
+        if (inet_pton(AF_INET6, address.c_str(), &addr6) != 1 || prefix > 128)
+            return false;
+        insert(v6, reinterpret_cast<const std::uint8_t*>(&addr6), prefix < 0 ? 128 : prefix, info);
+        return true;
+    }
+
+    if (address.find('.') != std::string::npos) {
+        // IPv4
+        struct in_addr addr4 = {};
+        if (inet_pton(AF_INET, address.c_str(), &addr4) != 1 || prefix > 32)
+            return false;
+        insert(v4, reinterpret_cast<const std::uint8_t*>(&addr4), prefix < 0 ? 32 : prefix, info);
+        return true;
+    }
+
+    return false;
+}
+
+void ClientAddressTrie::insert(std::vector<Node>& nodes, const std::uint8_t* bytes, unsigned int bits, const ClientInfo* info)
+{
+    std::uint32_t node = 0;
+    for (unsigned int i = 0; i < bits; i++) {
+        auto bit = (bytes[i / 8] >> (7 - i % 8)) & 1;
+        if (nodes[node].next[bit] == 0) {
+            nodes[node].next[bit] = nodes.size();
+            nodes.emplace_back();
+        }
+        node = nodes[node].next[bit];
+    }
+    // first rule for an address wins
+    if (!nodes[node].info)
+        nodes[node].info = info;
+}
+
+const ClientInfo* ClientAddressTrie::lookup(const std::vector<Node>& nodes, const std::uint8_t* bytes, unsigned int bits)
+{
+    const ClientInfo* result = nodes[0].info;
+    std::uint32_t node = 0;
+    for (unsigned int i = 0; i < bits; i++) {
+        node = nodes[node].next[(bytes[i / 8] >> (7 - i % 8)) & 1];
+        if (node == 0)
+            break;
+        if (nodes[node].info)
+            result = nodes[node].info;
+    }
+    return result;
+}
 
-    auto it = std::find_if(cache.begin(), cache.end(), [=](auto&& entry) //
-        { return sockAddrCmpAddr(reinterpret_cast<const struct sockaddr*>(&entry.addr), reinterpret_cast<const struct sockaddr*>(addr)) == 0; });
+const ClientInfo* ClientAddressTrie::find(const struct sockaddr* addr) const
+{
+    if (addr->sa_family == AF_INET) {
+        return lookup(v4, reinterpret_cast<const std::uint8_t*>(&SOCK_ADDR_IN_ADDR(addr)), 32);
+    }
 
-    if (it != cache.end()) {
-        auto hostName = getHostName(reinterpret_cast<const struct sockaddr*>(&it->addr));
-        log_debug("found client by cache (hostname='{}')", hostName);
-        return it->pInfo;
+    if (addr->sa_family == AF_INET6) {
+        auto addr6 = &SOCK_ADDR_IN6_ADDR(addr);
+        if (IN6_IS_ADDR_V4MAPPED(addr6)) {
+            // IPv4 client on a dual stack socket
+            return lookup(v4, reinterpret_cast<const std::uint8_t*>(addr6) + 12, 32);
+        }
+        return lookup(v6, reinterpret_cast<const std::uint8_t*>(addr6), 128);
     }
 
     return nullptr;
 }
 
-void Clients::updateCache(const struct sockaddr_storage* addr, std::string userAgent, const ClientInfo* pInfo)
+void ClientUserAgentMatcher::add(std::string_view pattern, int rule)
 {
-    AutoLock lock(mutex);
+    patterns.emplace_back(pattern, rule);
+}
 
-    // house cleaning, remove old entries
-    auto now = currentTime();
-    cache.erase(std::remove_if(cache.begin(), cache.end(),
-                    [now](auto&& entry) { return entry.last + std::chrono::hours(6) < now; }),
-        cache.end());
+void ClientUserAgentMatcher::compile()
+{
+    // only bytes used in patterns get their own column in the transition table
+    byteClass.fill(0);
+    classCount = 1;
+    for (auto&& [pattern, rule] : patterns) {
+        for (auto&& ch : pattern) {
+            auto&& cls = byteClass[static_cast<std::uint8_t>(ch)];
+            if (cls == 0)
+                cls = classCount++; // at most 256 bytes + class 0, fits into byteClass
+        }
+    }
 
-    auto it = std::find_if(cache.begin(), cache.end(), [=](auto&& entry) //
-        { return sockAddrCmpAddr(reinterpret_cast<const struct sockaddr*>(&entry.addr), reinterpret_cast<const struct sockaddr*>(addr)) == 0; });
+    // trie of all patterns
+    next.assign(classCount, 0);
+    best.assign(1, -1);
+    for (auto&& [pattern, rule] : patterns) {
+        std::uint32_t state = 0;
+        for (auto&& ch : pattern) {
+            auto cls = byteClass[static_cast<std::uint8_t>(ch)];
+            if (next[state * classCount + cls] == 0) {
+                next[state * classCount + cls] = best.size();
+                next.resize(next.size() + classCount, 0);
+                best.push_back(-1);
+            }
+            state = next[state * classCount + cls];
+        }
+        best[state] = std::max(best[state], rule);
+    }
 
-    if (it != cache.end()) {
-        it->last = now;
-        if (it->pInfo != pInfo) {
-            // client info changed, update all
-            it->age = now;
-            it->userAgent = std::move(userAgent);
-            it->pInfo = pInfo;
+    // failure links, folded into the transitions
+    std::vector<std::uint32_t> fail(best.size(), 0);
+    std::queue<std::uint32_t> queue;
+    for (std::size_t cls = 0; cls < classCount; cls++) {
+        if (next[cls] != 0)
+            queue.push(next[cls]);
+    }
+    while (!queue.empty()) {
+        auto state = queue.front();
+        queue.pop();
+        best[state] = std::max(best[state], best[fail[state]]);
+        for (std::size_t cls = 0; cls < classCount; cls++) {
+            auto&& target = next[state * classCount + cls];
+            if (target != 0) {
+                fail[target] = next[fail[state] * classCount + cls];
+                queue.push(target);
+            } else {
+                target = next[fail[state] * classCount + cls];
+            }
         }
-    } else {
-        // add new client
-        cache.emplace_back(*addr, std::move(userAgent), now, now, pInfo);
     }
 }
 
+int ClientUserAgentMatcher::find(std::string_view text) const
+{
+    if (best.empty())
+        return -1;
+
+    int result = best[0];
+    std::uint32_t state = 0;
+    for (auto&& ch : text) {
+        state = next[state * classCount + byteClass[static_cast<std::uint8_t>(ch)]];
+        result = std::max(result, best[state]);
+    }
+    return result;
+}
+
 std::unique_ptr<pugi::xml_document> Clients::downloadDescription(const std::string& location)
 {
 #if defined(USING_NPUPNP)
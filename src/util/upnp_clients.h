@@ -28,11 +28,15 @@
 #ifndef __UPNP_CLIENTS_H__
 #define __UPNP_CLIENTS_H__
 
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <pugixml.hpp>
+#include <string_view>
 #include <sys/socket.h>
+#include <unordered_map>
 #include <vector>
 
 #include "util/upnp_quirks.h"
@@ -73,12 +77,12 @@ struct ClientInfo {
 };
 
 struct ClientCacheEntry {
-    ClientCacheEntry(const struct sockaddr_storage& addr, std::string userAgent, std::chrono::seconds last, std::chrono::seconds age, const struct ClientInfo* pInfo)
+    ClientCacheEntry(const struct sockaddr_storage& addr, std::string userAgent, std::chrono::seconds last, std::chrono::seconds age, std::shared_ptr<const ClientInfo> pInfo)
         : addr(addr)
         , userAgent(std::move(userAgent))
         , last(last)
         , age(age)
-        , pInfo(pInfo)
+        , pInfo(std::move(pInfo))
     {
     }
 
@@ -86,7 +90,49 @@ struct ClientCacheEntry {
     std::string userAgent;
     std::chrono::seconds last;
     std::chrono::seconds age;
-    const struct ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo; ///< keeps the rule table it belongs to alive
+};
+
+/// \brief Binary trie over the bits of the configured client addresses.
+///
+/// Rules are either a plain address or a network in CIDR notation
+/// (e.g. 192.168.1.0/24 or fd00::/8), the longest matching prefix wins.
+class ClientAddressTrie {
+public:
+    /// \brief add address rule, returns false if the rule can not be parsed
+    bool add(const std::string& match, const ClientInfo* info);
+    const ClientInfo* find(const struct sockaddr* addr) const;
+    bool empty() const { return v4.size() == 1 && v6.size() == 1; }
+
+private:
+    struct Node {
+        std::array<std::uint32_t, 2> next {}; // 0: no child, the root is never a child
+        const ClientInfo* info {};
+    };
+    std::vector<Node> v4 { 1 };
+    std::vector<Node> v6 { 1 };
+
+    static void insert(std::vector<Node>& nodes, const std::uint8_t* bytes, unsigned int bits, const ClientInfo* info);
+    static const ClientInfo* lookup(const std::vector<Node>& nodes, const std::uint8_t* bytes, unsigned int bits);
+};
+
+/// \brief Aho-Corasick automaton over all User-Agent rules.
+///
+/// Returns the highest rule index of all patterns contained in the text,
+/// which keeps the "later entries win" order of the client table.
+class ClientUserAgentMatcher {
+public:
+    void add(std::string_view pattern, int rule);
+    void compile();
+    /// \brief highest matching rule or -1
+    int find(std::string_view text) const;
+
+private:
+    std::vector<std::pair<std::string, int>> patterns;
+    std::array<std::uint16_t, 256> byteClass {}; // 0: byte is not part of any pattern
+    std::size_t classCount { 1 };
+    std::vector<std::uint32_t> next; // states x classCount
+    std::vector<int> best;
 };
 
 class Clients {
@@ -95,25 +141,53 @@ public:
     void refresh(const std::shared_ptr<Config>& config);
 
     // always return something, 'Unknown' if we do not know better
-    const ClientInfo* getInfo(const struct sockaddr_storage* addr, const std::string& userAgent);
+    std::shared_ptr<const ClientInfo> getInfo(const struct sockaddr_storage* addr, const std::string& userAgent);
 
     void addClientByDiscovery(const struct sockaddr_storage* addr, const std::string& userAgent, const std::string& descLocation);
-    const std::vector<ClientCacheEntry>& getClientList() const { return cache; }
+    /// \brief snapshot of the recently seen clients, oldest first
+    std::vector<ClientCacheEntry> getClientList() const;
 
-private:
-    const ClientInfo* getInfoByAddr(const struct sockaddr_storage* addr);
-    const ClientInfo* getInfoByType(const std::string& match, ClientMatchType type);
+    static constexpr std::size_t CACHE_SHARDS = 16;
+    static constexpr std::size_t MAX_CACHE_ENTRIES_PER_SHARD = 256;
 
-    const ClientInfo* getInfoByCache(const struct sockaddr_storage* addr);
-    void updateCache(const struct sockaddr_storage* addr, std::string userAgent, const ClientInfo* pInfo);
+private:
+    /// \brief client table compiled for lookup, replaced as a whole by refresh
+    struct ClientRules {
+        std::vector<ClientInfo> clientInfo;
+        ClientAddressTrie addresses;
+        ClientUserAgentMatcher userAgents;
+    };
+
+    struct CacheKey {
+        explicit CacheKey(const struct sockaddr_storage* addr);
+        sa_family_t family;
+        std::array<std::uint8_t, 16> bytes {};
+        bool operator==(const CacheKey& other) const { return family == other.family && bytes == other.bytes; }
+    };
+    struct CacheKeyHash {
+        std::size_t operator()(const CacheKey& key) const;
+    };
+    struct CacheShard {
+        mutable std::mutex mutex;
+        std::unordered_map<CacheKey, ClientCacheEntry, CacheKeyHash> entries;
+    };
+
+    static const ClientInfo* getInfoByAddr(const ClientRules& rules, const struct sockaddr_storage* addr);
+    static const ClientInfo* getInfoByUserAgent(const ClientRules& rules, const std::string& userAgent);
+
+    std::shared_ptr<const ClientInfo> getInfoByCache(const struct sockaddr_storage* addr);
+    void updateCache(const struct sockaddr_storage* addr, std::string userAgent, const std::shared_ptr<const ClientInfo>& pInfo);
+    CacheShard& getShard(const CacheKey& key) { return cache[CacheKeyHash {}(key) % CACHE_SHARDS]; }
 
     static std::unique_ptr<pugi::xml_document> downloadDescription(const std::string& location);
 
     std::mutex mutex;
     using AutoLock = std::lock_guard<std::mutex>;
-    std::vector<ClientCacheEntry> cache;
+    std::array<CacheShard, CACHE_SHARDS> cache;
 
-    std::vector<ClientInfo> clientInfo;
+    /// \brief current rules, read with std::atomic_load
+    /// replaced rules are freed with the last ClientInfo handed out from them
+    std::shared_ptr<const ClientRules> rules;
 };
 
 #endif // __UPNP_CLIENTS_H__
@@ -123,7 +123,7 @@ void Quirks::getSamsungObjectIDfromIndex(const std::unique_ptr<ActionRequest>& r
 
     auto reqRoot = request->getRequest()->document_element();
 
-    log_debug("request {}", UpnpXMLBuilder::printXml(reqRoot, " "));
+    log_vdebug(clients, "request {}", UpnpXMLBuilder::printXml(reqRoot, " "));
 
     [[maybe_unused]] auto categoryType = reqRoot.child("CategoryType").text().as_string();
     [[maybe_unused]] auto index = reqRoot.child("Index").text().as_string();
@@ -143,7 +143,7 @@ void Quirks::getSamsungIndexfromRID(const std::unique_ptr<ActionRequest>& reques
     log_debug("Call for Samsung extension: X_GetIndexfromRID");
     auto reqRoot = request->getRequest()->document_element();
 
-    log_debug("request {}", UpnpXMLBuilder::printXml(reqRoot, " "));
+    log_vdebug(clients, "request {}", UpnpXMLBuilder::printXml(reqRoot, " "));
 
     [[maybe_unused]] auto categoryType = reqRoot.child("CategoryType").text().as_string();
     [[maybe_unused]] auto rID = reqRoot.child("RID").text().as_string();
@@ -117,7 +117,7 @@ public:
 private:
     std::shared_ptr<Context> context;
     std::shared_ptr<ContentManager> content;
-    const ClientInfo* pClientInfo;
+    std::shared_ptr<const ClientInfo> pClientInfo;
 };
 
 #endif // __UPNP_QUIRKS_H__
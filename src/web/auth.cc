@@ -86,6 +86,7 @@ void Web::Auth::process()
         cfg.append_attribute("show-tooltips") = config->getBoolOption(CFG_SERVER_UI_SHOW_TOOLTIPS);
         cfg.append_attribute("poll-when-idle") = config->getBoolOption(CFG_SERVER_UI_POLL_WHEN_IDLE);
         cfg.append_attribute("poll-interval") = config->getIntOption(CFG_SERVER_UI_POLL_INTERVAL);
+        cfg.append_attribute("push-updates") = config->getBoolOption(CFG_SERVER_UI_PUSH_UPDATES);
 
         /// CREATE XML FRAGMENT FOR ITEMS PER PAGE
         auto ipp = cfg.append_child("items-per-page");
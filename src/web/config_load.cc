@@ -54,125 +54,119 @@ Web::ConfigLoad::ConfigLoad(std::shared_ptr<ContentManager> content)
     }
 }
 
-void Web::ConfigLoad::addTypeMeta(pugi::xml_node& meta, const std::shared_ptr<ConfigSetup>& cs)
+void Web::ConfigLoad::addTypeMeta(const std::shared_ptr<ConfigSetup>& cs)
 {
-    auto info = meta.append_child("item");
-    info.append_attribute("item") = cs->getUniquePath().c_str();
-    info.append_attribute("id") = fmt::format("{:03d}", cs->option).c_str();
-    info.append_attribute("type") = cs->getTypeString().c_str();
-    info.append_attribute("value") = cs->getDefaultValue().c_str();
-    info.append_attribute("help") = cs->getHelp();
+    json.beginObject();
+    json.field("item", cs->getUniquePath());
+    json.field("id", fmt::format("{:03d}", cs->option));
+    json.textField("type", cs->getTypeString());
+    json.field("value", cs->getDefaultValue());
+    json.textField("help", cs->getHelp());
+    json.endObject();
 }
 
-void Web::ConfigLoad::createItem(pugi::xml_node& item, const std::string& name, config_option_t id, config_option_t aid, const std::shared_ptr<ConfigSetup>& cs)
+void Web::ConfigLoad::createItem(const std::string& name, config_option_t id, config_option_t aid, const std::shared_ptr<ConfigSetup>& cs)
 {
-    allItems[name] = fmt::format("{}[{}]", item.path(), allItems.size() + 1);
-    item.append_attribute("item") = name.c_str();
-    item.append_attribute("id") = fmt::format("{:03d}", id).c_str();
-    item.append_attribute("aid") = fmt::format("{:03d}", aid).c_str();
-    if (std::any_of(dbEntries.begin(), dbEntries.end(), [=](auto&& s) { return s.item == name; })) {
-        item.append_attribute("status") = "unchanged";
-        item.append_attribute("source") = "database";
+    // the item stays open until the next one, setValue() may still add to it
+    finishItem();
+    json.beginObject();
+    itemOpen = true;
+
+    allItems.insert(name);
+    json.field("item", name);
+    json.field("id", fmt::format("{:03d}", id));
+    json.field("aid", fmt::format("{:03d}", aid));
+    if (dbValues.find(name) != dbValues.end()) {
+        json.textField("status", "unchanged");
+        json.textField("source", "database");
     } else {
-        item.append_attribute("status") = !cs || !cs->isDefaultValueUsed() ? "unchanged" : "default";
-        item.append_attribute("source") = !cs || !cs->isDefaultValueUsed() ? "config.xml" : "default";
+        json.textField("status", !cs || !cs->isDefaultValueUsed() ? "unchanged" : "default");
+        json.textField("source", !cs || !cs->isDefaultValueUsed() ? "config.xml" : "default");
     }
-    item.append_attribute("origValue") = config->getOrigValue(name).c_str();
-    item.append_attribute("defaultValue") = cs ? cs->getDefaultValue().c_str() : "";
+    json.field("origValue", config->getOrigValue(name));
+    json.textField("defaultValue", cs ? cs->getDefaultValue() : "");
+}
+
+void Web::ConfigLoad::finishItem()
+{
+    if (itemOpen)
+        json.endObject();
+    itemOpen = false;
 }
 
 template <typename T>
-void Web::ConfigLoad::setValue(pugi::xml_node& item, const T& value)
+void Web::ConfigLoad::setValue(const T& value)
 {
     static_assert(fmt::has_formatter<T, fmt::format_context>::value, "T must be formattable");
-    item.append_attribute("value") = fmt::to_string(value).c_str();
+    json.field("value", fmt::to_string(value));
 }
 
 template <>
-void Web::ConfigLoad::setValue(pugi::xml_node& item, const std::string& value)
+void Web::ConfigLoad::setValue(const std::string& value)
 {
-    item.append_attribute("value") = value.c_str();
+    json.field("value", value);
 }
 
 template <>
-void Web::ConfigLoad::setValue(pugi::xml_node& item, const std::string_view& value)
+void Web::ConfigLoad::setValue(const std::string_view& value)
 {
-    item.append_attribute("value") = value.data();
+    json.field("value", value);
 }
 
 template <>
-void Web::ConfigLoad::setValue(pugi::xml_node& item, const fs::path& value)
+void Web::ConfigLoad::setValue(const fs::path& value)
 {
-    item.append_attribute("value") = value.c_str();
+    json.field("value", value.string());
 }
 
 /// \brief: process config_load request
 void Web::ConfigLoad::process()
 {
     checkRequest();
-    auto root = xmlDoc->document_element();
-    auto values = root.append_child("values");
     std::string action = param("action");
 
-    // set handling of json properties
-    xml2JsonHints->setArrayName(values, "item");
-    xml2JsonHints->setFieldType("item", "string");
-    xml2JsonHints->setFieldType("id", "string");
-    xml2JsonHints->setFieldType("aid", "string");
-    xml2JsonHints->setFieldType("value", "string");
-    xml2JsonHints->setFieldType("origValue", "string");
+    for (auto&& entry : dbEntries)
+        dbValues[entry.item] = &entry;
+    json.beginObject("values").beginArray("item");
 
     log_debug("Sending Config to web!");
 
     // write database status
     {
-        auto item = values.append_child("item");
-        createItem(item, "/status/attribute::total", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles());
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::virtual", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(true));
-
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::audio", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(false, "audio"));
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::video", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(false, "video"));
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::image", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(false, "image"));
-
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::audioVirtual", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(true, "audio"));
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::videoVirtual", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(true, "video"));
-        item = values.append_child("item");
-        createItem(item, "/status/attribute::imageVirtual", CFG_MAX, CFG_MAX);
-        setValue(item, database->getTotalFiles(true, "image"));
+        createItem("/status/attribute::total", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles());
+        createItem("/status/attribute::virtual", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(true));
+
+        createItem("/status/attribute::audio", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(false, "audio"));
+        createItem("/status/attribute::video", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(false, "video"));
+        createItem("/status/attribute::image", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(false, "image"));
+
+        createItem("/status/attribute::audioVirtual", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(true, "audio"));
+        createItem("/status/attribute::videoVirtual", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(true, "video"));
+        createItem("/status/attribute::imageVirtual", CFG_MAX, CFG_MAX);
+        setValue(database->getTotalFiles(true, "image"));
     }
 
-    if (action == "status")
+    if (action == "status") {
+        finishItem();
+        json.endArray().endObject();
         return;
-
-    // generate meta info for ui
-    auto meta = root.append_child("types");
-    xml2JsonHints->setArrayName(meta, "item");
-    for (auto&& cs : ConfigDefinition::getOptionList()) {
-        addTypeMeta(meta, cs);
     }
 
     // write all values with simple type (string, int, bool)
     for (auto&& option : ConfigOptionIterator()) {
         try {
             auto scs = ConfigDefinition::findConfigSetup(option);
-            auto item = values.append_child("item");
-            createItem(item, scs->getItemPath(ITEM_PATH_ROOT), option, option, scs);
+            createItem(scs->getItemPath(ITEM_PATH_ROOT), option, option, scs);
 
             log_debug("    Option {:03d} {} = {}", option, scs->getItemPath(), scs->getCurrentValue().c_str());
-            setValue(item, scs->getCurrentValue());
+            setValue(scs->getCurrentValue());
         } catch (const std::runtime_error& e) {
             log_warning("Option {:03d} {}", option, e.what());
         }
@@ -184,27 +178,21 @@ void Web::ConfigLoad::process()
     for (std::size_t i = 0; i < clientConfig->size(); i++) {
         auto client = clientConfig->get(i);
 
-        auto item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_CLIENTS_CLIENT_FLAGS), cs->option, ATTR_CLIENTS_CLIENT_FLAGS, cs);
-        setValue(item, ClientConfig::mapFlags(client->getFlags()));
+        createItem(cs->getItemPath(i, ATTR_CLIENTS_CLIENT_FLAGS), cs->option, ATTR_CLIENTS_CLIENT_FLAGS, cs);
+        setValue(ClientConfig::mapFlags(client->getFlags()));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_CLIENTS_CLIENT_IP), cs->option, ATTR_CLIENTS_CLIENT_IP, cs);
-        setValue(item, client->getIp());
+        createItem(cs->getItemPath(i, ATTR_CLIENTS_CLIENT_IP), cs->option, ATTR_CLIENTS_CLIENT_IP, cs);
+        setValue(client->getIp());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_CLIENTS_CLIENT_USERAGENT), cs->option, ATTR_CLIENTS_CLIENT_USERAGENT, cs);
-        setValue(item, client->getUserAgent());
+        createItem(cs->getItemPath(i, ATTR_CLIENTS_CLIENT_USERAGENT), cs->option, ATTR_CLIENTS_CLIENT_USERAGENT, cs);
+        setValue(client->getUserAgent());
     }
     if (clientConfig->size() == 0) {
-        auto item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_CLIENTS_CLIENT_FLAGS), cs->option, ATTR_CLIENTS_CLIENT_FLAGS, ConfigDefinition::findConfigSetup(ATTR_CLIENTS_CLIENT_FLAGS));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_CLIENTS_CLIENT_FLAGS), cs->option, ATTR_CLIENTS_CLIENT_FLAGS, ConfigDefinition::findConfigSetup(ATTR_CLIENTS_CLIENT_FLAGS));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_CLIENTS_CLIENT_IP), cs->option, ATTR_CLIENTS_CLIENT_IP, ConfigDefinition::findConfigSetup(ATTR_CLIENTS_CLIENT_IP));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_CLIENTS_CLIENT_IP), cs->option, ATTR_CLIENTS_CLIENT_IP, ConfigDefinition::findConfigSetup(ATTR_CLIENTS_CLIENT_IP));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_CLIENTS_CLIENT_USERAGENT), cs->option, ATTR_CLIENTS_CLIENT_USERAGENT, ConfigDefinition::findConfigSetup(ATTR_CLIENTS_CLIENT_USERAGENT));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_CLIENTS_CLIENT_USERAGENT), cs->option, ATTR_CLIENTS_CLIENT_USERAGENT, ConfigDefinition::findConfigSetup(ATTR_CLIENTS_CLIENT_USERAGENT));
     }
 
     // write import tweaks
@@ -213,45 +201,35 @@ void Web::ConfigLoad::process()
     for (std::size_t i = 0; i < directoryConfig->size(); i++) {
         auto dir = directoryConfig->get(i);
 
-        auto item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_LOCATION), cs->option, ATTR_DIRECTORIES_TWEAK_LOCATION);
-        setValue(item, dir->getLocation());
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_LOCATION), cs->option, ATTR_DIRECTORIES_TWEAK_LOCATION);
+        setValue(dir->getLocation());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_INHERIT), cs->option, ATTR_DIRECTORIES_TWEAK_INHERIT);
-        setValue(item, dir->getInherit());
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_INHERIT), cs->option, ATTR_DIRECTORIES_TWEAK_INHERIT);
+        setValue(dir->getInherit());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_RECURSIVE), cs->option, ATTR_DIRECTORIES_TWEAK_RECURSIVE);
-        setValue(item, dir->getRecursive());
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_RECURSIVE), cs->option, ATTR_DIRECTORIES_TWEAK_RECURSIVE);
+        setValue(dir->getRecursive());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_HIDDEN), cs->option, ATTR_DIRECTORIES_TWEAK_HIDDEN);
-        setValue(item, dir->getHidden());
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_HIDDEN), cs->option, ATTR_DIRECTORIES_TWEAK_HIDDEN);
+        setValue(dir->getHidden());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_CASE_SENSITIVE), cs->option, ATTR_DIRECTORIES_TWEAK_CASE_SENSITIVE);
-        setValue(item, dir->getCaseSensitive());
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_CASE_SENSITIVE), cs->option, ATTR_DIRECTORIES_TWEAK_CASE_SENSITIVE);
+        setValue(dir->getCaseSensitive());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_FOLLOW_SYMLINKS), cs->option, ATTR_DIRECTORIES_TWEAK_FOLLOW_SYMLINKS);
-        setValue(item, dir->getFollowSymlinks());
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_FOLLOW_SYMLINKS), cs->option, ATTR_DIRECTORIES_TWEAK_FOLLOW_SYMLINKS);
+        setValue(dir->getFollowSymlinks());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_META_CHARSET), cs->option, ATTR_DIRECTORIES_TWEAK_META_CHARSET);
-        setValue(item, dir->hasMetaCharset() ? dir->getMetaCharset() : "");
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_META_CHARSET), cs->option, ATTR_DIRECTORIES_TWEAK_META_CHARSET);
+        setValue(dir->hasMetaCharset() ? dir->getMetaCharset() : "");
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_FANART_FILE), cs->option, ATTR_DIRECTORIES_TWEAK_FANART_FILE);
-        setValue(item, dir->hasFanArtFile() ? dir->getFanArtFile() : "");
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_FANART_FILE), cs->option, ATTR_DIRECTORIES_TWEAK_FANART_FILE);
+        setValue(dir->hasFanArtFile() ? dir->getFanArtFile() : "");
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_RESOURCE_FILE), cs->option, ATTR_DIRECTORIES_TWEAK_RESOURCE_FILE);
-        setValue(item, dir->hasResourceFile() ? dir->getResourceFile() : "");
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_RESOURCE_FILE), cs->option, ATTR_DIRECTORIES_TWEAK_RESOURCE_FILE);
+        setValue(dir->hasResourceFile() ? dir->getResourceFile() : "");
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_SUBTILTE_FILE), cs->option, ATTR_DIRECTORIES_TWEAK_SUBTILTE_FILE);
-        setValue(item, dir->hasSubTitleFile() ? dir->getSubTitleFile() : "");
+        createItem(cs->getItemPath(i, ATTR_DIRECTORIES_TWEAK_SUBTILTE_FILE), cs->option, ATTR_DIRECTORIES_TWEAK_SUBTILTE_FILE);
+        setValue(dir->hasSubTitleFile() ? dir->getSubTitleFile() : "");
     }
 
     // write dynamic content
@@ -260,41 +238,31 @@ void Web::ConfigLoad::process()
     for (std::size_t i = 0; i < dynContent->size(); i++) {
         auto cont = dynContent->get(i);
 
-        auto item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_LOCATION), cs->option, ATTR_DYNAMIC_CONTAINER_LOCATION);
-        setValue(item, cont->getLocation());
+        createItem(cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_LOCATION), cs->option, ATTR_DYNAMIC_CONTAINER_LOCATION);
+        setValue(cont->getLocation());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_IMAGE), cs->option, ATTR_DYNAMIC_CONTAINER_IMAGE);
-        setValue(item, cont->getImage());
+        createItem(cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_IMAGE), cs->option, ATTR_DYNAMIC_CONTAINER_IMAGE);
+        setValue(cont->getImage());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_TITLE), cs->option, ATTR_DYNAMIC_CONTAINER_TITLE);
-        setValue(item, cont->getTitle());
+        createItem(cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_TITLE), cs->option, ATTR_DYNAMIC_CONTAINER_TITLE);
+        setValue(cont->getTitle());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_FILTER), cs->option, ATTR_DYNAMIC_CONTAINER_FILTER);
-        setValue(item, cont->getFilter());
+        createItem(cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_FILTER), cs->option, ATTR_DYNAMIC_CONTAINER_FILTER);
+        setValue(cont->getFilter());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_SORT), cs->option, ATTR_DYNAMIC_CONTAINER_SORT);
-        setValue(item, cont->getSort());
+        createItem(cs->getItemPath(i, ATTR_DYNAMIC_CONTAINER_SORT), cs->option, ATTR_DYNAMIC_CONTAINER_SORT);
+        setValue(cont->getSort());
     }
     if (dynContent->size() == 0) {
-        auto item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_LOCATION), cs->option, ATTR_DYNAMIC_CONTAINER_LOCATION, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_LOCATION));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_LOCATION), cs->option, ATTR_DYNAMIC_CONTAINER_LOCATION, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_LOCATION));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_IMAGE), cs->option, ATTR_DYNAMIC_CONTAINER_IMAGE, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_IMAGE));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_IMAGE), cs->option, ATTR_DYNAMIC_CONTAINER_IMAGE, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_IMAGE));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_TITLE), cs->option, ATTR_DYNAMIC_CONTAINER_TITLE, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_TITLE));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_TITLE), cs->option, ATTR_DYNAMIC_CONTAINER_TITLE, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_TITLE));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_FILTER), cs->option, ATTR_DYNAMIC_CONTAINER_FILTER, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_FILTER));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_FILTER), cs->option, ATTR_DYNAMIC_CONTAINER_FILTER, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_FILTER));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_SORT), cs->option, ATTR_DYNAMIC_CONTAINER_SORT, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_SORT));
+        createItem(cs->getItemPath(ITEM_PATH_NEW, ATTR_DYNAMIC_CONTAINER_SORT), cs->option, ATTR_DYNAMIC_CONTAINER_SORT, ConfigDefinition::findConfigSetup(ATTR_DYNAMIC_CONTAINER_SORT));
     }
 
     // write transconding configuration
@@ -304,13 +272,11 @@ void Web::ConfigLoad::process()
     std::map<std::string, int> profiles;
     for (auto&& [key, val] : transcoding->getList()) {
         for (auto&& [a, name] : *val) {
-            auto item = values.append_child("item");
-            createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_MIMETYPE_PROF_MAP, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_TRANSCODE, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_MIMETYPE), cs->option, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_MIMETYPE, cs);
-            setValue(item, key);
+            createItem(cs->getItemPath(pr, ATTR_TRANSCODING_MIMETYPE_PROF_MAP, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_TRANSCODE, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_MIMETYPE), cs->option, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_MIMETYPE, cs);
+            setValue(key);
 
-            item = values.append_child("item");
-            createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_MIMETYPE_PROF_MAP, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_TRANSCODE, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_USING), cs->option, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_USING, cs);
-            setValue(item, name->getName());
+            createItem(cs->getItemPath(pr, ATTR_TRANSCODING_MIMETYPE_PROF_MAP, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_TRANSCODE, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_USING), cs->option, ATTR_TRANSCODING_MIMETYPE_PROF_MAP_USING, cs);
+            setValue(name->getName());
             profiles.emplace(name->getName(), pr);
 
             pr++;
@@ -320,89 +286,86 @@ void Web::ConfigLoad::process()
     pr = 0;
     for (auto&& [key, val] : profiles) {
         auto entry = transcoding->getByName(key, true);
-        auto item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_NAME), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_NAME);
-        setValue(item, entry->getName());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_NAME), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_NAME);
+        setValue(entry->getName());
+
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_CLIENTFLAGS), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_CLIENTFLAGS);
+        setValue(ClientConfig::mapFlags(entry->getClientFlags()));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_CLIENTFLAGS), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_CLIENTFLAGS);
-        setValue(item, ClientConfig::mapFlags(entry->getClientFlags()));
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_ENABLED), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_ENABLED);
+        setValue(entry->getEnabled());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_ENABLED), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_ENABLED);
-        setValue(item, entry->getEnabled());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_TYPE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_TYPE);
+        setValue((entry->getType() == TR_External ? "external" : entry->getType() == TR_Internal ? "internal" : "none"));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_TYPE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_TYPE);
-        setValue(item, (entry->getType() == TR_External ? "external" : "none"));
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_MIMETYPE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_MIMETYPE);
+        setValue(entry->getTargetMimeType());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_MIMETYPE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_MIMETYPE);
-        setValue(item, entry->getTargetMimeType());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_RES), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_RES);
+        setValue(entry->getAttribute(MetadataHandler::getResAttrName(R_RESOLUTION)));
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_RES), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_RES);
-        setValue(item, entry->getAttribute(MetadataHandler::getResAttrName(R_RESOLUTION)));
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_ACCURL), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_ACCURL);
+        setValue(entry->acceptURL());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_ACCURL), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_ACCURL);
-        setValue(item, entry->acceptURL());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_SAMPFREQ), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_SAMPFREQ);
+        setValue(entry->getSampleFreq());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_SAMPFREQ), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_SAMPFREQ);
-        setValue(item, entry->getSampleFreq());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_NRCHAN), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_NRCHAN);
+        setValue(entry->getNumChannels());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_NRCHAN), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_NRCHAN);
-        setValue(item, entry->getNumChannels());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_MAX_JOBS);
+        setValue(entry->getMaxJobs());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_HIDEORIG), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_HIDEORIG);
-        setValue(item, entry->hideOriginalResource());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_WARM_PROCESSES);
+        setValue(entry->getWarmProcesses());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_THUMB), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_THUMB);
-        setValue(item, entry->isThumbnail());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_USE_STDOUT);
+        setValue(entry->useStdout());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_FIRST), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_FIRST);
-        setValue(item, entry->firstResource());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_HIDEORIG), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_HIDEORIG);
+        setValue(entry->hideOriginalResource());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_ACCOGG), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_ACCOGG);
-        setValue(item, entry->isTheora());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_THUMB), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_THUMB);
+        setValue(entry->isThumbnail());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND);
-        setValue(item, entry->getCommand());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_FIRST), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_FIRST);
+        setValue(entry->firstResource());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS);
-        setValue(item, entry->getArguments());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_ACCOGG), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_ACCOGG);
+        setValue(entry->isTheora());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_SIZE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_SIZE);
-        setValue(item, entry->getBufferSize());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_COMMAND);
+        setValue(entry->getCommand());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_CHUNK), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_CHUNK);
-        setValue(item, entry->getBufferChunkSize());
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AGENT_ARGS);
+        setValue(entry->getArguments());
 
-        item = values.append_child("item");
-        createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_FILL), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_FILL);
-        setValue(item, entry->getBufferInitialFillSize());
+        if (entry->getType() == TR_Internal) {
+            createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_FORMAT);
+            setValue(entry->getFormat());
+
+            createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_INTERNAL_ACODEC);
+            setValue(entry->getAudioCodec());
+        }
+
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_SIZE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_SIZE);
+        setValue(entry->getBufferSize());
+
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_CHUNK), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_CHUNK);
+        setValue(entry->getBufferChunkSize());
+
+        createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_FILL), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_BUFFER_FILL);
+        setValue(entry->getBufferInitialFillSize());
 
         auto fourCCMode = entry->getAVIFourCCListMode();
         if (fourCCMode != FCC_None) {
-            item = values.append_child("item");
-            createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_MODE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_MODE);
-            setValue(item, TranscodingProfile::mapFourCcMode(fourCCMode));
+            createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_MODE), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_MODE);
+            setValue(TranscodingProfile::mapFourCcMode(fourCCMode));
 
             const auto& fourCCList = entry->getAVIFourCCList();
             if (!fourCCList.empty()) {
-                item = values.append_child("item");
-                createItem(item, cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_4CC), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_4CC);
-                setValue(item, std::accumulate(next(fourCCList.begin()), fourCCList.end(), fourCCList[0], [](auto&& a, auto&& b) { return fmt::format("{}, {}", a, b); }));
+                createItem(cs->getItemPath(pr, ATTR_TRANSCODING_PROFILES_PROFLE, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_4CC), cs->option, ATTR_TRANSCODING_PROFILES_PROFLE_AVI4CC_4CC);
+                setValue(std::accumulate(next(fourCCList.begin()), fourCCList.end(), fourCCList[0], [](auto&& a, auto&& b) { return fmt::format("{}, {}", a, b); }));
             }
         }
         pr++;
@@ -414,62 +377,46 @@ void Web::ConfigLoad::process()
         for (std::size_t i = 0; i < autoscan->size(); i++) {
             auto&& entry = autoscan->get(i);
             auto&& adir = content->getAutoscanDirectory(entry->getLocation());
-            auto item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_LOCATION), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LOCATION);
-            setValue(item, adir->getLocation());
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_LOCATION), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LOCATION);
+            setValue(adir->getLocation());
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_MODE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_MODE);
-            setValue(item, AutoscanDirectory::mapScanmode(adir->getScanMode()));
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_MODE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_MODE);
+            setValue(AutoscanDirectory::mapScanmode(adir->getScanMode()));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_INTERVAL), ascs->option, ATTR_AUTOSCAN_DIRECTORY_INTERVAL);
-            setValue(item, adir->getInterval());
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_INTERVAL), ascs->option, ATTR_AUTOSCAN_DIRECTORY_INTERVAL);
+            setValue(adir->getInterval());
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE);
-            setValue(item, adir->getRecursive());
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE);
+            setValue(adir->getRecursive());
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES), ascs->option, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES);
-            setValue(item, adir->getHidden());
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES), ascs->option, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES);
+            setValue(adir->getHidden());
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT);
-            setValue(item, adir->getActiveScanCount());
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT);
+            setValue(adir->getActiveScanCount());
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT);
-            setValue(item, adir->getTaskCount());
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT);
+            setValue(adir->getTaskCount());
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_LMT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LMT);
-            setValue(item, fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(adir->getPreviousLMT().count())));
+            createItem(ascs->getItemPath(i, ATTR_AUTOSCAN_DIRECTORY_LMT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LMT);
+            setValue(fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(adir->getPreviousLMT().count())));
         }
         if (autoscan->size() == 0) {
-            auto item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_LOCATION), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LOCATION, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_LOCATION));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_LOCATION), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LOCATION, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_LOCATION));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_MODE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_MODE, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_MODE));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_MODE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_MODE, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_MODE));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_INTERVAL), ascs->option, ATTR_AUTOSCAN_DIRECTORY_INTERVAL, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_INTERVAL));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_INTERVAL), ascs->option, ATTR_AUTOSCAN_DIRECTORY_INTERVAL, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_INTERVAL));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_RECURSIVE));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE), ascs->option, ATTR_AUTOSCAN_DIRECTORY_RECURSIVE, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_RECURSIVE));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES), ascs->option, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES), ascs->option, ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_HIDDENFILES));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_SCANCOUNT));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_TASKCOUNT));
 
-            item = values.append_child("item");
-            createItem(item, ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_LMT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LMT, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_LMT));
+            createItem(ascs->getItemPath(ITEM_PATH_NEW, ATTR_AUTOSCAN_DIRECTORY_LMT), ascs->option, ATTR_AUTOSCAN_DIRECTORY_LMT, ConfigDefinition::findConfigSetup(ATTR_AUTOSCAN_DIRECTORY_LMT));
         }
     }
 
@@ -478,13 +425,11 @@ void Web::ConfigLoad::process()
         int i = 0;
         auto dictionary = dcs->getValue()->getDictionaryOption(true);
         for (auto&& [key, val] : dictionary) {
-            auto item = values.append_child("item");
-            createItem(item, dcs->getItemPath(i, dcs->keyOption), dcs->option, dcs->keyOption, dcs);
-            setValue(item, key.substr(5));
+            createItem(dcs->getItemPath(i, dcs->keyOption), dcs->option, dcs->keyOption, dcs);
+            setValue(key.substr(5));
 
-            item = values.append_child("item");
-            createItem(item, dcs->getItemPath(i, dcs->valOption), dcs->option, dcs->valOption, dcs);
-            setValue(item, val);
+            createItem(dcs->getItemPath(i, dcs->valOption), dcs->option, dcs->valOption, dcs);
+            setValue(val);
             i++;
         }
     }
@@ -494,30 +439,29 @@ void Web::ConfigLoad::process()
         auto array = acs->getValue()->getArrayOption(true);
         for (std::size_t i = 0; i < array.size(); i++) {
             auto&& entry = array[i];
-            auto item = values.append_child("item");
-            createItem(item, acs->getItemPath(i), acs->option, acs->attrOption != CFG_MAX ? acs->attrOption : acs->nodeOption, acs);
-            setValue(item, entry);
+            createItem(acs->getItemPath(i), acs->option, acs->attrOption != CFG_MAX ? acs->attrOption : acs->nodeOption, acs);
+            setValue(entry);
         }
     }
 
-    // update entries with datebase values
+    // add database values not written yet, the others got their status already
     for (auto&& entry : dbEntries) {
-        auto exItem = allItems.find(entry.item);
-        if (exItem != allItems.end()) {
-            auto item = root.select_node(exItem->second.c_str()).node();
-            item.attribute("source") = "database";
-            item.attribute("status") = entry.status.c_str();
-        } else {
+        if (allItems.find(entry.item) == allItems.end()) {
             auto cs = ConfigDefinition::findConfigSetupByPath(entry.item, true);
             auto acs = ConfigDefinition::findConfigSetupByPath(entry.item, true, cs);
             if (cs) {
-                auto item = values.append_child("item");
-                createItem(item, entry.item, cs->option, acs ? acs->option : CFG_MAX);
-                setValue(item, entry.value);
-                item.attribute("status") = entry.status.c_str();
-                item.attribute("origValue") = config->getOrigValue(entry.item).c_str();
-                item.attribute("source") = "database";
+                createItem(entry.item, cs->option, acs ? acs->option : CFG_MAX);
+                setValue(entry.value);
             }
         }
     }
+    finishItem();
+    json.endArray().endObject();
+
+    // generate meta info for ui
+    json.beginObject("types").beginArray("item");
+    for (auto&& cs : ConfigDefinition::getOptionList()) {
+        addTypeMeta(cs);
+    }
+    json.endArray().endObject();
 }
@@ -177,5 +177,6 @@ void Web::ConfigSave::process()
         }
     }
 
+    config->updateSnapshot();
     context->getClients()->refresh(context->getConfig());
 }
@@ -33,6 +33,7 @@
 
 #include "cds_objects.h"
 #include "content/autoscan.h"
+#include "content/content_manager.h"
 #include "database/database.h"
 #include "server.h"
 #include "upnp_xml.h"
@@ -52,32 +53,29 @@ void Web::Containers::process()
     if (parentID == INVALID_OBJECT_ID)
         throw_std_runtime_error("no parent_id given");
 
-    auto root = xmlDoc->document_element();
-
-    auto containers = root.append_child("containers");
-    xml2JsonHints->setArrayName(containers, "container");
-    xml2JsonHints->setFieldType("title", "string");
-    containers.append_attribute("parent_id") = parentID;
-    containers.append_attribute("type") = "database";
+    json.beginObject("containers");
+    json.field("parent_id", parentID);
+    json.field("type", "database");
     if (!param("select_it").empty())
-        containers.append_attribute("select_it") = param("select_it").c_str();
+        json.textField("select_it", param("select_it"));
 
     auto browseParam = BrowseParam(database->loadObject(parentID), BROWSE_DIRECT_CHILDREN | BROWSE_CONTAINERS);
     auto arr = database->browse(browseParam);
+    json.beginArray("container");
     for (auto&& obj : arr) {
         // if (obj->isContainer())
         //{
         auto cont = std::static_pointer_cast<CdsContainer>(obj);
-        auto ce = containers.append_child("container");
-        ce.append_attribute("id") = cont->getID();
+        json.beginObject();
+        json.field("id", cont->getID());
         int childCount = cont->getChildCount();
-        ce.append_attribute("child_count") = childCount;
+        json.field("child_count", childCount);
         int autoscanType = cont->getAutoscanType();
-        ce.append_attribute("autoscan_type") = mapAutoscanType(autoscanType).data();
+        json.field("autoscan_type", mapAutoscanType(autoscanType));
 
         auto [url, artAdded] = xmlBuilder->renderContainerImage(server->getVirtualUrl(), cont);
         if (artAdded) {
-            ce.append_attribute("image") = url.c_str();
+            json.textField("image", url);
         }
 
         std::string autoscanMode = "none";
@@ -85,14 +83,17 @@ void Web::Containers::process()
             autoscanMode = "timed";
 #ifdef HAVE_INOTIFY
             if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
-                auto adir = database->getAutoscanDirectory(cont->getID());
+                auto adir = content->getAutoscanDirectory(cont->getID());
                 if (adir && (adir->getScanMode() == ScanMode::INotify))
                     autoscanMode = "inotify";
             }
 #endif
         }
-        ce.append_attribute("autoscan_mode") = autoscanMode.c_str();
-        ce.append_attribute("title") = cont->getTitle().c_str();
+        json.field("autoscan_mode", autoscanMode);
+        json.field("title", cont->getTitle());
+        json.endObject();
         //}
     }
+    json.endArray();
+    json.endObject();
 }
@@ -0,0 +1,151 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    events.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file events.cc
+
+#include "pages.h" // API
+
+#include <algorithm>
+
+#include "content/content_manager.h"
+#include "iohandler/mem_io_handler.h"
+#include "util/upnp_headers.h"
+
+// comment lines keep proxies and browsers from closing an idle stream
+static constexpr auto heartbeatInterval = std::chrono::seconds(15);
+// changes arriving within this delay are sent in one event
+static constexpr auto batchDelay = std::chrono::milliseconds(250);
+// the browser reconnects, which frees the thread of the web server
+static constexpr auto maxStreamDuration = std::chrono::minutes(5);
+
+/// \brief endless response, writes an event whenever the subscriber reports changes
+class Web::Events::Stream : public IOHandler {
+public:
+    Stream(std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager,
+        std::string sessionID, std::shared_ptr<UpdateSubscriber> subscriber, std::string initial)
+        : content(std::move(content))
+        , sessionManager(std::move(sessionManager))
+        , sessionID(std::move(sessionID))
+        , subscriber(std::move(subscriber))
+        , buffer(std::move(initial))
+        , started(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~Stream() override { Stream::close(); }
+
+    std::size_t read(char* buf, std::size_t length) override
+    {
+        while (pos >= buffer.size()) {
+            if (!nextEvent())
+                return 0;
+        }
+        length = std::min(length, buffer.size() - pos);
+        std::copy_n(buffer.data() + pos, length, buf);
+        pos += length;
+        return length;
+    }
+
+    void close() override
+    {
+        if (subscriber) {
+            sessionManager->unsubscribe(subscriber);
+            subscriber = nullptr;
+        }
+    }
+
+private:
+    bool nextEvent()
+    {
+        if (!subscriber || std::chrono::steady_clock::now() - started > maxStreamDuration || !sessionManager->getSession(sessionID))
+            return false;
+
+        pos = 0;
+        if (!subscriber->wait(heartbeatInterval, batchDelay)) {
+            if (subscriber->isClosed())
+                return false;
+            buffer = ":\n\n";
+            return true;
+        }
+
+        JsonWriter json;
+        json.beginObject().field("success", true);
+        auto updateIDs = subscriber->takeUpdateIDs();
+        if (!updateIDs.empty())
+            json.beginObject("update_ids").textField("ids", updateIDs).field("updates", true).endObject();
+        if (subscriber->takeTaskChanged())
+            appendTask(content->getCurrentTask(), json);
+        json.endObject();
+
+        buffer = fmt::format("id: {}\nevent: update\ndata: {}\n\n", ++eventID, json.str());
+        return true;
+    }
+
+    std::shared_ptr<ContentManager> content;
+    std::shared_ptr<SessionManager> sessionManager;
+    std::string sessionID;
+    std::shared_ptr<UpdateSubscriber> subscriber;
+
+    std::string buffer;
+    std::size_t pos {};
+    unsigned int eventID {};
+    std::chrono::steady_clock::time_point started;
+};
+
+void Web::Events::getInfo(const char* filename, UpnpFileInfo* info)
+{
+    WebRequestHandler::getInfo(filename, info);
+
+    std::string contentType = "text/event-stream; charset=UTF-8";
+#ifdef USING_NPUPNP
+    info->content_type = std::move(contentType);
+#else
+    UpnpFileInfo_set_ContentType(info, contentType.c_str());
+#endif
+}
+
+void Web::Events::process()
+{
+    checkRequest();
+    if (!config->getBoolOption(CFG_SERVER_UI_PUSH_UPDATES))
+        throw_std_runtime_error("Push updates are disabled");
+    subscriber = sessionManager->subscribe();
+    if (!subscriber)
+        throw_std_runtime_error("Too many open event streams");
+}
+
+std::unique_ptr<IOHandler> Web::Events::open(const char* filename, enum UpnpOpenFileMode mode)
+{
+    // the first event holds the current task, like the response of every other page
+    auto output = renderResponse();
+
+    std::unique_ptr<IOHandler> ioHandler;
+    if (subscriber) {
+        ioHandler = std::make_unique<Stream>(content, sessionManager, session->getID(), subscriber, fmt::format("event: update\ndata: {}\n\n", output));
+    } else {
+        // the ui falls back to polling
+        ioHandler = std::make_unique<MemIOHandler>(fmt::format("event: error\ndata: {}\n\n", output));
+    }
+    ioHandler->open(mode);
+    return ioHandler;
+}
@@ -33,6 +33,7 @@
 
 #include "cds_objects.h"
 #include "content/autoscan.h"
+#include "content/content_manager.h"
 #include "database/database.h"
 #include "server.h"
 #include "upnp_xml.h"
@@ -57,13 +58,8 @@ void Web::Items::process()
         throw_std_runtime_error("illegal count parameter");
 
     // set result options
-    auto root = xmlDoc->document_element();
-    auto items = root.append_child("items");
-    xml2JsonHints->setArrayName(items, "item");
-    xml2JsonHints->setFieldType("title", "string");
-    xml2JsonHints->setFieldType("part", "string");
-    xml2JsonHints->setFieldType("track", "string");
-    items.append_attribute("parent_id") = parentID;
+    json.beginObject("items");
+    json.field("parent_id", parentID);
 
     auto container = database->loadObject(parentID);
     auto param = BrowseParam(container, BROWSE_DIRECT_CHILDREN | BROWSE_ITEMS);
@@ -75,16 +71,16 @@ void Web::Items::process()
 
     // get contents of request
     auto arr = database->browse(param);
-    items.append_attribute("virtual") = container->isVirtual();
-    items.append_attribute("start") = start;
-    // items.append_attribute("returned") = arr->size();
-    items.append_attribute("total_matches") = param.getTotalMatches();
+    json.field("virtual", container->isVirtual());
+    json.field("start", start);
+    // json.field("returned", arr.size());
+    json.field("total_matches", param.getTotalMatches());
 
     bool protectContainer = false;
     bool protectItems = false;
     std::string autoscanMode = "none";
 
-    auto parentDir = database->getAutoscanDirectory(parentID);
+    auto parentDir = content->getAutoscanDirectory(parentID);
     int autoscanType = 0;
     if (parentDir) {
         autoscanType = parentDir->persistent() ? 2 : 1;
@@ -94,55 +90,42 @@ void Web::Items::process()
 #ifdef HAVE_INOTIFY
     if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
         // check for inotify mode
-        int startpointId = INVALID_OBJECT_ID;
-        if (autoscanType == 0) {
-            auto pathIDs = database->getPathIDs(parentID);
-            for (int pathId : pathIDs) {
-                auto pathDir = database->getAutoscanDirectory(pathId);
-                if (pathDir && pathDir->getRecursive()) {
-                    startpointId = pathId;
-                    break;
-                }
-            }
-        } else {
-            startpointId = parentID;
-        }
-
-        if (startpointId != INVALID_OBJECT_ID) {
-            auto startPtDir = database->getAutoscanDirectory(startpointId);
-            if (startPtDir && startPtDir->getScanMode() == ScanMode::INotify) {
-                protectItems = true;
-                if (autoscanType == 0 || startPtDir->persistent())
-                    protectContainer = true;
+        auto startPtDir = autoscanType == 0 ? content->getParentAutoscanDirectory(parentID) : parentDir;
+        if (startPtDir && startPtDir->getScanMode() == ScanMode::INotify) {
+            protectItems = true;
+            if (autoscanType == 0 || startPtDir->persistent())
+                protectContainer = true;
 
-                autoscanMode = "inotify";
-            }
+            autoscanMode = "inotify";
         }
     }
 #endif
-    items.append_attribute("autoscan_mode") = autoscanMode.c_str();
-    items.append_attribute("autoscan_type") = mapAutoscanType(autoscanType).data();
-    items.append_attribute("protect_container") = protectContainer;
-    items.append_attribute("protect_items") = protectItems;
+    json.field("autoscan_mode", autoscanMode);
+    json.field("autoscan_type", mapAutoscanType(autoscanType));
+    json.field("protect_container", protectContainer);
+    json.field("protect_items", protectItems);
 
     // ouput objects of container
+    json.beginArray("item");
     for (auto&& arrayObj : arr) {
-        auto item = items.append_child("item");
-        item.append_attribute("id") = arrayObj->getID();
-        item.append_child("title").append_child(pugi::node_pcdata).set_value(arrayObj->getTitle().c_str());
+        json.beginObject();
+        json.field("id", arrayObj->getID());
+        json.field("title", arrayObj->getTitle());
 
         auto objItem = std::static_pointer_cast<CdsItem>(arrayObj);
         if (objItem->getPartNumber() > 0 && c == UPNP_CLASS_MUSIC_ALBUM)
-            item.append_child("part").append_child(pugi::node_pcdata).set_value(fmt::format("{:02}", objItem->getPartNumber()).c_str());
+            json.field("part", fmt::format("{:02}", objItem->getPartNumber()));
         if (objItem->getTrackNumber() > 0)
-            item.append_child("track").append_child(pugi::node_pcdata).set_value(fmt::format("{:02}", objItem->getTrackNumber()).c_str());
-        item.append_child("mtype").append_child(pugi::node_pcdata).set_value(objItem->getMimeType().c_str());
-        std::string res = UpnpXMLBuilder::getFirstResourcePath(objItem);
-        item.append_child("res").append_child(pugi::node_pcdata).set_value(res.c_str());
+            json.field("track", fmt::format("{:02}", objItem->getTrackNumber()));
+        json.textField("mtype", objItem->getMimeType());
+        json.textField("res", UpnpXMLBuilder::getFirstResourcePath(objItem));
 
         auto [url, artAdded] = xmlBuilder->renderItemImage(server->getVirtualUrl(), objItem);
         if (artAdded) {
-            item.append_child("image").append_child(pugi::node_pcdata).set_value(url.c_str());
+            json.textField("image", url);
         }
+        json.endObject();
     }
+    json.endArray();
+    json.endObject();
 }
@@ -0,0 +1,81 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    metrics.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file metrics.cc
+
+#include "pages.h" // API
+
+#include "database/database.h"
+#include "util/metrics.h"
+
+void Web::Metrics::process()
+{
+    checkRequest();
+
+    json.beginObject("metrics");
+    json.beginArray("metric");
+    for (auto&& entry : ::Metrics::getInstance()->getEntries()) {
+        json.beginObject();
+        json.field("name", entry->name);
+        json.field("labels", entry->labels);
+        json.field("help", entry->help);
+        switch (entry->type) {
+        case MetricType::Counter:
+            json.field("type", "counter");
+            json.field("value", entry->counter->get());
+            break;
+        case MetricType::Gauge:
+            json.field("type", "gauge");
+            json.field("value", entry->gauge->get());
+            break;
+        case MetricType::Histogram:
+            json.field("type", "histogram");
+            json.field("count", entry->histogram->getCount());
+            json.field("sum_us", entry->histogram->getSum().count());
+            json.field("p50_us", entry->histogram->getQuantile(0.5).count());
+            json.field("p95_us", entry->histogram->getQuantile(0.95).count());
+            json.field("p99_us", entry->histogram->getQuantile(0.99).count());
+            break;
+        }
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+
+    json.beginObject("slow_queries");
+    json.beginArray("query");
+    for (auto&& entry : database->getSlowQueries()) {
+        json.beginObject();
+        json.field("statement", entry.statement);
+        json.field("example", entry.example);
+        json.field("operation", entry.operation);
+        json.field("plan", entry.plan);
+        json.field("count", entry.count);
+        json.field("total_us", entry.total.count());
+        json.field("max_us", entry.max.count());
+        json.field("rows", entry.rows);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
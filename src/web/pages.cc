@@ -65,10 +65,14 @@ std::unique_ptr<WebRequestHandler> createWebRequestHandler(
         return std::make_unique<Web::VoidType>(std::move(content));
     if (page == "tasks")
         return std::make_unique<Web::Tasks>(std::move(content));
+    if (page == "events")
+        return std::make_unique<Web::Events>(std::move(content));
     if (page == "action")
         return std::make_unique<Web::Action>(std::move(content));
     if (page == "clients")
         return std::make_unique<Web::Clients>(std::move(content));
+    if (page == "metrics")
+        return std::make_unique<Web::Metrics>(std::move(content));
     if (page == "config_load")
         return std::make_unique<Web::ConfigLoad>(std::move(content));
     if (page == "config_save")
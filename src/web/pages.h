@@ -32,6 +32,8 @@
 #ifndef __WEB_PAGES_H__
 #define __WEB_PAGES_H__
 
+#include <set>
+
 #include "cds_objects.h"
 #include "common.h"
 #include "config/config_setup.h"
@@ -176,6 +178,20 @@ public:
     void process() override;
 };
 
+/// \brief Server-Sent Events stream of ui update ids and task changes
+class Events : public WebRequestHandler {
+    using WebRequestHandler::WebRequestHandler;
+
+public:
+    void getInfo(const char* filename, UpnpFileInfo* info) override;
+    std::unique_ptr<IOHandler> open(const char* filename, enum UpnpOpenFileMode mode) override;
+    void process() override;
+
+protected:
+    class Stream;
+    std::shared_ptr<UpdateSubscriber> subscriber;
+};
+
 /// \brief Chooses and creates the appropriate handler for processing the request.
 /// \param page identifies what type of the request we are dealing with.
 /// \return the appropriate request handler.
@@ -193,16 +209,28 @@ public:
     void process() override;
 };
 
+/// \brief show the current metrics
+class Metrics : public WebRequestHandler {
+    using WebRequestHandler::WebRequestHandler;
+
+public:
+    void process() override;
+};
+
 /// \brief load configuration
 class ConfigLoad : public WebRequestHandler {
 protected:
     std::vector<ConfigValue> dbEntries;
-    std::map<std::string, std::string> allItems;
-    void createItem(pugi::xml_node& item, const std::string& name, config_option_t id, config_option_t aid, const std::shared_ptr<ConfigSetup>& cs = nullptr);
+    std::map<std::string, const ConfigValue*> dbValues;
+    std::set<std::string> allItems;
+    bool itemOpen {};
+    /// \brief start a new entry in values, closes the previous one
+    void createItem(const std::string& name, config_option_t id, config_option_t aid, const std::shared_ptr<ConfigSetup>& cs = nullptr);
+    void finishItem();
     template <typename T>
-    static void setValue(pugi::xml_node& item, const T& value);
+    void setValue(const T& value);
 
-    static void addTypeMeta(pugi::xml_node& meta, const std::shared_ptr<ConfigSetup>& cs);
+    void addTypeMeta(const std::shared_ptr<ConfigSetup>& cs);
 
 public:
     explicit ConfigLoad(std::shared_ptr<ContentManager> content);
@@ -39,6 +39,8 @@
 #include "util/tools.h"
 
 #define MAX_UI_UPDATE_IDS 10
+// every push connection occupies a thread of the web server
+#define MAX_UI_SUBSCRIBERS 4
 
 namespace Web {
 
@@ -62,17 +64,15 @@ std::string Session::get(const std::string& key)
 
 void Session::containerChangedUI(int objectID)
 {
-    if (objectID == INVALID_OBJECT_ID)
+    if (objectID == INVALID_OBJECT_ID || updateAll)
         return;
+    AutoLock lock(updateMutex);
     if (!updateAll) {
-        AutoLockR lock(rmutex);
-        if (!updateAll) {
-            if (uiUpdateIDs.size() >= MAX_UI_UPDATE_IDS) {
-                updateAll = true;
-                uiUpdateIDs.clear();
-            } else
-                uiUpdateIDs.insert(objectID);
-        }
+        if (uiUpdateIDs.size() >= MAX_UI_UPDATE_IDS) {
+            updateAll = true;
+            uiUpdateIDs.clear();
+        } else
+            uiUpdateIDs.insert(objectID);
     }
 }
 
@@ -82,7 +82,7 @@ void Session::containerChangedUI(const std::vector<int>& objectIDs)
         return;
 
     auto arSize = objectIDs.size();
-    AutoLockR lock(rmutex);
+    AutoLock lock(updateMutex);
 
     if (updateAll)
         return;
@@ -100,7 +100,7 @@ std::string Session::getUIUpdateIDs()
 {
     if (!hasUIUpdateIDs())
         return {};
-    AutoLockR lock(rmutex);
+    AutoLock lock(updateMutex);
     if (updateAll) {
         updateAll = false;
         return "all";
@@ -117,20 +117,86 @@ bool Session::hasUIUpdateIDs() const
 {
     if (updateAll)
         return true;
-    // AutoLock lock(mutex); only accessing an int - shouldn't be necessary
+    AutoLock lock(updateMutex);
     return !uiUpdateIDs.empty();
 }
 
 void Session::clearUpdateIDs()
 {
     log_debug("clearing UI updateIDs");
-    AutoLockR lock(rmutex);
+    AutoLock lock(updateMutex);
     uiUpdateIDs.clear();
     updateAll = false;
 }
 
+bool UpdateSubscriber::wait(std::chrono::milliseconds timeout, std::chrono::milliseconds batchDelay)
+{
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    if (!cond.wait_for(lock, timeout, [this]() { return closed || task || updateAll || !uiUpdateIDs.empty(); }))
+        return false;
+    // an import changes many containers in a row
+    cond.wait_for(lock, batchDelay, [this]() { return closed; });
+    return !closed;
+}
+
+std::string UpdateSubscriber::takeUpdateIDs()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    std::string ret;
+    if (updateAll)
+        ret = "all";
+    else if (!uiUpdateIDs.empty())
+        ret = fmt::format("{}", fmt::join(uiUpdateIDs, ","));
+    updateAll = false;
+    uiUpdateIDs.clear();
+    return ret;
+}
+
+bool UpdateSubscriber::takeTaskChanged()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return std::exchange(task, false);
+}
+
+bool UpdateSubscriber::isClosed() const
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    return closed;
+}
+
+void UpdateSubscriber::containersChanged(const std::vector<int>& objectIDs)
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    if (updateAll)
+        return;
+    for (int objectID : objectIDs) {
+        if (objectID != INVALID_OBJECT_ID)
+            uiUpdateIDs.insert(objectID);
+    }
+    if (uiUpdateIDs.size() >= MAX_UI_UPDATE_IDS) {
+        updateAll = true;
+        uiUpdateIDs.clear();
+    }
+    cond.notify_one();
+}
+
+void UpdateSubscriber::taskChanged()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    task = true;
+    cond.notify_one();
+}
+
+void UpdateSubscriber::close()
+{
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    closed = true;
+    cond.notify_one();
+}
+
 SessionManager::SessionManager(const std::shared_ptr<Config>& config, std::shared_ptr<Timer> timer)
     : timer(std::move(timer))
+    , lastTick(currentTime() / SESSION_TIMEOUT_CHECK_INTERVAL)
     , accounts(config->getDictionaryOption(CFG_SERVER_UI_ACCOUNT_LIST))
 {
 }
@@ -138,49 +204,51 @@ SessionManager::SessionManager(const std::shared_ptr<Config>& config, std::share
 std::shared_ptr<Session> SessionManager::createSession(std::chrono::seconds timeout)
 {
     auto newSession = std::make_shared<Session>(timeout);
-    AutoLock lock(mutex);
 
     int count = 0;
-    std::string sessionID;
-    do {
-        sessionID = generateRandomId();
+    while (true) {
+        // for the rare case, where we get a random id, that is already taken
+        auto sessionID = generateRandomId();
+        auto&& shard = getShard(sessionID);
+        std::scoped_lock lock(shard.mutex);
+        if (shard.sessions.try_emplace(sessionID, newSession).second) {
+            newSession->setID(sessionID);
+            break;
+        }
         if (count++ > 100)
             throw_std_runtime_error("There seems to be something wrong with the random numbers. I tried to get a unique id 100 times and failed. last sessionID: {}", sessionID);
-    } while (getSession(sessionID, false)); // for the rare case, where we get a random id, that is already taken
+    }
+    ++sessionCount;
 
-    newSession->setID(sessionID);
-    sessions.push_back(newSession);
+    std::scoped_lock lock(wheelMutex);
+    schedule(newSession);
     checkTimer();
     return newSession;
 }
 
-std::shared_ptr<Session> SessionManager::getSession(const std::string& sessionID, bool doLock)
+std::shared_ptr<Session> SessionManager::getSession(const std::string& sessionID)
 {
-    if (sessions.empty()) {
+    if (sessionCount == 0) {
         return nullptr;
     }
 
-    auto lock = std::unique_lock<std::mutex>(mutex, std::defer_lock);
-    if (doLock)
-        lock.lock();
-
-    auto it = std::find_if(sessions.begin(), sessions.end(), [=](auto&& s) { return s->getID() == sessionID; });
-    return it != sessions.end() ? *it : nullptr;
+    auto&& shard = getShard(sessionID);
+    std::scoped_lock lock(shard.mutex);
+    auto it = shard.sessions.find(sessionID);
+    return it != shard.sessions.end() ? it->second : nullptr;
 }
 
 void SessionManager::removeSession(const std::string& sessionID)
 {
-    if (sessions.empty()) {
+    if (sessionCount == 0) {
         return;
     }
 
-    AutoLock lock(mutex);
-
-    auto it = std::find_if(sessions.begin(), sessions.end(), [=](auto&& s) { return s->getID() == sessionID; });
-    if (it != sessions.end()) {
-        sessions.erase(it);
-        checkTimer();
-    }
+    auto&& shard = getShard(sessionID);
+    std::scoped_lock lock(shard.mutex);
+    if (shard.sessions.erase(sessionID) > 0)
+        --sessionCount;
+    // the wheel drops the entry when its slot comes up
 }
 
 std::string SessionManager::getUserPassword(const std::string& user) const
@@ -188,57 +256,123 @@ std::string SessionManager::getUserPassword(const std::string& user) const
     return getValueOrDefault(accounts, user);
 }
 
+template <typename F>
+void SessionManager::forEachSession(F&& func)
+{
+    for (auto&& shard : shards) {
+        std::scoped_lock lock(shard.mutex);
+        for (auto&& [sessionID, session] : shard.sessions)
+            func(session);
+    }
+}
+
 void SessionManager::containerChangedUI(int objectID)
 {
-    if (sessions.empty())
-        return;
-    AutoLock lock(mutex);
-    for (auto&& session : sessions) {
-        if (session->isLoggedIn())
-            session->containerChangedUI(objectID);
+    if (sessionCount > 0) {
+        forEachSession([=](auto&& session) {
+            if (session->isLoggedIn())
+                session->containerChangedUI(objectID);
+        });
     }
+    AutoLock lock(mutex);
+    for (auto&& subscriber : subscribers)
+        subscriber->containersChanged({ objectID });
 }
 
 void SessionManager::containerChangedUI(const std::vector<int>& objectIDs)
 {
-    if (sessions.empty())
-        return;
-    AutoLock lock(mutex);
-    for (auto&& session : sessions) {
-        if (session->isLoggedIn())
-            session->containerChangedUI(objectIDs);
+    if (sessionCount > 0) {
+        forEachSession([&](auto&& session) {
+            if (session->isLoggedIn())
+                session->containerChangedUI(objectIDs);
+        });
     }
+    AutoLock lock(mutex);
+    for (auto&& subscriber : subscribers)
+        subscriber->containersChanged(objectIDs);
+}
+
+void SessionManager::taskChanged()
+{
+    AutoLock lock(mutex);
+    for (auto&& subscriber : subscribers)
+        subscriber->taskChanged();
+}
+
+std::shared_ptr<UpdateSubscriber> SessionManager::subscribe()
+{
+    AutoLock lock(mutex);
+    if (shutdownFlag || subscribers.size() >= MAX_UI_SUBSCRIBERS)
+        return nullptr;
+    auto subscriber = std::make_shared<UpdateSubscriber>();
+    subscribers.push_back(subscriber);
+    log_debug("UI push connections: {}", subscribers.size());
+    return subscriber;
+}
+
+void SessionManager::unsubscribe(const std::shared_ptr<UpdateSubscriber>& subscriber)
+{
+    AutoLock lock(mutex);
+    subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), subscriber), subscribers.end());
+}
+
+void SessionManager::shutdown()
+{
+    AutoLock lock(mutex);
+    shutdownFlag = true;
+    for (auto&& subscriber : subscribers)
+        subscriber->close();
 }
 
 void SessionManager::checkTimer()
 {
-    if (!sessions.empty() && !timerAdded) {
+    if (sessionCount > 0 && !timerAdded) {
         timer->addTimerSubscriber(this, SESSION_TIMEOUT_CHECK_INTERVAL, nullptr);
         timerAdded = true;
-    } else if (sessions.empty() && timerAdded) {
+    } else if (sessionCount == 0 && timerAdded) {
         timer->removeTimerSubscriber(this, nullptr);
         timerAdded = false;
     }
 }
 
-void SessionManager::timerNotify(std::shared_ptr<Timer::Parameter> parameter)
+void SessionManager::schedule(const std::shared_ptr<Session>& session)
 {
-    log_debug("notified... {} web sessions.", sessions.size());
-
-    AutoLock lock(mutex);
+    long tick = (session->getLastAccessTime() + session->getTimeout()) / SESSION_TIMEOUT_CHECK_INTERVAL;
+    wheel[std::max(tick, lastTick + 1) % SESSION_WHEEL_SLOTS].push_back(session);
+}
 
-    auto now = currentTimeMS();
+void SessionManager::timerNotify(std::shared_ptr<Timer::Parameter> parameter)
+{
+    log_debug("notified... {} web sessions.", sessionCount);
+    expireSessions(currentTime());
+}
 
-    for (auto it = sessions.begin(); it != sessions.end(); /*++it*/) {
-        if (getDeltaMillis((*it)->getLastAccessTime(), now) > (*it)->getTimeout()) {
-            log_debug("session timeout: {} - diff: {}", (*it)->getID(), getDeltaMillis((*it)->getLastAccessTime(), now).count());
-            checkTimer();
-            it = sessions.erase(it);
-            continue;
+void SessionManager::expireSessions(std::chrono::seconds now)
+{
+    std::scoped_lock lock(wheelMutex);
+
+    long nowTick = now / SESSION_TIMEOUT_CHECK_INTERVAL;
+    // after a long pause every slot is visited once
+    long firstTick = std::max(lastTick + 1, nowTick - static_cast<long>(SESSION_WHEEL_SLOTS) + 1);
+    lastTick = nowTick;
+
+    for (long tick = firstTick; tick <= nowTick; tick++) {
+        auto due = std::move(wheel[tick % SESSION_WHEEL_SLOTS]);
+        wheel[tick % SESSION_WHEEL_SLOTS].clear();
+        for (auto&& entry : due) {
+            auto session = entry.lock();
+            if (!session || getSession(session->getID()) != session)
+                continue;
+            auto idle = now - session->getLastAccessTime();
+            if (idle > session->getTimeout()) {
+                log_debug("session timeout: {} - diff: {}", session->getID(), idle.count());
+                removeSession(session->getID());
+            } else {
+                schedule(session);
+            }
         }
-
-        ++it;
     }
+    checkTimer();
 }
 
 } // namespace Web
@@ -32,7 +32,11 @@
 #ifndef __SESSION_MANAGER_H__
 #define __SESSION_MANAGER_H__
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -64,7 +68,7 @@ public:
 
     /// \brief Returns the time of last access to the session.
     /// \return std::chrono::seconds
-    std::chrono::seconds getLastAccessTime() const { return last_access; }
+    std::chrono::seconds getLastAccessTime() const { return last_access.load(); }
 
     std::chrono::seconds getTimeout() const { return timeout; }
 
@@ -74,7 +78,7 @@ public:
     /// \brief Sets the session identifier.
     void setID(const std::string& sessionID) { this->sessionID = sessionID; }
 
-    bool isLoggedIn() const { return loggedIn; }
+    bool isLoggedIn() const { return loggedIn.load(); }
 
     void logIn() { loggedIn = true; }
 
@@ -102,22 +106,61 @@ protected:
     using AutoLockR = std::lock_guard<decltype(rmutex)>;
     std::map<std::string, std::string> dict;
 
+    /// \brief protects the update ids, kept apart from rmutex so changes do not wait for requests
+    mutable std::mutex updateMutex;
+    using AutoLock = std::lock_guard<decltype(updateMutex)>;
+
     /// \brief True if the ui update id hash became to big and
     /// the UI shall update every container
-    bool updateAll {};
+    std::atomic_bool updateAll {};
 
+    /// \brief never holds more than MAX_UI_UPDATE_IDS entries
     std::unordered_set<int> uiUpdateIDs;
 
     /// \brief maximum time the session can be idle (starting from last_access)
     std::chrono::seconds timeout;
 
     /// \brief time of last access to the session, returned by getLastAccessTime()
-    std::chrono::seconds last_access {};
+    std::atomic<std::chrono::seconds> last_access {};
 
     /// \brief arbitrary but unique string representing the ID of the session (returned by getID())
     std::string sessionID;
 
-    bool loggedIn {};
+    std::atomic_bool loggedIn {};
+
+    friend class SessionManager;
+};
+
+/// \brief UI changes collected for one push connection of the web UI.
+///
+/// Unlike the update ids of a Session, every open connection gets its own
+/// copy, so several browser tabs of the same session all see the changes.
+class UpdateSubscriber {
+public:
+    /// \brief wait for changes, then collect further changes for batchDelay
+    /// \return false if nothing changed within timeout or the subscriber was closed
+    bool wait(std::chrono::milliseconds timeout, std::chrono::milliseconds batchDelay);
+
+    /// \brief take the collected container ids
+    /// \return comma separated ids, "all" if too many containers changed
+    std::string takeUpdateIDs();
+
+    /// \brief take and reset the flag for a changed current task
+    bool takeTaskChanged();
+
+    bool isClosed() const;
+
+protected:
+    void containersChanged(const std::vector<int>& objectIDs);
+    void taskChanged();
+    void close();
+
+    mutable std::mutex mutex;
+    std::condition_variable cond;
+    std::unordered_set<int> uiUpdateIDs;
+    bool updateAll {};
+    bool task {};
+    bool closed {};
 
     friend class SessionManager;
 };
@@ -127,17 +170,48 @@ class SessionManager : public Timer::Subscriber {
 protected:
     std::shared_ptr<Timer> timer;
 
+    /// \brief protects the push connections
     std::mutex mutex;
     using AutoLock = std::lock_guard<decltype(mutex)>;
 
-    /// \brief This array is holding available sessions.
-    std::vector<std::shared_ptr<Session>> sessions;
+    /// \brief Sessions by id, spread over several locks so lookups of different sessions do not wait for each other.
+    struct SessionShard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+    };
+    static constexpr std::size_t SESSION_SHARDS = 16;
+    std::array<SessionShard, SESSION_SHARDS> shards;
+    std::atomic_size_t sessionCount {};
+
+    SessionShard& getShard(const std::string& sessionID) { return shards[std::hash<std::string> {}(sessionID) % SESSION_SHARDS]; }
+
+    /// \brief Timer wheel for the expiry, each slot covers one SESSION_TIMEOUT_CHECK_INTERVAL.
+    ///
+    /// A session is only checked when the slot of its expiry comes up, it moves
+    /// on to a later slot if it was accessed in the meantime.
+    static constexpr std::size_t SESSION_WHEEL_SLOTS = 64;
+    std::mutex wheelMutex;
+    std::array<std::vector<std::weak_ptr<Session>>, SESSION_WHEEL_SLOTS> wheel;
+    /// \brief last slot tick that was expired
+    long lastTick;
+
+    void schedule(const std::shared_ptr<Session>& session);
+
+    /// \brief remove sessions not accessed within their timeout
+    void expireSessions(std::chrono::seconds now);
 
     std::map<std::string, std::string> accounts;
 
+    /// \brief open push connections
+    std::vector<std::shared_ptr<UpdateSubscriber>> subscribers;
+    bool shutdownFlag {};
+
     void checkTimer();
     bool timerAdded {};
 
+    template <typename F>
+    void forEachSession(F&& func);
+
 public:
     /// \brief Constructor, initializes the array.
     SessionManager(const std::shared_ptr<Config>& config, std::shared_ptr<Timer> timer);
@@ -149,7 +223,7 @@ public:
     /// \brief Returns the instance to a Session with a given sessionID
     /// \param ID of the Session.
     /// \return instance of the Session with a given ID or nullptr if no session with that ID was found.
-    std::shared_ptr<Session> getSession(const std::string& sessionID, bool doLock = true);
+    std::shared_ptr<Session> getSession(const std::string& sessionID);
 
     /// \brief Removes a session
     void removeSession(const std::string& sessionID);
@@ -164,6 +238,18 @@ public:
 
     void containerChangedUI(const std::vector<int>& objectIDs);
 
+    /// \brief Is called whenever the current task of the content manager changes.
+    void taskChanged();
+
+    /// \brief Registers a push connection.
+    /// \return nullptr if too many connections are open
+    std::shared_ptr<UpdateSubscriber> subscribe();
+
+    void unsubscribe(const std::shared_ptr<UpdateSubscriber>& subscriber);
+
+    /// \brief Ends all push connections, so the web server can stop.
+    void shutdown();
+
     void timerNotify([[maybe_unused]] std::shared_ptr<Timer::Parameter> parameter) override;
 };
 
@@ -113,6 +113,14 @@ void WebRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
 }
 
 std::unique_ptr<IOHandler> WebRequestHandler::open(const char* filename, enum UpnpOpenFileMode mode)
+{
+    auto output = renderResponse();
+    auto ioHandler = std::make_unique<MemIOHandler>(output);
+    ioHandler->open(mode);
+    return ioHandler;
+}
+
+std::string WebRequestHandler::renderResponse()
 {
     xmlDoc = std::make_unique<pugi::xml_document>();
     auto decl = xmlDoc->prepend_child(pugi::node_declaration);
@@ -121,11 +129,11 @@ std::unique_ptr<IOHandler> WebRequestHandler::open(const char* filename, enum Up
     auto root = xmlDoc->append_child("root");
 
     xml2JsonHints = std::make_unique<Xml2Json::Hints>();
+    json.clear();
 
     std::string error;
     int errorCode = 0;
 
-    std::string output;
     // processing page, creating output
     try {
         if (!config->getBoolOption(CFG_SERVER_UI_ENABLED)) {
@@ -137,7 +145,7 @@ std::unique_ptr<IOHandler> WebRequestHandler::open(const char* filename, enum Up
 
             if (checkRequestCalled) {
                 // add current task
-                appendTask(content->getCurrentTask(), root);
+                appendTask(content->getCurrentTask(), json);
 
                 handleUpdateIDs();
             }
@@ -159,32 +167,37 @@ std::unique_ptr<IOHandler> WebRequestHandler::open(const char* filename, enum Up
         errorCode = 800;
     }
 
-    if (error.empty()) {
-        root.append_attribute("success") = true;
-    } else {
-        root.append_attribute("success") = false;
-
-        auto errorEl = root.append_child("error");
-        errorEl.append_attribute("text") = error.c_str();
-
+    if (!error.empty()) {
+        // a partially written page cannot be closed properly
+        json.clear();
         if (errorCode == 0)
             errorCode = 899;
-        errorEl.append_attribute("code") = errorCode;
+        json.beginObject("error").textField("text", error).field("code", errorCode).endObject();
 
         log_warning("Web Error: {} {}", errorCode, error);
     }
 
-    try {
-        output = Xml2Json::getJson(root, *xml2JsonHints);
-    } catch (const std::runtime_error& e) {
-        log_error("Web marshalling error: {}", e.what());
+    // pages still building a document come first, then the directly written members
+    std::string output = fmt::format(R"({{"success":{})", error.empty());
+    if (root.first_child()) {
+        try {
+            auto xmlJson = Xml2Json::getJson(root, *xml2JsonHints);
+            output.push_back(',');
+            output.append(xmlJson, 1, xmlJson.size() - 2);
+        } catch (const std::runtime_error& e) {
+            log_error("Web marshalling error: {}", e.what());
+            return {};
+        }
     }
+    if (!json.empty()) {
+        output.reserve(output.size() + json.str().size() + 2);
+        output.push_back(',');
+        output.append(json.str());
+    }
+    output.push_back('}');
 
     log_debug("output-----------------------{}", output);
-
-    auto ioHandler = std::make_unique<MemIOHandler>(output);
-    ioHandler->open(mode);
-    return ioHandler;
+    return output;
 }
 
 void WebRequestHandler::handleUpdateIDs()
@@ -192,24 +205,25 @@ void WebRequestHandler::handleUpdateIDs()
     // session will be filled by check_request
     std::string updates = param("updates");
     if (!updates.empty()) {
-        auto root = xmlDoc->document_element();
-        auto updateIDs = root.append_child("update_ids");
-
+        json.key("update_ids");
         if (updates == "check") {
-            updateIDs.append_attribute("pending") = session->hasUIUpdateIDs();
+            json.beginObject().field("pending", session->hasUIUpdateIDs()).endObject();
         } else if (updates == "get") {
-            addUpdateIDs(session, updateIDs);
+            addUpdateIDs(session, json);
+        } else {
+            json.value("");
         }
     }
 }
 
-void WebRequestHandler::addUpdateIDs(const std::shared_ptr<Session>& session, pugi::xml_node& updateIDsEl)
+void WebRequestHandler::addUpdateIDs(const std::shared_ptr<Session>& session, JsonWriter& json)
 {
     std::string updateIDs = session->getUIUpdateIDs();
     if (!updateIDs.empty()) {
         log_debug("UI: sending update ids: {}", updateIDs);
-        updateIDsEl.append_attribute("ids") = updateIDs.c_str();
-        updateIDsEl.append_attribute("updates") = true;
+        json.beginObject().textField("ids", updateIDs).field("updates", true).endObject();
+    } else {
+        json.value("");
     }
 }
 
@@ -223,6 +237,17 @@ void WebRequestHandler::appendTask(const std::shared_ptr<GenericTask>& task, pug
     taskEl.append_attribute("text") = task->getDescription().c_str();
 }
 
+void WebRequestHandler::appendTask(const std::shared_ptr<GenericTask>& task, JsonWriter& json)
+{
+    if (!task)
+        return;
+    json.beginObject("task");
+    json.field("id", task->getID());
+    json.field("cancellable", task->isCancellable());
+    json.textField("text", task->getDescription());
+    json.endObject();
+}
+
 std::string_view WebRequestHandler::mapAutoscanType(int type)
 {
     switch (type) {
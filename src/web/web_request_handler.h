@@ -40,6 +40,7 @@
 #include "request_handler.h"
 #include "session_manager.h"
 #include "util/generic_task.h"
+#include "util/json_writer.h"
 #include "util/xml_to_json.h"
 
 namespace Web {
@@ -78,6 +79,10 @@ protected:
     /// \brief Hints for Xml2Json, such that we know when to create an array
     std::unique_ptr<Xml2Json::Hints> xml2JsonHints;
 
+    /// \brief Members of the response object written directly by process(),
+    /// pages using it do not touch xmlDoc.
+    JsonWriter json { true };
+
     /// \brief The current session, used for this request; will be filled by
     /// checkRequest()
     std::shared_ptr<Session> session;
@@ -98,10 +103,10 @@ protected:
     /// a decondary driver.
     void checkRequest(bool checkLogin = true);
 
-    /// \brief add the ui update ids from the given session as xml tags to the given root element
+    /// \brief write the ui update ids from the given session as json value
     /// \param session the session from which the ui update ids should be taken
-    /// \param updateIDsEl the xml element to add the elements to
-    static void addUpdateIDs(const std::shared_ptr<Session>& session, pugi::xml_node& updateIDsEl);
+    /// \param json the writer, positioned after the key
+    static void addUpdateIDs(const std::shared_ptr<Session>& session, JsonWriter& json);
 
     /// \brief check if ui update ids should be added to the response and add
     /// them in that case.
@@ -112,6 +117,7 @@ protected:
     /// \param task the task to add to the given xml element
     /// \param parent the xml element to add the elements to
     static void appendTask(const std::shared_ptr<GenericTask>& task, pugi::xml_node& parent);
+    static void appendTask(const std::shared_ptr<GenericTask>& task, JsonWriter& json);
 
     /// \brief check if accounts are enabled in the config
     /// \return true if accounts are enabled, false if not
@@ -119,6 +125,9 @@ protected:
 
     static std::string_view mapAutoscanType(int type);
 
+    /// \brief run process() and convert the result or the error to json
+    std::string renderResponse();
+
 public:
     /// \brief Constructor, currently empty.
     explicit WebRequestHandler(std::shared_ptr<ContentManager> content);
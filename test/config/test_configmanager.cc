@@ -5,8 +5,10 @@
 #include <gtest/gtest.h>
 #include <memory>
 
+#include "config/config_definition.h"
 #include "config/config_generator.h"
 #include "config/config_manager.h"
+#include "config/config_setup.h"
 #include "util/tools.h"
 
 class ConfigManagerTest : public ::testing::Test {
@@ -139,3 +141,30 @@ TEST_F(ConfigManagerTest, LoadsConfigFromDefaultHomeWhenExistsButNotSpecified)
     ASSERT_FALSE(shared->getBoolOption(CFG_SERVER_UI_ACCOUNTS_ENABLED));
     ASSERT_EQ(30, shared->getIntOption(CFG_SERVER_UI_SESSION_TIMEOUT));
 }
+
+TEST_F(ConfigManagerTest, PublishesSnapshotOfOptions)
+{
+    auto shared = std::make_shared<ConfigManager>(configFile, home, confdir, prefix, magic, "", "", 0, false);
+    shared->load(home);
+
+    auto snapshot = shared->getSnapshot();
+    EXPECT_EQ(snapshot->getContentType("audio/mpeg"), "mp3");
+    EXPECT_EQ(snapshot->getContentType("application/x-unknown"), "");
+    EXPECT_EQ(snapshot->getDlnaProfile("mp3"), "MP3");
+    EXPECT_EQ(snapshot->getDlnaProfile("unknown"), "");
+    EXPECT_EQ(snapshot->prefetchEnabled, shared->getBoolOption(CFG_SERVER_EXTOPTS_PREFETCH_ENABLED));
+    EXPECT_EQ(snapshot->prefetchChunkSize, std::size_t(shared->getIntOption(CFG_SERVER_EXTOPTS_PREFETCH_CHUNK_SIZE)));
+
+    ConfigDefinition::findConfigSetup(CFG_SERVER_EXTOPTS_PREFETCH_CHUNK_SIZE)->makeOption("8192", shared);
+    shared->updateSnapshot();
+
+    // old snapshot keeps its values while it is held
+    EXPECT_NE(snapshot->prefetchChunkSize, 8192);
+    EXPECT_EQ(shared->getSnapshot()->prefetchChunkSize, 8192);
+    EXPECT_EQ(shared->getSnapshot()->getContentType("audio/mpeg"), "mp3");
+
+    // and is freed with its last reader
+    std::weak_ptr<const ConfigSnapshot> oldSnapshot = snapshot;
+    snapshot.reset();
+    EXPECT_TRUE(oldSnapshot.expired());
+}
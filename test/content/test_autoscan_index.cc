@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include "content/autoscan.h"
+#include "content/autoscan_index.h"
+#include "content/autoscan_list.h"
+
+#include "../mock/database_mock.h"
+
+/// \brief container tree: 0 -> 1 -> 10 -> 100, 0 -> 2; 30 -> 31 where 30 has no row
+class PathDatabase : public DatabaseMock {
+public:
+    PathDatabase()
+        : DatabaseMock(nullptr)
+    {
+    }
+
+    std::vector<int> getPathIDs(int objectID) override
+    {
+        queries++;
+        std::vector<int> result;
+        while (objectID != CDS_ID_ROOT) {
+            result.push_back(objectID);
+            auto parent = parents.find(objectID);
+            if (parent == parents.end()) {
+                result.push_back(INVALID_OBJECT_ID);
+                break;
+            }
+            objectID = parent->second;
+        }
+        return result;
+    }
+
+    std::map<int, int> parents { { 1, 0 }, { 2, 0 }, { 10, 1 }, { 100, 10 }, { 31, 30 } };
+    int queries {};
+};
+
+class AutoscanIndexTest : public ::testing::Test {
+public:
+    std::shared_ptr<PathDatabase> database { std::make_shared<PathDatabase>() };
+    std::shared_ptr<AutoscanList> timed { std::make_shared<AutoscanList>(database) };
+    std::shared_ptr<AutoscanList> inotify;
+    AutoscanIndex index { database, [this] { return std::vector { timed, inotify }; } };
+
+    std::shared_ptr<AutoscanDirectory> addDirectory(const std::shared_ptr<AutoscanList>& list, const fs::path& location, int objectID)
+    {
+        auto adir = std::make_shared<AutoscanDirectory>(location, ScanMode::Timed, true, false);
+        adir->setObjectID(objectID);
+        list->add(adir);
+        return adir;
+    }
+};
+
+TEST_F(AutoscanIndexTest, RebuildsAfterInvalidate)
+{
+    auto music = addDirectory(timed, "/media/music", 10);
+    EXPECT_EQ(index.get(10), music);
+    EXPECT_EQ(index.get(1), nullptr);
+
+    // not seen until the generation changes
+    auto video = addDirectory(timed, "/media/video", 2);
+    EXPECT_EQ(index.get(2), nullptr);
+    index.invalidate();
+    EXPECT_EQ(index.get(2), video);
+
+    inotify = std::make_shared<AutoscanList>(database);
+    auto photos = addDirectory(inotify, "/media/photos", 1);
+    index.invalidate();
+    EXPECT_EQ(index.get(1), photos);
+    EXPECT_EQ(index.get(10), music);
+
+    timed->remove(music->getScanID());
+    index.invalidate();
+    EXPECT_EQ(index.get(10), nullptr);
+}
+
+TEST_F(AutoscanIndexTest, ChecksObjectIDOfIndexedDirectory)
+{
+    auto music = addDirectory(timed, "/media/music", 10);
+    EXPECT_EQ(index.get(10), music);
+
+    // a persistent directory which lost its container is still in the old index
+    music->setObjectID(INVALID_OBJECT_ID);
+    EXPECT_EQ(index.get(10), nullptr);
+    music->setObjectID(100);
+    index.invalidate();
+    EXPECT_EQ(index.get(100), music);
+}
+
+TEST_F(AutoscanIndexTest, CachesParents)
+{
+    EXPECT_EQ(index.getPathIDs(100), (std::vector { 100, 10, 1 }));
+    EXPECT_EQ(database->queries, 1);
+    EXPECT_EQ(index.getPathIDs(100), (std::vector { 100, 10, 1 }));
+    EXPECT_EQ(index.getPathIDs(10), (std::vector { 10, 1 }));
+    EXPECT_EQ(database->queries, 1);
+
+    // generation changes do not drop the parents
+    index.invalidate();
+    EXPECT_EQ(index.getPathIDs(100), (std::vector { 100, 10, 1 }));
+    EXPECT_EQ(database->queries, 1);
+
+    // ids may be used again after removals
+    database->parents[100] = 2;
+    index.clearParents();
+    EXPECT_EQ(index.getPathIDs(100), (std::vector { 100, 2 }));
+    EXPECT_EQ(database->queries, 2);
+}
+
+TEST_F(AutoscanIndexTest, DoesNotCacheBrokenChain)
+{
+    EXPECT_EQ(index.getPathIDs(31), (std::vector { 31, 30 }));
+    EXPECT_EQ(database->queries, 1);
+
+    // the parent of 31 is known, 30 is not taken as child of the root
+    database->parents[30] = 2;
+    EXPECT_EQ(index.getPathIDs(31), (std::vector { 31, 30, 2 }));
+    EXPECT_EQ(database->queries, 2);
+    EXPECT_EQ(index.getPathIDs(31), (std::vector { 31, 30, 2 }));
+    EXPECT_EQ(database->queries, 2);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "content/update_id_tracker.h"
+#include "util/metrics.h"
+
+#include "../mock/database_mock.h"
+
+/// \brief container tree: 0 -> 1 -> 10 .. 19, 0 -> 2 -> 20
+class UpdateIDDatabase : public DatabaseMock {
+public:
+    UpdateIDDatabase()
+        : DatabaseMock(nullptr)
+    {
+        rows = { { 0, { 5, -1 } }, { 1, { 3, 0 } }, { 2, { 7, 0 } }, { 20, { 1, 2 } } };
+        for (int id = 10; id < 20; id++)
+            rows[id] = { 0, 1 };
+    }
+
+    std::unordered_map<int, UpdateID> loadUpdateIDs(const std::unordered_set<int>& ids) override
+    {
+        loads++;
+        std::unordered_map<int, UpdateID> result;
+        for (int id : ids) {
+            auto it = rows.find(id);
+            if (it != rows.end())
+                result.emplace(id, it->second);
+        }
+        return result;
+    }
+
+    void storeUpdateIDs(const std::unordered_map<int, int>& updateIDs) override
+    {
+        for (auto&& [id, updateID] : updateIDs)
+            rows[id].updateID = updateID;
+    }
+
+    std::map<int, UpdateID> rows;
+    int loads {};
+};
+
+class UpdateIDTrackerTest : public ::testing::Test {
+public:
+    std::shared_ptr<UpdateIDDatabase> database { std::make_shared<UpdateIDDatabase>() };
+};
+
+TEST_F(UpdateIDTrackerTest, CountsInMemory)
+{
+    auto tracker = UpdateIDTracker(database, 10, 4096);
+    EXPECT_EQ(tracker.flush({ 1, 2 }), "1,4,2,8");
+    EXPECT_EQ(tracker.flush({ 1 }), "1,5");
+    EXPECT_EQ(database->loads, 1);
+    EXPECT_EQ(database->rows[1].updateID, 3);
+
+    EXPECT_TRUE(tracker.needsPersist());
+    tracker.persist();
+    EXPECT_FALSE(tracker.needsPersist());
+    EXPECT_EQ(database->rows[1].updateID, 5);
+    EXPECT_EQ(database->rows[2].updateID, 8);
+
+    // still known after persisting
+    EXPECT_EQ(tracker.flush({ 2 }), "2,9");
+    EXPECT_EQ(database->loads, 1);
+}
+
+TEST_F(UpdateIDTrackerTest, ForgetsRemovedContainers)
+{
+    auto tracker = UpdateIDTracker(database, 10, 4096);
+    EXPECT_EQ(tracker.flush({ 1, 2 }), "1,4,2,8");
+
+    // removed before the change was stored
+    database->rows.erase(2);
+    tracker.remove({ 2 });
+    tracker.persist();
+    EXPECT_EQ(database->rows.count(2), 0);
+    EXPECT_EQ(database->rows[1].updateID, 4);
+
+    EXPECT_EQ(tracker.flush({ 1, 2 }), "1,5");
+    EXPECT_EQ(database->loads, 2);
+}
+
+TEST_F(UpdateIDTrackerTest, SkipsRemovedContainers)
+{
+    auto tracker = UpdateIDTracker(database, 10, 4096);
+    EXPECT_EQ(tracker.flush({ 99 }), "");
+    EXPECT_EQ(tracker.flush({ 99, 20 }), "20,2");
+}
+
+TEST_F(UpdateIDTrackerTest, CollapsesToAncestors)
+{
+    auto&& changedMetric = Metrics::getInstance()->counter("gerbera_update_changed_containers_total", "");
+    auto&& reportedMetric = Metrics::getInstance()->counter("gerbera_update_containers_total", "");
+    auto&& collapsedMetric = Metrics::getInstance()->counter("gerbera_update_collapsed_events_total", "");
+    auto&& byteMetric = Metrics::getInstance()->counter("gerbera_update_event_bytes_total", "");
+    auto changedBefore = changedMetric.get();
+    auto reportedBefore = reportedMetric.get();
+    auto collapsedBefore = collapsedMetric.get();
+    auto bytesBefore = byteMetric.get();
+
+    auto tracker = UpdateIDTracker(database, 5, 4096);
+    std::unordered_set<int> changed;
+    for (int id = 10; id < 20; id++)
+        changed.insert(id);
+    changed.insert(20);
+
+    // 10 .. 19 become 1 and 20 becomes 2
+    EXPECT_EQ(tracker.flush(changed), "1,4,2,8");
+
+    // the collapsed containers still got new update ids
+    tracker.persist();
+    EXPECT_EQ(database->rows[15].updateID, 1);
+    EXPECT_EQ(database->rows[20].updateID, 2);
+    EXPECT_EQ(database->rows[1].updateID, 4);
+
+    EXPECT_EQ(changedMetric.get() - changedBefore, 11);
+    EXPECT_EQ(reportedMetric.get() - reportedBefore, 2);
+    EXPECT_EQ(collapsedMetric.get() - collapsedBefore, 1);
+    EXPECT_EQ(byteMetric.get() - bytesBefore, 7);
+}
+
+TEST_F(UpdateIDTrackerTest, CollapsesBySize)
+{
+    auto tracker = UpdateIDTracker(database, 100, 10);
+    // "10,1,11,1,20,2" is too long
+    EXPECT_EQ(tracker.flush({ 10, 11, 20 }), "1,4,2,8");
+}
+
+TEST_F(UpdateIDTrackerTest, StopsAtRoot)
+{
+    auto tracker = UpdateIDTracker(database, 1, 4096);
+    EXPECT_EQ(tracker.flush({ 0, 1, 2 }), "0,6");
+}
@@ -0,0 +1,86 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_album_art_cache.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "metadata/album_art_cache.h"
+#include "util/logger.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "../helper/temp_dir_test.h"
+
+class AlbumArtCacheTest : public TempDirTest {
+public:
+    void SetUp() override
+    {
+        TempDirTest::SetUp();
+        cache = std::make_unique<AlbumArtCache>(dir, std::vector<int> { 160 });
+    }
+
+    std::string store(const fs::path& mediaFile, time_t mtime, const std::string& picture)
+    {
+        return cache->store(mediaFile, mtime, reinterpret_cast<const std::byte*>(picture.data()), picture.size());
+    }
+
+    static std::string readFile(const fs::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    std::unique_ptr<AlbumArtCache> cache;
+};
+
+TEST_F(AlbumArtCacheTest, SharesPicturesOfAlbum)
+{
+    auto first = store("/music/album/01 - first.mp3", 100, "cover");
+    auto second = store("/music/album/02 - second.mp3", 200, "cover");
+    auto other = store("/music/other/01 - other.mp3", 100, "other cover");
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(readFile(cache->getPicturePath(first)), "cover");
+
+    EXPECT_EQ(cache->lookup("/music/album/01 - first.mp3", 100), first);
+    EXPECT_EQ(cache->lookup("/music/album/02 - second.mp3", 200), first);
+    EXPECT_EQ(cache->lookup("/music/other/01 - other.mp3", 100), other);
+}
+
+TEST_F(AlbumArtCacheTest, ModifiedMediaIsNotServed)
+{
+    store("/music/album/01 - first.mp3", 100, "cover");
+    EXPECT_EQ(cache->lookup("/music/album/01 - first.mp3", 101), std::nullopt);
+    EXPECT_EQ(cache->lookup("/music/album/03 - unknown.mp3", 100), std::nullopt);
+
+    auto hash = store("/music/album/01 - first.mp3", 101, "new cover");
+    EXPECT_EQ(cache->lookup("/music/album/01 - first.mp3", 101), hash);
+}
+
+TEST_F(AlbumArtCacheTest, MissingPictureIsNotServed)
+{
+    auto hash = store("/music/album/01 - first.mp3", 100, "cover");
+    fs::remove(cache->getPicturePath(hash));
+    EXPECT_EQ(cache->lookup("/music/album/01 - first.mp3", 100), std::nullopt);
+}
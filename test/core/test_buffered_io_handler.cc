@@ -0,0 +1,105 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_buffered_io_handler.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+#include "iohandler/buffered_io_handler.h"
+#include "iohandler/mem_io_handler.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "../mock/config_mock.h"
+
+class BufferedIOHandlerTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        config = std::make_shared<ConfigMock>();
+    }
+
+    static std::string makeData(std::size_t size)
+    {
+        std::string data(size, '\0');
+        for (std::size_t i = 0; i < size; i++)
+            data[i] = char(i % 251);
+        return data;
+    }
+
+    static std::size_t readAll(IOHandler& handler, std::size_t chunk, std::string* result = nullptr)
+    {
+        std::vector<char> buf(chunk);
+        std::size_t total = 0;
+        std::size_t ret;
+        while ((ret = handler.read(buf.data(), buf.size())) > 0 && ret != std::size_t(-1)) {
+            if (result)
+                result->append(buf.data(), ret);
+            total += ret;
+        }
+        return total;
+    }
+
+    std::shared_ptr<ConfigMock> config;
+};
+
+TEST_F(BufferedIOHandlerTest, ReadsEverything)
+{
+    auto data = makeData(1000000);
+    auto handler = BufferedIOHandler(config, std::make_unique<MemIOHandler>(data), 16384, 4096, 0);
+    handler.open(UPNP_READ);
+    std::string result;
+    readAll(handler, 3000, &result);
+    handler.close();
+    EXPECT_EQ(result, data);
+}
+
+TEST_F(BufferedIOHandlerTest, WaitsForInitialFill)
+{
+    auto data = makeData(100000);
+    auto handler = BufferedIOHandler(config, std::make_unique<MemIOHandler>(data), 32768, 1000, 32768);
+    handler.open(UPNP_READ);
+
+    // the first read only returns once the buffer is full
+    std::vector<char> buf(65536);
+    EXPECT_EQ(handler.read(buf.data(), buf.size()), 32768U);
+
+    std::string result(buf.data(), 32768);
+    readAll(handler, 5000, &result);
+    handler.close();
+    EXPECT_EQ(result, data);
+}
+
+/// \brief prints the throughput for typical read sizes of the web server,
+/// the results are not checked as they depend on the machine
+TEST_F(BufferedIOHandlerTest, DISABLED_ThroughputByReadSize)
+{
+    auto data = makeData(64 * 1024 * 1024);
+    for (std::size_t readSize : { 512, 4096, 16384, 65536 }) {
+        auto handler = BufferedIOHandler(config, std::make_unique<MemIOHandler>(data), 1024 * 1024, 65536, 0);
+        auto start = std::chrono::steady_clock::now();
+        handler.open(UPNP_READ);
+        auto total = readAll(handler, readSize);
+        handler.close();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        EXPECT_EQ(total, data.size());
+        std::cout << fmt::format("read size {:6}: {:8.1f} MB/s\n", readSize, double(total) / elapsed / 1e6);
+    }
+}
@@ -0,0 +1,298 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_curl_io_handler.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+#ifdef HAVE_CURL
+
+#include "iohandler/curl_engine.h"
+#include "iohandler/curl_io_handler.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../mock/config_mock.h"
+
+/// \brief minimal HTTP/1.1 server with keep-alive and range support
+class TestHttpServer {
+public:
+    explicit TestHttpServer(std::string body)
+        : body(std::move(body))
+    {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addrLen = sizeof(addr);
+        if (bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), addrLen) != 0
+            || listen(listenFd, 16) != 0
+            || getsockname(listenFd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) != 0)
+            throw std::runtime_error("failed to start test server");
+        port = ntohs(addr.sin_port);
+        acceptThread = std::thread([this]() { acceptConnections(); });
+    }
+
+    ~TestHttpServer()
+    {
+        ::shutdown(listenFd, SHUT_RDWR);
+        acceptThread.join();
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            for (auto fd : connectionFds)
+                ::shutdown(fd, SHUT_RDWR);
+        }
+        for (auto&& thread : connectionThreads)
+            thread.join();
+        ::close(listenFd);
+    }
+
+    std::string getUrl() const { return fmt::format("http://127.0.0.1:{}/stream", port); }
+
+    std::atomic_int connections {};
+    std::atomic_int requests {};
+
+private:
+    std::string body;
+    int listenFd;
+    int port;
+    std::thread acceptThread;
+    std::mutex mutex;
+    std::vector<int> connectionFds;
+    std::vector<std::thread> connectionThreads;
+
+    void acceptConnections()
+    {
+        int fd;
+        while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC)) >= 0) {
+            connections++;
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            connectionFds.push_back(fd);
+            connectionThreads.emplace_back([this, fd]() { serve(fd); });
+        }
+    }
+
+    void serve(int fd)
+    {
+        std::string request;
+        char buf[4096];
+        while (true) {
+            auto end = request.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                auto ret = ::read(fd, buf, sizeof(buf));
+                if (ret <= 0)
+                    break;
+                request.append(buf, ret);
+                continue;
+            }
+            requests++;
+
+            std::size_t from = 0;
+            auto range = request.find("Range: bytes=");
+            if (range != std::string::npos && range < end)
+                from = std::stoul(request.substr(range + 13));
+            request.erase(0, end + 4);
+
+            auto header = fmt::format("HTTP/1.1 {}\r\nContent-Length: {}\r\n", from > 0 ? "206 Partial Content" : "200 OK", body.size() - from);
+            if (from > 0)
+                header += fmt::format("Content-Range: bytes {}-{}/{}\r\n", from, body.size() - 1, body.size());
+            header += "\r\n";
+            if (!sendAll(fd, header.data(), header.size()) || !sendAll(fd, body.data() + from, body.size() - from))
+                break;
+        }
+        ::close(fd);
+    }
+
+    static bool sendAll(int fd, const char* data, std::size_t length)
+    {
+        while (length > 0) {
+            auto ret = ::send(fd, data, length, MSG_NOSIGNAL);
+            if (ret <= 0)
+                return false;
+            data += ret;
+            length -= ret;
+        }
+        return true;
+    }
+};
+
+class CurlIOHandlerTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        curl_global_init(CURL_GLOBAL_ALL);
+        config = std::make_shared<ConfigMock>();
+        data = makeData(1000000);
+        server = std::make_unique<TestHttpServer>(data);
+        engine = std::make_shared<CurlEngine>(config);
+        engine->run();
+    }
+
+    void TearDown() override
+    {
+        engine = nullptr;
+        server = nullptr;
+        curl_global_cleanup();
+    }
+
+    static std::string makeData(std::size_t size)
+    {
+        std::string result(size, '\0');
+        for (std::size_t i = 0; i < size; i++)
+            result[i] = char(i % 251);
+        return result;
+    }
+
+    static std::string readAll(IOHandler& handler, std::size_t chunk)
+    {
+        std::string result;
+        std::vector<char> buf(chunk);
+        std::size_t ret;
+        while ((ret = handler.read(buf.data(), buf.size())) > 0 && ret != std::size_t(-1))
+            result.append(buf.data(), ret);
+        return result;
+    }
+
+    std::unique_ptr<CurlIOHandler> makeHandler(std::size_t bufSize = 65536, std::size_t initialFillSize = 0)
+    {
+        return std::make_unique<CurlIOHandler>(config, engine, server->getUrl(), bufSize, initialFillSize);
+    }
+
+    std::shared_ptr<ConfigMock> config;
+    std::string data;
+    std::unique_ptr<TestHttpServer> server;
+    std::shared_ptr<CurlEngine> engine;
+};
+
+TEST_F(CurlIOHandlerTest, ReadsWholeStream)
+{
+    // the buffer is much smaller than the stream, so the request gets paused
+    auto handler = makeHandler(CURL_MAX_WRITE_SIZE);
+    handler->open(UPNP_READ);
+    EXPECT_EQ(readAll(*handler, 1000), data);
+    handler->close();
+    EXPECT_EQ(engine->getTransferCount(), 0U);
+}
+
+TEST_F(CurlIOHandlerTest, WaitsForInitialFill)
+{
+    auto handler = makeHandler(65536, 32768);
+    handler->open(UPNP_READ);
+    std::vector<char> buf(100000);
+    EXPECT_GE(handler->read(buf.data(), buf.size()), 32768U);
+    handler->close();
+}
+
+TEST_F(CurlIOHandlerTest, ReusesConnection)
+{
+    for (int i = 0; i < 3; i++) {
+        auto handler = makeHandler();
+        handler->open(UPNP_READ);
+        EXPECT_EQ(readAll(*handler, 65536), data);
+        handler->close();
+    }
+    EXPECT_EQ(server->requests, 3);
+    EXPECT_EQ(server->connections, 1);
+}
+
+TEST_F(CurlIOHandlerTest, SeeksWithNewRequest)
+{
+    auto handler = makeHandler();
+    handler->open(UPNP_READ);
+    std::vector<char> buf(1000);
+    ASSERT_EQ(handler->read(buf.data(), buf.size()), 1000U);
+
+    handler->seek(600000, SEEK_SET);
+    EXPECT_EQ(readAll(*handler, 4096), data.substr(600000));
+
+    // the request is restarted after the end of the stream, too
+    handler->seek(10, SEEK_SET);
+    EXPECT_EQ(readAll(*handler, 4096), data.substr(10));
+    handler->close();
+    EXPECT_EQ(server->requests, 3);
+}
+
+TEST_F(CurlIOHandlerTest, ReleasesUnreachableInitialFill)
+{
+    // a full chunk does not fit anymore before the initial fill size is reached
+    auto handler = makeHandler(CURL_MAX_WRITE_SIZE, CURL_MAX_WRITE_SIZE);
+    handler->open(UPNP_READ);
+    EXPECT_EQ(readAll(*handler, 1000), data);
+    handler->close();
+}
+
+TEST_F(CurlIOHandlerTest, ServesStreamsInOneThread)
+{
+    std::vector<std::unique_ptr<CurlIOHandler>> handlers;
+    std::vector<std::string> results(4);
+    for (std::size_t i = 0; i < results.size(); i++) {
+        handlers.push_back(makeHandler(CURL_MAX_WRITE_SIZE));
+        handlers.back()->open(UPNP_READ);
+    }
+    EXPECT_EQ(engine->getTransferCount(), results.size());
+
+    // all requests are paused most of the time
+    std::vector<char> buf(3000);
+    bool reading = true;
+    while (reading) {
+        reading = false;
+        for (std::size_t i = 0; i < handlers.size(); i++) {
+            if (results[i].size() == data.size())
+                continue;
+            auto ret = handlers[i]->read(buf.data(), buf.size());
+            ASSERT_NE(ret, std::size_t(-1));
+            results[i].append(buf.data(), ret);
+            reading = true;
+        }
+    }
+    for (auto&& result : results)
+        EXPECT_EQ(result, data);
+    for (auto&& handler : handlers)
+        handler->close();
+}
+
+TEST_F(CurlIOHandlerTest, ShutdownAbortsStreams)
+{
+    auto handler = makeHandler(CURL_MAX_WRITE_SIZE);
+    handler->open(UPNP_READ);
+    std::vector<char> buf(1000);
+    ASSERT_EQ(handler->read(buf.data(), buf.size()), 1000U);
+
+    engine->shutdown();
+    std::size_t ret;
+    while ((ret = handler->read(buf.data(), buf.size())) > 0 && ret != std::size_t(-1)) { }
+    EXPECT_EQ(ret, std::size_t(-1));
+    handler->close();
+}
+
+TEST_F(CurlIOHandlerTest, ReportsFailedRequest)
+{
+    auto handler = std::make_unique<CurlIOHandler>(config, engine, "http://127.0.0.1:1/stream", 65536, 0);
+    handler->open(UPNP_READ);
+    std::vector<char> buf(1000);
+    EXPECT_EQ(handler->read(buf.data(), buf.size()), std::size_t(-1));
+    handler->close();
+}
+
+#endif // HAVE_CURL
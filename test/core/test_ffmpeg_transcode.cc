@@ -0,0 +1,224 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_ffmpeg_transcode.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+#if defined(HAVE_FFMPEG) && defined(HAVE_AVSTREAM_CODECPAR)
+
+#include "iohandler/ffmpeg_transcode_io_handler.h"
+#include "transcoding/transcoding.h"
+#include "util/grb_fs.h"
+
+#include <cmath>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../helper/temp_dir_test.h"
+
+#define WAV_SAMPLE_RATE 44100
+#define WAV_CHANNELS 2
+
+using namespace std::chrono_literals;
+
+class FfmpegTranscodeTest : public TempDirTest {
+public:
+    void SetUp() override
+    {
+        TempDirTest::SetUp();
+        wavPath = dir / "sine.wav";
+    }
+
+    /// \brief write a stereo sine wave as 16 bit PCM
+    void writeWav(int seconds) const
+    {
+        auto put16 = [](std::ofstream& out, uint16_t val) { out.put(char(val & 0xff)).put(char(val >> 8)); };
+        auto put32 = [&put16](std::ofstream& out, uint32_t val) { put16(out, val & 0xffff); put16(out, val >> 16); };
+
+        uint32_t samples = WAV_SAMPLE_RATE * seconds;
+        uint32_t dataSize = samples * WAV_CHANNELS * 2;
+        std::ofstream out(wavPath, std::ios::binary);
+        out << "RIFF";
+        put32(out, 36 + dataSize);
+        out << "WAVEfmt ";
+        put32(out, 16);
+        put16(out, 1);
+        put16(out, WAV_CHANNELS);
+        put32(out, WAV_SAMPLE_RATE);
+        put32(out, WAV_SAMPLE_RATE * WAV_CHANNELS * 2);
+        put16(out, WAV_CHANNELS * 2);
+        put16(out, 16);
+        out << "data";
+        put32(out, dataSize);
+        for (uint32_t i = 0; i < samples; i++) {
+            auto val = int16_t(10000 * std::sin(2 * M_PI * 440 * i / WAV_SAMPLE_RATE));
+            for (int c = 0; c < WAV_CHANNELS; c++)
+                put16(out, uint16_t(val));
+        }
+    }
+
+    std::shared_ptr<TranscodingProfile> makeProfile(const std::string& format, const std::string& audioCodec, int sampleFreq = -1, int channels = -1) const
+    {
+        auto profile = std::make_shared<TranscodingProfile>(TR_Internal, "internal");
+        profile->setFormat(format);
+        profile->setAudioCodec(audioCodec);
+        profile->setSampleFreq(sampleFreq);
+        profile->setNumChannels(channels);
+        return profile;
+    }
+
+    static std::string readAll(IOHandler& handler)
+    {
+        std::string result;
+        char buf[65536];
+        std::size_t len;
+        while ((len = handler.read(buf, sizeof(buf))) > 0) {
+            if (len == std::size_t(-1))
+                throw std::runtime_error("read failed");
+            result.append(buf, len);
+        }
+        return result;
+    }
+
+    fs::path wavPath;
+};
+
+TEST_F(FfmpegTranscodeTest, RemuxesAudio)
+{
+    writeWav(2);
+    FfmpegTranscodeIOHandler handler(makeProfile("wav", "copy"), wavPath);
+    handler.open(UPNP_READ);
+    auto output = readAll(handler);
+    handler.close();
+
+    EXPECT_EQ(output.substr(0, 4), "RIFF");
+    EXPECT_GE(output.size(), std::size_t(2 * WAV_SAMPLE_RATE * WAV_CHANNELS * 2));
+}
+
+TEST_F(FfmpegTranscodeTest, StartsAtTime)
+{
+    writeWav(2);
+    FfmpegTranscodeIOHandler handler(makeProfile("wav", "copy"), wavPath, 1.5);
+    handler.open(UPNP_READ);
+    auto output = readAll(handler);
+
+    // half a second of samples plus the header
+    EXPECT_NEAR(double(output.size()), WAV_SAMPLE_RATE / 2 * WAV_CHANNELS * 2, 8192);
+}
+
+TEST_F(FfmpegTranscodeTest, RejectsInvalidProfile)
+{
+    writeWav(1);
+    FfmpegTranscodeIOHandler unknownFormat(makeProfile("no-such-format", "copy"), wavPath);
+    EXPECT_THROW(unknownFormat.open(UPNP_READ), std::runtime_error);
+
+    FfmpegTranscodeIOHandler missingFile(makeProfile("wav", "copy"), wavPath.string() + ".missing");
+    EXPECT_THROW(missingFile.open(UPNP_READ), std::runtime_error);
+}
+
+#ifdef HAVE_SWRESAMPLE
+TEST_F(FfmpegTranscodeTest, ConvertsToLpcm)
+{
+    writeWav(2);
+    FfmpegTranscodeIOHandler handler(makeProfile("s16be", "pcm_s16be", 22050, 1), wavPath);
+    handler.open(UPNP_READ);
+    auto output = readAll(handler);
+
+    // raw samples without header, the resampler may add a few at the end
+    EXPECT_NEAR(double(output.size()), 2 * 22050 * 2, 256);
+}
+
+static double cpuSeconds(const struct rusage& usage)
+{
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/// \brief compares start latency and cpu time with an external ffmpeg doing the same conversion,
+/// the results are printed and not checked as they depend on the machine,
+/// run with --gtest_also_run_disabled_tests
+TEST_F(FfmpegTranscodeTest, DISABLED_BenchmarkAgainstExternalProcess)
+{
+    writeWav(30);
+    char buf[65536];
+
+    struct rusage before;
+    struct rusage after;
+    getrusage(RUSAGE_THREAD, &before);
+    auto start = std::chrono::steady_clock::now();
+    FfmpegTranscodeIOHandler handler(makeProfile("s16be", "pcm_s16be", 22050, 1), wavPath);
+    handler.open(UPNP_READ);
+    std::size_t internalSize = handler.read(buf, sizeof(buf));
+    auto internalLatency = std::chrono::steady_clock::now() - start;
+    internalSize += readAll(handler).size();
+    getrusage(RUSAGE_THREAD, &after);
+    auto internalCpu = cpuSeconds(after) - cpuSeconds(before);
+    std::cout << fmt::format("internal: first data after {} us, {:.3f} s cpu for {} bytes\n",
+        std::chrono::duration_cast<std::chrono::microseconds>(internalLatency).count(), internalCpu, internalSize);
+    EXPECT_GT(internalSize, 0);
+
+    auto ffmpeg = findInPath("ffmpeg");
+    if (ffmpeg.empty()) {
+        std::cout << "ffmpeg not found in $PATH, no external comparison\n";
+        return;
+    }
+
+    // same setup as the external handler: the transcoder writes to a pipe
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+    std::vector<std::string> args { ffmpeg.string(), "-loglevel", "quiet", "-i", wavPath.string(), "-f", "s16be", "-acodec", "pcm_s16be", "-ar", "22050", "-ac", "1", "/dev/stdout" };
+    std::vector<char*> argv;
+    for (auto&& arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    getrusage(RUSAGE_CHILDREN, &before);
+    start = std::chrono::steady_clock::now();
+    pid_t pid;
+    ASSERT_EQ(posix_spawn(&pid, ffmpeg.c_str(), &actions, nullptr, argv.data(), environ), 0);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+
+    std::size_t externalSize = 0;
+    ssize_t len = ::read(fds[0], buf, sizeof(buf));
+    auto externalLatency = std::chrono::steady_clock::now() - start;
+    while (len > 0) {
+        externalSize += len;
+        len = ::read(fds[0], buf, sizeof(buf));
+    }
+    ::close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    getrusage(RUSAGE_CHILDREN, &after);
+    auto externalCpu = cpuSeconds(after) - cpuSeconds(before);
+    std::cout << fmt::format("external: first data after {} us, {:.3f} s cpu for {} bytes\n",
+        std::chrono::duration_cast<std::chrono::microseconds>(externalLatency).count(), externalCpu, externalSize);
+    EXPECT_GT(externalSize, 0);
+}
+#endif // HAVE_SWRESAMPLE
+
+#endif // HAVE_FFMPEG
@@ -0,0 +1,212 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_file_request_context.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "file_request_handler.h"
+#include "iohandler/mem_io_handler.h"
+
+#include <atomic>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "cds_objects.h"
+#include "config/client_config.h"
+#include "content/content_manager.h"
+#include "server.h"
+#include "util/timer.h"
+#include "util/upnp_clients.h"
+#include "web/session_manager.h"
+
+#include "../helper/temp_dir_test.h"
+#include "../mock/config_mock.h"
+#include "../mock/database_mock.h"
+
+class FileRequestContextTest : public ::testing::Test {
+public:
+    static std::string readAll(const std::unique_ptr<IOHandler>& handler)
+    {
+        std::string result;
+        char buf[7];
+        std::size_t len;
+        while ((len = handler->read(buf, sizeof(buf))) > 0)
+            result.append(buf, len);
+        return result;
+    }
+};
+
+TEST_F(FileRequestContextTest, ContentIsCreatedOnce)
+{
+    int created = 0;
+    auto request = FileRequestContext();
+    request.setContentFactory([&created]() {
+        created++;
+        return std::make_unique<MemIOHandler>(std::string("thumbnail data"));
+    });
+    EXPECT_EQ(created, 0);
+
+    EXPECT_EQ(request.getContentLength(), 14);
+    EXPECT_EQ(request.getContentLength(), 14);
+
+    auto handler = request.openContent();
+    EXPECT_EQ(created, 1);
+    EXPECT_EQ(readAll(handler), "thumbnail data");
+    handler->close();
+}
+
+TEST_F(FileRequestContextTest, ContentIsCreatedOnOpen)
+{
+    int created = 0;
+    auto request = FileRequestContext();
+    request.setContentFactory([&created]() {
+        created++;
+        return std::make_unique<MemIOHandler>(std::string("transcoded"));
+    });
+    EXPECT_EQ(created, 0);
+
+    auto handler = request.openContent();
+    EXPECT_EQ(created, 1);
+    EXPECT_EQ(readAll(handler), "transcoded");
+    handler->close();
+}
+
+TEST_F(FileRequestContextTest, MissingContentThrows)
+{
+    auto request = FileRequestContext();
+    EXPECT_THROW(request.openContent(), std::runtime_error);
+
+    request.setContentFactory([]() { return std::unique_ptr<IOHandler>(); });
+    EXPECT_THROW(request.getContentLength(), std::runtime_error);
+}
+
+class RequestDatabase : public DatabaseMock {
+public:
+    using DatabaseMock::DatabaseMock;
+
+    std::shared_ptr<CdsObject> loadObject(int objectID) override { return items.at(objectID); }
+
+    std::map<int, std::shared_ptr<CdsObject>> items;
+};
+
+class RequestConfigMock : public ConfigMock {
+public:
+    std::shared_ptr<ClientConfigList> getClientConfigListOption(config_option_t option) const override { return clients; }
+
+    std::shared_ptr<ClientConfigList> clients { std::make_shared<ClientConfigList>() };
+};
+
+class FileRequestHandlerTest : public TempDirTest {
+public:
+    void SetUp() override
+    {
+        TempDirTest::SetUp();
+        config = std::make_shared<::testing::NiceMock<RequestConfigMock>>();
+        database = std::make_shared<RequestDatabase>(config);
+        timer = std::make_shared<Timer>(config);
+        timer->run();
+        sessionManager = std::make_shared<Web::SessionManager>(config, timer);
+
+        auto server = std::make_shared<Server>(config);
+        auto clients = std::make_shared<Clients>(config);
+        auto context = std::make_shared<Context>(config, clients, nullptr, database, server, sessionManager);
+        content = std::make_shared<ContentManager>(context, server, timer);
+        xmlBuilder = std::make_shared<UpnpXMLBuilder>(context, "", "http://someurl/");
+    }
+
+    void TearDown() override
+    {
+        sessionManager->shutdown();
+        timer->shutdown();
+        TempDirTest::TearDown();
+    }
+
+    /// \brief add an item backed by a file with the given content
+    void addItem(int id, const std::string& payload)
+    {
+        auto path = dir / fmt::format("item{}.txt", id);
+        std::ofstream(path, std::ios::binary) << payload;
+
+        auto item = std::make_shared<CdsItem>();
+        item->setID(id);
+        item->setTitle(fmt::format("Item {}", id));
+        item->setMimeType("text/plain");
+        item->setLocation(path);
+        auto resource = std::make_shared<CdsResource>(CH_DEFAULT);
+        resource->addAttribute(R_PROTOCOLINFO, renderProtocolInfo("text/plain"));
+        item->addResource(resource);
+        database->items[id] = item;
+    }
+
+    std::shared_ptr<RequestConfigMock> config;
+    std::shared_ptr<RequestDatabase> database;
+    std::shared_ptr<Timer> timer;
+    std::shared_ptr<Web::SessionManager> sessionManager;
+    std::shared_ptr<ContentManager> content;
+    std::shared_ptr<UpnpXMLBuilder> xmlBuilder;
+};
+
+TEST_F(FileRequestHandlerTest, ConcurrentRequestsAreIndependent)
+{
+    constexpr int itemCount = 5;
+    constexpr int threadCount = 8;
+    constexpr int requestCount = 50;
+    std::map<int, std::string> payloads;
+    for (int id = 1; id <= itemCount; id++) {
+        // every item has a different length
+        payloads[id] = fmt::format("{:x>{}}", fmt::format("payload of item {}", id), 20 * id);
+        addItem(id, payloads[id]);
+    }
+
+    std::atomic<int> failures = 0;
+    auto threads = std::vector<std::thread>();
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([this, t, &payloads, &failures]() {
+            for (int r = 0; r < requestCount; r++) {
+                int id = 1 + (t + r) % itemCount;
+                auto&& payload = payloads.at(id);
+                auto filename = fmt::format("{}object_id/{}/{}/0", LINK_FILE_REQUEST_HANDLER, id, URL_RESOURCE_ID);
+
+                // the server creates a handler for every request
+                auto handler = std::make_unique<FileRequestHandler>(content, xmlBuilder);
+#if defined(USING_NPUPNP)
+                auto info = std::make_unique<UpnpFileInfo>();
+                handler->getInfo(filename.c_str(), info.get());
+                if (info->file_length != off_t(payload.size()))
+                    failures++;
+#else
+                auto info = std::unique_ptr<UpnpFileInfo, decltype(&UpnpFileInfo_delete)>(UpnpFileInfo_new(), UpnpFileInfo_delete);
+                handler->getInfo(filename.c_str(), info.get());
+                if (UpnpFileInfo_get_FileLength(info.get()) != off_t(payload.size()))
+                    failures++;
+#endif
+
+                auto ioHandler = handler->open(filename.c_str(), UPNP_READ);
+                if (FileRequestContextTest::readAll(ioHandler) != payload)
+                    failures++;
+                ioHandler->close();
+            }
+        });
+    }
+    for (auto&& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(failures, 0);
+}
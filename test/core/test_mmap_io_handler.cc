@@ -0,0 +1,115 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_mmap_io_handler.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "iohandler/mmap_io_handler.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "../helper/temp_dir_test.h"
+
+class MmapIOHandlerTest : public TempDirTest {
+public:
+    fs::path writeFile(const std::string& name, const std::string& content)
+    {
+        auto path = dir / name;
+        std::ofstream out(path, std::ios::binary);
+        out << content;
+        return path;
+    }
+
+    static struct stat getStat(const fs::path& path)
+    {
+        struct stat statbuf;
+        stat(path.c_str(), &statbuf);
+        return statbuf;
+    }
+};
+
+TEST_F(MmapIOHandlerTest, ReadAndSeek)
+{
+    auto path = writeFile("cover.jpg", "0123456789");
+    auto cache = MappedFileCache(1024, 4096);
+    auto file = cache.get(path, getStat(path));
+    ASSERT_NE(file, nullptr);
+
+    auto handler = MmapIOHandler(file);
+    handler.open(UPNP_READ);
+    handler.seek(0, SEEK_END);
+    EXPECT_EQ(handler.tell(), 10);
+    handler.close();
+
+    char buf[8];
+    handler.open(UPNP_READ);
+    handler.seek(6, SEEK_SET);
+    EXPECT_EQ(handler.read(buf, sizeof(buf)), 4U);
+    EXPECT_EQ(std::string(buf, 4), "6789");
+    EXPECT_EQ(handler.read(buf, sizeof(buf)), 0U);
+    EXPECT_THROW(handler.seek(1, SEEK_END), std::runtime_error);
+    EXPECT_THROW(handler.seek(-11, SEEK_END), std::runtime_error);
+    handler.close();
+}
+
+TEST_F(MmapIOHandlerTest, CacheReusesMapping)
+{
+    auto path = writeFile("cover.jpg", "0123456789");
+    auto cache = MappedFileCache(1024, 4096);
+    auto statbuf = getStat(path);
+
+    auto first = cache.get(path, statbuf);
+    auto second = cache.get(path, statbuf);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(cache.getEntryCount(), 1U);
+
+    // a new modification time replaces the mapping
+    statbuf.st_mtime++;
+    auto third = cache.get(path, statbuf);
+    EXPECT_NE(first, third);
+    EXPECT_EQ(cache.getEntryCount(), 1U);
+    EXPECT_EQ(cache.getCacheSize(), 10U);
+}
+
+TEST_F(MmapIOHandlerTest, CacheIsBounded)
+{
+    auto cache = MappedFileCache(100, 250);
+    auto a = writeFile("a.jpg", std::string(100, 'a'));
+    auto b = writeFile("b.jpg", std::string(100, 'b'));
+    auto c = writeFile("c.jpg", std::string(100, 'c'));
+    auto big = writeFile("big.jpg", std::string(101, 'x'));
+    auto empty = writeFile("empty.srt", "");
+
+    EXPECT_EQ(cache.get(big, getStat(big)), nullptr);
+    EXPECT_EQ(cache.get(empty, getStat(empty)), nullptr);
+
+    auto mappedA = cache.get(a, getStat(a));
+    cache.get(b, getStat(b));
+    // a is now more recently used than b
+    EXPECT_EQ(cache.get(a, getStat(a)), mappedA);
+    cache.get(c, getStat(c));
+
+    EXPECT_EQ(cache.getEntryCount(), 2U);
+    EXPECT_EQ(cache.getCacheSize(), 200U);
+    EXPECT_EQ(cache.get(a, getStat(a)), mappedA);
+
+    // evicted mappings stay valid while in use
+    EXPECT_EQ(std::string(mappedA->data(), mappedA->size()), std::string(100, 'a'));
+}
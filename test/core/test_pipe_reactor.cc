@@ -0,0 +1,136 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_pipe_reactor.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#ifdef HAVE_EPOLL
+
+#include "iohandler/pipe_reactor.h"
+#include "util/process_executor.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../mock/config_mock.h"
+
+using namespace std::chrono_literals;
+
+static std::size_t countThreads()
+{
+    std::size_t count = 0;
+    auto dir = opendir("/proc/self/task");
+    while (auto entry = readdir(dir)) {
+        if (entry->d_name[0] != '.')
+            count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+class PipeReactorTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        reactor = std::make_unique<PipeReactor>(std::make_shared<ConfigMock>());
+    }
+
+    static std::string readAll(PipeStream& stream, std::size_t chunk)
+    {
+        std::string result;
+        std::vector<char> buf(chunk);
+        std::size_t ret;
+        while ((ret = stream.read(buf.data(), buf.size(), 0, 5s)) > 0 && ret != std::size_t(-1) && ret != std::size_t(CHECK_SOCKET))
+            result.append(buf.data(), ret);
+        return result;
+    }
+
+    std::unique_ptr<PipeReactor> reactor;
+};
+
+TEST_F(PipeReactorTest, SlowReaderPausesWriter)
+{
+    int fds[2];
+    ASSERT_EQ(pipe2(fds, O_CLOEXEC), 0);
+    auto stream = reactor->addStream(fds[0], 1000, 300);
+
+    std::string data(500000, '\0');
+    for (std::size_t i = 0; i < data.size(); i++)
+        data[i] = char(i % 251);
+    auto writer = std::thread([&]() {
+        std::size_t written = 0;
+        while (written < data.size()) {
+            auto ret = ::write(fds[1], data.data() + written, data.size() - written);
+            if (ret <= 0)
+                break;
+            written += ret;
+        }
+        ::close(fds[1]);
+    });
+
+    EXPECT_EQ(readAll(*stream, 777), data);
+    writer.join();
+}
+
+TEST_F(PipeReactorTest, ReadTimesOutWithoutData)
+{
+    int fds[2];
+    ASSERT_EQ(pipe2(fds, O_CLOEXEC), 0);
+    auto stream = reactor->addStream(fds[0], 1000, 1000);
+
+    char buf[10];
+    EXPECT_EQ(stream->read(buf, sizeof(buf), 0, 50ms), std::size_t(CHECK_SOCKET));
+
+    ASSERT_EQ(::write(fds[1], "abc", 3), 3);
+    // the initial fill size is not reached before the pipe is closed
+    EXPECT_EQ(stream->read(buf, sizeof(buf), 5, 50ms), std::size_t(CHECK_SOCKET));
+    ::close(fds[1]);
+    EXPECT_EQ(stream->read(buf, sizeof(buf), 5, 1s), 3);
+    EXPECT_EQ(stream->read(buf, sizeof(buf), 0, 1s), 0);
+}
+
+TEST_F(PipeReactorTest, ReadsProcessesWithOneThread)
+{
+    auto threads = countThreads();
+
+    std::vector<std::shared_ptr<ProcessExecutor>> procs;
+    std::vector<std::shared_ptr<PipeStream>> streams;
+    for (int i = 0; i < 16; i++) {
+        int fds[2];
+        ASSERT_EQ(pipe2(fds, O_CLOEXEC), 0);
+        procs.push_back(std::make_shared<ProcessExecutor>("seq", std::vector<std::string> { "1", fmt::to_string(10000 + i) }, std::map<std::string, std::string>(), std::vector<fs::path>(), fds[1]));
+        ::close(fds[1]);
+        streams.push_back(reactor->addStream(fds[0], 4096, 1024));
+    }
+    EXPECT_EQ(reactor->getStreamCount(), 16);
+    EXPECT_EQ(countThreads(), threads);
+
+    for (int i = 0; i < 16; i++) {
+        auto output = readAll(*streams[i], 3000);
+        EXPECT_EQ(output.substr(output.size() - 6), fmt::format("{}\n", 10000 + i));
+    }
+
+    streams.clear();
+    EXPECT_EQ(reactor->getStreamCount(), 0);
+}
+
+#endif
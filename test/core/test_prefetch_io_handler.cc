@@ -0,0 +1,131 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_prefetch_io_handler.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "iohandler/prefetch_io_handler.h"
+#include "util/metrics.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "../helper/temp_dir_test.h"
+#include "../mock/config_mock.h"
+
+class PrefetchIOHandlerTest : public TempDirTest {
+public:
+    void SetUp() override
+    {
+        TempDirTest::SetUp();
+        config = std::make_shared<ConfigMock>();
+        path = dir / "prefetch.bin";
+        data.resize(200000);
+        for (std::size_t i = 0; i < data.size(); i++)
+            data[i] = char(i % 251);
+        std::ofstream out(path, std::ios::binary);
+        out.write(data.data(), data.size());
+    }
+
+    std::string readAll(IOHandler& handler, std::size_t chunk)
+    {
+        std::string result;
+        std::vector<char> buf(chunk);
+        std::size_t ret;
+        while ((ret = handler.read(buf.data(), buf.size())) > 0 && ret != std::size_t(-1))
+            result.append(buf.data(), ret);
+        return result;
+    }
+
+    std::shared_ptr<ConfigMock> config;
+    fs::path path;
+    std::string data;
+};
+
+TEST_F(PrefetchIOHandlerTest, ReadsWholeFile)
+{
+    auto handler = PrefetchIOHandler(config, path, 16384, 4096, 0);
+    handler.open(UPNP_READ);
+    EXPECT_EQ(readAll(handler, 3000), data);
+    EXPECT_EQ(handler.tell(), off_t(data.size()));
+    handler.close();
+}
+
+TEST_F(PrefetchIOHandlerTest, SeekRestartsPrefetch)
+{
+    auto handler = PrefetchIOHandler(config, path, 16384, 4096, 1024);
+    handler.open(UPNP_READ);
+
+    std::vector<char> buf(100);
+    ASSERT_EQ(handler.read(buf.data(), buf.size()), buf.size());
+
+    // far outside of the prefetch window
+    handler.seek(150000, SEEK_SET);
+    EXPECT_EQ(handler.tell(), 150000);
+    EXPECT_EQ(readAll(handler, 5000), data.substr(150000));
+
+    // back to the start after hitting the end of the file
+    handler.seek(0, SEEK_SET);
+    ASSERT_EQ(handler.read(buf.data(), buf.size()), buf.size());
+    EXPECT_EQ(std::string(buf.data(), buf.size()), data.substr(0, 100));
+
+    handler.seek(-10, SEEK_END);
+    EXPECT_EQ(readAll(handler, 100), data.substr(data.size() - 10));
+    handler.close();
+
+    auto stats = handler.getStatistics();
+    EXPECT_EQ(stats.seeks, 3U);
+}
+
+TEST_F(PrefetchIOHandlerTest, SeekInsideWindow)
+{
+    auto&& seekMetric = Metrics::getInstance()->counter("gerbera_prefetch_seeks_total", "");
+    auto&& bufferedSeekMetric = Metrics::getInstance()->counter("gerbera_prefetch_buffered_seeks_total", "");
+    auto seeksBefore = seekMetric.get();
+    auto bufferedSeeksBefore = bufferedSeekMetric.get();
+
+    auto handler = PrefetchIOHandler(config, path, 65536, 4096, 65536);
+    handler.open(UPNP_READ);
+
+    std::vector<char> buf(100);
+    ASSERT_EQ(handler.read(buf.data(), buf.size()), buf.size());
+
+    // the initial fill guarantees that this part is buffered already
+    handler.seek(1000, SEEK_CUR);
+    ASSERT_EQ(handler.read(buf.data(), buf.size()), buf.size());
+    EXPECT_EQ(std::string(buf.data(), buf.size()), data.substr(1100, 100));
+    handler.close();
+
+    auto stats = handler.getStatistics();
+    EXPECT_EQ(stats.seeks, 1U);
+    EXPECT_EQ(stats.bufferedSeeks, 1U);
+
+    // closing adds the counters to the metrics
+    EXPECT_EQ(seekMetric.get() - seeksBefore, 1U);
+    EXPECT_EQ(bufferedSeekMetric.get() - bufferedSeeksBefore, 1U);
+}
+
+TEST_F(PrefetchIOHandlerTest, InvalidSeekThrows)
+{
+    auto handler = PrefetchIOHandler(config, path, 16384, 4096, 0);
+    handler.open(UPNP_READ);
+    EXPECT_THROW(handler.seek(data.size() + 1, SEEK_SET), std::runtime_error);
+    EXPECT_THROW(handler.seek(-1, SEEK_SET), std::runtime_error);
+    handler.close();
+}
@@ -0,0 +1,205 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_session_manager.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "web/session_manager.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "../mock/config_mock.h"
+
+using namespace std::chrono_literals;
+
+class TestSessionManager : public Web::SessionManager {
+public:
+    using Web::SessionManager::SessionManager;
+    using Web::SessionManager::expireSessions;
+};
+
+class SessionManagerTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        config = std::make_shared<ConfigMock>();
+        timer = std::make_shared<Timer>(config);
+        timer->run();
+        sessionManager = std::make_shared<TestSessionManager>(config, timer);
+        sessionManager->createSession(60s)->logIn();
+    }
+
+    void TearDown() override
+    {
+        sessionManager->shutdown();
+        timer->shutdown();
+    }
+
+    static std::vector<std::string> sortedIDs(const std::string& ids)
+    {
+        auto result = splitString(ids, ',');
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::shared_ptr<ConfigMock> config;
+    std::shared_ptr<Timer> timer;
+    std::shared_ptr<TestSessionManager> sessionManager;
+};
+
+TEST_F(SessionManagerTest, FindsSessions)
+{
+    std::vector<std::shared_ptr<Web::Session>> sessions;
+    for (int i = 0; i < 200; i++)
+        sessions.push_back(sessionManager->createSession(60s));
+
+    for (auto&& session : sessions)
+        EXPECT_EQ(sessionManager->getSession(session->getID()), session);
+    EXPECT_FALSE(sessionManager->getSession("unknown"));
+
+    sessionManager->removeSession(sessions.front()->getID());
+    EXPECT_FALSE(sessionManager->getSession(sessions.front()->getID()));
+    EXPECT_EQ(sessionManager->getSession(sessions.back()->getID()), sessions.back());
+}
+
+TEST_F(SessionManagerTest, ExpiresSessions)
+{
+    auto now = currentTime();
+    auto shortSession = sessionManager->createSession(60s);
+    auto longSession = sessionManager->createSession(2h);
+
+    sessionManager->expireSessions(now + 1min);
+    EXPECT_TRUE(sessionManager->getSession(shortSession->getID()));
+
+    sessionManager->expireSessions(now + 15min);
+    EXPECT_FALSE(sessionManager->getSession(shortSession->getID()));
+    EXPECT_TRUE(sessionManager->getSession(longSession->getID()));
+
+    sessionManager->expireSessions(now + 3h);
+    EXPECT_FALSE(sessionManager->getSession(longSession->getID()));
+}
+
+TEST_F(SessionManagerTest, RechecksSessionsNotIdleYet)
+{
+    auto now = currentTime();
+    auto session = sessionManager->createSession(10min);
+
+    // the slot of the expiry comes up before the session is idle long enough
+    std::chrono::seconds slotStart = (now + 10min) / SESSION_TIMEOUT_CHECK_INTERVAL * SESSION_TIMEOUT_CHECK_INTERVAL;
+    sessionManager->expireSessions(slotStart);
+    EXPECT_TRUE(sessionManager->getSession(session->getID()));
+
+    sessionManager->expireSessions(slotStart + SESSION_TIMEOUT_CHECK_INTERVAL);
+    EXPECT_FALSE(sessionManager->getSession(session->getID()));
+}
+
+TEST_F(SessionManagerTest, BoundsSessionUpdateIDs)
+{
+    auto session = sessionManager->createSession(60s);
+    auto loggedOut = sessionManager->createSession(60s);
+    session->logIn();
+
+    sessionManager->containerChangedUI(std::vector<int> { 3, 4 });
+    EXPECT_TRUE(session->hasUIUpdateIDs());
+    EXPECT_FALSE(loggedOut->hasUIUpdateIDs());
+    EXPECT_EQ(sortedIDs(session->getUIUpdateIDs()), std::vector<std::string>({ "3", "4" }));
+    EXPECT_FALSE(session->hasUIUpdateIDs());
+
+    for (int id = 0; id < 100; id++)
+        sessionManager->containerChangedUI(id);
+    EXPECT_EQ(session->getUIUpdateIDs(), "all");
+}
+
+TEST_F(SessionManagerTest, SubscribersGetChanges)
+{
+    auto first = sessionManager->subscribe();
+    auto second = sessionManager->subscribe();
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+
+    sessionManager->containerChangedUI(std::vector<int> { 3, 4 });
+    sessionManager->containerChangedUI(5);
+    sessionManager->containerChangedUI(INVALID_OBJECT_ID);
+
+    EXPECT_TRUE(first->wait(1s, 0ms));
+    EXPECT_EQ(sortedIDs(first->takeUpdateIDs()), std::vector<std::string>({ "3", "4", "5" }));
+    EXPECT_EQ(first->takeUpdateIDs(), "");
+    // every connection has its own copy
+    EXPECT_EQ(sortedIDs(second->takeUpdateIDs()), std::vector<std::string>({ "3", "4", "5" }));
+    EXPECT_FALSE(first->takeTaskChanged());
+}
+
+TEST_F(SessionManagerTest, CollapsesManyChanges)
+{
+    auto subscriber = sessionManager->subscribe();
+    for (int id = 0; id < 20; id++)
+        sessionManager->containerChangedUI(id);
+    EXPECT_EQ(subscriber->takeUpdateIDs(), "all");
+}
+
+TEST_F(SessionManagerTest, ReportsTaskChanges)
+{
+    auto subscriber = sessionManager->subscribe();
+    EXPECT_FALSE(subscriber->wait(10ms, 0ms));
+
+    sessionManager->taskChanged();
+    EXPECT_TRUE(subscriber->wait(10ms, 0ms));
+    EXPECT_TRUE(subscriber->takeTaskChanged());
+    EXPECT_FALSE(subscriber->takeTaskChanged());
+}
+
+TEST_F(SessionManagerTest, BatchesChanges)
+{
+    auto subscriber = sessionManager->subscribe();
+    auto changer = std::thread([this]() {
+        sessionManager->containerChangedUI(1);
+        std::this_thread::sleep_for(20ms);
+        sessionManager->containerChangedUI(2);
+    });
+
+    EXPECT_TRUE(subscriber->wait(1s, 200ms));
+    changer.join();
+    EXPECT_EQ(sortedIDs(subscriber->takeUpdateIDs()), std::vector<std::string>({ "1", "2" }));
+}
+
+TEST_F(SessionManagerTest, LimitsSubscribers)
+{
+    std::vector<std::shared_ptr<Web::UpdateSubscriber>> subscribers;
+    while (auto subscriber = sessionManager->subscribe())
+        subscribers.push_back(subscriber);
+    EXPECT_EQ(subscribers.size(), 4);
+
+    sessionManager->unsubscribe(subscribers.back());
+    EXPECT_TRUE(sessionManager->subscribe());
+}
+
+TEST_F(SessionManagerTest, ShutdownReleasesSubscribers)
+{
+    auto subscriber = sessionManager->subscribe();
+    auto waiter = std::thread([&subscriber]() { EXPECT_FALSE(subscriber->wait(10s, 0ms)); });
+
+    std::this_thread::sleep_for(10ms);
+    auto start = std::chrono::steady_clock::now();
+    sessionManager->shutdown();
+    waiter.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+    EXPECT_TRUE(subscriber->isClosed());
+    EXPECT_FALSE(sessionManager->subscribe());
+}
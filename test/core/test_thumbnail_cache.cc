@@ -0,0 +1,206 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_thumbnail_cache.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "metadata/thumbnail_cache.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "util/tools.h"
+
+#include "../helper/temp_dir_test.h"
+
+using namespace std::chrono_literals;
+
+class ThumbnailCacheTest : public TempDirTest {
+public:
+    void SetUp() override
+    {
+        TempDirTest::SetUp();
+        fs::create_directories(dir / "media");
+    }
+
+    fs::path writeMovie(const std::string& name)
+    {
+        auto path = dir / "media" / name;
+        std::ofstream out(path, std::ios::binary);
+        out << name;
+        return path;
+    }
+
+    static void store(ThumbnailCache& cache, const fs::path& movie, std::size_t size)
+    {
+        auto data = std::vector<std::byte>(size, std::byte('x'));
+        cache.store(movie, data.data(), data.size());
+    }
+};
+
+TEST_F(ThumbnailCacheTest, StoresInShardDirectories)
+{
+    auto movie = writeMovie("a.mkv");
+    auto cache = ThumbnailCache(dir / "cache", 0);
+    EXPECT_FALSE(cache.lookup(movie));
+
+    store(cache, movie, 100);
+    auto path = cache.lookup(movie);
+    ASSERT_TRUE(path);
+    auto hash = hexStringMd5(movie.string());
+    EXPECT_EQ(*path, dir / "cache" / "thumbs" / hash.substr(0, 2) / (hash + ".jpg"));
+    EXPECT_EQ(fs::file_size(*path), 100);
+    EXPECT_TRUE(cache.contains(movie));
+    EXPECT_EQ(cache.getCacheSize(), 100);
+
+    // replacing keeps a single entry
+    store(cache, movie, 50);
+    EXPECT_EQ(cache.getCacheSize(), 50);
+    EXPECT_EQ(cache.getEntryCount(), 1);
+    EXPECT_EQ(fs::file_size(*path), 50);
+}
+
+TEST_F(ThumbnailCacheTest, IgnoresModifiedMovie)
+{
+    auto movie = writeMovie("a.mkv");
+    auto cache = ThumbnailCache(dir / "cache", 0);
+    store(cache, movie, 100);
+    auto path = cache.getThumbnailPath(hexStringMd5(movie.string()));
+
+    fs::last_write_time(movie, fs::last_write_time(movie) + 1h);
+    EXPECT_FALSE(cache.contains(movie));
+    EXPECT_FALSE(cache.lookup(movie));
+    EXPECT_EQ(cache.getEntryCount(), 0);
+    EXPECT_EQ(cache.getCacheSize(), 0);
+    EXPECT_FALSE(fs::exists(path));
+}
+
+TEST_F(ThumbnailCacheTest, EvictsLeastRecentlyUsed)
+{
+    auto a = writeMovie("a.mkv");
+    auto b = writeMovie("b.mkv");
+    auto c = writeMovie("c.mkv");
+    auto cache = ThumbnailCache(dir / "cache", 250);
+
+    store(cache, a, 100);
+    store(cache, b, 100);
+    EXPECT_TRUE(cache.lookup(a));
+    store(cache, c, 100);
+
+    EXPECT_TRUE(cache.contains(a));
+    EXPECT_FALSE(cache.contains(b));
+    EXPECT_TRUE(cache.contains(c));
+    EXPECT_EQ(cache.getCacheSize(), 200);
+    EXPECT_FALSE(fs::exists(cache.getThumbnailPath(hexStringMd5(b.string()))));
+
+    // a thumbnail larger than the limit is still kept
+    store(cache, b, 300);
+    EXPECT_TRUE(cache.contains(b));
+    EXPECT_EQ(cache.getEntryCount(), 1);
+}
+
+TEST_F(ThumbnailCacheTest, PersistsIndex)
+{
+    auto a = writeMovie("a movie with spaces.mkv");
+    auto b = writeMovie("b.mkv");
+    auto c = writeMovie("c.mkv");
+    {
+        auto cache = ThumbnailCache(dir / "cache", 0);
+        store(cache, a, 100);
+        store(cache, b, 100);
+        EXPECT_TRUE(cache.lookup(a));
+    }
+    EXPECT_TRUE(fs::exists(dir / "cache" / "index"));
+
+    auto cache = ThumbnailCache(dir / "cache", 250);
+    EXPECT_EQ(cache.getEntryCount(), 2);
+    EXPECT_EQ(cache.getCacheSize(), 200);
+    EXPECT_TRUE(cache.lookup(a));
+
+    store(cache, c, 100);
+    EXPECT_TRUE(cache.contains(a));
+    EXPECT_FALSE(cache.contains(b));
+}
+
+TEST_F(ThumbnailCacheTest, ShutdownWritesIndex)
+{
+    auto a = writeMovie("a.mkv");
+    auto cache = ThumbnailCache(dir / "cache", 0);
+    store(cache, a, 100);
+    cache.shutdown();
+    EXPECT_TRUE(fs::exists(dir / "cache" / "index"));
+
+    auto loaded = ThumbnailCache(dir / "cache", 0);
+    EXPECT_TRUE(loaded.contains(a));
+}
+
+TEST_F(ThumbnailCacheTest, AppliesSmallerLimitOnLoad)
+{
+    auto a = writeMovie("a.mkv");
+    auto b = writeMovie("b.mkv");
+    {
+        auto cache = ThumbnailCache(dir / "cache", 0);
+        store(cache, a, 100);
+        store(cache, b, 100);
+    }
+
+    auto cache = ThumbnailCache(dir / "cache", 150);
+    EXPECT_EQ(cache.getEntryCount(), 1);
+    EXPECT_TRUE(cache.contains(b));
+}
+
+TEST_F(ThumbnailCacheTest, RemovesOrphans)
+{
+    auto a = writeMovie("a.mkv");
+    auto b = writeMovie("b.mkv");
+    auto cache = ThumbnailCache(dir / "cache", 0);
+    store(cache, a, 100);
+    store(cache, b, 100);
+
+    auto stray = cache.getThumbnailPath(hexStringMd5("/gone.mkv"));
+    auto fresh = cache.getThumbnailPath(hexStringMd5("/storing.mkv"));
+    fs::create_directories(stray.parent_path());
+    fs::create_directories(fresh.parent_path());
+    std::ofstream(stray) << "x";
+    std::ofstream(fresh) << "x";
+    fs::last_write_time(stray, fs::file_time_type::clock::now() - 1h);
+
+    auto bThumb = cache.getThumbnailPath(hexStringMd5(b.string()));
+    fs::remove(b);
+    EXPECT_EQ(cache.removeOrphans(), 2);
+
+    EXPECT_TRUE(cache.contains(a));
+    EXPECT_EQ(cache.getEntryCount(), 1);
+    EXPECT_EQ(cache.getCacheSize(), 100);
+    EXPECT_FALSE(fs::exists(bThumb));
+    EXPECT_FALSE(fs::exists(stray));
+    // may be renamed to its final name right now
+    EXPECT_TRUE(fs::exists(fresh));
+}
+
+TEST_F(ThumbnailCacheTest, RemovesEntry)
+{
+    auto a = writeMovie("a.mkv");
+    auto cache = ThumbnailCache(dir / "cache", 0);
+    store(cache, a, 100);
+
+    cache.remove(a);
+    EXPECT_FALSE(cache.lookup(a));
+    EXPECT_EQ(cache.getCacheSize(), 0);
+}
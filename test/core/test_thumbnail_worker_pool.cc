@@ -0,0 +1,194 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_thumbnail_worker_pool.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+#include "metadata/thumbnail_worker_pool.h"
+#include "exceptions.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+/// \brief generator which blocks until the test opens the gate
+class TestGenerator {
+public:
+    std::vector<std::byte> generate(const fs::path& file)
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        order.push_back(file.string());
+        running++;
+        maxRunning = std::max(maxRunning, running);
+        cond.notify_all();
+        cond.wait(lock, [this]() { return open; });
+        running--;
+        if (file == "/fail")
+            throw std::runtime_error("broken file");
+        auto name = file.string();
+        return { reinterpret_cast<const std::byte*>(name.data()), reinterpret_cast<const std::byte*>(name.data() + name.size()) };
+    }
+
+    void waitForRunning(int count)
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        cond.wait(lock, [this, count]() { return running >= count; });
+    }
+
+    void openGate()
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        open = true;
+        cond.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool open {};
+    int running {};
+    int maxRunning {};
+    std::vector<std::string> order;
+};
+
+class ThumbnailWorkerPoolTest : public ::testing::Test {
+public:
+    std::unique_ptr<ThumbnailWorkerPool> makePool(std::size_t workers, std::size_t maxQueued = 100)
+    {
+        return std::make_unique<ThumbnailWorkerPool>(workers, maxQueued, [this](const fs::path& file) { return generator.generate(file); });
+    }
+
+    static std::string toString(const std::vector<std::byte>& data)
+    {
+        return { reinterpret_cast<const char*>(data.data()), data.size() };
+    }
+
+    TestGenerator generator;
+};
+
+TEST_F(ThumbnailWorkerPoolTest, GeneratesOncePerFile)
+{
+    auto pool = makePool(2);
+    std::vector<std::string> results(4);
+    std::vector<std::thread> clients;
+    for (auto&& result : results)
+        clients.emplace_back([&pool, &result]() { result = toString(pool->get("/movie.mkv")); });
+
+    generator.waitForRunning(1);
+    // give the other clients time to find the running job
+    std::this_thread::sleep_for(50ms);
+    generator.openGate();
+    for (auto&& client : clients)
+        client.join();
+
+    for (auto&& result : results)
+        EXPECT_EQ(result, "/movie.mkv");
+    EXPECT_EQ(generator.order.size(), 1U);
+    EXPECT_EQ(pool->getJobCount(), 0U);
+}
+
+TEST_F(ThumbnailWorkerPoolTest, LimitsWorkers)
+{
+    auto pool = makePool(2);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 6; i++)
+        clients.emplace_back([&pool, i]() { pool->get("/movie" + std::to_string(i) + ".mkv"); });
+
+    generator.waitForRunning(2);
+    std::this_thread::sleep_for(50ms);
+    generator.openGate();
+    for (auto&& client : clients)
+        client.join();
+
+    EXPECT_EQ(generator.order.size(), 6U);
+    EXPECT_EQ(generator.maxRunning, 2);
+}
+
+TEST_F(ThumbnailWorkerPoolTest, PrefersRequests)
+{
+    auto pool = makePool(1);
+    EXPECT_TRUE(pool->pregenerate("/a.mkv"));
+    generator.waitForRunning(1);
+    EXPECT_TRUE(pool->pregenerate("/b.mkv"));
+    EXPECT_TRUE(pool->pregenerate("/c.mkv"));
+
+    // the request for a queued pregeneration moves it to the front
+    auto client1 = std::thread([&pool]() { pool->get("/d.mkv"); });
+    auto client2 = std::thread([&pool]() { pool->get("/c.mkv"); });
+    while (pool->getJobCount() < 4)
+        std::this_thread::sleep_for(1ms);
+    std::this_thread::sleep_for(20ms);
+    generator.openGate();
+    client1.join();
+    client2.join();
+    pool->shutdown();
+
+    ASSERT_GE(generator.order.size(), 3U);
+    EXPECT_EQ(generator.order[0], "/a.mkv");
+    EXPECT_NE(generator.order[1], "/b.mkv");
+    EXPECT_NE(generator.order[2], "/b.mkv");
+}
+
+TEST_F(ThumbnailWorkerPoolTest, LimitsQueuedPregenerations)
+{
+    auto pool = makePool(1, 2);
+    EXPECT_TRUE(pool->pregenerate("/a.mkv"));
+    generator.waitForRunning(1);
+    EXPECT_TRUE(pool->pregenerate("/b.mkv"));
+    EXPECT_TRUE(pool->pregenerate("/c.mkv"));
+    EXPECT_FALSE(pool->pregenerate("/d.mkv"));
+    // already queued
+    EXPECT_TRUE(pool->pregenerate("/b.mkv"));
+    generator.openGate();
+}
+
+TEST_F(ThumbnailWorkerPoolTest, ReportsFailure)
+{
+    auto pool = makePool(1);
+    generator.openGate();
+    EXPECT_THROW(pool->get("/fail"), std::runtime_error);
+    EXPECT_EQ(toString(pool->get("/ok.mkv")), "/ok.mkv");
+}
+
+TEST_F(ThumbnailWorkerPoolTest, ShutdownReleasesClients)
+{
+    auto pool = makePool(1);
+    EXPECT_TRUE(pool->pregenerate("/a.mkv"));
+    generator.waitForRunning(1);
+
+    bool released = false;
+    auto client = std::thread([&pool, &released]() {
+        try {
+            pool->get("/b.mkv");
+        } catch (const ServerShutdownException&) {
+            released = true;
+        }
+    });
+    while (pool->getJobCount() < 2)
+        std::this_thread::sleep_for(1ms);
+
+    auto stopper = std::thread([&pool]() { pool->shutdown(); });
+    client.join();
+    EXPECT_TRUE(released);
+    generator.openGate();
+    stopper.join();
+    EXPECT_FALSE(pool->pregenerate("/c.mkv"));
+    EXPECT_THROW(pool->get("/c.mkv"), ServerShutdownException);
+}
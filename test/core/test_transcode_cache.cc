@@ -0,0 +1,276 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_transcode_cache.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "transcoding/transcode_cache.h"
+#include "transcoding/transcoding.h"
+
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "../helper/temp_dir_test.h"
+
+/// \brief produces the output in small chunks like a transcoder does
+class FakeTranscoder : public IOHandler {
+public:
+    FakeTranscoder(std::string output, std::size_t chunkSize, std::chrono::milliseconds delay = {})
+        : output(std::move(output))
+        , chunkSize(chunkSize)
+        , delay(delay)
+    {
+    }
+
+    std::size_t read(char* buf, std::size_t length) override
+    {
+        std::this_thread::sleep_for(delay);
+        auto len = std::min({ length, chunkSize, output.size() - pos });
+        std::memcpy(buf, output.data() + pos, len);
+        pos += len;
+        return len;
+    }
+
+private:
+    std::string output;
+    std::size_t chunkSize;
+    std::chrono::milliseconds delay;
+    std::size_t pos {};
+};
+
+class TranscodeCacheTest : public TempDirTest {
+public:
+    TranscodeCache::TranscoderFactory transcoder(const std::string& output, std::chrono::milliseconds delay = {})
+    {
+        return [this, output, delay]() {
+            started++;
+            return std::make_unique<FakeTranscoder>(output, 7, delay);
+        };
+    }
+
+    static std::string readAll(const std::unique_ptr<IOHandler>& handler)
+    {
+        std::string result;
+        char buf[10];
+        while (true) {
+            auto len = handler->read(buf, sizeof(buf));
+            if (len == std::size_t(CHECK_SOCKET))
+                continue;
+            if (len == 0 || len == std::size_t(-1))
+                break;
+            result.append(buf, len);
+        }
+        return result;
+    }
+
+    static void waitForComplete(const TranscodeCache& cache, const std::string& key)
+    {
+        for (int i = 0; i < 500 && !cache.getCompleteSize(key); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::atomic<int> started {};
+};
+
+TEST_F(TranscodeCacheTest, ConcurrentRequestsShareTranscoder)
+{
+    auto cache = TranscodeCache(dir, 1024);
+    auto output = std::string("transcoded output of a longer movie");
+
+    auto first = cache.serve("movie", transcoder(output, std::chrono::milliseconds(5)));
+    auto second = cache.serve("movie", transcoder(output));
+    first->open(UPNP_READ);
+    second->open(UPNP_READ);
+
+    std::string secondResult;
+    auto thread = std::thread([&]() { secondResult = readAll(second); });
+    EXPECT_EQ(readAll(first), output);
+    thread.join();
+    EXPECT_EQ(secondResult, output);
+    EXPECT_EQ(started, 1);
+
+    first->close();
+    second->close();
+}
+
+TEST_F(TranscodeCacheTest, CompleteOutputSupportsRanges)
+{
+    auto cache = TranscodeCache(dir, 1024);
+    auto output = std::string("0123456789abcdefghij");
+    auto handler = cache.serve("movie", transcoder(output));
+    handler->open(UPNP_READ);
+    EXPECT_THROW(handler->seek(0, SEEK_END), std::runtime_error);
+    readAll(handler);
+    handler->close();
+
+    waitForComplete(cache, "movie");
+    EXPECT_EQ(cache.getCompleteSize("movie"), off_t(output.size()));
+
+    handler = cache.serve("movie", transcoder(output));
+    handler->open(UPNP_READ);
+    handler->seek(-5, SEEK_END);
+    EXPECT_EQ(readAll(handler), "fghij");
+    handler->seek(10, SEEK_SET);
+    EXPECT_EQ(readAll(handler), "abcdefghij");
+    EXPECT_THROW(handler->seek(1, SEEK_END), std::runtime_error);
+    handler->close();
+    EXPECT_EQ(started, 1);
+}
+
+TEST_F(TranscodeCacheTest, LeastRecentlyUsedIsEvicted)
+{
+    auto cache = TranscodeCache(dir, 100);
+    for (auto&& key : { "a", "b", "a", "c" }) {
+        auto handler = cache.serve(key, transcoder(std::string(40, key[0])));
+        handler->open(UPNP_READ);
+        EXPECT_EQ(readAll(handler), std::string(40, key[0]));
+        handler->close();
+        waitForComplete(cache, key);
+    }
+
+    EXPECT_EQ(started, 3);
+    EXPECT_EQ(cache.getEntryCount(), 2U);
+    EXPECT_EQ(cache.getCacheSize(), 80);
+    EXPECT_TRUE(cache.getCompleteSize("a"));
+    EXPECT_FALSE(cache.getCompleteSize("b"));
+    EXPECT_TRUE(cache.getCompleteSize("c"));
+}
+
+TEST_F(TranscodeCacheTest, OversizedOutputFails)
+{
+    auto cache = TranscodeCache(dir, 10);
+    auto handler = cache.serve("movie", transcoder(std::string(40, 'x')));
+    handler->open(UPNP_READ);
+    readAll(handler);
+    handler->close();
+
+    for (int i = 0; i < 500 && cache.getEntryCount() > 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(cache.getEntryCount(), 0U);
+    EXPECT_EQ(cache.getCacheSize(), 0);
+}
+
+TEST_F(TranscodeCacheTest, OutputsAreReusedAfterRestart)
+{
+    {
+        auto cache = TranscodeCache(dir, 1024);
+        auto handler = cache.serve("movie", transcoder("complete output"));
+        handler->open(UPNP_READ);
+        readAll(handler);
+        handler->close();
+        waitForComplete(cache, "movie");
+    }
+    std::ofstream(dir / "interrupted.part") << "partial";
+
+    auto cache = TranscodeCache(dir, 1024);
+    EXPECT_EQ(cache.getCompleteSize("movie"), 15);
+    EXPECT_EQ(cache.getEntryCount(), 1U);
+    EXPECT_FALSE(fs::exists(dir / "interrupted.part"));
+}
+
+TEST_F(TranscodeCacheTest, SlowTranscoderStartDoesNotBlockOtherOutputs)
+{
+    auto cache = TranscodeCache(dir, 1024);
+    std::promise<void> starting;
+    std::promise<void> release;
+    auto slow = std::async(std::launch::async, [&]() {
+        return cache.serve("slow", [&]() {
+            starting.set_value();
+            release.get_future().wait();
+            return transcoder("slow output")();
+        });
+    });
+    starting.get_future().wait();
+
+    auto fast = std::async(std::launch::async, [&]() { return cache.serve("fast", transcoder("fast output")); });
+    ASSERT_EQ(fast.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto fastHandler = fast.get();
+    fastHandler->open(UPNP_READ);
+    EXPECT_EQ(readAll(fastHandler), "fast output");
+    fastHandler->close();
+
+    // a request joining the starting transcoder waits for its output
+    auto joined = cache.serve("slow", transcoder("other output"));
+    release.set_value();
+    auto slowHandler = slow.get();
+    joined->open(UPNP_READ);
+    EXPECT_EQ(readAll(joined), "slow output");
+    joined->close();
+    slowHandler->close();
+    EXPECT_EQ(started, 2);
+}
+
+TEST_F(TranscodeCacheTest, WriterStopsWithoutReaders)
+{
+    auto cache = TranscodeCache(dir, 1024 * 1024);
+    auto handler = cache.serve("movie", transcoder(std::string(70000, 'x'), std::chrono::milliseconds(1)));
+    handler->open(UPNP_READ);
+    char buf[10];
+    handler->read(buf, sizeof(buf));
+    handler->close();
+
+    for (int i = 0; i < 500 && cache.getEntryCount() > 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(cache.getEntryCount(), 0U);
+    EXPECT_EQ(cache.getCacheSize(), 0);
+    EXPECT_FALSE(fs::exists(dir / "movie.part"));
+}
+
+TEST_F(TranscodeCacheTest, PinnedOutputIsNotEvicted)
+{
+    auto cache = TranscodeCache(dir, 100);
+    auto complete = [&](const char* key) {
+        auto handler = cache.serve(key, transcoder(std::string(40, key[0])));
+        handler->open(UPNP_READ);
+        readAll(handler);
+        handler->close();
+        waitForComplete(cache, key);
+    };
+
+    complete("a");
+    EXPECT_EQ(cache.pin("a", std::chrono::milliseconds(200)), 40);
+    EXPECT_FALSE(cache.pin("b"));
+
+    complete("b");
+    complete("c");
+    EXPECT_TRUE(cache.getCompleteSize("a"));
+    EXPECT_FALSE(cache.getCompleteSize("b"));
+
+    // the pin expires without being released
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    complete("d");
+    EXPECT_FALSE(cache.getCompleteSize("a"));
+    EXPECT_TRUE(cache.getCompleteSize("c"));
+}
+
+TEST_F(TranscodeCacheTest, KeyDependsOnProfile)
+{
+    auto profile = std::make_shared<TranscodingProfile>(TR_External, "video");
+    profile->setArguments("-i %in %out");
+    auto key = TranscodeCache::makeKey(profile, "/media/movie.mkv", 100, "");
+    EXPECT_EQ(key, TranscodeCache::makeKey(profile, "/media/movie.mkv", 100, ""));
+    EXPECT_NE(key, TranscodeCache::makeKey(profile, "/media/movie.mkv", 101, ""));
+    EXPECT_NE(key, TranscodeCache::makeKey(profile, "/media/movie.mkv", 100, "10-"));
+
+    profile->setArguments("-i %in -b 1M %out");
+    EXPECT_NE(key, TranscodeCache::makeKey(profile, "/media/movie.mkv", 100, ""));
+}
@@ -0,0 +1,120 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_transcode_scheduler.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+
+#include "transcoding/transcode_scheduler.h"
+#include "exceptions.h"
+
+#include <future>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(TranscodeSchedulerTest, QueuesUntilGlobalSlotIsFree)
+{
+    auto scheduler = std::make_shared<TranscodeScheduler>(2, 5s);
+    auto first = scheduler->admit("mp3", 0, "first");
+    auto second = scheduler->admit("ogg", 0, "second");
+    EXPECT_EQ(scheduler->getActiveCount(), 2);
+
+    auto third = std::async(std::launch::async, [&]() { return scheduler->admit("mp3", 0, "third"); });
+    EXPECT_EQ(third.wait_for(100ms), std::future_status::timeout);
+
+    first.reset();
+    ASSERT_EQ(third.wait_for(2s), std::future_status::ready);
+    auto thirdJob = third.get();
+    EXPECT_NE(thirdJob, nullptr);
+    EXPECT_EQ(scheduler->getActiveCount(), 2);
+}
+
+TEST(TranscodeSchedulerTest, LimitsJobsPerProfile)
+{
+    auto scheduler = std::make_shared<TranscodeScheduler>(0, 0ms);
+    auto first = scheduler->admit("mp3", 1, "first");
+    EXPECT_THROW(scheduler->admit("mp3", 1, "second"), TranscodingRejectedException);
+
+    auto other = scheduler->admit("ogg", 1, "other");
+    EXPECT_EQ(scheduler->getActiveCount("mp3"), 1);
+    EXPECT_EQ(scheduler->getActiveCount("ogg"), 1);
+    EXPECT_EQ(scheduler->getActiveCount(), 2);
+}
+
+TEST(TranscodeSchedulerTest, RejectsAfterQueueTimeout)
+{
+    auto scheduler = std::make_shared<TranscodeScheduler>(1, 200ms);
+    auto first = scheduler->admit("mp3", 0, "first");
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(scheduler->admit("mp3", 0, "second"), TranscodingRejectedException);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 200ms);
+}
+
+TEST(TranscodeSchedulerTest, UnstartedReservationExpires)
+{
+    auto scheduler = std::make_shared<TranscodeScheduler>(1, 2s, 100ms);
+    auto started = scheduler->admit("mp3", 0, "started");
+    started->start();
+    started.reset();
+
+    // reservation of a request whose content is never opened
+    auto leaked = scheduler->admit("mp3", 0, "leaked");
+    auto next = scheduler->admit("mp3", 0, "next");
+    EXPECT_NE(next, nullptr);
+    EXPECT_EQ(scheduler->getActiveCount(), 1);
+
+    next->start();
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(scheduler->getActiveCount(), 1);
+    EXPECT_EQ(scheduler->getJobs().size(), 1);
+
+    // a late start counts again
+    leaked->start();
+    EXPECT_EQ(scheduler->getActiveCount(), 2);
+}
+
+TEST(TranscodeSchedulerTest, ListsActiveJobs)
+{
+    auto scheduler = std::make_shared<TranscodeScheduler>(0, 0ms);
+    auto job = scheduler->admit("mp3", 0, "Transcoding song with mp3");
+
+    auto jobs = scheduler->getJobs();
+    ASSERT_EQ(jobs.size(), 1);
+    EXPECT_EQ(jobs.front()->getDescription(), "Transcoding song with mp3");
+    EXPECT_EQ(jobs.front()->getType(), Transcode);
+    EXPECT_FALSE(jobs.front()->isCancellable());
+
+    jobs.clear();
+    job.reset();
+    EXPECT_TRUE(scheduler->getJobs().empty());
+}
+
+TEST(TranscodeSchedulerTest, ScheduledHandlerHoldsSlot)
+{
+    auto scheduler = std::make_shared<TranscodeScheduler>(1, 0ms);
+    auto job = scheduler->admit("mp3", 0, "job");
+    job->start();
+    auto ioHandler = std::make_unique<ScheduledIOHandler>(std::move(job), std::make_unique<IOHandler>());
+    EXPECT_THROW(scheduler->admit("mp3", 0, "second"), TranscodingRejectedException);
+
+    ioHandler.reset();
+    EXPECT_NE(scheduler->admit("mp3", 0, "second"), nullptr);
+}
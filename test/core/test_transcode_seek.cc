@@ -0,0 +1,178 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_transcode_seek.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+#include "cds_objects.h"
+#include "metadata/metadata_handler.h"
+#include "transcoding/transcode_seek.h"
+#include "transcoding/transcoding.h"
+#include "upnp_common.h"
+
+#include <cstring>
+#include <gtest/gtest.h>
+
+/// \brief delivers its output starting at the byte matching the start time
+class SeekTestTranscoder : public IOHandler {
+public:
+    explicit SeekTestTranscoder(std::string output)
+        : output(std::move(output))
+    {
+    }
+
+    std::size_t read(char* buf, std::size_t length) override
+    {
+        auto len = std::min({ length, std::size_t(7), output.size() - pos });
+        std::memcpy(buf, output.data() + pos, len);
+        pos += len;
+        return len;
+    }
+
+private:
+    std::string output;
+    std::size_t pos {};
+};
+
+class TranscodeSeekTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        for (std::size_t i = 0; i < 1000; i++)
+            output.push_back(char('a' + i % 26));
+    }
+
+    /// \brief output with 10 bytes per second
+    SeekableTranscodeIOHandler::Starter starter()
+    {
+        return [this](double time) {
+            starts.push_back(time);
+            return std::make_unique<SeekTestTranscoder>(output.substr(std::size_t(time * 10)));
+        };
+    }
+
+    static std::string read(IOHandler& handler, std::size_t length = std::string::npos)
+    {
+        std::string result;
+        char buf[16];
+        while (result.size() < length) {
+            auto len = handler.read(buf, std::min(sizeof(buf), length - result.size()));
+            if (len == 0)
+                break;
+            result.append(buf, len);
+        }
+        return result;
+    }
+
+    std::string output;
+    std::vector<double> starts;
+};
+
+TEST_F(TranscodeSeekTest, ParsesNptStart)
+{
+    EXPECT_EQ(parseNptStart("npt=90.5-"), 90.5);
+    EXPECT_EQ(parseNptStart("npt=0:01:30.5-0:02:00"), 90.5);
+    EXPECT_EQ(parseNptStart(" npt=1:00:00-"), 3600);
+    EXPECT_EQ(parseNptStart("npt=-"), std::nullopt);
+    EXPECT_EQ(parseNptStart("npt=now-"), std::nullopt);
+    EXPECT_EQ(parseNptStart("npt=10"), std::nullopt);
+    EXPECT_EQ(parseNptStart("bytes=0-"), std::nullopt);
+    EXPECT_EQ(formatNptTime(90.5), "0:01:30.500");
+}
+
+TEST_F(TranscodeSeekTest, ReadsDurationFromResource)
+{
+    auto item = std::make_shared<CdsItem>();
+    auto resource = std::make_shared<CdsResource>(CH_DEFAULT);
+    resource->addAttribute(R_DURATION, "0:01:40.000");
+    item->addResource(resource);
+    EXPECT_EQ(getItemDuration(item), 100);
+
+    EXPECT_EQ(getItemDuration(std::make_shared<CdsItem>()), 0);
+}
+
+TEST_F(TranscodeSeekTest, OffersTimeSeekOnly)
+{
+    auto profile = std::make_shared<TranscodingProfile>(TR_External, "seek");
+    profile->setArguments("-i %in -f mpegts %out");
+    EXPECT_EQ(getTranscodeSeekFlags(profile), UPNP_DLNA_OP_SEEK_DISABLED);
+
+    profile->setArguments("-ss %start -i %in -f mpegts %out");
+    EXPECT_EQ(getTranscodeSeekFlags(profile), UPNP_DLNA_OP_SEEK_TIME);
+    EXPECT_EQ(getTranscodeSeekFlags(nullptr), UPNP_DLNA_OP_SEEK_DISABLED);
+}
+
+TEST_F(TranscodeSeekTest, StartsAtRequestedTime)
+{
+    TranscodeRestartCache cache(0, std::chrono::seconds(10));
+    SeekableTranscodeIOHandler handler(starter(), "key", TranscodeSeek { 5 }, cache);
+    handler.open(UPNP_READ);
+    EXPECT_EQ(read(handler), output.substr(50));
+    EXPECT_EQ(starts, std::vector<double> { 5 });
+}
+
+TEST_F(TranscodeSeekTest, ByteSeekFails)
+{
+    TranscodeRestartCache cache(0, std::chrono::seconds(10));
+    SeekableTranscodeIOHandler handler(starter(), "key", TranscodeSeek { 0 }, cache);
+    handler.open(UPNP_READ);
+    EXPECT_NO_THROW(handler.seek(0, SEEK_SET));
+    EXPECT_NO_THROW(handler.seek(0, SEEK_CUR));
+    EXPECT_THROW(handler.seek(10, SEEK_SET), std::runtime_error);
+    EXPECT_THROW(handler.seek(-10, SEEK_CUR), std::runtime_error);
+    EXPECT_THROW(handler.seek(0, SEEK_END), std::runtime_error);
+}
+
+TEST_F(TranscodeSeekTest, ReusesParkedTranscoder)
+{
+    TranscodeRestartCache cache(4, std::chrono::seconds(10));
+    {
+        SeekableTranscodeIOHandler probe(starter(), "key", TranscodeSeek { 20 }, cache);
+        probe.open(UPNP_READ);
+        EXPECT_EQ(read(probe, 30), output.substr(200, 30));
+        probe.close();
+    }
+    EXPECT_EQ(cache.getEntryCount(), 1);
+
+    // a different start time needs its own transcoder
+    SeekableTranscodeIOHandler other(starter(), "key", TranscodeSeek { 10 }, cache);
+    EXPECT_EQ(read(other, 10), output.substr(100, 10));
+    EXPECT_EQ(starts.size(), 2);
+
+    SeekableTranscodeIOHandler handler(starter(), "key", TranscodeSeek { 20 }, cache);
+    handler.open(UPNP_READ);
+    EXPECT_EQ(read(handler), output.substr(200));
+    EXPECT_EQ(starts.size(), 2);
+    EXPECT_EQ(cache.getEntryCount(), 0);
+}
+
+TEST_F(TranscodeSeekTest, ExpiresParkedTranscoders)
+{
+    TranscodeRestartCache cache(1, std::chrono::seconds(10));
+    std::string prefix;
+    cache.park("first", std::make_unique<SeekTestTranscoder>(output), "");
+    cache.park("second", std::make_unique<SeekTestTranscoder>(output), "abc");
+    EXPECT_EQ(cache.getEntryCount(), 1);
+    EXPECT_EQ(cache.take("first", prefix), nullptr);
+    EXPECT_NE(cache.take("second", prefix), nullptr);
+    EXPECT_EQ(prefix, "abc");
+
+    TranscodeRestartCache expiring(4, std::chrono::milliseconds(0));
+    expiring.park("first", std::make_unique<SeekTestTranscoder>(output), "");
+    EXPECT_EQ(expiring.take("first", prefix), nullptr);
+}
@@ -0,0 +1,163 @@
+/*GRB*
+  Gerbera - https://gerbera.io/
+
+  test_transcode_warm_pool.cc - this file is part of Gerbera.
+
+  Copyright (C) 2021 Gerbera Contributors
+
+  Gerbera is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License version 2
+  as published by the Free Software Foundation.
+
+  Gerbera is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+  $Id$
+*/
+#include "transcoding/transcode_warm_pool.h"
+#include "transcoding/transcoding.h"
+#include "util/process_executor.h"
+
+#include <csignal>
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../mock/config_mock.h"
+
+using namespace std::chrono_literals;
+using ::testing::_;
+using ::testing::Return;
+
+class WarmPoolConfigMock : public ConfigMock {
+public:
+    bool getBoolOption(config_option_t option) const override { return option == CFG_TRANSCODING_TRANSCODING_ENABLED; }
+};
+
+static std::string readOutput(int fd)
+{
+    std::string result;
+    char buf[256];
+    ssize_t len;
+    while ((len = ::read(fd, buf, sizeof(buf))) > 0)
+        result.append(buf, len);
+    ::close(fd);
+    return result;
+}
+
+TEST(TranscodeWarmPoolTest, ExecutesCommandInHelper)
+{
+    auto process = WarmProcess(true);
+    auto pid = process.getPid();
+    ASSERT_GT(pid, 0);
+
+    ASSERT_TRUE(process.exec("/bin/sh", { "sh", "-c", "echo $GRB_WARM_TEST" }, { { "GRB_WARM_TEST", "warm" } }));
+    EXPECT_EQ(process.getPid(), pid);
+    EXPECT_EQ(readOutput(process.releaseOutput()), "warm\n");
+
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(TranscodeWarmPoolTest, HelperClosesInheritedDescriptors)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    auto process = WarmProcess(true);
+    auto pid = process.getPid();
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    auto script = fmt::format("test -e /proc/self/fd/{} && echo open || echo closed", fds[1]);
+    ASSERT_TRUE(process.exec("/bin/sh", { "sh", "-c", script }, {}));
+    EXPECT_EQ(readOutput(process.releaseOutput()), "closed\n");
+    waitpid(pid, nullptr, 0);
+}
+
+TEST(TranscodeWarmPoolTest, UnusedHelperExits)
+{
+    pid_t pid;
+    {
+        auto process = WarmProcess(false);
+        pid = process.getPid();
+        ASSERT_EQ(::kill(pid, 0), 0);
+    }
+    // reaped by the destructor
+    EXPECT_EQ(::kill(pid, 0), -1);
+}
+
+TEST(TranscodeWarmPoolTest, ResolvesCommands)
+{
+    auto pool = TranscodeWarmPool(std::make_shared<ConfigMock>());
+    auto path = pool.resolveCommand("sh");
+    EXPECT_TRUE(path.is_absolute());
+    EXPECT_EQ(path.filename(), "sh");
+    EXPECT_EQ(pool.resolveCommand("sh"), path);
+    EXPECT_EQ(pool.resolveCommand(path), path);
+
+    EXPECT_THROW(pool.resolveCommand("grb-no-such-transcoder"), std::runtime_error);
+    EXPECT_THROW(pool.resolveCommand("/grb/no/such/transcoder"), std::runtime_error);
+}
+
+TEST(TranscodeWarmPoolTest, KeepsHelpersOfProfile)
+{
+    auto profile = std::make_shared<TranscodingProfile>(TR_External, "warm");
+    profile->setCommand("sh");
+    profile->setWarmProcesses(2);
+    auto list = std::make_shared<TranscodingProfileList>();
+    list->add("audio/x-test", profile);
+
+    auto config = std::make_shared<WarmPoolConfigMock>();
+    EXPECT_CALL(*config, getTranscodingProfileListOption(_)).WillRepeatedly(Return(list));
+    EXPECT_CALL(*config, getOption(_)).WillRepeatedly(Return(fs::temp_directory_path().string()));
+
+    auto pool = TranscodeWarmPool(config);
+    pool.run();
+
+    std::unique_ptr<WarmProcess> process;
+    for (int i = 0; i < 100 && !process; i++) {
+        process = pool.takeProcess(profile);
+        if (!process)
+            std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_NE(process, nullptr);
+
+    // the adopted process is killed and reaped by the executor
+    ASSERT_TRUE(process->exec(pool.resolveCommand("sh"), { "sh", "-c", "sleep 10" }, {}));
+    auto executor = ProcessExecutor(process->getPid(), {});
+    EXPECT_TRUE(executor.isAlive());
+    EXPECT_TRUE(executor.kill());
+
+    // other profiles have no helpers
+    auto other = std::make_shared<TranscodingProfile>(TR_External, "cold");
+    EXPECT_EQ(pool.takeProcess(other), nullptr);
+    pool.shutdown();
+}
+
+TEST(TranscodeWarmPoolTest, SumsUpTimings)
+{
+    auto pool = TranscodeWarmPool(std::make_shared<ConfigMock>());
+    TranscodeStartupTimings timings;
+    timings.spawn = 100us;
+    timings.firstData = 5ms;
+    pool.addTimings("mp3", timings);
+    timings.spawn = 300us;
+    timings.warm = true;
+    pool.addTimings("mp3", timings);
+
+    auto stats = pool.getStatistics("mp3");
+    EXPECT_EQ(stats.starts, 2U);
+    EXPECT_EQ(stats.warmStarts, 1U);
+    EXPECT_EQ(stats.total.spawn, 400us);
+    EXPECT_EQ(stats.max.spawn, 300us);
+    EXPECT_EQ(stats.total.firstData, 10ms);
+    EXPECT_EQ(pool.getStatistics("ogg").starts, 0U);
+}
@@ -1,10 +1,14 @@
+#include <chrono>
+#include <fmt/format.h>
 #include <gtest/gtest.h>
+#include <iostream>
 
 #include "cds_objects.h"
 #include "common.h"
 #include "metadata/metadata_handler.h"
 #include "transcoding/transcoding.h"
 #include "upnp_xml.h"
+#include "util/logger.h"
 
 #include "../mock/config_mock.h"
 #include "../mock/database_mock.h"
@@ -267,3 +271,53 @@ TEST_F(UpnpXmlTest, FirstResourceAddsLocalResourceIdToItem)
     EXPECT_NE(result, "");
     EXPECT_STREQ(result.c_str(), "content/media/object_id/12345/res_id/0");
 }
+
+TEST_F(UpnpXmlTest, DISABLED_BenchmarkBrowseWithoutDebugOutput)
+{
+    EXPECT_CALL(*config, getOption(CFG_IMPORT_LIBOPTS_ENTRY_SEP))
+        .WillRepeatedly(Return(" / "));
+    EXPECT_CALL(*config, getTranscodingProfileListOption(_))
+        .WillRepeatedly(Return(std::make_shared<TranscodingProfileList>()));
+
+    std::vector<std::shared_ptr<CdsObject>> objects;
+    for (int i = 0; i < 200; i++) {
+        auto obj = std::make_shared<CdsItem>();
+        obj->setID(i + 10);
+        obj->setParentID(2);
+        obj->setTitle(fmt::format("Track {}", i));
+        obj->setClass(UPNP_CLASS_MUSIC_TRACK);
+        obj->addMetaData(M_ARTIST, "Artist");
+        obj->addMetaData(M_ALBUM, "Album");
+        obj->addMetaData(M_TRACKNUMBER, fmt::to_string(i));
+        objects.push_back(obj);
+    }
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::info);
+
+    // the rendering loop of doBrowse, eager evaluates the argument of the
+    // former unconditional "Rendered DIDL" message like before
+    std::size_t size = 0;
+    auto browse = [&](bool eager) {
+        constexpr int rounds = 50;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++) {
+            pugi::xml_document didlLite;
+            auto root = didlLite.append_child("DIDL-Lite");
+            for (auto&& obj : objects) {
+                subject->renderObject(obj, std::string::npos, root);
+                if (eager)
+                    size += UpnpXMLBuilder::printXml(root.last_child(), "  ").size();
+            }
+            size += UpnpXMLBuilder::printXml(didlLite, "", 0).size();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        return rounds / elapsed.count();
+    };
+    auto before = browse(true);
+    auto after = browse(false);
+    spdlog::set_level(level);
+
+    std::cout << fmt::format("browse of {} items with debug off: eager {:.0f}/s, lazy {:.0f}/s\n", objects.size(), before, after);
+    EXPECT_GT(size, 0);
+}
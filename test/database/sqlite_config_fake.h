@@ -47,6 +47,8 @@ public:
         return {};
     }
     void addOption(config_option_t option, std::shared_ptr<ConfigOption> optionValue) override { }
+    std::shared_ptr<const ConfigSnapshot> getSnapshot() const override { return snapshot; }
+    void updateSnapshot() override { }
     int getIntOption(config_option_t option) const override { return 0; }
     bool getBoolOption(config_option_t option) const override
     {
@@ -68,6 +70,8 @@ public:
     bool hasOrigValue(const std::string& item) const override { return false; }
     std::shared_ptr<TranscodingProfileList> getTranscodingProfileListOption(config_option_t option) const override { return nullptr; }
     std::shared_ptr<DynamicContentList> getDynamicContentListOption(config_option_t option) const override { return nullptr; }
+
+    std::shared_ptr<ConfigSnapshot> snapshot { std::make_shared<ConfigSnapshot>() };
 };
 
 #endif //GERBERA_SQLITE_CONFIG_FAKE_H
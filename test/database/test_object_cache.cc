@@ -0,0 +1,144 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    test_object_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file test_object_cache.cc
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "cds_objects.h"
+#include "database/object_cache.h"
+
+class ObjectCacheTest : public ::testing::Test {
+public:
+    ObjectCache::Loader loader(int objectID, int parentID = 1, int refID = INVALID_OBJECT_ID)
+    {
+        return [this, objectID, parentID, refID]() {
+            loads++;
+            auto item = std::make_shared<CdsItem>();
+            item->setID(objectID);
+            item->setParentID(parentID);
+            item->setRefID(refID);
+            item->setTitle(fmt::format("Item {}", objectID));
+            item->setMimeType("video/mp4");
+            return item;
+        };
+    }
+
+    int loads {};
+};
+
+TEST_F(ObjectCacheTest, ReturnsCopiesOfCachedItems)
+{
+    auto cache = ObjectCache(10, std::chrono::seconds(60));
+
+    auto first = cache.get(42, loader(42));
+    auto second = cache.get(42, loader(42));
+    EXPECT_EQ(loads, 1);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(second->getTitle(), "Item 42");
+    EXPECT_EQ(std::static_pointer_cast<CdsItem>(second)->getMimeType(), "video/mp4");
+
+    // callers may modify their copy
+    second->setFlag(OBJECT_FLAG_PLAYED);
+    EXPECT_FALSE(cache.get(42, loader(42))->getFlag(OBJECT_FLAG_PLAYED));
+}
+
+TEST_F(ObjectCacheTest, ContainersAreNotCached)
+{
+    auto cache = ObjectCache(10, std::chrono::seconds(60));
+    auto containerLoader = [this]() {
+        loads++;
+        auto container = std::make_shared<CdsContainer>();
+        container->setID(7);
+        return container;
+    };
+    cache.get(7, containerLoader);
+    cache.get(7, containerLoader);
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST_F(ObjectCacheTest, EntriesExpire)
+{
+    auto cache = ObjectCache(10, std::chrono::milliseconds(20));
+    cache.get(42, loader(42));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    cache.get(42, loader(42));
+    EXPECT_EQ(loads, 2);
+}
+
+TEST_F(ObjectCacheTest, LeastRecentlyUsedIsEvicted)
+{
+    auto cache = ObjectCache(2, std::chrono::seconds(60));
+    cache.get(1, loader(1));
+    cache.get(2, loader(2));
+    cache.get(1, loader(1));
+    cache.get(3, loader(3));
+    EXPECT_EQ(loads, 3);
+    EXPECT_EQ(cache.size(), 2U);
+
+    cache.get(1, loader(1));
+    EXPECT_EQ(loads, 3);
+    cache.get(2, loader(2));
+    EXPECT_EQ(loads, 4);
+}
+
+TEST_F(ObjectCacheTest, ChangedContainersInvalidateChildren)
+{
+    auto cache = ObjectCache(10, std::chrono::seconds(60));
+    cache.get(10, loader(10, 1));
+    cache.get(11, loader(11, 1));
+    cache.get(20, loader(20, 2));
+    EXPECT_EQ(cache.size(), 3U);
+
+    cache.containersChanged({ 1 });
+    EXPECT_EQ(cache.size(), 1U);
+
+    cache.remove(20);
+    EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST_F(ObjectCacheTest, ChangedObjectsInvalidateReferences)
+{
+    auto cache = ObjectCache(10, std::chrono::seconds(60));
+    cache.get(10, loader(10, 1));
+    cache.get(30, loader(30, 3, 10));
+    cache.get(40, loader(40, 4, 11));
+    EXPECT_EQ(cache.size(), 3U);
+
+    cache.remove(10);
+    EXPECT_EQ(cache.size(), 1U);
+
+    cache.get(11, loader(11, 1));
+    cache.containersChanged({ 1 });
+    EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST_F(ObjectCacheTest, ChangeDuringLoadIsNotCached)
+{
+    auto cache = ObjectCache(10, std::chrono::seconds(60));
+    cache.get(10, [&]() {
+        // the object is modified while the old state is loaded
+        cache.containersChanged({ 1 });
+        return loader(10, 1)();
+    });
+    EXPECT_EQ(cache.size(), 0U);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "database/slow_query_log.h"
+
+using namespace std::chrono_literals;
+
+TEST(SlowQueryLogTest, NormalizesLiterals)
+{
+    EXPECT_EQ(SlowQueryLog::normalize(R"(SELECT "c"."id" FROM "mt_cds_object" "c" WHERE "c"."parent_id" = 12 AND "c"."title" = 'it''s' LIMIT 10,  25)"),
+        R"(SELECT "c"."id" FROM "mt_cds_object" "c" WHERE "c"."parent_id" = ? AND "c"."title" = ? LIMIT ?, ?)");
+    EXPECT_EQ(SlowQueryLog::normalize("DELETE FROM `mt_cds_object` WHERE `id` IN (1, 2,3)"),
+        "DELETE FROM `mt_cds_object` WHERE `id` IN (?...)");
+    EXPECT_EQ(SlowQueryLog::normalize("DELETE FROM `mt_cds_object` WHERE `id` IN (7)"),
+        "DELETE FROM `mt_cds_object` WHERE `id` IN (?)");
+    EXPECT_EQ(SlowQueryLog::normalize("SELECT\n  \"col2\"\tFROM \"t1\" WHERE x = '1 2'"),
+        "SELECT \"col2\" FROM \"t1\" WHERE x = ?");
+}
+
+TEST(SlowQueryLogTest, AggregatesStatements)
+{
+    SlowQueryLog log(10ms);
+    EXPECT_EQ(log.getThreshold(), 10ms);
+
+    {
+        auto operation = SlowQueryLog::Operation("browse");
+        log.record("SELECT * FROM t WHERE id = 1", 20ms, 1);
+        {
+            auto inner = SlowQueryLog::Operation("getChildCount");
+            log.record("SELECT * FROM t WHERE id = 2", 50ms, 3);
+        }
+        log.record("SELECT * FROM t WHERE id = 3", 30ms, 2);
+    }
+    log.record("DELETE FROM t WHERE id IN (1,2)", 100ms, 2);
+
+    auto entries = log.getEntries();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].statement, "DELETE FROM t WHERE id IN (?...)");
+    EXPECT_EQ(entries[0].operation, "other");
+    EXPECT_EQ(entries[1].statement, "SELECT * FROM t WHERE id = ?");
+    EXPECT_EQ(entries[1].count, 3);
+    EXPECT_EQ(entries[1].total, 100ms);
+    EXPECT_EQ(entries[1].max, 50ms);
+    EXPECT_EQ(entries[1].example, "SELECT * FROM t WHERE id = 2");
+    EXPECT_EQ(entries[1].operation, "getChildCount");
+    EXPECT_EQ(entries[1].rows, 3);
+}
+
+TEST(SlowQueryLogTest, ExplainsEachStatementOnce)
+{
+    SlowQueryLog log(10ms);
+    int calls = 0;
+    auto explain = [&] {
+        calls++;
+        return std::string("SCAN t");
+    };
+    log.record("SELECT * FROM t WHERE id = 1", 20ms, 1, explain);
+    log.record("SELECT * FROM t WHERE id = 2", 20ms, 1, explain);
+
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(log.getEntries()[0].plan, "SCAN t");
+}
+
+TEST(SlowQueryLogTest, KeepsExpensiveStatements)
+{
+    SlowQueryLog log(10ms, 2);
+    log.record("SELECT a FROM t", 100ms, 0);
+    log.record("SELECT b FROM t", 20ms, 0);
+    log.record("SELECT c FROM t", 50ms, 0);
+
+    auto entries = log.getEntries();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].statement, "SELECT a FROM t");
+    EXPECT_EQ(entries[1].statement, "SELECT c FROM t");
+}
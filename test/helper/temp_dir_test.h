@@ -0,0 +1,32 @@
+#ifndef __TEMP_DIR_TEST_H__
+#define __TEMP_DIR_TEST_H__
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "util/grb_fs.h"
+
+/// \brief fixture with an empty directory per test suite, removed after each test
+///
+/// Fixtures that need their own SetUp/TearDown call the ones of this class first/last.
+class TempDirTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        auto info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir = fs::temp_directory_path() / fmt::format("grb-{}-{}", info->test_suite_name(), ::getpid());
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    fs::path dir;
+};
+
+#endif // __TEMP_DIR_TEST_H__
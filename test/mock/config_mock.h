@@ -5,12 +5,15 @@
 #include <gtest/gtest.h>
 
 #include "config/config.h"
+#include "config/config_snapshot.h"
 
 class ConfigMock : public Config {
 public:
     fs::path getConfigFilename() const override { return {}; }
     MOCK_METHOD(std::string, getOption, (config_option_t option), (const override));
     void addOption(config_option_t option, std::shared_ptr<ConfigOption> optionValue) override { }
+    std::shared_ptr<const ConfigSnapshot> getSnapshot() const override { return snapshot; }
+    void updateSnapshot() override { }
     int getIntOption(config_option_t option) const override { return 0; }
     bool getBoolOption(config_option_t option) const override { return false; }
     std::map<std::string, std::string> getDictionaryOption(config_option_t option) const override
@@ -46,6 +49,8 @@ public:
     bool hasOrigValue(const std::string& item) const override { return false; }
     MOCK_METHOD(std::shared_ptr<TranscodingProfileList>, getTranscodingProfileListOption, (config_option_t option), (const override));
     MOCK_METHOD(std::shared_ptr<DynamicContentList>, getDynamicContentListOption, (config_option_t option), (const override));
+
+    std::shared_ptr<ConfigSnapshot> snapshot { std::make_shared<ConfigSnapshot>() };
 };
 
 #endif // __CONFIG_MOCK_H__
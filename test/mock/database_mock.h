@@ -30,7 +30,8 @@ public:
     std::vector<std::shared_ptr<CdsObject>> findObjectByContentClass(const std::string& contentClass) override { return {}; }
     std::shared_ptr<CdsObject> findObjectByPath(const fs::path& path, bool wasRegularFile = false) override { return {}; }
     int findObjectIDByPath(const fs::path& fullpath, bool wasRegularFile = false) override { return INVALID_OBJECT_ID; }
-    std::string incrementUpdateIDs(const std::unordered_set<int>& ids) override { return {}; }
+    std::unordered_map<int, UpdateID> loadUpdateIDs(const std::unordered_set<int>& ids) override { return {}; }
+    void storeUpdateIDs(const std::unordered_map<int, int>& updateIDs) override { }
 
     std::shared_ptr<CdsObject> loadObject(int objectID) override { return nullptr; }
     int getChildCount(int contId, bool containers = true, bool items = true, bool hideFsRoot = false) override { return 0; }
@@ -0,0 +1,53 @@
+#include "util/logger.h"
+
+#include <gtest/gtest.h>
+
+class LoggerTest : public ::testing::Test {
+public:
+    void SetUp() override { level = spdlog::get_level(); }
+    void TearDown() override { spdlog::set_level(level); }
+
+    spdlog::level::level_enum level;
+};
+
+TEST_F(LoggerTest, DebugArgumentsAreOnlyEvaluatedWhenLogged)
+{
+    int calls = 0;
+    auto expensive = [&] { return ++calls; };
+
+    spdlog::set_level(spdlog::level::info);
+    log_debug("value {}", expensive());
+    EXPECT_EQ(calls, 0);
+
+    spdlog::set_level(spdlog::level::debug);
+    log_debug("value {}", expensive());
+    // log_debug compiles to nothing above SPDLOG_LEVEL_DEBUG, so read the counter through expensive() itself
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+    EXPECT_EQ(expensive(), 2);
+#else
+    EXPECT_EQ(expensive(), 1);
+#endif
+}
+
+TEST_F(LoggerTest, FacilitiesAreEnabledByName)
+{
+    EXPECT_FALSE(GrbLogger::isEnabled(GrbLogFacility::cds));
+    EXPECT_FALSE(GrbLogger::isEnabled(GrbLogFacility::sql));
+
+    GrbLogger::enableFacilities("Cds, sql");
+    EXPECT_TRUE(GrbLogger::isEnabled(GrbLogFacility::cds));
+    EXPECT_TRUE(GrbLogger::isEnabled(GrbLogFacility::sql));
+    EXPECT_FALSE(GrbLogger::isEnabled(GrbLogFacility::xml));
+
+    EXPECT_THROW(GrbLogger::enableFacilities("cds,unknown"), std::runtime_error);
+
+    int calls = 0;
+    auto expensive = [&] { return ++calls; };
+    spdlog::set_level(spdlog::level::debug);
+    log_vdebug(xml, "value {}", expensive());
+    EXPECT_EQ(expensive(), 1);
+
+    GrbLogger::enableFacilities("all");
+    EXPECT_TRUE(GrbLogger::isEnabled(GrbLogFacility::xml));
+    EXPECT_TRUE(GrbLogger::isEnabled(GrbLogFacility::clients));
+}
@@ -0,0 +1,110 @@
+#include "util/metrics.h"
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(MetricsTest, BucketsCoverAllValues)
+{
+    for (std::uint64_t v = 0; v < 100000; v++) {
+        auto bucket = MetricHistogram::bucketIndex(v);
+        EXPECT_LE(v, MetricHistogram::bucketLimit(bucket)) << v;
+        if (bucket > 0) {
+            EXPECT_GT(v, MetricHistogram::bucketLimit(bucket - 1)) << v;
+        }
+    }
+    EXPECT_EQ(MetricHistogram::bucketIndex(std::numeric_limits<std::uint64_t>::max()), MetricHistogram::BUCKETS - 1);
+}
+
+TEST(MetricsTest, BucketsAreNarrow)
+{
+    for (std::size_t bucket = MetricHistogram::SUB_BUCKETS; bucket < MetricHistogram::BUCKETS; bucket++) {
+        auto lower = MetricHistogram::bucketLimit(bucket - 1) + 1;
+        auto upper = MetricHistogram::bucketLimit(bucket);
+        EXPECT_LE((upper - lower + 1) * 4, lower) << bucket;
+    }
+}
+
+TEST(MetricsTest, HistogramQuantiles)
+{
+    MetricHistogram histogram;
+    EXPECT_EQ(histogram.getQuantile(0.5), 0us);
+
+    for (int i = 1; i <= 1000; i++)
+        histogram.record(std::chrono::microseconds(i));
+
+    EXPECT_EQ(histogram.getCount(), 1000);
+    EXPECT_EQ(histogram.getSum(), 500500us);
+
+    auto p50 = histogram.getQuantile(0.5).count();
+    EXPECT_GE(p50, 500);
+    EXPECT_LE(p50, 500 * 5 / 4);
+    auto p99 = histogram.getQuantile(0.99).count();
+    EXPECT_GE(p99, 990);
+    EXPECT_LE(p99, 990 * 5 / 4);
+}
+
+TEST(MetricsTest, TimerRecordsOnce)
+{
+    MetricHistogram histogram;
+    {
+        auto timer = MetricTimer(histogram);
+        timer.stop();
+        timer.stop();
+    }
+    EXPECT_EQ(histogram.getCount(), 1);
+}
+
+TEST(MetricsTest, RegistryReturnsSameMetric)
+{
+    Metrics metrics;
+    auto&& a = metrics.counter("test_total", "Test", R"(kind="a")");
+    auto&& b = metrics.counter("test_total", "Test", R"(kind="b")");
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(&a, &metrics.counter("test_total", "Test", R"(kind="a")"));
+    EXPECT_THROW(metrics.gauge("test_total", "Test", R"(kind="a")"), std::runtime_error);
+}
+
+TEST(MetricsTest, RendersPrometheus)
+{
+    Metrics metrics;
+    metrics.counter("test_bytes_total", "Bytes read", R"(handler="file")").inc(42);
+    metrics.gauge("test_queue_length", "Queue length").set(3);
+    auto&& histogram = metrics.histogram("test_seconds", "Duration", R"(action="Browse")");
+    histogram.record(10us);
+    histogram.record(100ms);
+
+    auto text = metrics.renderPrometheus();
+    EXPECT_NE(text.find("# HELP test_bytes_total Bytes read\n# TYPE test_bytes_total counter\ntest_bytes_total{handler=\"file\"} 42\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("# TYPE test_queue_length gauge\ntest_queue_length 3\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("# TYPE test_seconds histogram\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("test_seconds_bucket{action=\"Browse\",le=\"6.4e-05\"} 1\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("test_seconds_bucket{action=\"Browse\",le=\"0.262144\"} 2\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("test_seconds_bucket{action=\"Browse\",le=\"+Inf\"} 2\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("test_seconds_sum{action=\"Browse\"} 0.10001\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("test_seconds_count{action=\"Browse\"} 2\n"), std::string::npos) << text;
+}
+
+TEST(MetricsTest, ConcurrentUpdates)
+{
+    Metrics metrics;
+    auto&& counter = metrics.counter("test_total", "Test");
+    auto&& histogram = metrics.histogram("test_seconds", "Test");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; i++) {
+                counter.inc();
+                histogram.record(std::chrono::microseconds(i));
+            }
+        });
+    }
+    for (auto&& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(counter.get(), 40000);
+    EXPECT_EQ(histogram.getCount(), 40000);
+}
@@ -0,0 +1,112 @@
+#include "util/ring_buffer.h"
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+
+static std::size_t writeAll(SpscRingBuffer& ring, const char* data, std::size_t length)
+{
+    std::size_t written = 0;
+    while (written < length) {
+        std::size_t maxWrite;
+        char* target = ring.writeArea(maxWrite);
+        if (maxWrite == 0)
+            break;
+        auto chunk = std::min(maxWrite, length - written);
+        std::memcpy(target, data + written, chunk);
+        ring.commit(chunk);
+        written += chunk;
+    }
+    return written;
+}
+
+TEST(RingBufferTest, FillAndDrain)
+{
+    SpscRingBuffer ring(8);
+    EXPECT_EQ(ring.size(), 0U);
+    EXPECT_EQ(ring.space(), 8U);
+
+    EXPECT_EQ(writeAll(ring, "0123456789", 10), 8U);
+    EXPECT_EQ(ring.size(), 8U);
+    EXPECT_EQ(ring.space(), 0U);
+
+    char buf[16];
+    EXPECT_EQ(ring.read(buf, 5), 5U);
+    EXPECT_EQ(std::string(buf, 5), "01234");
+    EXPECT_EQ(ring.space(), 5U);
+
+    // wraps around the end of the memory
+    EXPECT_EQ(writeAll(ring, "abcde", 5), 5U);
+    EXPECT_EQ(ring.read(buf, sizeof(buf)), 8U);
+    EXPECT_EQ(std::string(buf, 8), "567abcde");
+    EXPECT_EQ(ring.read(buf, sizeof(buf)), 0U);
+}
+
+TEST(RingBufferTest, SkipAndClear)
+{
+    SpscRingBuffer ring(8);
+    writeAll(ring, "012345", 6);
+    EXPECT_EQ(ring.skip(4), 4U);
+    EXPECT_EQ(ring.skip(4), 2U);
+    EXPECT_EQ(ring.size(), 0U);
+
+    writeAll(ring, "abc", 3);
+    ring.clear();
+    EXPECT_EQ(ring.size(), 0U);
+
+    // a cleared ring offers its whole memory in one piece
+    std::size_t maxWrite;
+    ring.writeArea(maxWrite);
+    EXPECT_EQ(maxWrite, 8U);
+}
+
+TEST(RingBufferTest, TransfersBetweenThreads)
+{
+    constexpr std::size_t total = 4 * 1024 * 1024;
+    SpscRingBuffer ring(4096);
+    EventCount dataEvent;
+    EventCount spaceEvent;
+
+    std::thread producer([&]() {
+        std::vector<char> chunk(1000);
+        std::size_t written = 0;
+        while (written < total) {
+            auto length = std::min(chunk.size(), total - written);
+            for (std::size_t i = 0; i < length; i++)
+                chunk[i] = char((written + i) % 251);
+            std::size_t done = 0;
+            while (done < length) {
+                auto key = spaceEvent.prepareWait();
+                if (ring.space() == 0) {
+                    spaceEvent.wait(key);
+                    continue;
+                }
+                spaceEvent.cancelWait();
+                done += writeAll(ring, chunk.data() + done, length - done);
+                dataEvent.notify();
+            }
+            written += length;
+        }
+    });
+
+    std::vector<char> buf(777);
+    std::size_t received = 0;
+    bool valid = true;
+    while (received < total) {
+        auto key = dataEvent.prepareWait();
+        if (ring.size() == 0) {
+            dataEvent.wait(key);
+            continue;
+        }
+        dataEvent.cancelWait();
+        auto length = ring.read(buf.data(), buf.size());
+        spaceEvent.notify();
+        for (std::size_t i = 0; i < length; i++)
+            valid = valid && buf[i] == char((received + i) % 251);
+        received += length;
+    }
+    producer.join();
+
+    EXPECT_EQ(received, total);
+    EXPECT_TRUE(valid);
+}
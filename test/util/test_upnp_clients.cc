@@ -1,4 +1,7 @@
+#include <chrono>
+#include <fmt/format.h>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <upnp.h>
 
 #include "config/client_config.h"
@@ -41,13 +44,26 @@ public:
         memcpy(addr, &sin, sizeof(sin));
     }
 
+    static void fillAddr6(struct sockaddr_storage* addr, const char* ip)
+    {
+        struct sockaddr_in6 sin6 = {};
+        sin6.sin6_family = AF_INET6;
+        inet_pton(AF_INET6, ip, &sin6.sin6_addr);
+        memcpy(addr, &sin6, sizeof(sin6));
+    }
+
+    void addClient(int flags, std::string_view ip, std::string_view userAgent)
+    {
+        config->list->add(std::make_shared<ClientConfig>(flags, ip, userAgent));
+    }
+
     Clients* subject;
     std::shared_ptr<MyConfigMock> config;
 };
 
 TEST_F(UpnpClientsTest, bubbleUPnPV3_4_4)
 {
-    const ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo;
     struct sockaddr_storage addr;
     fillAddr(&addr, "192.168.1.42");
 
@@ -62,7 +78,7 @@ TEST_F(UpnpClientsTest, bubbleUPnPV3_4_4)
 
 TEST_F(UpnpClientsTest, foobar2000V1_6_2)
 {
-    const ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo;
     struct sockaddr_storage addr;
     fillAddr(&addr, "192.168.1.42");
 
@@ -77,7 +93,7 @@ TEST_F(UpnpClientsTest, foobar2000V1_6_2)
 
 TEST_F(UpnpClientsTest, kodiV18_9)
 {
-    const ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo;
     struct sockaddr_storage addr;
     fillAddr(&addr, "192.168.1.42");
 
@@ -92,7 +108,7 @@ TEST_F(UpnpClientsTest, kodiV18_9)
 
 TEST_F(UpnpClientsTest, samsungTVQ70)
 {
-    const ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo;
     struct sockaddr_storage addr;
     fillAddr(&addr, "192.168.1.42");
 
@@ -107,7 +123,7 @@ TEST_F(UpnpClientsTest, samsungTVQ70)
 
 TEST_F(UpnpClientsTest, vlcV3_0_11_1)
 {
-    const ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo;
     struct sockaddr_storage addr;
     fillAddr(&addr, "192.168.1.42");
 
@@ -126,13 +142,13 @@ TEST_F(UpnpClientsTest, windows10)
     fillAddr(&addr, "192.168.1.42");
 
     // via actionReq (e.g. doBrowse)
-    const ClientInfo* pInfo = subject->getInfo(&addr, "Microsoft-Windows/10.0 UPnP/1.0 Microsoft-DLNA DLNADOC/1.50");
+    std::shared_ptr<const ClientInfo> pInfo = subject->getInfo(&addr, "Microsoft-Windows/10.0 UPnP/1.0 Microsoft-DLNA DLNADOC/1.50");
     EXPECT_EQ(pInfo->type, ClientType::StandardUPnP);
 }
 
 TEST_F(UpnpClientsTest, multipleClientsOnSameIP)
 {
-    const ClientInfo* pInfo;
+    std::shared_ptr<const ClientInfo> pInfo;
     struct sockaddr_storage addr;
     fillAddr(&addr, "192.168.1.42");
 
@@ -153,6 +169,173 @@ TEST_F(UpnpClientsTest, multipleClientsOnSameIP)
     EXPECT_EQ(pInfo->type, ClientType::StandardUPnP);
 }
 
+TEST_F(UpnpClientsTest, networkRules)
+{
+    addClient(1, "10.0.0.0/8", "");
+    addClient(2, "10.1.0.0/16", "");
+    addClient(3, "10.1.2.3", "");
+    addClient(4, "not an address", "");
+    subject->refresh(config);
+
+    struct sockaddr_storage addr;
+    fillAddr(&addr, "10.2.3.4");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 1);
+    fillAddr(&addr, "10.1.9.9");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 2);
+    fillAddr(&addr, "10.1.2.3");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 3);
+    fillAddr(&addr, "11.1.2.3");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, QUIRK_FLAG_NONE);
+    fillAddr(&addr, "192.168.1.100");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 123);
+}
+
+TEST_F(UpnpClientsTest, ipv6Rules)
+{
+    addClient(5, "fd00::/8", "");
+    addClient(6, "fd00::42", "");
+    subject->refresh(config);
+
+    struct sockaddr_storage addr;
+    fillAddr6(&addr, "fd12::1");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 5);
+    fillAddr6(&addr, "fd00::42");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 6);
+    fillAddr6(&addr, "fe80::42");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, QUIRK_FLAG_NONE);
+
+    // IPv4 client on a dual stack socket
+    fillAddr6(&addr, "::ffff:192.168.1.100");
+    EXPECT_EQ(subject->getInfo(&addr, "")->flags, 123);
+}
+
+TEST_F(UpnpClientsTest, laterUserAgentRulesWin)
+{
+    addClient(7, "", "Kodi");
+    addClient(8, "", "Kodi/18");
+    subject->refresh(config);
+
+    struct sockaddr_storage addr;
+    fillAddr(&addr, "192.168.1.42");
+    EXPECT_EQ(subject->getInfo(&addr, "UPnP/1.0 DLNADOC/1.50 Kodi")->flags, 7);
+    EXPECT_EQ(subject->getInfo(&addr, "Kodi/18.9 (Windows NT 10.0.19041; Win64; x64)")->flags, 8);
+    EXPECT_EQ(subject->getInfo(&addr, "Kod")->flags, 8); // last match from cache
+    EXPECT_EQ(subject->getInfo(&addr, "DLNADOC/1.50 SEC_HHP_[TV] Samsung Q70 Series/1.0 UPnP/1.0")->type, ClientType::SamsungSeriesQ);
+}
+
+TEST_F(UpnpClientsTest, clientListFollowsRefresh)
+{
+    struct sockaddr_storage addr;
+    fillAddr(&addr, "192.168.1.42");
+    subject->getInfo(&addr, "UPnP/1.0 DLNADOC/1.50 Kodi");
+    fillAddr(&addr, "192.168.1.43");
+    subject->getInfo(&addr, "BubbleUPnP UPnP/1.1");
+
+    auto list = subject->getClientList();
+    ASSERT_EQ(list.size(), 2);
+    EXPECT_EQ(list[0].pInfo->type, ClientType::StandardUPnP);
+    EXPECT_EQ(list[1].pInfo->type, ClientType::BubbleUPnP);
+
+    addClient(9, "", "Kodi");
+    subject->refresh(config);
+
+    list = subject->getClientList();
+    ASSERT_EQ(list.size(), 2);
+    EXPECT_EQ(list[0].pInfo->flags, 9);
+    EXPECT_EQ(list[1].pInfo->type, ClientType::BubbleUPnP);
+}
+
+TEST_F(UpnpClientsTest, cacheIsBounded)
+{
+    struct sockaddr_storage addr;
+    auto maxEntries = Clients::CACHE_SHARDS * Clients::MAX_CACHE_ENTRIES_PER_SHARD;
+    for (std::size_t i = 0; i < 2 * maxEntries; i++) {
+        fillAddr(&addr, fmt::format("10.{}.{}.{}", i / 65536, (i / 256) % 256, i % 256).c_str());
+        subject->getInfo(&addr, "any unknown user-agent info");
+    }
+    EXPECT_LE(subject->getClientList().size(), maxEntries);
+}
+
+TEST_F(UpnpClientsTest, refreshReleasesOldRules)
+{
+    struct sockaddr_storage addr;
+    fillAddr(&addr, "192.168.1.42");
+    std::weak_ptr<const ClientInfo> oldInfo = subject->getInfo(&addr, "UPnP/1.0 DLNADOC/1.50 Kodi");
+    EXPECT_FALSE(oldInfo.expired());
+
+    subject->refresh(config);
+    EXPECT_TRUE(oldInfo.expired());
+    EXPECT_EQ(subject->getClientList().size(), 1);
+}
+
+TEST(ClientUserAgentMatcherTest, allBytesInPatterns)
+{
+    ClientUserAgentMatcher matcher;
+    std::string allBytes;
+    for (int ch = 1; ch < 256; ch++)
+        allBytes.push_back(static_cast<char>(ch));
+    matcher.add(allBytes, 0);
+    matcher.add(std::string(1, '\0'), 1);
+    matcher.add("Kodi", 2);
+    matcher.compile();
+
+    EXPECT_EQ(matcher.find(allBytes), 0);
+    EXPECT_EQ(matcher.find(std::string("x\0y", 3)), 1);
+    EXPECT_EQ(matcher.find("UPnP/1.0 Kodi"), 2);
+    EXPECT_EQ(matcher.find("VLC"), -1);
+}
+
+TEST_F(UpnpClientsTest, DISABLED_BenchmarkManyRules)
+{
+    constexpr int rules = 500;
+    for (int i = 0; i < rules / 2; i++) {
+        addClient(i, fmt::format("10.{}.{}.0/24", i / 256, i % 256), "");
+        addClient(i, "", fmt::format("Vendor{}Player/{}.0", i, i % 10));
+    }
+    subject->refresh(config);
+
+    // linear scan as done before the rules were compiled
+    std::vector<ClientInfo> table;
+    for (std::size_t i = 0; i < config->list->size(); i++)
+        table.push_back(*config->list->get(i)->getClientInfo());
+    auto linear = [&](const std::string& userAgent) {
+        for (auto&& c : table) {
+            if (c.matchType == ClientMatchType::IP) {
+                struct in_addr clientAddr = {};
+                inet_pton(AF_INET, c.match.c_str(), &clientAddr);
+            }
+        }
+        auto it = std::find_if(table.rbegin(), table.rend(), [&](auto&& c) { return c.matchType == ClientMatchType::UserAgent && userAgent.find(c.match) != std::string::npos; });
+        return it != table.rend() ? &(*it) : nullptr;
+    };
+
+    std::vector<std::string> userAgents;
+    for (int i = 0; i < 64; i++)
+        userAgents.push_back(fmt::format("Linux/5.4 UPnP/1.0 Vendor{}Player/{}.0 DLNADOC/1.50", i * 3, (i * 3) % 10));
+
+    constexpr int rounds = 20000;
+    struct sockaddr_storage addr;
+    fillAddr(&addr, "192.168.1.42");
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t found = 0;
+    for (int i = 0; i < rounds; i++)
+        found += linear(userAgents[i % userAgents.size()]) != nullptr;
+    auto linearTime = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(found, rounds);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        auto pInfo = subject->getInfo(&addr, userAgents[i % userAgents.size()]);
+        EXPECT_EQ(pInfo->flags, (i % userAgents.size()) * 3);
+    }
+    auto compiledTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << fmt::format("{} rules, {} lookups: linear {} us, compiled {} us\n", rules, rounds,
+        std::chrono::duration_cast<std::chrono::microseconds>(linearTime).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(compiledTime).count());
+}
+
 // keep this at the end of all tests (otherwise we need a removeClientInfo function...)
 TEST_F(UpnpClientsTest, configuredIP)
 {
@@ -161,7 +344,7 @@ TEST_F(UpnpClientsTest, configuredIP)
     fillAddr(&addr, ip.c_str());
 
     // act
-    const ClientInfo* pInfo = subject->getInfo(&addr, "any unknown user-agent info");
+    std::shared_ptr<const ClientInfo> pInfo = subject->getInfo(&addr, "any unknown user-agent info");
     EXPECT_EQ(pInfo->type, ClientType::Unknown);
     EXPECT_EQ(pInfo->flags, 123);
 }
@@ -29,6 +29,7 @@ import {Tweaks} from "./gerbera-tweak.module.js";
 import {Tree} from './gerbera-tree.module.js';
 import {Updates} from './gerbera-updates.module.js';
 import {Clients} from './gerbera-clients.module.js';
+import {Metrics} from './gerbera-metrics.module.js';
 import {Config} from './gerbera-config.module.js';
 
 export class App {
@@ -46,6 +47,7 @@ export class App {
         'db': [],
         'fs': [],
         'clients': [],
+        'metrics': [],
         'config': [],
       }
     };
@@ -54,6 +56,7 @@ export class App {
       'db': '#nav-db',
       'fs': '#nav-fs',
       'clients': '#nav-clients',
+      'metrics': '#nav-metrics',
       'config': '#nav-config',
     };
   }
@@ -139,6 +142,7 @@ export class App {
         'db': [],
         'fs': [],
         'clients': [],
+        'metrics': [],
         'config': [],
       }
     };
@@ -276,6 +280,7 @@ export class App {
       Autoscan.initialize();
       Updates.initialize();
       Clients.initialize();
+      Metrics.initialize();
       Config.initialize();
       Tweaks.initialize();
       this.getStatus(this.clientConfig).then((response) => {return this.displayStatus(response); });
@@ -321,6 +326,7 @@ export class App {
     Trail.destroy();
     Items.destroy();
     Clients.destroy();
+    Metrics.destroy();
     Config.destroy();
   }
 
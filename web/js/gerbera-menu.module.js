@@ -26,6 +26,7 @@ import {GerberaApp} from "./gerbera-app.module.js";
 import {Trail} from "./gerbera-trail.module.js";
 import {Tree} from "./gerbera-tree.module.js";
 import {Clients} from "./gerbera-clients.module.js";
+import {Metrics} from "./gerbera-metrics.module.js";
 import {Config} from "./gerbera-config.module.js";
 
 const disable = () => {
@@ -74,12 +75,14 @@ const selectType = (menuItem) => {
   $('#home').hide();
   $('#content').show();
   $('#clients').hide();
+  $('#metrics').hide();
   $('#config').hide();
   const type = menuItem.data('gerbera-type');
   Tree.selectType(type, 0);
   GerberaApp.setType(type);
   Items.destroy();
   Clients.destroy();
+  Metrics.destroy();
   Config.destroy();
 };
 
@@ -87,6 +90,7 @@ const selectClients = (menuItem) => {
   $('#home').hide();
   $('#content').hide();
   $('#clients').show();
+  $('#metrics').hide();
   $('#config').hide();
   Trail.destroy();
   const type = menuItem.data('gerbera-type');
@@ -94,6 +98,23 @@ const selectClients = (menuItem) => {
   Clients.menuSelected();
   Items.destroy();
   Clients.destroy();
+  Metrics.destroy();
+  Config.destroy();
+};
+
+const selectMetrics = (menuItem) => {
+  $('#home').hide();
+  $('#content').hide();
+  $('#clients').hide();
+  $('#metrics').show();
+  $('#config').hide();
+  Trail.destroy();
+  const type = menuItem.data('gerbera-type');
+  GerberaApp.setType(type);
+  Metrics.menuSelected();
+  Items.destroy();
+  Clients.destroy();
+  Metrics.destroy();
   Config.destroy();
 };
 
@@ -101,12 +122,14 @@ const selectConfig = (menuItem) => {
   $('#home').hide();
   $('#content').hide();
   $('#clients').hide();
+  $('#metrics').hide();
   $('#config').show();
   const type = menuItem.data('gerbera-type');
   GerberaApp.setType(type);
   Config.menuSelected();
   Items.destroy();
   Clients.destroy();
+  Metrics.destroy();
   Config.destroy();
 };
 
@@ -126,6 +149,9 @@ var click = (event) => {
     case 'SELECT_CLIENTS':
       selectClients(menuItem);
       break;
+    case 'SELECT_METRICS':
+      selectMetrics(menuItem);
+      break;
     case 'SELECT_CONFIG':
       selectConfig(menuItem);
       break;
@@ -139,12 +165,14 @@ var home = function () {
   $('#home').show();
   $('#content').hide();
   $('#clients').hide();
+  $('#metrics').hide();
   $('#config').hide();
   GerberaApp.setType('home');
   Tree.destroy();
   Trail.destroy();
   Items.destroy();
   Clients.destroy();
+  Metrics.destroy();
   Config.destroy();
 };
 
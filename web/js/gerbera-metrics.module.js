@@ -0,0 +1,151 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    gerbera-metrics.module.js - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+import {GerberaApp} from './gerbera-app.module.js';
+import {Auth} from './gerbera-auth.module.js';
+
+const destroy = () => {
+  ['#metricgrid', '#slowquerygrid'].forEach((id) => {
+    const datagrid = $(id);
+    if (datagrid.hasClass('grb-metrics')) {
+      datagrid.metrics('destroy');
+    } else {
+      datagrid.html('');
+    }
+  });
+};
+
+const initialize = () => {
+  $('#metricgrid').html('');
+  $('#slowquerygrid').html('');
+  return Promise.resolve();
+};
+
+const menuSelected = () => {
+  retrieveGerberaItems('metrics')
+    .then((response) => loadItems(response))
+    .catch((err) => GerberaApp.error(err));
+};
+
+const retrieveGerberaItems = (type) => {
+  var requestData = {
+    req_type: type
+  };
+  requestData[Auth.SID] = Auth.getSessionId();
+  return $.ajax({
+    url: GerberaApp.clientConfig.api,
+    type: 'get',
+    data: requestData
+  });
+};
+
+const loadItems = (response) => {
+  if (response.success) {
+    const items = transformItems(response.metrics.metric);
+
+    const datagrid = $('#metricgrid');
+
+    if (datagrid.hasClass('grb-metrics')) {
+      datagrid.metrics('destroy');
+    }
+
+    datagrid.metrics({
+      data: items,
+      itemType: 'metrics'
+    });
+
+    const queries = response.slow_queries ? transformSlowQueries(response.slow_queries.query) : [];
+    const querygrid = $('#slowquerygrid');
+
+    if (querygrid.hasClass('grb-metrics')) {
+      querygrid.metrics('destroy');
+    }
+
+    querygrid.metrics({
+      data: queries,
+      itemType: 'slowqueries',
+      columns: ['operation', 'statement', 'count', 'total', 'max', 'rows'],
+      headings: {
+        operation: 'Operation',
+        statement: 'Slow Statement',
+        count: 'Count',
+        total: 'Total',
+        max: 'Slowest',
+        rows: 'Rows'
+      },
+      emptyText: 'No slow queries recorded'
+    });
+  }
+};
+
+const formatMicros = (us) => {
+  if (us >= 1000000) {
+    return (us / 1000000).toFixed(2) + ' s';
+  }
+  if (us >= 1000) {
+    return (us / 1000).toFixed(1) + ' ms';
+  }
+  return us + ' µs';
+};
+
+const transformItems = (items) => {
+  return items.map((item) => {
+    const widgetItem = {
+      name: item.name,
+      labels: item.labels,
+      help: item.help,
+    };
+    if (item.type === 'histogram') {
+      widgetItem.value = item.count;
+      widgetItem.mean = item.count > 0 ? formatMicros(Math.round(item.sum_us / item.count)) : '';
+      widgetItem.p50 = formatMicros(item.p50_us);
+      widgetItem.p95 = formatMicros(item.p95_us);
+      widgetItem.p99 = formatMicros(item.p99_us);
+    } else {
+      widgetItem.value = item.value;
+    }
+    return widgetItem;
+  });
+};
+
+const transformSlowQueries = (queries) => {
+  return queries.map((query) => {
+    return {
+      operation: query.operation,
+      statement: query.statement,
+      help: query.plan ? query.example + '\n\n' + query.plan : query.example,
+      count: query.count,
+      total: formatMicros(query.total_us),
+      max: formatMicros(query.max_us),
+      rows: query.rows,
+    };
+  });
+};
+
+export const Metrics = {
+  destroy,
+  loadItems,
+  initialize,
+  transformItems,
+  transformSlowQueries,
+  menuSelected,
+};
@@ -26,13 +26,62 @@ import {Tree} from "./gerbera-tree.module.js";
 
 let POLLING_INTERVAL;
 let UI_TIMEOUT;
+let EVENT_SOURCE;
 
 const initialize = () => {
   $('#toast').toast();
   $(document).ajaxComplete(errorCheck);
+  Updates.subscribe();
   return Promise.resolve();
 };
 
+const subscribe = () => {
+  if (EVENT_SOURCE || !window.EventSource || !GerberaApp.isLoggedIn() || !GerberaApp.serverConfig['push-updates']) {
+    return false;
+  }
+  let requestData = {
+    req_type: 'events',
+    updates: 'get'
+  };
+  requestData[Auth.SID] = Auth.getSessionId();
+
+  EVENT_SOURCE = new window.EventSource(GerberaApp.clientConfig.api + '?' + $.param(requestData));
+  EVENT_SOURCE.addEventListener('update', (event) => Updates.pushUpdate(JSON.parse(event.data)));
+  EVENT_SOURCE.addEventListener('error', (event) => Updates.pushError(event));
+  return true;
+};
+
+const unsubscribe = () => {
+  if (EVENT_SOURCE) {
+    EVENT_SOURCE.close();
+    EVENT_SOURCE = undefined;
+  }
+};
+
+const isPushing = () => {
+  return EVENT_SOURCE !== undefined;
+};
+
+const pushUpdate = (response) => {
+  // started before the stream was connected
+  Updates.clearTaskInterval(response);
+  return Updates.updateTask(response)
+    .then((response) => Updates.updateUi(response));
+};
+
+const pushError = (event) => {
+  // the browser reconnects by itself unless the server refused the stream
+  if (event.data) {
+    const response = JSON.parse(event.data);
+    Updates.unsubscribe();
+    Updates.errorCheck(event, {responseJSON: response});
+    Updates.getUpdates(false);
+  } else if (EVENT_SOURCE && EVENT_SOURCE.readyState === window.EventSource.CLOSED) {
+    Updates.unsubscribe();
+    Updates.getUpdates(false);
+  }
+};
+
 const errorCheck = (event, xhr) => {
   const response = xhr.responseJSON;
   if (response && !response.success) {
@@ -147,7 +196,7 @@ const addUiTimer = (interval) => {
 };
 
 const addTaskInterval = () => {
-  if (!Updates.isPolling()) {
+  if (!Updates.isPolling() && !Updates.isPushing()) {
     POLLING_INTERVAL = window.setInterval(function () {
       Updates.getUpdates(false);
     }, GerberaApp.serverConfig['poll-interval']);
@@ -210,8 +259,13 @@ export const Updates = {
   getUpdates,
   initialize,
   isPolling,
+  isPushing,
   isTimer,
+  pushError,
+  pushUpdate,
   showMessage,
+  subscribe,
+  unsubscribe,
   updateTask,
   updateTreeByIds,
   updateUi,
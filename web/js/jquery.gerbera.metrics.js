@@ -0,0 +1,101 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    jquery.gerbera.metrics.js - this file is part of Gerbera.
+
+    Copyright (C) 2021 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+$.widget('grb.metrics', {
+
+  options: {
+    columns: ['name', 'labels', 'value', 'mean', 'p50', 'p95', 'p99'],
+    headings: {
+      name: 'Metric',
+      labels: 'Labels',
+      value: 'Value / Count',
+      mean: 'Mean',
+      p50: 'Median',
+      p95: '95%',
+      p99: '99%'
+    },
+    emptyText: 'No Metrics recorded'
+  },
+
+  _create: function () {
+    this.element.html('');
+    this.element.addClass('grb-metrics');
+    const table = $('<table></table>').addClass('table');
+    const tbody = $('<tbody></tbody>');
+    const thead = $('<thead></thead>');
+    const data = this.options.data;
+    const headings = this.options.headings;
+    const props = this.options.columns;
+    let row, content, text;
+
+    if (data.length > 0) {
+
+      row = $('<tr></tr>');
+      props.forEach( function(p) {
+          content = $('<th></th>');
+          text = $('<span></span>');
+          text.text(headings[p]).appendTo(content);
+          content.addClass('grb-metric-' + p);
+
+          row.append(content);
+      });
+
+      row.addClass('grb-metric');
+      thead.append(row);
+
+      for (let i = 0; i < data.length; i++) {
+        const item = data[i];
+        row = $('<tr></tr>');
+        row.attr('title', item.help);
+
+        props.forEach( function(p) {
+            content = $('<td></td>');
+            text = $('<span></span>');
+            text.text(item[p] !== undefined ? item[p] : '').appendTo(content);
+            content.addClass('grb-metric-' + p);
+            row.append(content);
+        });
+
+        row.addClass('grb-metric');
+        tbody.append(row);
+      }
+      thead.appendTo(table);
+    } else {
+      row = $('<tr></tr>');
+      content = $('<td></td>');
+      $('<span></span>').text(this.options.emptyText).appendTo(content);
+      row.append(content);
+      tbody.append(row);
+    }
+
+    tbody.appendTo(table);
+
+    this.element.append(table);
+    this.element.addClass('with-data');
+  },
+
+  _destroy: function () {
+    this.element.children('table').remove();
+    this.element.removeClass('grb-metrics');
+    this.element.removeClass('with-data');
+  }
+});